@@ -103,8 +103,11 @@ class AddressImpl;
  *   <td>link</td>
  *   <td>A nested map through which properties of the 'link' from
  *       sender/receiver to node can be configured. Current propeties
- *       are name, durable, realiability, x-declare, x-subscribe and
- *       x-bindings.
+ *       are name, durable, realiability, x-declare, x-subscribe,
+ *       x-bindings and, for senders, compression. Compression is not
+ *       negotiated: every receiver of the node must support the
+ *       algorithm named, or it will get the compressed body with the
+ *       qpid.compression property set.
  *   </td>
  * </tr>
  * 
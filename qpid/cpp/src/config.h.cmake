@@ -52,6 +52,7 @@
 
 #define BROKER_SASL_NAME "${QPID_BROKER_SASL_NAME}"
 #cmakedefine HAVE_SASL ${HAVE_SASL}
+#cmakedefine HAVE_ZLIB ${HAVE_ZLIB}
 
 #cmakedefine HAVE_SYS_SDT_H ${HAVE_SYS_SDT_H}
 #cmakedefine HAVE_LOG_AUTHPRIV
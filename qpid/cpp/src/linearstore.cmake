@@ -88,6 +88,7 @@ if (BUILD_LINEARSTORE)
         qpid/linearstore/journal/JournalFile.cpp
         qpid/linearstore/journal/JournalLog.cpp
         qpid/linearstore/journal/LinearFileController.cpp
+        qpid/linearstore/journal/MappedFileCache.cpp
         qpid/linearstore/journal/pmgr.cpp
         qpid/linearstore/journal/RecoveryManager.cpp
         qpid/linearstore/journal/time_ns.cpp
@@ -105,8 +106,10 @@ if (BUILD_LINEARSTORE)
         qpid/linearstore/IdDbt.cpp
         qpid/linearstore/IdSequence.cpp
         qpid/linearstore/JournalImpl.cpp
+        qpid/linearstore/LatencyHistogram.cpp
         qpid/linearstore/MessageStoreImpl.cpp
         qpid/linearstore/PreparedTransaction.cpp
+        qpid/linearstore/SharedContentStore.cpp
         qpid/linearstore/JournalLogImpl.cpp
         qpid/linearstore/TxnCtxt.cpp
     )
@@ -24,6 +24,7 @@
 
 #include "qpid/RefCounted.h"
 #include <boost/intrusive_ptr.hpp>
+#include <assert.h>
 
 namespace qpid {
 
@@ -41,8 +42,11 @@ template <class T> class BufferRefT {
     T* begin() const { return begin_; }
     T* end() const { return end_; }
 
+    /** True if no other reference shares the underlying buffer */
+    bool unique() const { return !counter || counter->refCount() == 1; }
+
     /** Return a sub-buffer of the current buffer */
-    BufferRefT sub_buffer(T* begin, T* end) {
+    BufferRefT sub_buffer(T* begin, T* end) const {
         assert(begin_ <= begin && begin <= end_);
         assert(begin_ <= end && end <= end_);
         assert(begin <= end);
@@ -50,6 +54,8 @@ template <class T> class BufferRefT {
     }
 
   private:
+    template <class U> friend class BufferRefT;
+
     boost::intrusive_ptr<RefCounted> counter;
     T* begin_;
     T* end_;
@@ -0,0 +1,136 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+#include "qpid/Compression.h"
+#include "qpid/Exception.h"
+#include "qpid/Msg.h"
+
+#include "config.h"
+
+#include <algorithm>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace qpid {
+
+const std::string Compression::PROPERTY("qpid.compression");
+const std::string Compression::DEFLATE("deflate");
+const size_t Compression::MIN_SIZE(1024);
+// A few KB of deflate data can expand a thousandfold, so never trust
+// the sender to bound the output.
+const size_t Compression::MAX_SIZE(100*1024*1024);
+
+#ifdef HAVE_ZLIB
+
+namespace {
+// Favour speed: the aim is to cut bytes on the wire without making
+// the sender the bottleneck.
+const int LEVEL = Z_BEST_SPEED;
+}
+
+bool Compression::isSupported(const std::string& algorithm)
+{
+    return algorithm == DEFLATE;
+}
+
+bool Compression::compress(const std::string& algorithm, const char* in, size_t size, std::string& out)
+{
+    if (algorithm != DEFLATE || size < MIN_SIZE) return false;
+    // Size the window and hash table to the body: deflate's default
+    // state is a few hundred KB, which would dominate the cost of
+    // compressing small bodies. The window size is recorded in the
+    // stream header, so any inflater can read the result.
+    int windowBits = 9;
+    while (windowBits < MAX_WBITS && (size_t(1) << windowBits) < size) ++windowBits;
+    int memLevel = windowBits - 7 < MAX_MEM_LEVEL ? windowBits - 7 : MAX_MEM_LEVEL;
+
+    z_stream stream = z_stream();
+    if (deflateInit2(&stream, LEVEL, Z_DEFLATED, windowBits, memLevel, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw Exception(QPID_MSG("Could not initialise " << algorithm << " compression"));
+    }
+    std::string buffer(deflateBound(&stream, size), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in));
+    stream.avail_in = size;
+    stream.next_out = reinterpret_cast<Bytef*>(&buffer[0]);
+    stream.avail_out = buffer.size();
+    int result = deflate(&stream, Z_FINISH);
+    size_t length = buffer.size() - stream.avail_out;
+    deflateEnd(&stream);
+    if (result != Z_STREAM_END || length >= size) return false;
+    buffer.resize(length);
+    out.swap(buffer);
+    return true;
+}
+
+bool Compression::decompress(const std::string& algorithm, const char* in, size_t size, std::string& out, size_t limit)
+{
+    if (algorithm != DEFLATE) return false;
+    z_stream stream = z_stream();
+    if (inflateInit(&stream) != Z_OK) throw Exception(QPID_MSG("Could not initialise " << algorithm << " decompression"));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in));
+    stream.avail_in = size;
+
+    std::string buffer(std::min(std::max(size * 4, MIN_SIZE), limit), '\0');
+    size_t used = 0;
+    int result;
+    do {
+        if (used == buffer.size()) {
+            if (used >= limit) {
+                inflateEnd(&stream);
+                throw Exception(QPID_MSG("Decompressed " << algorithm << " message body exceeds " << limit << " bytes"));
+            }
+            buffer.resize(std::min(buffer.size() * 2, limit));
+        }
+        stream.next_out = reinterpret_cast<Bytef*>(&buffer[used]);
+        stream.avail_out = buffer.size() - used;
+        result = inflate(&stream, Z_NO_FLUSH);
+        used = buffer.size() - stream.avail_out;
+    } while (result == Z_OK);
+    inflateEnd(&stream);
+    if (result != Z_STREAM_END) {
+        throw Exception(QPID_MSG("Could not decompress " << algorithm << " message body"));
+    }
+    buffer.resize(used);
+    out.swap(buffer);
+    return true;
+}
+
+#else
+
+bool Compression::isSupported(const std::string&)
+{
+    return false;
+}
+
+bool Compression::compress(const std::string&, const char*, size_t, std::string&)
+{
+    return false;
+}
+
+bool Compression::decompress(const std::string&, const char*, size_t, std::string&, size_t)
+{
+    return false;
+}
+
+#endif
+
+} // namespace qpid
@@ -0,0 +1,65 @@
+#ifndef QPID_COMPRESSION_H
+#define QPID_COMPRESSION_H
+
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+#include "qpid/CommonImportExport.h"
+#include <string>
+#include <stddef.h>
+
+namespace qpid {
+
+/**
+ * Compression of message bodies. A sender that compresses a body
+ * records the algorithm used in the application property named by
+ * PROPERTY; a receiver that finds that property restores the original
+ * body and removes the property. Because the marker is an ordinary
+ * application property it survives translation between 0-10 and 1.0,
+ * and the broker can store and forward the compressed body untouched.
+ */
+class QPID_COMMON_CLASS_EXTERN Compression
+{
+  public:
+    static const QPID_COMMON_EXTERN std::string PROPERTY;
+    static const QPID_COMMON_EXTERN std::string DEFLATE;
+    /** Bodies smaller than this are never compressed. */
+    static const QPID_COMMON_EXTERN size_t MIN_SIZE;
+    /** Default limit on the size of a decompressed body. */
+    static const QPID_COMMON_EXTERN size_t MAX_SIZE;
+
+    static QPID_COMMON_EXTERN bool isSupported(const std::string& algorithm);
+    /**
+     * Compress in into out. Returns false, leaving out untouched, if
+     * the body is too small or does not shrink.
+     */
+    static QPID_COMMON_EXTERN bool compress(const std::string& algorithm, const char* in, size_t size, std::string& out);
+    /**
+     * Decompress in into out. Returns false if the algorithm is not
+     * supported; throws qpid::Exception if the data is corrupt or
+     * would decompress to more than limit bytes.
+     */
+    static QPID_COMMON_EXTERN bool decompress(const std::string& algorithm, const char* in, size_t size, std::string& out,
+                                              size_t limit = MAX_SIZE);
+};
+
+} // namespace qpid
+
+#endif  /*!QPID_COMPRESSION_H*/
@@ -20,11 +20,14 @@
  */
 
 #include "qpid/SessionState.h"
+#include "qpid/RefCountedBuffer.h"
 #include "qpid/framing/reply_exceptions.h"
 #include "qpid/framing/AMQMethodBody.h"
+#include "qpid/framing/Buffer.h"
 #include "qpid/framing/enum.h"
 #include "qpid/log/Statement.h"
 #include <boost/bind.hpp>
+#include <algorithm>
 #include <numeric>
 
 namespace qpid {
@@ -43,6 +46,9 @@ bool isControl(const AMQFrame& f) {
 bool isCommand(const AMQFrame& f) {
     return f.getMethod() && f.getMethod()->type() == framing::SEGMENT_TYPE_COMMAND;
 }
+
+// Large enough for any frame, so normally all chunks are this size.
+const size_t REPLAY_CHUNK_SIZE = 64*1024;
 } // namespace
 
 SessionPoint::SessionPoint(SequenceNumber c, uint64_t o) : command(c), offset(o) {}
@@ -91,6 +97,71 @@ bool SessionPoint::operator==(const SessionPoint& x) const {
 }
 
 
+SessionState::ReplayList::ReplayList() : head(0), commandComplete(true) {}
+
+void SessionState::ReplayList::push(const AMQFrame& f, size_t size) {
+    if (chunks.empty() || chunks.back().capacity() - chunks.back().used < size) {
+        if (spare.begin() && size <= REPLAY_CHUNK_SIZE) {
+            chunks.push_back(Chunk(spare));
+            spare = BufferRef();
+        } else {
+            chunks.push_back(Chunk(RefCountedBuffer::create(std::max(size, REPLAY_CHUNK_SIZE))));
+        }
+    }
+    Chunk& chunk = chunks.back();
+    framing::Buffer buffer(chunk.buffer.begin() + chunk.used, size);
+    f.encode(buffer);
+    chunk.used += size;
+    if (commandComplete) commandSizes.push_back(0);
+    commandSizes.back() += size;
+    commandComplete = f.isLastSegment() && f.isLastFrame();
+}
+
+void SessionState::ReplayList::pop() {
+    size_t size = commandSizes.front();
+    commandSizes.pop_front();
+    if (commandSizes.empty()) commandComplete = true;
+    while (size) {
+        assert(!chunks.empty());
+        Chunk& chunk = chunks.front();
+        size_t n = std::min(size, chunk.used - head);
+        head += n;
+        size -= n;
+        if (head == chunk.used) {
+            // Chunk is empty. Replayed frames may still refer to it.
+            bool reusable = chunk.buffer.unique() && chunk.capacity() == REPLAY_CHUNK_SIZE;
+            if (chunks.size() == 1 && reusable) {
+                chunk.used = 0;
+            } else {
+                if (reusable) spare = chunk.buffer;
+                chunks.pop_front();
+            }
+            head = 0;
+        }
+    }
+}
+
+void SessionState::ReplayList::decode(size_t n, ReplayRange& frames) const {
+    size_t skip = std::accumulate(commandSizes.begin(), commandSizes.begin() + n, size_t(0));
+    for (std::deque<Chunk>::const_iterator i = chunks.begin(); i != chunks.end(); ++i) {
+        size_t start = (i == chunks.begin()) ? head : 0;
+        size_t available = i->used - start;
+        if (skip >= available) {
+            skip -= available;
+            continue;
+        }
+        framing::Buffer buffer(i->buffer.begin() + start + skip, available - skip);
+        buffer.setBacking(i->buffer);
+        skip = 0;
+        while (buffer.available()) {
+            AMQFrame f;
+            if (!f.decode(buffer))
+                throw InternalErrorException(QPID_MSG("Incomplete frame in replay list"));
+            frames.push_back(f);
+        }
+    }
+}
+
 SessionState::SendState::SendState() : unflushedSize(), replaySize(), bytesSinceKnownCompleted() {}
 
 SessionState::ReceiveState::ReceiveState() : bytesSinceKnownCompleted() {}
@@ -106,12 +177,20 @@ SessionState::ReplayRange SessionState::senderExpected(const SessionPoint& expec
     if (expect < sender.replayPoint || sender.sendPoint < expect)
         throw InvalidArgumentException(QPID_MSG(getId() << ": expected command-point out of range."));
     QPID_LOG(debug, getId() << ": sender expected point moved to " << expect);
-    ReplayList::iterator i = sender.replayList.begin();
-    SessionPoint p = sender.replayPoint;
-    while (i != sender.replayList.end() && p.command < expect.command)
-        p.advance(*i++);
-    assert(p.command == expect.command);
-    return boost::make_iterator_range(i, sender.replayList.end());
+    ReplayRange frames;
+    size_t n = expect.command - sender.replayPoint.command;
+    if (n < sender.replayList.commands()) {
+        sender.replayList.decode(n, frames);
+        // Skip frames of a partial command the peer already has.
+        SessionPoint p(expect.command);
+        ReplayRange::iterator i = frames.begin();
+        while (i != frames.end() && p < expect)
+            p.advance(*i++);
+        if (p != expect)
+            throw InvalidArgumentException(QPID_MSG(getId() << ": expected command-point " << expect << " is not on a frame boundary."));
+        frames.erase(frames.begin(), i);
+    }
+    return frames;
 }
 
 void SessionState::senderRecord(const AMQFrame& f) {
@@ -119,10 +198,11 @@ void SessionState::senderRecord(const AMQFrame& f) {
     QPID_LOG(trace, getId() << ": sent cmd " << sender.sendPoint.command << ": " << *f.getBody());
 
     stateful = true;
-    if (timeout) sender.replayList.push_back(f);
-    sender.unflushedSize += f.encodedSize();
-    sender.bytesSinceKnownCompleted += f.encodedSize();
-    sender.replaySize += f.encodedSize();
+    size_t size = f.encodedSize();
+    if (timeout) sender.replayList.push(f, size);
+    sender.unflushedSize += size;
+    sender.bytesSinceKnownCompleted += size;
+    sender.replaySize += size;
     sender.incomplete += sender.sendPoint.command;
     sender.sendPoint.advance(f);
     if (config.replayHardLimit && config.replayHardLimit < sender.replaySize) 
@@ -153,18 +233,20 @@ void SessionState::senderConfirmed(const SessionPoint& confirmed) {
     if (confirmed > sender.sendPoint)
         throw InvalidArgumentException(QPID_MSG(getId() << ": confirmed < " << confirmed << " but only sent < " << sender.sendPoint));
     QPID_LOG(debug, getId() << ": sender confirmed point moved to " << confirmed);
-    ReplayList::iterator i = sender.replayList.begin();
-    while (i != sender.replayList.end() && sender.replayPoint.command < confirmed.command) {
-        sender.replayPoint.advance(*i);
+    // Commands before confirmed are complete, so are removed whole.
+    while (sender.replayList.commands() && sender.replayPoint.command < confirmed.command) {
+        size_t size = sender.replayList.frontSize();
+        sender.replaySize -= size;
+        if (sender.flushPoint.command < sender.replayPoint.command)
+            sender.unflushedSize -= size;
+        else if (sender.flushPoint.command == sender.replayPoint.command)
+            sender.unflushedSize -= size - sender.flushPoint.offset;
+        ++sender.replayPoint.command;
         assert(sender.replayPoint <= sender.sendPoint);
-        sender.replaySize -= i->encodedSize();
-        if (sender.replayPoint > sender.flushPoint) 
-            sender.unflushedSize -= i->encodedSize();
-        ++i;
+        sender.replayList.pop();
     }
     if (sender.replayPoint > sender.flushPoint)
         sender.flushPoint = sender.replayPoint;
-    sender.replayList.erase(sender.replayList.begin(), i);
     assert(sender.replayPoint.offset == 0);
 }
 
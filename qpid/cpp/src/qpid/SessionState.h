@@ -27,8 +27,9 @@
 #include <qpid/framing/SequenceSet.h>
 #include <qpid/framing/AMQFrame.h>
 #include <qpid/framing/FrameHandler.h>
+#include <qpid/BufferRef.h>
 #include <boost/operators.hpp>
-#include <boost/range/iterator_range.hpp>
+#include <deque>
 #include <vector>
 #include <iosfwd>
 #include <qpid/CommonImportExport.h>
@@ -64,19 +65,17 @@ QPID_COMMON_EXTERN std::ostream& operator<<(std::ostream&, const SessionPoint&);
  * max currently received command data, either explicitly via
  * session.command-point or implicitly via session.gap.
  *
- * Partial replay is not supported, replay always begins on a command
- * boundary, and we never confirm partial commands.
+ * Replay may begin part way through a command, at any frame
+ * boundary, but we never confirm partial commands.
  *
- * The SessionPoint data structure does store offsets so this class
- * could be extended to support partial replay without
- * source-incompatbile API changes.
+ * Frames kept for replay are stored encoded, so an unconfirmed
+ * command costs little more than its size on the wire. They are
+ * decoded again only if they have to be replayed.
  */
 class SessionState {
-    typedef std::vector<framing::AMQFrame> ReplayList;
-
   public:
 
-    typedef boost::iterator_range<ReplayList::iterator> ReplayRange;
+    typedef std::vector<framing::AMQFrame> ReplayRange;
 
     struct Configuration {
         QPID_COMMON_EXTERN Configuration(size_t flush=1024*1024, size_t hard=0);
@@ -130,8 +129,9 @@ class SessionState {
     /** Point from which we can replay. */
     QPID_COMMON_EXTERN virtual SessionPoint senderGetReplayPoint() const;
 
-    /** Peer expecting commands from this point.
-     *@return Range of frames to be replayed.
+    /** Peer expecting commands from this point, which must be on a
+     * frame boundary.
+     *@return Frames to be replayed.
      */
     QPID_COMMON_EXTERN virtual ReplayRange senderExpected(const SessionPoint& expected);
 
@@ -198,6 +198,39 @@ class SessionState {
 
   private:
 
+    /**
+     * Encoded frames kept for replay, in a list of chunks, with an
+     * index of the encoded size of each command. Frames are never
+     * split across chunks. Chunks are reused once emptied unless a
+     * replayed frame still refers to them.
+     */
+    class ReplayList {
+      public:
+        ReplayList();
+        void push(const framing::AMQFrame& f, size_t size);
+        /** Number of commands, complete or not, in the list */
+        size_t commands() const { return commandSizes.size(); }
+        /** Encoded size of the first command */
+        size_t frontSize() const { return commandSizes.front(); }
+        /** Remove the first command */
+        void pop();
+        /** Decode all frames from the start of the n'th command */
+        void decode(size_t n, ReplayRange& frames) const;
+
+      private:
+        struct Chunk {
+            BufferRef buffer;
+            size_t used;
+            Chunk(const BufferRef& b) : buffer(b), used(0) {}
+            size_t capacity() const { return buffer.end() - buffer.begin(); }
+        };
+        std::deque<Chunk> chunks;
+        size_t head;            // Start of first command in first chunk.
+        std::deque<uint32_t> commandSizes;
+        bool commandComplete;   // Last command in commandSizes is complete.
+        BufferRef spare;
+    };
+
     struct SendState {
         SendState();
         // invariant: replayPoint <= flushPoint <= sendPoint
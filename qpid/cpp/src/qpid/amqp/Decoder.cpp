@@ -35,13 +35,24 @@ namespace amqp {
 
 using namespace qpid::amqp::typecodes;
 
+namespace {
+/**
+ * Indexed by the subcategory of a typecode (i.e. its high nibble),
+ * gives either the width of a fixed width value or the width of the
+ * size that precedes a variable width or compound value.
+ */
+const uint8_t WIDTHS[16] = { 0, 0, 0, 0, 0, 1, 2, 4, 8, 16, 1, 4, 1, 4, 1, 4 };
+const uint8_t FIXED_WIDTH_START(0x4);
+const uint8_t VARIABLE_WIDTH_START(0xa);
+}
+
 Decoder::Decoder(const char* d, size_t s) : start(d), size(s), position(0), current(0) {}
 
 void Decoder::readMap(qpid::types::Variant::Map& map)
 {
     MapBuilder builder;
     read(builder);
-    map = builder.getMap();
+    map.swap(builder.getValue().asMap());
 }
 
 qpid::types::Variant::Map Decoder::readMap()
@@ -267,6 +278,24 @@ void Decoder::readArray(Reader& reader, uint32_t size, uint32_t count, const Des
 }
 
 
+void Decoder::skip(uint8_t code)
+{
+    uint8_t subcategory = code >> 4;
+    if (subcategory < FIXED_WIDTH_START) {
+        if (code != DESCRIPTOR) throw qpid::Exception(QPID_MSG("Cannot skip value of unknown type " << (int) code));
+        readDescriptor();
+        skip(readCode());
+    } else if (subcategory < VARIABLE_WIDTH_START) {
+        advance(WIDTHS[subcategory]);
+    } else if (WIDTHS[subcategory] == 1) {
+        if (!available()) throw qpid::Exception(QPID_MSG("Out of Bounds: no size for value of type " << (int) code << " at " << position));
+        advance(readUByte());
+    } else {
+        if (available() < 4) throw qpid::Exception(QPID_MSG("Out of Bounds: no size for value of type " << (int) code << " at " << position));
+        advance(readUInt());
+    }
+}
+
 Constructor Decoder::readConstructor()
 {
     Constructor result(readCode());
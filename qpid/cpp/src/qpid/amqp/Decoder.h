@@ -65,6 +65,14 @@ class Decoder
     QPID_COMMON_EXTERN CharSequence readSequence32();
     QPID_COMMON_EXTERN Descriptor readDescriptor();
     QPID_COMMON_EXTERN void read(Reader& reader);
+    /**
+     * Skip over the value for the supplied typecode (which has
+     * already been read) without decoding it. The extent of any
+     * value, including compound values, can be determined from the
+     * subcategory of its typecode and, for variable width and
+     * compound values, the size that follows.
+     */
+    QPID_COMMON_EXTERN void skip(uint8_t code);
 
     QPID_COMMON_EXTERN void readMap(std::map<std::string, qpid::types::Variant>&);
     QPID_COMMON_EXTERN std::map<std::string, qpid::types::Variant> readMap();
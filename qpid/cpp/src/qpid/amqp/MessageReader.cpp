@@ -19,6 +19,7 @@
  *
  */
 #include "qpid/amqp/MessageReader.h"
+#include "qpid/amqp/Decoder.h"
 #include "qpid/amqp/Descriptor.h"
 #include "qpid/amqp/descriptors.h"
 #include "qpid/amqp/typecodes.h"
@@ -31,6 +32,7 @@ using namespace qpid::amqp::message;
 namespace qpid {
 namespace amqp {
 namespace {
+using namespace qpid::amqp::typecodes;
 
 //header fields:
 const size_t DURABLE(0);
@@ -60,293 +62,287 @@ const Descriptor* nested(const Descriptor* d)
     if (d && d->nested) return d->nested.get();
     else return 0;
 }
-}
 
-MessageReader::HeaderReader::HeaderReader(MessageReader& p) : parent(p), index(0) {}
-void MessageReader::HeaderReader::onBoolean(bool v, const Descriptor*)  // durable, first-acquirer
-{
-    if (index == DURABLE) {
-        parent.onDurable(v);
-    } else if (index == FIRST_ACQUIRER) {
-        parent.onFirstAcquirer(v);
-    } else {
-        QPID_LOG(warning, "Unexpected message format, got boolean at index " << index << " of headers");
-    }
-    ++index;
-}
-void MessageReader::HeaderReader::onUByte(uint8_t v, const Descriptor*) // priority
-{
-    if (index == PRIORITY) {
-        parent.onPriority(v);
-    } else {
-        QPID_LOG(warning, "Unexpected message format, got ubyte at index " << index << " of headers");
-    }
-    ++index;
-}
-void MessageReader::HeaderReader::onUInt(uint32_t v, const Descriptor*) // ttl, delivery-count
+/**
+ * Reads the constructor of a field in the header or properties
+ * list. Any descriptors are skipped over; only the underlying type is
+ * of interest.
+ */
+uint8_t readFieldCode(Decoder& decoder)
 {
-    if (index == TTL) {
-        parent.onTtl(v);
-    } else if (index == DELIVERY_COUNT) {
-        parent.onDeliveryCount(v);
-    } else {
-        QPID_LOG(warning, "Unexpected message format, got uint at index " << index << " of headers");
+    uint8_t code = decoder.readCode();
+    while (code == DESCRIPTOR) {
+        decoder.readDescriptor();
+        code = decoder.readCode();
     }
-    ++index;
-}
-void MessageReader::HeaderReader::onNull(const Descriptor*)
-{
-    ++index;
+    return code;
 }
 
-MessageReader::PropertiesReader::PropertiesReader(MessageReader& p) : parent(p), index(0) {}
-void MessageReader::PropertiesReader::onUuid(const CharSequence& v, const Descriptor*) // message-id, correlation-id
+uint32_t readUInt(Decoder& decoder, uint8_t code)
 {
-    if (index == MESSAGE_ID) {
-        parent.onMessageId(v, qpid::types::VAR_UUID);
-    } else if (index == CORRELATION_ID) {
-        parent.onCorrelationId(v, qpid::types::VAR_UUID);
-    } else {
-        QPID_LOG(warning, "Unexpected message format, got uuid at index " << index << " of properties");
+    switch (code) {
+      case UINT_SMALL: return decoder.readUByte();
+      case UINT_ZERO: return 0;
+      default: return decoder.readUInt();
     }
-    ++index;
 }
-void MessageReader::PropertiesReader::onULong(uint64_t v, const Descriptor*) // message-id, correlation-id
+
+uint64_t readULong(Decoder& decoder, uint8_t code)
 {
-    if (index == MESSAGE_ID) {
-        parent.onMessageId(v);
-    } else if (index == CORRELATION_ID) {
-        parent.onCorrelationId(v);
-    } else {
-        QPID_LOG(warning, "Unexpected message format, got long at index " << index << " of properties");
+    switch (code) {
+      case ULONG_SMALL: return decoder.readUByte();
+      case ULONG_ZERO: return 0;
+      default: return decoder.readULong();
     }
-    ++index;
 }
-void MessageReader::PropertiesReader::onBinary(const CharSequence& v, const Descriptor*) // message-id, correlation-id, user-id
-{
-    if (index == MESSAGE_ID) {
-        parent.onMessageId(v, qpid::types::VAR_STRING);
-    } else if (index == CORRELATION_ID) {
-        parent.onCorrelationId(v, qpid::types::VAR_STRING);
-    } else if (index == USER_ID) {
-        parent.onUserId(v);
-    } else {
-        QPID_LOG(warning, "Unexpected message format, got binary at index " << index << " of properties");
-    }
-    ++index;
-}
-void MessageReader::PropertiesReader::onString(const CharSequence& v, const Descriptor*) // message-id, correlation-id, group-id, reply-to-group-id, subject, to, reply-to
-{
-    if (index == MESSAGE_ID) {
-        parent.onMessageId(v, qpid::types::VAR_STRING);
-    } else if (index == CORRELATION_ID) {
-        parent.onCorrelationId(v, qpid::types::VAR_STRING);
-    } else if (index == GROUP_ID) {
-        parent.onGroupId(v);
-    } else if (index == REPLY_TO_GROUP_ID) {
-        parent.onReplyToGroupId(v);
-    } else if (index == SUBJECT) {
-        parent.onSubject(v);
-    } else if (index == TO) {
-        parent.onTo(v);
-    } else if (index == REPLY_TO) {
-        parent.onReplyTo(v);
-    } else {
-        QPID_LOG(warning, "Unexpected message format, got string at index " << index << " of properties");
-    }
-    ++index;
-}
-void MessageReader::PropertiesReader::onSymbol(const CharSequence& v, const Descriptor*) // content-type, content-encoding
+
+CharSequence readSequence(Decoder& decoder, uint8_t code)
 {
-    if (index == CONTENT_TYPE) {
-        parent.onContentType(v);
-    } else if (index == CONTENT_ENCODING) {
-        parent.onContentEncoding(v);
-    } else {
-        QPID_LOG(warning, "Unexpected message format, got symbol at index " << index << " of properties");
-    }
-    ++index;
+    //binary, string and symbol codes with subcategory 0xa have a one
+    //byte size, those with subcategory 0xb have a four byte size
+    if ((code >> 4) == 0xa) return decoder.readSequence8();
+    else return decoder.readSequence32();
 }
-void MessageReader::PropertiesReader::onTimestamp(int64_t v, const Descriptor*) // absolute-expiry-time, creation-time
-{
-    if (index == ABSOLUTE_EXPIRY_TIME) {
-        parent.onAbsoluteExpiryTime(v);
-    } else if (index == CREATION_TIME) {
-        parent.onCreationTime(v);
-    } else {
-        QPID_LOG(warning, "Unexpected message format, got timestamp at index " << index << " of properties");
+
+/**
+ * The header and properties sections are short lists of known
+ * fields, so rather than dispatching each element through the Reader
+ * callbacks, the fields are decoded directly and anything unexpected
+ * is skipped using the size implied by its typecode.
+ */
+void readHeader(MessageReader& reader, uint32_t count, const CharSequence& elements)
+{
+    Decoder decoder(elements.data, elements.size);
+    for (size_t index = 0; index < count && decoder.available(); ++index) {
+        uint8_t code = readFieldCode(decoder);
+        switch (code) {
+          case NULL_VALUE:
+            break;
+          case BOOLEAN:
+          case BOOLEAN_TRUE:
+          case BOOLEAN_FALSE: {
+            bool v = code == BOOLEAN ? decoder.readBoolean() : code == BOOLEAN_TRUE;
+            if (index == DURABLE) {
+                reader.onDurable(v);
+            } else if (index == FIRST_ACQUIRER) {
+                reader.onFirstAcquirer(v);
+            } else {
+                QPID_LOG(warning, "Unexpected message format, got boolean at index " << index << " of headers");
+            }
+            break;
+          }
+          case UBYTE: {
+            uint8_t v = decoder.readUByte();
+            if (index == PRIORITY) {
+                reader.onPriority(v);
+            } else {
+                QPID_LOG(warning, "Unexpected message format, got ubyte at index " << index << " of headers");
+            }
+            break;
+          }
+          case UINT:
+          case UINT_SMALL:
+          case UINT_ZERO: {
+            uint32_t v = readUInt(decoder, code);
+            if (index == TTL) {
+                reader.onTtl(v);
+            } else if (index == DELIVERY_COUNT) {
+                reader.onDeliveryCount(v);
+            } else {
+                QPID_LOG(warning, "Unexpected message format, got uint at index " << index << " of headers");
+            }
+            break;
+          }
+          default:
+            QPID_LOG(warning, "Unexpected message format, got type " << (int) code << " at index " << index << " of headers");
+            decoder.skip(code);
+            break;
+        }
     }
-    ++index;
 }
-void MessageReader::PropertiesReader::onUInt(uint32_t v, const Descriptor*) // group-sequence
+
+void readProperties(MessageReader& reader, uint32_t count, const CharSequence& elements)
 {
-    if (index == GROUP_SEQUENCE) {
-        parent.onGroupSequence(v);
-    } else {
-        QPID_LOG(warning, "Unexpected message format, got uint at index " << index << " of properties");
+    Decoder decoder(elements.data, elements.size);
+    for (size_t index = 0; index < count && decoder.available(); ++index) {
+        uint8_t code = readFieldCode(decoder);
+        switch (code) {
+          case NULL_VALUE:
+            break;
+          case UUID: {
+            CharSequence v = CharSequence::create(elements.data + decoder.getPosition(), 16);
+            decoder.advance(v.size);
+            if (index == MESSAGE_ID) {
+                reader.onMessageId(v, qpid::types::VAR_UUID);
+            } else if (index == CORRELATION_ID) {
+                reader.onCorrelationId(v, qpid::types::VAR_UUID);
+            } else {
+                QPID_LOG(warning, "Unexpected message format, got uuid at index " << index << " of properties");
+            }
+            break;
+          }
+          case ULONG:
+          case ULONG_SMALL:
+          case ULONG_ZERO: {
+            uint64_t v = readULong(decoder, code);
+            if (index == MESSAGE_ID) {
+                reader.onMessageId(v);
+            } else if (index == CORRELATION_ID) {
+                reader.onCorrelationId(v);
+            } else {
+                QPID_LOG(warning, "Unexpected message format, got long at index " << index << " of properties");
+            }
+            break;
+          }
+          case BINARY8:
+          case BINARY32: {
+            CharSequence v = readSequence(decoder, code);
+            if (index == MESSAGE_ID) {
+                reader.onMessageId(v, qpid::types::VAR_STRING);
+            } else if (index == CORRELATION_ID) {
+                reader.onCorrelationId(v, qpid::types::VAR_STRING);
+            } else if (index == USER_ID) {
+                reader.onUserId(v);
+            } else {
+                QPID_LOG(warning, "Unexpected message format, got binary at index " << index << " of properties");
+            }
+            break;
+          }
+          case STRING8:
+          case STRING32: {
+            CharSequence v = readSequence(decoder, code);
+            if (index == MESSAGE_ID) {
+                reader.onMessageId(v, qpid::types::VAR_STRING);
+            } else if (index == CORRELATION_ID) {
+                reader.onCorrelationId(v, qpid::types::VAR_STRING);
+            } else if (index == GROUP_ID) {
+                reader.onGroupId(v);
+            } else if (index == REPLY_TO_GROUP_ID) {
+                reader.onReplyToGroupId(v);
+            } else if (index == SUBJECT) {
+                reader.onSubject(v);
+            } else if (index == TO) {
+                reader.onTo(v);
+            } else if (index == REPLY_TO) {
+                reader.onReplyTo(v);
+            } else {
+                QPID_LOG(warning, "Unexpected message format, got string at index " << index << " of properties");
+            }
+            break;
+          }
+          case SYMBOL8:
+          case SYMBOL32: {
+            CharSequence v = readSequence(decoder, code);
+            if (index == CONTENT_TYPE) {
+                reader.onContentType(v);
+            } else if (index == CONTENT_ENCODING) {
+                reader.onContentEncoding(v);
+            } else {
+                QPID_LOG(warning, "Unexpected message format, got symbol at index " << index << " of properties");
+            }
+            break;
+          }
+          case TIMESTAMP: {
+            int64_t v = decoder.readLong();
+            if (index == ABSOLUTE_EXPIRY_TIME) {
+                reader.onAbsoluteExpiryTime(v);
+            } else if (index == CREATION_TIME) {
+                reader.onCreationTime(v);
+            } else {
+                QPID_LOG(warning, "Unexpected message format, got timestamp at index " << index << " of properties");
+            }
+            break;
+          }
+          case UINT:
+          case UINT_SMALL:
+          case UINT_ZERO: {
+            uint32_t v = readUInt(decoder, code);
+            if (index == GROUP_SEQUENCE) {
+                reader.onGroupSequence(v);
+            } else {
+                QPID_LOG(warning, "Unexpected message format, got uint at index " << index << " of properties");
+            }
+            break;
+          }
+          default:
+            QPID_LOG(info, "skipping message property at index " << index << " unexpected type (" << (int) code << ")");
+            decoder.skip(code);
+            break;
+        }
     }
-    ++index;
-}
-void MessageReader::PropertiesReader::onNull(const Descriptor*)
-{
-    ++index;
-}
-void MessageReader::PropertiesReader::onBoolean(bool, const Descriptor*)
-{
-    QPID_LOG(info, "skipping message property at index " << index << " unexpected type (boolean)");
-    ++index;
-}
-void MessageReader::PropertiesReader::onUByte(uint8_t, const Descriptor*)
-{
-    QPID_LOG(info, "skipping message property at index " << index << " unexpected type (ubyte)");
-    ++index;
-}
-void MessageReader::PropertiesReader::onUShort(uint16_t, const Descriptor*)
-{
-    QPID_LOG(info, "skipping message property at index " << index << " unexpected type (ushort)");
-    ++index;
 }
-void MessageReader::PropertiesReader::onByte(int8_t, const Descriptor*)
-{
-    QPID_LOG(info, "skipping message property at index " << index << " unexpected type (byte)");
-    ++index;
-}
-void MessageReader::PropertiesReader::onShort(int16_t, const Descriptor*)
-{
-    QPID_LOG(info, "skipping message property at index " << index << " unexpected type (short)");
-    ++index;
-}
-void MessageReader::PropertiesReader::onInt(int32_t, const Descriptor*)
-{
-    QPID_LOG(info, "skipping message property at index " << index << " unexpected type (int)");
-    ++index;
-}
-void MessageReader::PropertiesReader::onLong(int64_t, const Descriptor*)
-{
-    QPID_LOG(info, "skipping message property at index " << index << " unexpected type (long)");
-    ++index;
-}
-void MessageReader::PropertiesReader::onFloat(float, const Descriptor*)
-{
-    QPID_LOG(info, "skipping message property at index " << index << " unexpected type (float)");
-    ++index;
-}
-void MessageReader::PropertiesReader::onDouble(double, const Descriptor*)
-{
-    QPID_LOG(info, "skipping message property at index " << index << " unexpected type (double)");
-    ++index;
-}
-bool MessageReader::PropertiesReader::onStartList(uint32_t /*count*/, const CharSequence& /*elements*/, const CharSequence& /*complete*/, const Descriptor*)
-{
-    QPID_LOG(info, "skipping message property at index " << index << " unexpected type (list)");
-    ++index;
-    return false;
-}
-bool MessageReader::PropertiesReader::onStartMap(uint32_t /*count*/, const CharSequence& /*elements*/, const CharSequence& /*complete*/, const Descriptor*)
-{
-    QPID_LOG(info, "skipping message property at index " << index << " unexpected type (map)");
-    ++index;
-    return false;
-}
-bool MessageReader::PropertiesReader::onStartArray(uint32_t /*count*/, const CharSequence&, const Constructor&, const Descriptor*)
-{
-    QPID_LOG(info, "skipping message property at index " << index << " unexpected type (array)");
-    ++index;
-    return false;
 }
 
 
 //header, properties, amqp-sequence, amqp-value
 bool MessageReader::onStartList(uint32_t count, const CharSequence& elements, const CharSequence& raw, const Descriptor* descriptor)
 {
-    if (delegate) {
-        return delegate->onStartList(count, elements, raw, descriptor);
+    if (!descriptor) {
+        QPID_LOG(warning, "Expected described type but got no descriptor for list.");
+        return false;
+    } else if (descriptor->match(HEADER_SYMBOL, HEADER_CODE)) {
+        readHeader(*this, count, elements);
+        return false;
+    } else if (descriptor->match(PROPERTIES_SYMBOL, PROPERTIES_CODE)) {
+        readProperties(*this, count, elements);
+        return false;
+    } else if (descriptor->match(AMQP_SEQUENCE_SYMBOL, AMQP_SEQUENCE_CODE)) {
+        onAmqpSequence(raw);
+        return false;
+    } else if (descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
+        onAmqpValue(elements, qpid::amqp::typecodes::LIST_NAME, nested(descriptor));
+        return false;
     } else {
-        if (!descriptor) {
-            QPID_LOG(warning, "Expected described type but got no descriptor for list.");
-            return false;
-        } else if (descriptor->match(HEADER_SYMBOL, HEADER_CODE)) {
-            delegate = &headerReader;
-            return true;
-        } else if (descriptor->match(PROPERTIES_SYMBOL, PROPERTIES_CODE)) {
-            delegate = &propertiesReader;
-            return true;
-        } else if (descriptor->match(AMQP_SEQUENCE_SYMBOL, AMQP_SEQUENCE_CODE)) {
-            onAmqpSequence(raw);
-            return false;
-        } else if (descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
-            onAmqpValue(elements, qpid::amqp::typecodes::LIST_NAME, nested(descriptor));
-            return false;
-        } else {
-            QPID_LOG(warning, "Unexpected described list: " << *descriptor);
-            return false;
-        }
+        QPID_LOG(warning, "Unexpected described list: " << *descriptor);
+        return false;
     }
 }
-void MessageReader::onEndList(uint32_t count, const Descriptor* descriptor)
+void MessageReader::onEndList(uint32_t /*count*/, const Descriptor*)
 {
-    if (delegate) {
-        if (descriptor && (descriptor->match(HEADER_SYMBOL, HEADER_CODE) || descriptor->match(PROPERTIES_SYMBOL, PROPERTIES_CODE))) {
-            delegate = 0;
-        } else {
-            delegate->onEndList(count, descriptor);
-        }
-    }
 }
 
 //delivery-annotations, message-annotations, application-properties, amqp-value
-bool MessageReader::onStartMap(uint32_t count, const CharSequence& elements, const CharSequence& raw, const Descriptor* descriptor)
+bool MessageReader::onStartMap(uint32_t /*count*/, const CharSequence& elements, const CharSequence& raw, const Descriptor* descriptor)
 {
-    if (delegate) {
-        return delegate->onStartMap(count, elements, raw, descriptor);
+    if (!descriptor) {
+        QPID_LOG(warning, "Expected described type but got no descriptor for map.");
+        return false;
+    } else if (descriptor->match(DELIVERY_ANNOTATIONS_SYMBOL, DELIVERY_ANNOTATIONS_CODE)) {
+        onDeliveryAnnotations(elements, raw);
+        return false;
+    } else if (descriptor->match(MESSAGE_ANNOTATIONS_SYMBOL, MESSAGE_ANNOTATIONS_CODE)) {
+        onMessageAnnotations(elements, raw);
+        return false;
+    } else if (descriptor->match(FOOTER_SYMBOL, FOOTER_CODE)) {
+        onFooter(elements, raw);
+        return false;
+    } else if (descriptor->match(APPLICATION_PROPERTIES_SYMBOL, APPLICATION_PROPERTIES_CODE)) {
+        onApplicationProperties(elements, raw);
+        return false;
+    } else if (descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
+        onAmqpValue(elements, qpid::amqp::typecodes::MAP_NAME, nested(descriptor));
+        return false;
     } else {
-        if (!descriptor) {
-            QPID_LOG(warning, "Expected described type but got no descriptor for map.");
-            return false;
-        } else if (descriptor->match(DELIVERY_ANNOTATIONS_SYMBOL, DELIVERY_ANNOTATIONS_CODE)) {
-            onDeliveryAnnotations(elements, raw);
-            return false;
-        } else if (descriptor->match(MESSAGE_ANNOTATIONS_SYMBOL, MESSAGE_ANNOTATIONS_CODE)) {
-            onMessageAnnotations(elements, raw);
-            return false;
-        } else if (descriptor->match(FOOTER_SYMBOL, FOOTER_CODE)) {
-            onFooter(elements, raw);
-            return false;
-        } else if (descriptor->match(APPLICATION_PROPERTIES_SYMBOL, APPLICATION_PROPERTIES_CODE)) {
-            onApplicationProperties(elements, raw);
-            return false;
-        } else if (descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
-            onAmqpValue(elements, qpid::amqp::typecodes::MAP_NAME, nested(descriptor));
-            return false;
-        } else {
-            QPID_LOG(warning, "Unexpected described map: " << *descriptor);
-            return false;
-        }
+        QPID_LOG(warning, "Unexpected described map: " << *descriptor);
+        return false;
     }
 }
 
-void MessageReader::onEndMap(uint32_t count, const Descriptor* descriptor)
+void MessageReader::onEndMap(uint32_t /*count*/, const Descriptor*)
 {
-    if (delegate) {
-        delegate->onEndMap(count, descriptor);
-    }
 }
 
 //data, amqp-value
 void MessageReader::onBinary(const CharSequence& bytes, const Descriptor* descriptor)
 {
-    if (delegate) {
-        delegate->onBinary(bytes, descriptor);
+    if (!descriptor) {
+        QPID_LOG(warning, "Expected described type but got binary value with no descriptor.");
+    } else if (descriptor->match(DATA_SYMBOL, DATA_CODE)) {
+        onData(bytes);
+    } else if (descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
+        onAmqpValue(bytes, qpid::amqp::typecodes::BINARY_NAME, nested(descriptor));
     } else {
-        if (!descriptor) {
-            QPID_LOG(warning, "Expected described type but got binary value with no descriptor.");
-        } else if (descriptor->match(DATA_SYMBOL, DATA_CODE)) {
-            onData(bytes);
-        } else if (descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
-            onAmqpValue(bytes, qpid::amqp::typecodes::BINARY_NAME, nested(descriptor));
-        } else {
-            QPID_LOG(warning, "Unexpected binary value with descriptor: " << *descriptor);
-        }
+        QPID_LOG(warning, "Unexpected binary value with descriptor: " << *descriptor);
     }
 
 }
@@ -354,314 +350,243 @@ void MessageReader::onBinary(const CharSequence& bytes, const Descriptor* descri
 //amqp-value
 void MessageReader::onNull(const Descriptor* descriptor)
 {
-    if (delegate) {
-        delegate->onNull(descriptor);
+    if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
+        qpid::types::Variant v;
+        onAmqpValue(v, nested(descriptor));
     } else {
-        if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
-            qpid::types::Variant v;
-            onAmqpValue(v, nested(descriptor));
+        if (!descriptor) {
+            QPID_LOG(warning, "Expected described type but got null value with no descriptor.");
         } else {
-            if (!descriptor) {
-                QPID_LOG(warning, "Expected described type but got null value with no descriptor.");
-            } else {
-                QPID_LOG(warning, "Unexpected null value with descriptor: " << *descriptor);
-            }
+            QPID_LOG(warning, "Unexpected null value with descriptor: " << *descriptor);
         }
     }
 }
 void MessageReader::onString(const CharSequence& v, const Descriptor* descriptor)
 {
-    if (delegate) {
-        delegate->onString(v, descriptor);
+    if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
+        onAmqpValue(v, qpid::amqp::typecodes::STRING_NAME, nested(descriptor));
     } else {
-        if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
-            onAmqpValue(v, qpid::amqp::typecodes::STRING_NAME, nested(descriptor));
+        if (!descriptor) {
+            QPID_LOG(warning, "Expected described type but got string value with no descriptor.");
         } else {
-            if (!descriptor) {
-                QPID_LOG(warning, "Expected described type but got string value with no descriptor.");
-            } else {
-                QPID_LOG(warning, "Unexpected string value with descriptor: " << *descriptor);
-            }
+            QPID_LOG(warning, "Unexpected string value with descriptor: " << *descriptor);
         }
     }
 }
 void MessageReader::onSymbol(const CharSequence& v, const Descriptor* descriptor)
 {
-    if (delegate) {
-        delegate->onSymbol(v, descriptor);
+    if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
+        onAmqpValue(v, qpid::amqp::typecodes::SYMBOL_NAME, nested(descriptor));
     } else {
-        if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
-            onAmqpValue(v, qpid::amqp::typecodes::SYMBOL_NAME, nested(descriptor));
+        if (!descriptor) {
+            QPID_LOG(warning, "Expected described type but got symbol value with no descriptor.");
         } else {
-            if (!descriptor) {
-                QPID_LOG(warning, "Expected described type but got symbol value with no descriptor.");
-            } else {
-                QPID_LOG(warning, "Unexpected symbol value with descriptor: " << *descriptor);
-            }
+            QPID_LOG(warning, "Unexpected symbol value with descriptor: " << *descriptor);
         }
     }
 }
 
 void MessageReader::onBoolean(bool v, const Descriptor* descriptor)
 {
-    if (delegate) {
-        delegate->onBoolean(v, descriptor);
+    if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
+        qpid::types::Variant body = v;
+        onAmqpValue(body, nested(descriptor));
     } else {
-        if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
-            qpid::types::Variant body = v;
-            onAmqpValue(body, nested(descriptor));
+        if (!descriptor) {
+            QPID_LOG(warning, "Expected described type but got boolean value with no descriptor.");
         } else {
-            if (!descriptor) {
-                QPID_LOG(warning, "Expected described type but got boolean value with no descriptor.");
-            } else {
-                QPID_LOG(warning, "Unexpected boolean value with descriptor: " << *descriptor);
-            }
+            QPID_LOG(warning, "Unexpected boolean value with descriptor: " << *descriptor);
         }
     }
 }
 
 void MessageReader::onUByte(uint8_t v, const Descriptor* descriptor)
 {
-    if (delegate) {
-        delegate->onUByte(v, descriptor);
+    if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
+        qpid::types::Variant body = v;
+        onAmqpValue(body, nested(descriptor));
     } else {
-        if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
-            qpid::types::Variant body = v;
-            onAmqpValue(body, nested(descriptor));
+        if (!descriptor) {
+            QPID_LOG(warning, "Expected described type but got ubyte value with no descriptor.");
         } else {
-            if (!descriptor) {
-                QPID_LOG(warning, "Expected described type but got ubyte value with no descriptor.");
-            } else {
-                QPID_LOG(warning, "Unexpected ubyte value with descriptor: " << *descriptor);
-            }
+            QPID_LOG(warning, "Unexpected ubyte value with descriptor: " << *descriptor);
         }
     }
 }
 
 void MessageReader::onUShort(uint16_t v, const Descriptor* descriptor)
 {
-    if (delegate) {
-        delegate->onUShort(v, descriptor);
+    if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
+        qpid::types::Variant body = v;
+        onAmqpValue(body, nested(descriptor));
     } else {
-        if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
-            qpid::types::Variant body = v;
-            onAmqpValue(body, nested(descriptor));
+        if (!descriptor) {
+            QPID_LOG(warning, "Expected described type but got ushort value with no descriptor.");
         } else {
-            if (!descriptor) {
-                QPID_LOG(warning, "Expected described type but got ushort value with no descriptor.");
-            } else {
-                QPID_LOG(warning, "Unexpected ushort value with descriptor: " << *descriptor);
-            }
+            QPID_LOG(warning, "Unexpected ushort value with descriptor: " << *descriptor);
         }
     }
 }
 
 void MessageReader::onUInt(uint32_t v, const Descriptor* descriptor)
 {
-    if (delegate) {
-        delegate->onUInt(v, descriptor);
+    if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
+        qpid::types::Variant body = v;
+        onAmqpValue(body, nested(descriptor));
     } else {
-        if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
-            qpid::types::Variant body = v;
-            onAmqpValue(body, nested(descriptor));
+        if (!descriptor) {
+            QPID_LOG(warning, "Expected described type but got uint value with no descriptor.");
         } else {
-            if (!descriptor) {
-                QPID_LOG(warning, "Expected described type but got uint value with no descriptor.");
-            } else {
-                QPID_LOG(warning, "Unexpected uint value with descriptor: " << *descriptor);
-            }
+            QPID_LOG(warning, "Unexpected uint value with descriptor: " << *descriptor);
         }
     }
 }
 
 void MessageReader::onULong(uint64_t v, const Descriptor* descriptor)
 {
-    if (delegate) {
-        delegate->onULong(v, descriptor);
+    if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
+        qpid::types::Variant body = v;
+        onAmqpValue(body, nested(descriptor));
     } else {
-        if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
-            qpid::types::Variant body = v;
-            onAmqpValue(body, nested(descriptor));
+        if (!descriptor) {
+            QPID_LOG(warning, "Expected described type but got ulong value with no descriptor.");
         } else {
-            if (!descriptor) {
-                QPID_LOG(warning, "Expected described type but got ulong value with no descriptor.");
-            } else {
-                QPID_LOG(warning, "Unexpected ulong value with descriptor: " << *descriptor);
-            }
+            QPID_LOG(warning, "Unexpected ulong value with descriptor: " << *descriptor);
         }
     }
 }
 
 void MessageReader::onByte(int8_t v, const Descriptor* descriptor)
 {
-    if (delegate) {
-        delegate->onByte(v, descriptor);
+    if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
+        qpid::types::Variant body = v;
+        onAmqpValue(body, nested(descriptor));
     } else {
-        if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
-            qpid::types::Variant body = v;
-            onAmqpValue(body, nested(descriptor));
+        if (!descriptor) {
+            QPID_LOG(warning, "Expected described type but got byte value with no descriptor.");
         } else {
-            if (!descriptor) {
-                QPID_LOG(warning, "Expected described type but got byte value with no descriptor.");
-            } else {
-                QPID_LOG(warning, "Unexpected byte value with descriptor: " << *descriptor);
-            }
+            QPID_LOG(warning, "Unexpected byte value with descriptor: " << *descriptor);
         }
     }
 }
 
 void MessageReader::onShort(int16_t v, const Descriptor* descriptor)
 {
-    if (delegate) {
-        delegate->onShort(v, descriptor);
+    if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
+        qpid::types::Variant body = v;
+        onAmqpValue(body, nested(descriptor));
     } else {
-        if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
-            qpid::types::Variant body = v;
-            onAmqpValue(body, nested(descriptor));
+        if (!descriptor) {
+            QPID_LOG(warning, "Expected described type but got short value with no descriptor.");
         } else {
-            if (!descriptor) {
-                QPID_LOG(warning, "Expected described type but got short value with no descriptor.");
-            } else {
-                QPID_LOG(warning, "Unexpected short value with descriptor: " << *descriptor);
-            }
+            QPID_LOG(warning, "Unexpected short value with descriptor: " << *descriptor);
         }
     }
 }
 
 void MessageReader::onInt(int32_t v, const Descriptor* descriptor)
 {
-    if (delegate) {
-        delegate->onInt(v, descriptor);
+    if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
+        qpid::types::Variant body = v;
+        onAmqpValue(body, nested(descriptor));
     } else {
-        if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
-            qpid::types::Variant body = v;
-            onAmqpValue(body, nested(descriptor));
+        if (!descriptor) {
+            QPID_LOG(warning, "Expected described type but got int value with no descriptor.");
         } else {
-            if (!descriptor) {
-                QPID_LOG(warning, "Expected described type but got int value with no descriptor.");
-            } else {
-                QPID_LOG(warning, "Unexpected int value with descriptor: " << *descriptor);
-            }
+            QPID_LOG(warning, "Unexpected int value with descriptor: " << *descriptor);
         }
     }
 }
 
 void MessageReader::onLong(int64_t v, const Descriptor* descriptor)
 {
-    if (delegate) {
-        delegate->onLong(v, descriptor);
+    if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
+        qpid::types::Variant body = v;
+        onAmqpValue(body, nested(descriptor));
     } else {
-        if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
-            qpid::types::Variant body = v;
-            onAmqpValue(body, nested(descriptor));
+        if (!descriptor) {
+            QPID_LOG(warning, "Expected described type but got long value with no descriptor.");
         } else {
-            if (!descriptor) {
-                QPID_LOG(warning, "Expected described type but got long value with no descriptor.");
-            } else {
-                QPID_LOG(warning, "Unexpected long value with descriptor: " << *descriptor);
-            }
+            QPID_LOG(warning, "Unexpected long value with descriptor: " << *descriptor);
         }
     }
 }
 
 void MessageReader::onFloat(float v, const Descriptor* descriptor)
 {
-    if (delegate) {
-        delegate->onFloat(v, descriptor);
+    if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
+        qpid::types::Variant body = v;
+        onAmqpValue(body, nested(descriptor));
     } else {
-        if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
-            qpid::types::Variant body = v;
-            onAmqpValue(body, nested(descriptor));
+        if (!descriptor) {
+            QPID_LOG(warning, "Expected described type but got float value with no descriptor.");
         } else {
-            if (!descriptor) {
-                QPID_LOG(warning, "Expected described type but got float value with no descriptor.");
-            } else {
-                QPID_LOG(warning, "Unexpected float value with descriptor: " << *descriptor);
-            }
+            QPID_LOG(warning, "Unexpected float value with descriptor: " << *descriptor);
         }
     }
 }
 
 void MessageReader::onDouble(double v, const Descriptor* descriptor)
 {
-    if (delegate) {
-        delegate->onDouble(v, descriptor);
+    if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
+        qpid::types::Variant body = v;
+        onAmqpValue(body, nested(descriptor));
     } else {
-        if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
-            qpid::types::Variant body = v;
-            onAmqpValue(body, nested(descriptor));
+        if (!descriptor) {
+            QPID_LOG(warning, "Expected described type but got double value with no descriptor.");
         } else {
-            if (!descriptor) {
-                QPID_LOG(warning, "Expected described type but got double value with no descriptor.");
-            } else {
-                QPID_LOG(warning, "Unexpected double value with descriptor: " << *descriptor);
-            }
+            QPID_LOG(warning, "Unexpected double value with descriptor: " << *descriptor);
         }
     }
 }
 
 void MessageReader::onUuid(const CharSequence& v, const Descriptor* descriptor)
 {
-    if (delegate) {
-        delegate->onUuid(v, descriptor);
+    if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
+        onAmqpValue(v, qpid::amqp::typecodes::UUID_NAME, nested(descriptor));
     } else {
-        if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
-            onAmqpValue(v, qpid::amqp::typecodes::UUID_NAME, nested(descriptor));
+        if (!descriptor) {
+            QPID_LOG(warning, "Expected described type but got uuid value with no descriptor.");
         } else {
-            if (!descriptor) {
-                QPID_LOG(warning, "Expected described type but got uuid value with no descriptor.");
-            } else {
-                QPID_LOG(warning, "Unexpected uuid value with descriptor: " << *descriptor);
-            }
+            QPID_LOG(warning, "Unexpected uuid value with descriptor: " << *descriptor);
         }
     }
 }
 
 void MessageReader::onTimestamp(int64_t v, const Descriptor* descriptor)
 {
-    if (delegate) {
-        delegate->onTimestamp(v, descriptor);
+    if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
+        qpid::types::Variant body = v;
+        onAmqpValue(body, nested(descriptor));
     } else {
-        if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
-            qpid::types::Variant body = v;
-            onAmqpValue(body, nested(descriptor));
+        if (!descriptor) {
+            QPID_LOG(warning, "Expected described type but got timestamp value with no descriptor.");
         } else {
-            if (!descriptor) {
-                QPID_LOG(warning, "Expected described type but got timestamp value with no descriptor.");
-            } else {
-                QPID_LOG(warning, "Unexpected timestamp value with descriptor: " << *descriptor);
-            }
+            QPID_LOG(warning, "Unexpected timestamp value with descriptor: " << *descriptor);
         }
     }
 }
 
-bool MessageReader::onStartArray(uint32_t count, const CharSequence& raw, const Constructor& constructor, const Descriptor* descriptor)
+bool MessageReader::onStartArray(uint32_t /*count*/, const CharSequence& raw, const Constructor& /*constructor*/, const Descriptor* descriptor)
 {
-    if (delegate) {
-        return delegate->onStartArray(count, raw, constructor, descriptor);
+    if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
+        //TODO: might be better to decode this here
+        onAmqpValue(raw, qpid::amqp::typecodes::ARRAY_NAME, nested(descriptor));
     } else {
-        if (descriptor && descriptor->match(AMQP_VALUE_SYMBOL, AMQP_VALUE_CODE)) {
-            //TODO: might be better to decode this here
-            onAmqpValue(raw, qpid::amqp::typecodes::ARRAY_NAME, nested(descriptor));
+        if (!descriptor) {
+            QPID_LOG(warning, "Expected described type but got array with no descriptor.");
         } else {
-            if (!descriptor) {
-                QPID_LOG(warning, "Expected described type but got array with no descriptor.");
-            } else {
-                QPID_LOG(warning, "Unexpected array with descriptor: " << *descriptor);
-            }
+            QPID_LOG(warning, "Unexpected array with descriptor: " << *descriptor);
         }
-        return false;
     }
+    return false;
 }
 
-void MessageReader::onEndArray(uint32_t v, const Descriptor* descriptor)
+void MessageReader::onEndArray(uint32_t /*count*/, const Descriptor*)
 {
-    if (delegate) {
-        delegate->onEndArray(v, descriptor);
-    }
 }
 
-MessageReader::MessageReader() : headerReader(*this), propertiesReader(*this), delegate(0)
+MessageReader::MessageReader()
 {
     bare.init();
 }
@@ -108,52 +108,6 @@ class MessageReader : public Reader
     QPID_COMMON_EXTERN CharSequence getBareMessage() const;
 
   private:
-
-    class HeaderReader : public Reader
-    {
-      public:
-        HeaderReader(MessageReader&);
-        void onBoolean(bool v, const Descriptor*);  // durable, first-acquirer
-        void onUByte(uint8_t v, const Descriptor*); // priority
-        void onUInt(uint32_t v, const Descriptor*); // ttl, delivery-count
-        void onNull(const Descriptor*);
-      private:
-        MessageReader& parent;
-        size_t index;
-    };
-    class PropertiesReader : public Reader
-    {
-      public:
-        PropertiesReader(MessageReader&);
-        void onUuid(const CharSequence& v, const Descriptor*); // message-id, correlation-id
-        void onULong(uint64_t v, const Descriptor*); // message-id, correlation-id
-        void onBinary(const CharSequence& v, const Descriptor*); // message-id, correlation-id, user-id
-        void onString(const CharSequence& v, const Descriptor*); // message-id, correlation-id, group-id, reply-to-group-id, subject, to, reply-to
-        void onSymbol(const CharSequence& v, const Descriptor*); // content-type, content-encoding
-        void onTimestamp(int64_t v, const Descriptor*); // absolute-expiry-time, creation-time
-        void onUInt(uint32_t v, const Descriptor*); // group-sequence
-        void onNull(const Descriptor*);
-
-        void onBoolean(bool, const Descriptor*);
-        void onUByte(uint8_t, const Descriptor*);
-        void onUShort(uint16_t, const Descriptor*);
-        void onByte(int8_t, const Descriptor*);
-        void onShort(int16_t, const Descriptor*);
-        void onInt(int32_t, const Descriptor*);
-        void onLong(int64_t, const Descriptor*);
-        void onFloat(float, const Descriptor*);
-        void onDouble(double, const Descriptor*);
-        bool onStartList(uint32_t /*count*/, const CharSequence& /*elements*/, const CharSequence& /*complete*/, const Descriptor*);
-        bool onStartMap(uint32_t /*count*/, const CharSequence& /*elements*/, const CharSequence& /*complete*/, const Descriptor*);
-        bool onStartArray(uint32_t /*count*/, const CharSequence&, const Constructor&, const Descriptor*);
-
-      private:
-        MessageReader& parent;
-        size_t index;
-    };
-    HeaderReader headerReader;
-    PropertiesReader propertiesReader;
-    Reader* delegate;
     CharSequence bare;
 };
 }} // namespace qpid::amqp
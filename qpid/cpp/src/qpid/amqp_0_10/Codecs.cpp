@@ -52,13 +52,38 @@ template <class T, class U, class F> void convert(const T& from, U& to, F f)
     std::transform(from.begin(), from.end(), std::inserter(to, to.begin()), f);
 }
 
-Variant::Map::value_type toVariantMapEntry(const FieldTable::value_type& in);
+void toVariant(boost::shared_ptr<FieldValue> in, Variant& out);
 
-template <class T, class U, class F> void translate(boost::shared_ptr<FieldValue> in, U& u, F f) 
+// The decoded values are built in place in the map or list, rather
+// than copied into it, as copying a Variant copies its whole value.
+void toVariantMap(const FieldTable& in, Variant::Map& out)
+{
+    for (FieldTable::const_iterator i = in.begin(); i != in.end(); ++i) {
+        std::pair<Variant::Map::iterator, bool> entry = out.insert(Variant::Map::value_type(i->first, Variant()));
+        if (entry.second) toVariant(i->second, entry.first->second);
+    }
+}
+
+template <class T> void toVariantList(const T& in, Variant::List& out)
+{
+    for (typename T::const_iterator i = in.begin(); i != in.end(); ++i) {
+        out.push_back(Variant());
+        toVariant(*i, out.back());
+    }
+}
+
+template <class T> void translateMap(boost::shared_ptr<FieldValue> in, Variant::Map& out)
 {
     T t;
     getEncodedValue<T>(in, t);
-    convert(t, u, f);
+    toVariantMap(t, out);
+}
+
+template <class T> void translateList(boost::shared_ptr<FieldValue> in, Variant::List& out)
+{
+    T t;
+    getEncodedValue<T>(in, t);
+    toVariantList(t, out);
 }
 
 void setEncodingFor(Variant& out, uint8_t code)
@@ -97,9 +122,8 @@ qpid::types::Uuid getUuid(FieldValue& value)
     return qpid::types::Uuid(data);
 }
 
-Variant toVariant(boost::shared_ptr<FieldValue> in)
+void toVariant(boost::shared_ptr<FieldValue> in, Variant& out)
 {
-    Variant out;
     //based on AMQP 0-10 typecode, pick most appropriate variant type
     switch (in->getType()) {
         //Fixed Width types:
@@ -147,28 +171,29 @@ Variant toVariant(boost::shared_ptr<FieldValue> in)
 
       case 0xa8:
         out = Variant::Map();
-        translate<FieldTable>(in, out.asMap(), &toVariantMapEntry);
+        translateMap<FieldTable>(in, out.asMap());
         break;
 
       case 0xa9:
         out = Variant::List();
-        translate<List>(in, out.asList(), &toVariant);
+        translateList<List>(in, out.asList());
         break;
       case 0xaa: //convert amqp0-10 array into variant list
         out = Variant::List();
-        translate<Array>(in, out.asList(), &toVariant);
+        translateList<Array>(in, out.asList());
         break;
 
       default:
         //error?
         break;
     }
-    return out;
 }
 
-Variant::Map::value_type toVariantMapEntry(const FieldTable::value_type& in)
+Variant toVariant(boost::shared_ptr<FieldValue> in)
 {
-    return Variant::Map::value_type(in.first, toVariant(in.second));
+    Variant out;
+    toVariant(in, out);
+    return out;
 }
 
 struct DecodeBuffer
@@ -181,12 +206,12 @@ struct DecodeBuffer
 
 };
 
-template <class T, class U, class F> void _decode(const std::string& data, U& value, F f)
+template <class T> T _decode(const std::string& data)
 {
     T t;
     DecodeBuffer buffer(data);
     buffer.decode(t);
-    convert(t, value, f);
+    return t;
 }
 
 uint32_t encodedSize(const Variant& value)
@@ -411,7 +436,7 @@ void MapCodec::encode(const Variant::Map& value, std::string& data)
 
 void MapCodec::decode(const std::string& data, Variant::Map& value)
 {
-    _decode<FieldTable>(data, value, &toVariantMapEntry);
+    toVariantMap(_decode<FieldTable>(data), value);
 }
 
 size_t MapCodec::encodedSize(const Variant::Map& value)
@@ -432,7 +457,7 @@ void ListCodec::encode(const Variant::List& value, std::string& data)
 
 void ListCodec::decode(const std::string& data, Variant::List& value)
 {
-    _decode<List>(data, value, &toVariant);
+    toVariantList(_decode<List>(data), value);
 }
 
 size_t ListCodec::encodedSize(const Variant::List& value)
@@ -482,7 +507,7 @@ void translate(const Variant::Map& from, const std::string& efield, const Varian
 
 void translate(const FieldTable& from, Variant::Map& to)
 {
-    convert(from, to, &toVariantMapEntry);
+    toVariantMap(from, to);
 }
 
 namespace {
@@ -572,7 +597,8 @@ void translate(const types::Variant& from, boost::shared_ptr<framing::FieldValue
 
 void translate(const boost::shared_ptr<FieldValue> from, Variant& to)
 {
-    to = toVariant(from);
+    to.reset();
+    toVariant(from, to);
 }
 
 boost::shared_ptr<framing::FieldValue> translate(const types::Variant& from)
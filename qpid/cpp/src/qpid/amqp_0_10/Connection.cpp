@@ -42,6 +42,16 @@ void Connection::setInputHandler(std::auto_ptr<sys::ConnectionInputHandler> c) {
 
 size_t  Connection::decode(const char* buffer, size_t size) {
     framing::Buffer in(const_cast<char*>(buffer), size);
+    return decodeFrames(in);
+}
+
+size_t  Connection::decodeShared(const BufferRef& backing, const char* buffer, size_t size) {
+    framing::Buffer in(const_cast<char*>(buffer), size);
+    in.setBacking(backing);
+    return decodeFrames(in);
+}
+
+size_t  Connection::decodeFrames(framing::Buffer& in) {
     if (isClient && !initialized) {
         //read in protocol header
         framing::ProtocolInitiation pi;
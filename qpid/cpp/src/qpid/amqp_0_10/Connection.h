@@ -57,10 +57,13 @@ class Connection  : public sys::ConnectionCodec,
     size_t buffered;
     framing::ProtocolVersion version;
 
+    size_t decodeFrames(framing::Buffer& in);
+
   public:
     QPID_BROKER_EXTERN Connection(sys::OutputControl&, const std::string& id, bool isClient);
     QPID_BROKER_EXTERN void setInputHandler(std::auto_ptr<sys::ConnectionInputHandler> c);
     size_t decode(const char* buffer, size_t size);
+    size_t decodeShared(const BufferRef& backing, const char* buffer, size_t size);
     size_t encode(char* buffer, size_t size);
     bool isClosed() const;
     bool canEncode();
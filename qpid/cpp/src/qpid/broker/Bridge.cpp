@@ -34,6 +34,7 @@
 #include "qpid/framing/MessageProperties.h"
 #include "qpid/framing/MessageTransferBody.h"
 #include "qpid/log/Statement.h"
+#include <algorithm>
 #include <iostream>
 
 using qpid::framing::FieldTable;
@@ -74,7 +75,8 @@ Bridge::Bridge(const std::string& _name, Link* _link, framing::ChannelId _id,
     altEx(ae), persistenceId(0),
     conn(0), initialize(init), detached(false),
     useExistingQueue(!_queueName.empty()),
-    sessionName("qpid.bridge_session_" + name + "_" + link->getBroker()->getFederationTag())
+    sessionName("qpid.bridge_session_" + name + "_" + link->getBroker()->getFederationTag()),
+    adaptive(false), creditWindow(0), msgRate(0), rtt(0), probing(false)
 {
     // If both acks (i_sync) and limited credit is configured, then we'd
     // better be able to sync before running out of credit or we
@@ -104,6 +106,15 @@ void Bridge::create(amqp_0_10::Connection& c)
 {
     detached = false;           // Reset detached in case we are recovering.
     conn = &c;
+    adaptive = probing = false;
+    rtt = 0;
+    {
+        // The peer starts with no bindings for a new session; dynamic
+        // routes are re-propagated in full when the bridge registers.
+        sys::Mutex::ScopedLock l(bindingLock);
+        pendingBindings.clear();
+        propagated.clear();
+    }
 
     SessionHandler& sessionHandler = c.getChannel(channel);
     sessionHandler.setErrorListener(shared_from_this());
@@ -150,6 +161,10 @@ void Bridge::create(amqp_0_10::Connection& c)
         if (freq)
             options.setInt("qpid.sync_frequency", freq);
 
+        // Grow limited credit on pull routes to keep a high latency link full.
+        adaptive = !args.i_srcIsLocal && credit != LinkRegistry::INFINITE_CREDIT;
+        creditWindow = credit;
+
         // create a subscription on the remote
         if (args.i_srcIsQueue) {
             peer->getMessage().subscribe(args.i_src, args.i_dest, ack_mode, 0, false, "", 0, options);
@@ -198,6 +213,85 @@ void Bridge::create(amqp_0_10::Connection& c)
         }
     }
     if (args.i_srcIsLocal) sessionHandler.getSession()->enableReceiverTracking();
+    if (adaptive) {
+        lastVisit = sys::AbsTime::now();
+        lastReceived = sessionHandler.getSession()->receiverGetReceived().command;
+        sessionHandler.getSession()->setSenderCompletedListener(
+            boost::bind(&Bridge::senderCompleted, boost::weak_ptr<Bridge>(shared_from_this()), _1));
+    }
+}
+
+/** Called by the owning Link in the IO thread at each maintenance interval. */
+void Bridge::maintenanceVisit()
+{
+    if (!adaptive || detached || !resetProxy()) return;
+    SessionState* session = conn->getChannel(channel).getSession();
+    sys::AbsTime now = sys::AbsTime::now();
+    int64_t elapsed = sys::Duration(lastVisit, now);
+    framing::SequenceNumber received = session->receiverGetReceived().command;
+    int32_t count = received - lastReceived; // Commands received, nearly all transfers.
+    if (elapsed > 0 && count >= 0)
+        msgRate = uint32_t(uint64_t(count) * sys::TIME_SEC / elapsed);
+    lastVisit = now;
+    lastReceived = received;
+
+    uint32_t target = adaptCreditWindow(creditWindow, args.i_credit, msgRate, rtt);
+    if (target != creditWindow) {
+        if (target > creditWindow) {
+            peer->getMessage().flow(args.i_dest, 0, target - creditWindow);
+        } else {
+            // In window mode stop only resets the window, messages in
+            // flight still count against the new one.
+            peer->getMessage().stop(args.i_dest);
+            peer->getMessage().flow(args.i_dest, 0, target);
+            peer->getMessage().flow(args.i_dest, 1, LinkRegistry::INFINITE_CREDIT);
+        }
+        QPID_LOG(debug, "Bridge " << name << " credit window " << creditWindow << " -> " << target
+                 << " (rate " << msgRate << " msgs/sec, rtt " << rtt << ")");
+        creditWindow = target;
+    }
+    if (!probing) {             // Measure round trip time with an execution.sync
+        probeId = session->senderGetCommandPoint().command;
+        probeStart = now;
+        probing = true;
+        framing::Proxy::ScopedSync s(peer->getExecution());
+        peer->getExecution().sync();
+    }
+    if (mgmtObject) {
+        mgmtObject->set_creditWindow(creditWindow);
+        mgmtObject->set_msgRate(msgRate);
+        mgmtObject->set_roundTripTime(rtt);
+    }
+}
+
+uint32_t Bridge::adaptCreditWindow(uint32_t window, uint32_t minimum,
+                                   uint32_t msgRate, sys::Duration rtt)
+{
+    if (int64_t(rtt) <= 0) return window; // Not measured yet.
+    // While the window is the bottleneck msgRate*rtt is close to the window,
+    // so aiming for twice the bandwidth-delay product doubles it each visit
+    // till the link rather than the window limits the rate.
+    uint64_t bdp = uint64_t(msgRate) * (int64_t(rtt)/sys::TIME_USEC) / (sys::TIME_SEC/sys::TIME_USEC);
+    uint64_t target = std::max(uint64_t(minimum), std::min(2*bdp, uint64_t(MAX_ADAPTIVE_CREDIT)));
+    // Grow at once, shrink only when the window is well over the target so
+    // a small dip in the rate doesn't reset it.
+    if (target > window || target < window/2) return uint32_t(target);
+    return window;
+}
+
+void Bridge::senderCompleted(boost::weak_ptr<Bridge> wp, const framing::SequenceSet& commands)
+{
+    Bridge::shared_ptr bridge = wp.lock();
+    if (bridge) bridge->probeCompleted(commands);
+}
+
+void Bridge::probeCompleted(const framing::SequenceSet& commands)
+{
+    if (probing && commands.contains(probeId)) {
+        sys::Duration sample(probeStart, sys::AbsTime::now());
+        rtt = rtt ? (7*int64_t(rtt) + int64_t(sample))/8 : int64_t(sample); // Smoothed as for TCP.
+        probing = false;
+    }
 }
 
 void Bridge::cancel(amqp_0_10::Connection& c)
@@ -235,6 +329,8 @@ void Bridge::setPersistenceId(uint64_t pId) const
 const std::string Bridge::ENCODED_IDENTIFIER("bridge.v2");
 const std::string Bridge::ENCODED_IDENTIFIER_V1("bridge");
 
+const uint32_t Bridge::MAX_ADAPTIVE_CREDIT(65536);
+
 bool Bridge::isEncodedBridge(const std::string& key)
 {
     return key == ENCODED_IDENTIFIER || key == ENCODED_IDENTIFIER_V1;
@@ -381,11 +477,23 @@ void Bridge::propagateBinding(const string& key, const string& tagList,
          else
              bindArgs.setString(qpidFedOrigin, origin);
 
-         conn->requestIOProcessing(
-             weakCallback<Bridge>(
-                 boost::bind(&Bridge::ioThreadPropagateBinding, _1,
-                             queueName, args.i_src, key, bindArgs),
-                 this));
+         PendingBinding pending;
+         pending.key = key;
+         pending.args = bindArgs;
+         pending.id = std::make_pair(key, origin.empty() ? localTag : origin);
+         pending.bind = op.empty() || op == fedOpBind;
+         pending.coalesce = !extra_args && (pending.bind || op == fedOpUnbind);
+
+         bool first;
+         {
+             sys::Mutex::ScopedLock l(bindingLock);
+             first = pendingBindings.empty();
+             pendingBindings.push_back(pending);
+         }
+         if (first)
+             conn->requestIOProcessing(
+                 weakCallback<Bridge>(
+                     boost::bind(&Bridge::ioThreadPropagateBindings, _1), this));
     }
 }
 
@@ -420,6 +528,50 @@ void Bridge::ioThreadPropagateBinding(const string& queue, const string& exchang
     }
 }
 
+void Bridge::ioThreadPropagateBindings()
+{
+    std::vector<PendingBinding> batch;
+    {
+        sys::Mutex::ScopedLock l(bindingLock);
+        batch.swap(pendingBindings);
+    }
+    if (!resetProxy()) {
+        // link's periodic maintenance visit will attempt to recover
+        return;
+    }
+    size_t changes = batch.size();
+    coalesceBindings(batch, propagated);
+    for (std::vector<PendingBinding>::const_iterator i = batch.begin(); i != batch.end(); ++i)
+        peer->getExchange().bind(queueName, args.i_src, i->key, i->args);
+    QPID_LOG(debug, "Bridge " << name << " propagated " << batch.size() << " of "
+             << changes << " binding changes");
+}
+
+void Bridge::coalesceBindings(std::vector<PendingBinding>& batch, BindingIds& propagated)
+{
+    // Only the last operation for a key and origin changes the peer.
+    std::vector<bool> superseded(batch.size(), false);
+    BindingIds seen;
+    for (size_t i = batch.size(); i > 0; --i) {
+        const PendingBinding& pending = batch[i-1];
+        if (pending.coalesce && !seen.insert(pending.id).second)
+            superseded[i-1] = true;
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        const PendingBinding& pending = batch[i];
+        if (superseded[i]) continue;
+        if (pending.coalesce) {
+            if (pending.bind ? !propagated.insert(pending.id).second
+                             : !propagated.erase(pending.id))
+                continue;
+        }
+        if (kept != i) batch[kept] = pending;
+        ++kept;
+    }
+    batch.resize(kept);
+}
+
 bool Bridge::containsLocalTag(const string& tagList) const
 {
     const string& localTag = link->getBroker()->getFederationTag();
@@ -27,15 +27,22 @@
 #include "qpid/framing/Buffer.h"
 #include "qpid/framing/FrameHandler.h"
 #include "qpid/framing/FieldTable.h"
+#include "qpid/framing/SequenceNumber.h"
+#include "qpid/framing/SequenceSet.h"
 #include "qpid/management/Manageable.h"
 #include "qpid/broker/Exchange.h"
 #include "qpid/broker/SessionHandler.h"
+#include "qpid/sys/Mutex.h"
+#include "qpid/sys/Time.h"
 #include "qmf/org/apache/qpid/broker/ArgsLinkBridge.h"
 #include "qmf/org/apache/qpid/broker/Bridge.h"
 
 #include <boost/function.hpp>
 #include <boost/enable_shared_from_this.hpp>
+#include <boost/weak_ptr.hpp>
 #include <memory>
+#include <set>
+#include <vector>
 
 namespace qpid {
 namespace broker {
@@ -94,6 +101,7 @@ class Bridge : public PersistableConfig,
     void propagateBinding(const std::string& key, const std::string& tagList, const std::string& op, const std::string& origin, qpid::framing::FieldTable* extra_args=0);
     void sendReorigin();
     void ioThreadPropagateBinding(const std::string& queue, const std::string& exchange, const std::string& key, framing::FieldTable args);
+    void ioThreadPropagateBindings();
     bool containsLocalTag(const std::string& tagList) const;
     const std::string& getLocalTag() const;
 
@@ -115,6 +123,38 @@ class Bridge : public PersistableConfig,
     void detach();
 
     void setErrorListener(boost::shared_ptr<ErrorListener> e) { errorListener = e; }
+
+    // Adaptive credit: size the credit window from the bandwidth-delay
+    // product estimated from the message rate and the round trip time of an
+    // execution.sync probe.
+    QPID_BROKER_EXTERN static const uint32_t MAX_ADAPTIVE_CREDIT;
+
+    /** The credit window to use for the measured rate and rtt.
+     *@param minimum the configured credit, the window never goes below it.
+     */
+    QPID_BROKER_EXTERN static uint32_t adaptCreditWindow(uint32_t window, uint32_t minimum,
+                                                         uint32_t msgRate, sys::Duration rtt);
+
+    // Dynamic binding propagation: binding changes are queued and sent in
+    // a batch from the connection IO thread. Within a batch only the last
+    // bind or unbind for a key and origin is kept, and it is dropped if the
+    // peer's bridge queue already has (or never had) that binding.
+    struct PendingBinding {
+        std::string key;
+        framing::FieldTable args;
+        std::pair<std::string, std::string> id; // key and origin as sent
+        bool bind;
+        bool coalesce;          // False for extra args or other ops.
+    };
+    typedef std::set<std::pair<std::string, std::string> > BindingIds;
+
+    /** Remove the changes in batch that would not change the peer, keeping
+     * the order of the rest.
+     *@param propagated ids bound on the peer, updated for the kept changes.
+     */
+    QPID_BROKER_EXTERN static void coalesceBindings(std::vector<PendingBinding>& batch,
+                                                    BindingIds& propagated);
+
   private:
     struct PushHandler : framing::FrameHandler {
         PushHandler(amqp_0_10::Connection* c) { conn = c; }
@@ -145,11 +185,32 @@ class Bridge : public PersistableConfig,
     void create(amqp_0_10::Connection& c);
     void cancel(amqp_0_10::Connection& c);
     void closed();
+    void maintenanceVisit();
     friend class Link; // to call create, cancel, closed()
     boost::shared_ptr<ErrorListener> errorListener;
 
     const bool useExistingQueue;
     const std::string sessionName;
+
+    // Adaptive credit state, only used in the connection IO thread.
+    static void senderCompleted(boost::weak_ptr<Bridge>, const framing::SequenceSet&);
+    void probeCompleted(const framing::SequenceSet&);
+
+    bool adaptive;
+    uint32_t creditWindow;      // Message credit granted to the peer.
+    sys::AbsTime lastVisit;
+    framing::SequenceNumber lastReceived;
+    uint32_t msgRate;
+    sys::Duration rtt;          // Smoothed round trip time, 0 if not yet known.
+    bool probing;
+    framing::SequenceNumber probeId;
+    sys::AbsTime probeStart;
+
+    sys::Mutex bindingLock;     // Protects pendingBindings.
+    std::vector<PendingBinding> pendingBindings;
+    // Keys and origins bound on the peer this session. Only used in the
+    // connection IO thread.
+    BindingIds propagated;
 };
 
 
@@ -372,6 +372,9 @@ void ConnectionHandler::Handler::start(const FieldTable& serverProperties,
     }
 
     FieldTable ft = connection.getBroker().getLinkClientProperties();
+    FieldTable linkProperties = connection.getLinkClientProperties();
+    for (FieldTable::const_iterator i = linkProperties.begin(); i != linkProperties.end(); ++i)
+        ft.set(i->first, i->second);
     ft.setInt(QPID_FED_LINK,1);
     ft.setString(QPID_FED_TAG, connection.getBroker().getFederationTag());
 
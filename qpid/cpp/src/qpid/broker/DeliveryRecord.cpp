@@ -37,7 +37,7 @@ DeliveryRecord::DeliveryRecord(const QueueCursor& _msg,
                                framing::SequenceNumber _msgId,
                                framing::SequenceNumber _replicationId,
                                const Queue::shared_ptr& _queue,
-                               const std::string& _tag,
+                               const Tag& _tag,
                                const boost::shared_ptr<Consumer>& _consumer,
                                bool _acquired,
                                bool accepted,
@@ -125,7 +125,7 @@ uint32_t DeliveryRecord::getCredit() const
 }
 
 void DeliveryRecord::acquire(DeliveryIds& results) {
-    if (queue->acquire(msg, tag)) {
+    if (queue->acquire(msg, *tag)) {
         acquired = true;
         results.push_back(id);
         if (!acceptExpected) {
@@ -137,7 +137,7 @@ void DeliveryRecord::acquire(DeliveryIds& results) {
     }
 }
 
-void DeliveryRecord::cancel(const std::string& cancelledTag)
+void DeliveryRecord::cancel(const Tag& cancelledTag)
 {
     if (tag == cancelledTag)
         cancelled = true;
@@ -159,7 +159,7 @@ namespace broker {
 std::ostream& operator<<(std::ostream& out, const DeliveryRecord& r)
 {
     out << "{" << "id=" << r.id.getValue();
-    out << ", tag=" << r.tag << "}";
+    out << ", tag=" << *r.tag << "}";
     out << ", queue=" << r.queue->getName() << "}";
     return out;
 }
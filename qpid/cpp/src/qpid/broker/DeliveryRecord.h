@@ -47,9 +47,14 @@ class Consumer;
  */
 class DeliveryRecord
 {
+  public:
+    /** Name of consumer, shared by all of that consumer's records */
+    typedef boost::shared_ptr<const std::string> Tag;
+
+  private:
     QueueCursor msg;
     mutable boost::shared_ptr<Queue> queue;
-    std::string tag;    // name of consumer
+    Tag tag;
     boost::shared_ptr<Consumer> consumer;
     DeliveryId id;
     bool acquired : 1;
@@ -75,7 +80,7 @@ class DeliveryRecord
                                       framing::SequenceNumber msgId,
                                       framing::SequenceNumber replicationId,
                                       const boost::shared_ptr<Queue>& queue, 
-                                      const std::string& tag,
+                                      const Tag& tag,
                                       const boost::shared_ptr<Consumer>& consumer,
                                       bool acquired,
                                       bool accepted,
@@ -89,7 +94,7 @@ class DeliveryRecord
     void requeue();
     void release(bool setRedelivered);
     void reject();
-    void cancel(const std::string& tag);
+    void cancel(const Tag& tag);
     void acquire(DeliveryIds& results);
     void complete();
     bool accept(TransactionContext* ctxt); // Returns isRedundant()
@@ -105,7 +110,8 @@ class DeliveryRecord
     bool isWindowing() const { return windowing; }
 
     uint32_t getCredit() const;
-    const std::string& getTag() const { return tag; }
+    const std::string& getTag() const { return *tag; }
+    const Tag& getSharedTag() const { return tag; }
 
     void setId(DeliveryId _id) { id = _id; }
 
@@ -145,6 +151,33 @@ struct AckRange
     AckRange(DeliveryRecords::iterator _start, DeliveryRecords::iterator _end) : start(_start), end(_end) {}
 };
 
+/**
+ * Apply f to each record whose id is in ids. Records are sorted by id,
+ * so each range of ids is located by binary search and handled as a
+ * contiguous run rather than testing every record against the set.
+ */
+template <class F> void forEachInSet(DeliveryRecords& records, const framing::SequenceSet& ids, F f)
+{
+    for (framing::SequenceSet::RangeIterator i = ids.rangesBegin(); i != ids.rangesEnd(); ++i) {
+        AckRange range = DeliveryRecord::findRange(records, i->first(), i->last());
+        for (DeliveryRecords::iterator r = range.start; r != range.end; ++r) f(*r);
+    }
+}
+
+/**
+ * As forEachInSet, but erases the records for which predicate returns
+ * true. Only the records in each range are moved, and erasing from
+ * the front of the deque (the usual case, as deliveries are
+ * acknowledged roughly in order) is cheap.
+ */
+template <class Predicate> void removeInSet(DeliveryRecords& records, const framing::SequenceSet& ids, Predicate predicate)
+{
+    for (framing::SequenceSet::RangeIterator i = ids.rangesBegin(); i != ids.rangesEnd(); ++i) {
+        AckRange range = DeliveryRecord::findRange(records, i->first(), i->last());
+        records.erase(std::remove_if(range.start, range.end, predicate), range.end);
+    }
+}
+
 }
 }
 
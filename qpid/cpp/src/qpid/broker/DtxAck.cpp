@@ -28,8 +28,10 @@ using namespace qpid::broker;
 
 DtxAck::DtxAck(const qpid::framing::SequenceSet& acked, DeliveryRecords& unacked)
 {
-    remove_copy_if(unacked.begin(), unacked.end(), inserter(pending, pending.end()), 
-                   not1(bind2nd(mem_fun_ref(&DeliveryRecord::coveredBy), &acked)));
+    for (qpid::framing::SequenceSet::RangeIterator i = acked.rangesBegin(); i != acked.rangesEnd(); ++i) {
+        AckRange range = DeliveryRecord::findRange(unacked, i->first(), i->last());
+        pending.insert(pending.end(), range.start, range.end);
+    }
 }
 
 DtxAck::DtxAck(DeliveryRecords& unacked) {
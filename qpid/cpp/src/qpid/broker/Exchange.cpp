@@ -112,6 +112,8 @@ void Exchange::doRoute(Deliverable& msg, ConstBindingList b)
     int count = 0;
 
     if (b.get()) {
+        // Copies of a durable message stored on several queues must share one persistent context
+        if (b->size() > 1 && msg.getMessage().isPersistent()) msg.getMessage().mergeAnnotations();
         ExInfo error(getName()); // Save exception to throw at the end.
         for(std::vector<Binding::shared_ptr>::const_iterator i = b->begin(); i != b->end(); i++, count++) {
             try {
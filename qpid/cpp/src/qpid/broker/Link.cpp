@@ -455,7 +455,22 @@ void Link::ioThreadProcessing()
 
     if (state != STATE_OPERATIONAL)
         return;
+    processBridgesLH();
+}
+
+void Link::ioThreadMaintenance()
+{
+    Mutex::ScopedLock mutex(lock);
+
+    if (state != STATE_OPERATIONAL)
+        return;
+    processBridgesLH();
+    // Only here, so bridges measure their rate over a maintenance interval.
+    std::for_each(active.begin(), active.end(), boost::bind(&Bridge::maintenanceVisit, _1));
+}
 
+void Link::processBridgesLH()
+{
     // check for bridge session errors and recover
     if (!active.empty()) {
         Bridges::iterator removed = std::remove_if(
@@ -511,7 +526,7 @@ void Link::maintenanceVisit ()
         if ((!active.empty() || !created.empty() || !cancellations.empty()) &&
             connection && connection->isOpen())
         connection->requestIOProcessing (
-            weakCallback<Link>(boost::bind(&Link::ioThreadProcessing, _1), this));
+            weakCallback<Link>(boost::bind(&Link::ioThreadMaintenance, _1), this));
         break;
 
     default:    // no-op for all other states
@@ -777,6 +792,16 @@ bool Link::getRemoteAddress(qpid::Address& addr) const
     return state == STATE_OPERATIONAL;
 }
 
+void Link::setClientProperties(const framing::FieldTable& ft) {
+    Mutex::ScopedLock mutex(lock);
+    clientProperties = ft;
+}
+
+framing::FieldTable Link::getClientProperties() const {
+    Mutex::ScopedLock mutex(lock);
+    return clientProperties;
+}
+
 
 // FieldTable keys for internal state data
 namespace {
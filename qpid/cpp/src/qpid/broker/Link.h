@@ -96,6 +96,7 @@ class Link : public PersistableConfig, public management::Manageable,
     bool failover; // Do we subscribe to a failover exchange?
     uint failoverChannel;
     std::string failoverSession;
+    framing::FieldTable clientProperties; // Added to the broker's link properties
 
     static const int STATE_WAITING     = 1;
     static const int STATE_CONNECTING  = 2;
@@ -110,6 +111,8 @@ class Link : public PersistableConfig, public management::Manageable,
     void startConnectionLH();        // Start the IO Connection
     void destroy();                  // Cleanup connection before link goes away
     void ioThreadProcessing();       // Called on connection's IO thread by request
+    void ioThreadMaintenance();      // Called on connection's IO thread each maintenance visit
+    void processBridgesLH();         // Recover, cancel and create bridges
     bool tryFailoverLH();            // Called during maintenance visit
     void reconnectLH(const Address&); //called by LinkRegistry
 
@@ -161,6 +164,12 @@ class Link : public PersistableConfig, public management::Manageable,
 
     QPID_BROKER_EXTERN void setUrl(const Url&); // Set URL for reconnection.
 
+    /** Client properties sent on this link's connection in addition to the
+     * broker-wide link client properties. Takes effect on the next connect.
+     */
+    QPID_BROKER_EXTERN void setClientProperties(const framing::FieldTable&);
+    framing::FieldTable getClientProperties() const;
+
     // Close the link.
     QPID_BROKER_EXTERN void close();
 
@@ -414,6 +414,14 @@ uint16_t LinkRegistry::getPort(const std::string& key)
      return addr.port;
 }
 
+framing::FieldTable LinkRegistry::getClientProperties(const std::string& key)
+{
+    Link::shared_ptr link = findLink(key);
+    if (!link)
+        return framing::FieldTable();
+    return link->getClientProperties();
+}
+
 std::string LinkRegistry::getPassword(const std::string& key)
 {
     Link::shared_ptr link = findLink(key);
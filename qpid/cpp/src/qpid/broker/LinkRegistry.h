@@ -147,6 +147,7 @@ namespace amqp_0_10 {
         QPID_BROKER_EXTERN std::string getPassword        (const std::string& key);
         QPID_BROKER_EXTERN std::string getHost            (const std::string& key);
         QPID_BROKER_EXTERN uint16_t    getPort            (const std::string& key);
+        QPID_BROKER_EXTERN framing::FieldTable getClientProperties(const std::string& key);
     };
 }
 }
@@ -47,11 +47,11 @@ using std::string;
 namespace qpid {
 namespace broker {
 
-Message::Message() : deliveryCount(-1), alreadyAcquired(false), replicationId(0), isReplicationIdSet(false)
+Message::Message() : deliveryCount(-1), alreadyAcquired(false), replicationId(0), isReplicationIdSet(false), annotationsPending(false)
 {}
 
 Message::Message(boost::intrusive_ptr<SharedState> e, boost::intrusive_ptr<PersistableMessage> p)
-    : sharedState(e), persistentContext(p), deliveryCount(-1), alreadyAcquired(false), replicationId(0), isReplicationIdSet(false)
+    : sharedState(e), persistentContext(p), deliveryCount(-1), alreadyAcquired(false), replicationId(0), isReplicationIdSet(false), annotationsPending(false)
 {
     if (persistentContext) persistentContext->setIngressCompletion(e);
 }
@@ -170,14 +170,25 @@ void Message::addAnnotation(const std::string& key, const qpid::types::Variant&
 
 void Message::annotationsChanged()
 {
-    if (persistentContext) {
+    if (persistentContext) annotationsPending = true;
+}
+
+void Message::mergeAnnotations()
+{
+    if (annotationsPending) {
         uint64_t id = persistentContext->getPersistenceId();
         persistentContext = persistentContext->merge(getAnnotations());
         persistentContext->setIngressCompletion(sharedState);
         persistentContext->setPersistenceId(id);
+        annotationsPending = false;
     }
 }
 
+bool Message::hasPendingAnnotations() const
+{
+    return annotationsPending;
+}
+
 uint8_t Message::getPriority() const
 {
     return getEncoding().getPriority();
@@ -297,7 +308,7 @@ class PropertyRetriever : public MapHandler
 qpid::types::Variant Message::getProperty(const std::string& key) const
 {
     PropertyRetriever r(key);
-    sharedState->processProperties(r);
+    if (!sharedState->processProperty(key, r)) sharedState->processProperties(r);
     return r.getResult();
 }
 
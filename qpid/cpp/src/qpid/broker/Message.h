@@ -76,6 +76,11 @@ public:
         virtual bool getTtl(uint64_t&) const = 0;
         virtual std::string getContent() const = 0;
         virtual void processProperties(qpid::amqp::MapHandler&) const = 0;
+        /**
+         * Pass just the named property, if present, to the handler.
+         * Returns false if the caller should use processProperties().
+         */
+        virtual bool processProperty(const std::string&, qpid::amqp::MapHandler&) const { return false; }
         virtual std::string getUserId() const = 0;
         virtual uint64_t getTimestamp() const = 0;
         virtual std::string getTo() const = 0;
@@ -146,7 +151,19 @@ public:
     QPID_BROKER_EXTERN std::string getSubject() const;
     QPID_BROKER_EXTERN std::string getReplyTo() const;
 
+    /**
+     * Annotations are held alongside the shared encoding and written
+     * out by the egress path as it sends the message. The persistent
+     * context is only re-encoded with them by mergeAnnotations().
+     */
     QPID_BROKER_EXTERN void addAnnotation(const std::string& key, const qpid::types::Variant& value);
+    /**
+     * Re-encode the persistent context with any annotations added since
+     * it was last merged. Called before the message is stored, paged or
+     * copied onto several queues.
+     */
+    QPID_BROKER_EXTERN void mergeAnnotations();
+    QPID_BROKER_EXTERN bool hasPendingAnnotations() const;
     QPID_BROKER_EXTERN bool isExcluded(const std::vector<std::string>& excludes) const;
     QPID_BROKER_EXTERN void addTraceId(const std::string& id);
     QPID_BROKER_EXTERN void clearTrace();
@@ -226,6 +243,7 @@ public:
     qpid::framing::SequenceNumber sequence;
     framing::SequenceNumber replicationId;
     bool isReplicationIdSet:1;
+    bool annotationsPending:1;
 
     void annotationsChanged();
     bool getTtl(uint64_t&, uint64_t expiredValue) const;
@@ -315,6 +315,14 @@ void Queue::deliverTo(Message msg, TxBuffer* txn)
     }
 }
 
+void Queue::deliverReplica(Message msg)
+{
+    if (enqueue(0, msg, true)) {
+        push(msg);
+        QPID_LOG(debug, "Replicated message " << msg.getSequence() << " enqueued on " << name);
+    }
+}
+
 void Queue::recoverPrepared(const Message& msg)
 {
     Mutex::ScopedLock locker(messageLock);
@@ -389,6 +397,29 @@ bool Queue::dequeueMessageAt(const SequenceNumber& position)
     return true;
 }
 
+uint32_t Queue::dequeueMessagesAt(const SequenceSet& positions)
+{
+    ScopedAutoDelete autodelete(*this);
+    std::vector<boost::intrusive_ptr<PersistableMessage> > pmsgs;
+    uint32_t count = 0;
+    {
+        Mutex::ScopedLock locker(messageLock);
+        QPID_LOG(debug, "Attempting to dequeue messages at " << positions);
+        for (SequenceSet::iterator i = positions.begin(); i != positions.end(); ++i) {
+            QueueCursor cursor;
+            Message* msg = messages->find(*i, &cursor);
+            if (msg) {
+                if (msg->isPersistent()) pmsgs.push_back(msg->getPersistentContext());
+                observeDequeue(*msg, locker, settings.autodelete ? &autodelete : 0);
+                messages->deleted(cursor);
+                ++count;
+            }
+        }
+    }
+    for_each(pmsgs.begin(), pmsgs.end(), boost::bind(&Queue::dequeueFromStore, this, _1));
+    return count;
+}
+
 bool Queue::acquire(const QueueCursor& position, const std::string& consumer)
 {
     Mutex::ScopedLock locker(messageLock);
@@ -837,6 +868,7 @@ void Queue::push(Message& message, bool /*isRecovery*/)
         Mutex::ScopedLock locker(messageLock);
         message.setSequence(++sequence);
         if (settings.sequencing) message.addAnnotation(settings.sequenceKey, (uint32_t)sequence);
+        if (settings.paging) message.mergeAnnotations();//pages hold the persistent encoding
         interceptors.publish(message);
         messages->publish(message);
         listeners.populate(copy);
@@ -893,7 +925,7 @@ bool Queue::isEmpty(const Mutex::ScopedLock&) const
  * return true if enqueue succeeded and message should be made
  * available; returning false will result in the message being dropped
  */
-bool Queue::enqueue(TransactionContext* ctxt, Message& msg)
+bool Queue::enqueue(TransactionContext* ctxt, Message& msg, bool replica)
 {
     ScopedUse u(barrier);
     if (!u.acquired) return false;
@@ -905,11 +937,12 @@ bool Queue::enqueue(TransactionContext* ctxt, Message& msg)
         }
     }
 
-    if (settings.traceId.size()) {
+    if (settings.traceId.size() && !replica) {
         msg.addTraceId(settings.traceId);
     }
 
     if (msg.isPersistent() && store) {
+        msg.mergeAnnotations();
         // mark the message as being enqueued - the store MUST CALL msg->enqueueComplete()
         // when it considers the message stored.
         boost::intrusive_ptr<PersistableMessage> pmsg = msg.getPersistentContext();
@@ -37,6 +37,7 @@
 
 #include "qpid/framing/FieldTable.h"
 #include "qpid/framing/SequenceNumber.h"
+#include "qpid/framing/SequenceSet.h"
 #include "qpid/sys/AtomicCount.h"
 #include "qpid/sys/AtomicValue.h"
 #include "qpid/sys/Monitor.h"
@@ -232,7 +233,7 @@ class Queue : public boost::enable_shared_from_this<Queue>,
     virtual void push(Message& msg, bool isRecovery=false);
     bool accept(const Message&);
     void process(Message& msg);
-    bool enqueue(TransactionContext* ctxt, Message& msg);
+    bool enqueue(TransactionContext* ctxt, Message& msg, bool replica=false);
     bool getNextMessage(Message& msg, Consumer::shared_ptr& c);
 
     void removeListener(Consumer::shared_ptr);
@@ -320,6 +321,15 @@ class Queue : public boost::enable_shared_from_this<Queue>,
      */
     QPID_BROKER_EXTERN bool dequeueMessageAt(const qpid::framing::SequenceNumber& position);
 
+    /**
+     * Removes (and dequeues) the messages at a set of sequence numbers,
+     * taking the message lock once for the whole set.
+     *
+     * @param positions the sequence numbers of the messages to be dequeued.
+     * @return the number of messages dequeued.
+     */
+    QPID_BROKER_EXTERN uint32_t dequeueMessagesAt(const qpid::framing::SequenceSet& positions);
+
     /**
      * Delivers a message to the queue or to overflow partner.
      */
@@ -331,6 +341,13 @@ class Queue : public boost::enable_shared_from_this<Queue>,
   private:
     QPID_BROKER_EXTERN void deliverTo(Message, TxBuffer* = 0);
   public:
+    /**
+     * Delivers a message that has already been accepted, intercepted
+     * and traced by the queue it replicates: skips those steps and
+     * goes straight to depth accounting, the store and the in-memory
+     * queue. Used by HA backups.
+     */
+    QPID_BROKER_EXTERN void deliverReplica(Message);
     /**
      * Returns a message to the in-memory queue (due to lack
      * of acknowledegement from a receiver). If a consumer is
@@ -35,6 +35,7 @@ const std::string MAX_COUNT("qpid.max_count");
 const std::string MAX_SIZE("qpid.max_size");
 const std::string MAX_FILE_COUNT("qpid.file_count");
 const std::string MAX_FILE_SIZE("qpid.file_size");
+const std::string STORE_SHARED_CONTENT("qpid.store_shared_content");
 const std::string POLICY_TYPE("qpid.policy_type");
 const std::string POLICY_TYPE_REJECT("reject");
 const std::string POLICY_TYPE_RING("ring");
@@ -109,6 +110,7 @@ QueueSettings::QueueSettings(bool d, bool a) :
     alertRepeatInterval(60),
     maxFileSize(0),
     maxFileCount(0),
+    sharedContent(false),
     sequencing(false)
 {}
 
@@ -210,6 +212,9 @@ bool QueueSettings::handle(const std::string& key, const qpid::types::Variant& v
     } else if (key == MAX_FILE_SIZE && value.asUint64() > 0) {
         maxFileSize = value.asUint64();
         return false; // 'handle' here and also pass to store
+    } else if (key == STORE_SHARED_CONTENT) {
+        sharedContent = value;
+        return false; // 'handle' here and also pass to store
     } else if (key == PAGING) {
         paging = value;
         return true;
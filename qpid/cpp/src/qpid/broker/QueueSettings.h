@@ -95,6 +95,8 @@ struct QueueSettings
     //file limits checked by Acl and shared with storeSettings
     uint64_t maxFileSize;
     uint64_t maxFileCount;
+    //store message content once for all such queues (shared with storeSettings)
+    bool sharedContent;
 
     std::string sequenceKey;
     // store bool to avoid testing string value
@@ -43,6 +43,16 @@ size_t SecureConnection::decode(const char* buffer, size_t size)
     }
 }
 
+size_t SecureConnection::decodeShared(const BufferRef& backing, const char* buffer, size_t size)
+{
+    if (securityLayer.get()) {
+        // Decrypted data is held in the security layer, not the read buffer
+        return decode(buffer, size);
+    } else {
+        return codec->decodeShared(backing, buffer, size);
+    }
+}
+
 size_t SecureConnection::encode(char* buffer, size_t size)
 {
     if (secured) {
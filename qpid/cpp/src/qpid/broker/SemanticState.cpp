@@ -38,7 +38,6 @@
 #include "qpid/framing/reply_exceptions.h"
 #include "qpid/framing/MessageTransferBody.h"
 #include "qpid/framing/SequenceSet.h"
-#include "qpid/framing/IsInSequenceSet.h"
 #include "qpid/log/Statement.h"
 #include "qpid/management/ManagementAgent.h"
 #include "qpid/ptr_map.h"
@@ -149,11 +148,13 @@ bool SemanticState::cancel(const string& tag)
 {
     ConsumerImplMap::iterator i = consumers.find(tag);
     if (i != consumers.end()) {
+        // Keep the shared tag, erasing may release the last reference to the consumer.
+        DeliveryRecord::Tag sharedTag = i->second->getSharedTag();
         cancel(i->second);
         consumers.erase(i);
         //should cancel all unacked messages for this consumer so that
         //they are not redelivered on recovery
-        for_each(unacked.begin(), unacked.end(), boost::bind(&DeliveryRecord::cancel, _1, tag));
+        for_each(unacked.begin(), unacked.end(), boost::bind(&DeliveryRecord::cancel, _1, sharedTag));
         //can also remove any records that are now redundant
         DeliveryRecords::iterator removed =
             remove_if(unacked.begin(), unacked.end(), bind(&DeliveryRecord::isRedundant, _1));
@@ -328,6 +329,7 @@ SemanticStateConsumerImpl::SemanticStateConsumerImpl(SemanticState* _parent,
     Consumer(_name, type, _tag),
     parent(_parent),
     queue(_queue),
+    sharedTag(new std::string(_tag)),
     ackExpected(ack),
     acquire(type == CONSUMER),
     blocked(true),
@@ -384,7 +386,7 @@ bool SemanticStateConsumerImpl::deliver(const QueueCursor& cursor, const Message
 {
     allocateCredit(msg);
     boost::intrusive_ptr<const amqp_0_10::MessageTransfer> transfer = protocols.translate(msg);
-    DeliveryRecord record(cursor, msg.getSequence(), msg.getReplicationId(), queue, getTag(),
+    DeliveryRecord record(cursor, msg.getSequence(), msg.getReplicationId(), queue, sharedTag,
                           consumer, acquire, !ackExpected, credit.isWindowMode(), transfer->getRequiredCredit());
     bool sync = syncFrequency && ++deliveryCount >= syncFrequency;
     if (sync) deliveryCount = 0;//reset
@@ -531,12 +533,14 @@ void SemanticStateConsumerImpl::requestDispatch()
     }
 }
 
-bool SemanticState::complete(DeliveryRecord& delivery)
+bool SemanticState::CompleteRecord::operator()(DeliveryRecord& delivery)
 {
-    ConsumerImplMap::iterator i = consumers.find(delivery.getTag());
-    if (i != consumers.end()) {
-        i->second->complete(delivery);
+    if (delivery.getSharedTag() != tag) {
+        tag = delivery.getSharedTag();
+        ConsumerImplMap::iterator i = state.consumers.find(*tag);
+        consumer = i == state.consumers.end() ? 0 : i->second.get();
     }
+    if (consumer) consumer->complete(delivery);
     return delivery.isRedundant();
 }
 
@@ -759,22 +763,6 @@ void SemanticStateConsumerImpl::notify()
 }
 
 
-// Test that a DeliveryRecord's ID is in a sequence set and some other
-// predicate on DeliveryRecord holds.
-template <class Predicate> struct IsInSequenceSetAnd {
-    IsInSequenceSet isInSet;
-    Predicate predicate;
-    IsInSequenceSetAnd(const SequenceSet& s, Predicate p) : isInSet(s), predicate(p) {}
-    bool operator()(DeliveryRecord& dr) {
-        return isInSet(dr.getId()) && predicate(dr);
-    }
-};
-
-template<class Predicate> IsInSequenceSetAnd<Predicate>
-isInSequenceSetAnd(const SequenceSet& s, Predicate p) {
-    return IsInSequenceSetAnd<Predicate>(s,p);
-}
-
 void SemanticState::accepted(const SequenceSet& commands) {
     if (txBuffer.get()) {
         //in transactional mode, don't dequeue or remove, just
@@ -790,29 +778,16 @@ void SemanticState::accepted(const SequenceSet& commands) {
             //mark the relevant messages as 'ended' in unacked
             //if the messages are already completed, they can be
             //removed from the record
-            DeliveryRecords::iterator removed =
-                remove_if(unacked.begin(), unacked.end(),
-                          isInSequenceSetAnd(commands,
-                                             bind(&DeliveryRecord::setEnded, _1)));
-            unacked.erase(removed, unacked.end());
+            removeInSet(unacked, commands, bind(&DeliveryRecord::setEnded, _1));
         }
     } else {
-        DeliveryRecords::iterator removed =
-            remove_if(unacked.begin(), unacked.end(),
-                      isInSequenceSetAnd(commands,
-                                         bind(&DeliveryRecord::accept, _1,
-                                              (TransactionContext*) 0)));
-        unacked.erase(removed, unacked.end());
+        removeInSet(unacked, commands, bind(&DeliveryRecord::accept, _1, (TransactionContext*) 0));
     }
     getSession().setUnackedCount(unacked.size());
 }
 
 void SemanticState::completed(const SequenceSet& commands) {
-    DeliveryRecords::iterator removed =
-        remove_if(unacked.begin(), unacked.end(),
-                  isInSequenceSetAnd(commands,
-                                     bind(&SemanticState::complete, this, _1)));
-    unacked.erase(removed, unacked.end());
+    removeInSet(unacked, commands, CompleteRecord(*this));
     requestDispatch();
     getSession().setUnackedCount(unacked.size());
 }
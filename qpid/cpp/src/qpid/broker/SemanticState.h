@@ -109,9 +109,24 @@ class SemanticState : private boost::noncopyable {
 
     Bindings bindings;
 
+    /**
+     * Completes delivery records, looking up the consumer once for each
+     * run of records from the same consumer rather than once per record.
+     */
+    class CompleteRecord
+    {
+      public:
+        CompleteRecord(SemanticState& s) : state(s), consumer(0) {}
+        bool operator()(DeliveryRecord&);
+      private:
+        SemanticState& state;
+        DeliveryRecord::Tag tag;
+        ConsumerImpl* consumer;
+    };
+    friend class CompleteRecord;
+
     void checkDtxTimeout();
 
-    bool complete(DeliveryRecord&);
     AckRange findRange(DeliveryId first, DeliveryId last);
     void requestDispatch();
     void cancel(boost::shared_ptr<ConsumerImpl>);
@@ -204,6 +219,7 @@ class SemanticStateConsumerImpl : public Consumer, public sys::OutputTask,
     const boost::shared_ptr<Queue> queue;
 
     private:
+    const DeliveryRecord::Tag sharedTag;
     const bool ackExpected;
     const bool acquire;
     bool blocked;
@@ -265,6 +281,7 @@ class SemanticStateConsumerImpl : public Consumer, public sys::OutputTask,
 
     Credit& getCredit() { return credit; }
     const Credit& getCredit() const { return credit; }
+    const DeliveryRecord::Tag& getSharedTag() const { return sharedTag; }
     bool isAckExpected() const { return ackExpected; }
     bool isAcquire() const { return acquire; }
     bool isExclusive() const { return exclusive; }
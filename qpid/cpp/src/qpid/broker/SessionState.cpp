@@ -334,6 +334,7 @@ void SessionState::sendCompletion() {
 void SessionState::senderCompleted(const SequenceSet& commands) {
     qpid::SessionState::senderCompleted(commands);
     semanticState.completed(commands);
+    if (senderCompletedListener) senderCompletedListener(commands);
 }
 
 void SessionState::readyToSend() {
@@ -37,6 +37,7 @@
 #include "qpid/broker/amqp_0_10/MessageTransfer.h"
 #include "qpid/sys/Monitor.h"
 
+#include <boost/function.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/intrusive_ptr.hpp>
@@ -100,6 +101,10 @@ class SessionState : public qpid::SessionState,
 
     void senderCompleted(const framing::SequenceSet& ranges);
 
+    /** Called in the IO thread with commands completed by the peer. */
+    typedef boost::function<void(const framing::SequenceSet&)> SenderCompletedListener;
+    void setSenderCompletedListener(const SenderCompletedListener& l) { senderCompletedListener = l; }
+
     void sendCompletion();
 
     DeliveryId deliver(const qpid::broker::amqp_0_10::MessageTransfer& message,
@@ -175,6 +180,8 @@ class SessionState : public qpid::SessionState,
     // sequence numbers for pending received Execution.Sync commands
     std::queue<SequenceNumber> pendingExecutionSyncs;
 
+    SenderCompletedListener senderCompletedListener;
+
   public:
 
     /** Information about the currently executing command.
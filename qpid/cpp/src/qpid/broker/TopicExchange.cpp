@@ -35,18 +35,62 @@ namespace _qmf = qmf::org::apache::qpid::broker;
 // iterator for federation ReOrigin bind operation
 class TopicExchange::ReOriginIter : public BindingNode::TreeIterator {
 public:
-    ReOriginIter() {};
+    ReOriginIter(const std::set<std::string>& s) : subsumed(s) {};
     ~ReOriginIter() {};
     bool visit(BindingNode& node) {
-        if (node.bindings.fedBinding.hasLocal()) {
+        if (node.bindings.fedBinding.hasLocal() && !subsumed.count(node.routePattern)) {
             keys2prop.push_back(node.routePattern);
         }
         return true;
     }
+    const std::set<std::string>& subsumed;
     std::vector<std::string> keys2prop;
 };
 
 
+// match iterator used by isSubsumed(): stops at the first other locally
+// bound pattern that covers the key.  Matching the key's wildcards as
+// literal tokens finds every candidate, subsumes() weeds out the rest.
+class TopicExchange::SubsumerIter : public BindingNode::TreeIterator {
+public:
+    SubsumerIter(const std::string& k) : key(k), found(false) {};
+    ~SubsumerIter() {};
+    bool visit(BindingNode& node) {
+        if (node.routePattern != key && node.bindings.fedBinding.hasLocal() &&
+            TopicExchange::subsumes(node.routePattern, key)) {
+            found = true;
+            return false;   // search done
+        }
+        return true;
+    }
+    const std::string& key;
+    bool found;
+};
+
+
+// iterator used with iterateCovered() to collect the other local keys
+// covered by a pattern: those propagated (not in subsumed) when the pattern
+// is bound, those not propagated (in subsumed) when it is unbound.
+class TopicExchange::SubsumedIter : public BindingNode::TreeIterator {
+public:
+    SubsumedIter(const std::string& p, const std::set<std::string>& s, bool inS) :
+        pattern(p), subsumed(s), inSubsumed(inS) {};
+    ~SubsumedIter() {};
+    bool visit(BindingNode& node) {
+        if (node.routePattern != pattern && node.bindings.fedBinding.hasLocal() &&
+            (subsumed.count(node.routePattern) != 0) == inSubsumed &&
+            TopicExchange::subsumes(pattern, node.routePattern)) {
+            keys.push_back(node.routePattern);
+        }
+        return true;
+    }
+    const std::string& pattern;
+    const std::set<std::string>& subsumed;
+    bool inSubsumed;
+    std::vector<std::string> keys;
+};
+
+
 // match iterator used by route(): builds BindingList of all unique queues
 // that match the routing key.
 class TopicExchange::BindingsFinderIter : public BindingNode::TreeIterator {
@@ -138,6 +182,36 @@ string TopicExchange::normalize(const string& pattern) {
     return normal;
 }
 
+namespace {
+bool hasWildcard(const string& pattern) {
+    return pattern.find_first_of("*#") != string::npos;
+}
+
+// A '#' in the key matches any number of tokens so only a '#' in the
+// pattern can cover it; a '*' in the key is covered by '*' or '#'.
+bool subsumesTokens(TokenIterator p, TokenIterator k) {
+    if (p.finished()) return k.finished();
+    if (p.match1('#')) {
+        TokenIterator rest(p);
+        rest.next();
+        while (true) {
+            if (subsumesTokens(rest, k)) return true;
+            if (k.finished()) return false;
+            k.next();
+        }
+    }
+    if (k.finished() || k.match1('#')) return false;
+    if (!p.match1('*') && !p.match(k.token)) return false;
+    p.next();
+    k.next();
+    return subsumesTokens(p, k);
+}
+}
+
+bool TopicExchange::subsumes(const string& pattern, const string& key) {
+    return subsumesTokens(TokenIterator(pattern), TokenIterator(key));
+}
+
 
 TopicExchange::TopicExchange(const string& _name, Manageable* _parent, Broker* b)
     : Exchange(_name, _parent, b),
@@ -164,6 +238,7 @@ bool TopicExchange::bind(Queue::shared_ptr queue, const string& routingKey, cons
     string fedOrigin(args ? args->getAsString(qpidFedOrigin) : "");
     bool propagate = false;
     string routingPattern = normalize(routingKey);
+    std::vector<std::string> released, retracted;
 
     if (args == 0 || fedOp.empty() || fedOp == fedOpBind) {
         RWlock::ScopedWlock l(lock);
@@ -184,6 +259,8 @@ bool TopicExchange::bind(Queue::shared_ptr queue, const string& routingKey, cons
             bk->bindingVector.push_back(binding);
             nBindings++;
             propagate = bk->fedBinding.addOrigin(queue->getName(), fedOrigin);
+            if (propagate && fedOrigin.empty())
+                propagate = !aggregateLocalBind(routingPattern, retracted);
             if (mgmtExchange != 0) {
                 mgmtExchange->inc_bindingCount();
             }
@@ -197,6 +274,8 @@ bool TopicExchange::bind(Queue::shared_ptr queue, const string& routingKey, cons
             QPID_LOG(debug, "FedOpUnbind [" << routingPattern << "] from exchange " << getName()
                      << " on queue=" << queue->getName() << " origin=" << fedOrigin);
             propagate = bk->fedBinding.delOrigin(queue->getName(), fedOrigin);
+            if (propagate && fedOrigin.empty())
+                propagate = !aggregateLocalUnbind(routingPattern, released);
             // if this was the last binding for the queue, delete the binding
             if (bk->fedBinding.countFedBindings(queue->getName()) == 0) {
                 deleteBinding(queue, routingPattern, bk);
@@ -207,7 +286,7 @@ bool TopicExchange::bind(Queue::shared_ptr queue, const string& routingKey, cons
          * while holding the lock.  Then propagate once the lock is
          * released
          */
-        ReOriginIter reOriginIter;
+        ReOriginIter reOriginIter(subsumedKeys);
         {
             RWlock::ScopedRlock l(lock);
             bindingTree.iterateAll( reOriginIter );
@@ -221,8 +300,14 @@ bool TopicExchange::bind(Queue::shared_ptr queue, const string& routingKey, cons
 
     cc.clearCache(); // clear the cache before we IVE route.
     routeIVE();
+    // newly uncovered keys go out before the unbind of the pattern that
+    // covered them, keys covered by a new pattern are withdrawn after it
+    for (std::vector<std::string>::const_iterator key = released.begin(); key != released.end(); key++)
+        propagateFedOp(*key, string(), fedOpBind, string());
     if (propagate)
-        propagateFedOp(routingKey, fedTags, fedOp, fedOrigin);
+        propagateFedOp(routingPattern, fedTags, fedOp, fedOrigin);
+    for (std::vector<std::string>::const_iterator key = retracted.begin(); key != retracted.end(); key++)
+        propagateFedOp(*key, string(), fedOpUnbind, string());
     return true;
 }
 
@@ -238,7 +323,12 @@ bool TopicExchange::unbind(Queue::shared_ptr queue, const string& constRoutingKe
     BindingKey* bk = getQueueBinding(queue, routingKey);
     if (!bk) return false;
     bool propagate = bk->fedBinding.delOrigin(queue->getName(), fedOrigin);
+    std::vector<std::string> released;
+    if (propagate && fedOrigin.empty())
+        propagate = !aggregateLocalUnbind(routingKey, released);
     deleteBinding(queue, routingKey, bk);
+    for (std::vector<std::string>::const_iterator key = released.begin(); key != released.end(); key++)
+        propagateFedOp(*key, string(), fedOpBind, string());
     if (propagate)
         propagateFedOp(routingKey, string(), fedOpUnbind, string());
     if (nBindings == 0) checkAutodelete();
@@ -272,6 +362,62 @@ bool TopicExchange::deleteBinding(Queue::shared_ptr queue,
     return true;
 }
 
+/** returns true if another locally bound pattern covers the given
+ * pattern, in which case the pattern need not be propagated.
+ */
+bool TopicExchange::isSubsumed(const string& pattern)
+{
+    // Note well: lock held by caller....
+    SubsumerIter subsumer(pattern);
+    bindingTree.iterateMatch(pattern, subsumer);
+    return subsumer.found;
+}
+
+/** Called for the first local binding of a pattern.  Returns true if the
+ * pattern is covered by another local binding and so must not be
+ * propagated.  Otherwise, if the pattern is a wildcard, the propagated
+ * keys it now covers are returned in 'retracted' for withdrawal.
+ */
+bool TopicExchange::aggregateLocalBind(const string& pattern, std::vector<std::string>& retracted)
+{
+    // Note well: write lock held by caller
+    if (isSubsumed(pattern)) {
+        subsumedKeys.insert(pattern);
+        QPID_LOG(debug, "Binding key [" << pattern << "] on exchange " << getName()
+                 << " covered by existing binding, not propagated");
+        return true;
+    }
+    if (hasWildcard(pattern)) {
+        // Only the part of the tree the pattern can cover is searched.
+        SubsumedIter subsumed(pattern, subsumedKeys, false);
+        bindingTree.iterateCovered(pattern, subsumed);
+        subsumedKeys.insert(subsumed.keys.begin(), subsumed.keys.end());
+        retracted.swap(subsumed.keys);
+    }
+    return false;
+}
+
+/** Called when the last local binding of a pattern goes.  Returns true if
+ * the pattern was never propagated.  Otherwise any keys it covered that
+ * are no longer covered are returned in 'released' for propagation.
+ */
+bool TopicExchange::aggregateLocalUnbind(const string& pattern, std::vector<std::string>& released)
+{
+    // Note well: write lock held by caller, pattern no longer has local bindings
+    if (subsumedKeys.erase(pattern)) return true;
+    if (hasWildcard(pattern) && !subsumedKeys.empty()) {
+        SubsumedIter covered(pattern, subsumedKeys, true);
+        bindingTree.iterateCovered(pattern, covered);
+        for (std::vector<std::string>::iterator i = covered.keys.begin(); i != covered.keys.end(); ++i) {
+            if (!isSubsumed(*i)) {
+                released.push_back(*i);
+                subsumedKeys.erase(*i);
+            }
+        }
+    }
+    return false;
+}
+
 /** returns a pointer to the BindingKey if the given queue is bound to this
  * exchange using the routing pattern. 0 if queue binding does not exist.
  */
@@ -22,6 +22,7 @@
 #define _TopicExchange_
 
 #include <map>
+#include <set>
 #include <vector>
 #include "qpid/broker/BrokerImportExport.h"
 #include "qpid/broker/Exchange.h"
@@ -53,10 +54,20 @@ class TopicExchange : public virtual Exchange {
     class ReOriginIter;
     class BindingsFinderIter;
     class QueueFinderIter;
+    class SubsumerIter;
+    class SubsumedIter;
+
+    bool isSubsumed(const std::string& pattern);
+    bool aggregateLocalBind(const std::string& pattern, std::vector<std::string>& retracted);
+    bool aggregateLocalUnbind(const std::string& pattern, std::vector<std::string>& released);
 
     BindingNode bindingTree;
     unsigned long nBindings;
-    qpid::sys::RWlock lock;     // protects bindingTree and nBindings
+    /** Locally bound keys that are not propagated to dynamic bridges
+     * because another local binding pattern already covers them.
+     */
+    std::set<std::string> subsumedKeys;
+    qpid::sys::RWlock lock;     // protects bindingTree, nBindings and subsumedKeys
     qpid::sys::RWlock cacheLock;     // protects cache
     std::map<std::string, BindingList> bindingCache; // cache of matched routes.
 
@@ -84,6 +95,10 @@ public:
     QPID_BROKER_EXTERN static const std::string typeName;
 
     static QPID_BROKER_EXTERN std::string normalize(const std::string& pattern);
+    /** True if every routing key matched by the normalized binding
+     * 'key' is also matched by the normalized binding 'pattern'.
+     */
+    static QPID_BROKER_EXTERN bool subsumes(const std::string& pattern, const std::string& key);
 
     QPID_BROKER_EXTERN TopicExchange(const std::string& name,
                                      management::Manageable* parent = 0, Broker* broker = 0);
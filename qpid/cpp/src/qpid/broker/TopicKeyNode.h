@@ -156,6 +156,14 @@ class QPID_BROKER_CLASS_EXTERN TopicKeyNode {
         return iterateMatch( rKey, iter );
     }
 
+    // applies iter against the nodes whose pattern could be covered by the
+    // normalized binding 'pattern' until iter returns false.  Visits a
+    // superset, iter must check each pattern it is interested in.
+    QPID_BROKER_EXTERN bool iterateCovered(const std::string& pattern, TreeIterator& iter) {
+        TokenIterator bKey(pattern);
+        return iterateCovered(bKey, iter);
+    }
+
     std::string routePattern;  // normalized binding that matches this node
     T bindings;  // for matches against this node
 
@@ -281,6 +289,40 @@ class QPID_BROKER_CLASS_EXTERN TopicKeyNode {
     }
 
 
+    bool iterateCovered(TokenIterator& bKey, TreeIterator& iter) {
+        // invariant: the tokens to this node are covered by the pattern so far.
+        if (bKey.finished())
+            return iter.visit(*this);
+
+        // "#" covers anything below here, including this node.
+        if (bKey.match(HASH))
+            return iterateAll(iter);
+
+        // "*" covers exactly one token, which can't be a "#".
+        if (bKey.match(STAR)) {
+            bKey.next();
+            if (starChild) {
+                TokenIterator tmp(bKey);
+                if (!starChild->iterateCovered(tmp, iter)) return false;
+            }
+            for (typename ChildMap::iterator ptr = childTokens.begin();
+                 ptr != childTokens.end(); ptr++) {
+                TokenIterator tmp(bKey);
+                if (!ptr->second->iterateCovered(tmp, iter)) return false;
+            }
+            return true;
+        }
+
+        // A literal token only covers itself.
+        std::string next_token;
+        bKey.pop(next_token);
+        typename ChildMap::iterator ptr = childTokens.find(next_token);
+        if (ptr != childTokens.end())
+            return ptr->second->iterateCovered(bKey, iter);
+        return true;
+    }
+
+
     bool iterateMatch(TokenIterator& rKey, TreeIterator& iter) {
         if (isStar) return iterateMatchStar(rKey, iter);
         if (isHash) return iterateMatchHash(rKey, iter);
@@ -36,17 +36,7 @@ TxAccept::TxAccept(const SequenceSet& _acked, DeliveryRecords& _unacked) :
 {}
 
 void TxAccept::each(boost::function<void(DeliveryRecord&)> f) {
-    DeliveryRecords::iterator dr = unacked.begin();
-    SequenceSet::iterator seq = acked.begin();
-    while(dr != unacked.end() && seq != acked.end()) {
-        if (dr->getId() == *seq) {
-            f(*dr);
-            ++dr;
-            ++seq;
-        }
-        else if (dr->getId() < *seq) ++dr;
-        else if (dr->getId() > *seq) ++seq;
-    }
+    forEachInSet(unacked, acked, f);
 }
 
 bool TxAccept::prepare(TransactionContext* ctxt) throw()
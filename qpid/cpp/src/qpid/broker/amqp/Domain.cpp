@@ -21,6 +21,7 @@
 #include "Domain.h"
 #include "Interconnect.h"
 #include "Interconnects.h"
+#include "Relay.h"
 #include "SaslClient.h"
 #include "qpid/broker/Broker.h"
 #include "qpid/Exception.h"
@@ -31,6 +32,7 @@
 #include "qpid/management/ManagementAgent.h"
 #include <boost/shared_ptr.hpp>
 #include <boost/lexical_cast.hpp>
+#include <algorithm>
 #include <sstream>
 
 namespace _qmf = qmf::org::apache::qpid::broker;
@@ -51,6 +53,10 @@ const std::string SASL_SERVICE("sasl_service");
 const std::string MIN_SSF("min_ssf");
 const std::string MAX_SSF("max_ssf");
 const std::string DURABLE("durable");
+const std::string LINKS_PER_CONNECTION("links_per_connection");
+const std::string RELAY_CREDIT("relay_credit");
+const int DEFAULT_LINKS_PER_CONNECTION(100);
+const size_t RELAY_BUFFER(1000);
 const std::string AMQP_SASL_SERVICENAME("amqp");
 
 class Wrapper : public qpid::sys::ConnectionCodec
@@ -148,6 +154,8 @@ class InterconnectFactory : public BrokerContext, public qpid::sys::ConnectionCo
     }
     bool connect();
     void failed(int, std::string);
+    bool addLink(const Interconnect::RelayLink&, size_t max);
+    std::vector<Interconnect::RelayLink> takeLinks();
   private:
     bool incoming;
     std::string name;
@@ -159,10 +167,12 @@ class InterconnectFactory : public BrokerContext, public qpid::sys::ConnectionCo
     boost::shared_ptr<Domain> domain;
     qpid::Address address;
     boost::shared_ptr<Relay> relay;
+    std::vector<Interconnect::RelayLink> links; // Routes to multiplex once connected.
+    bool linksTaken;
 };
 
 InterconnectFactory::InterconnectFactory(bool i, const std::string& n, const qpid::types::Variant::Map& properties, boost::shared_ptr<Domain> d, BrokerContext& c)
-    : BrokerContext(c), incoming(i), name(n), url(d->getUrl()), domain(d)
+    : BrokerContext(c), incoming(i), name(n), url(d->getUrl()), domain(d), linksTaken(false)
 {
     get(source, SOURCE, properties);
     get(target, TARGET, properties);
@@ -171,7 +181,8 @@ InterconnectFactory::InterconnectFactory(bool i, const std::string& n, const qpi
 
 InterconnectFactory::InterconnectFactory(bool i, const std::string& n, const std::string& source_, const std::string& target_,
                                          boost::shared_ptr<Domain> d, BrokerContext& c, boost::shared_ptr<Relay> relay_)
-    : BrokerContext(c), incoming(i), name(n), source(source_), target(target_), url(d->getUrl()), domain(d), relay(relay_)
+    : BrokerContext(c), incoming(i), name(n), source(source_), target(target_), url(d->getUrl()), domain(d), relay(relay_),
+      linksTaken(false)
 {
     next = url.begin();
 }
@@ -184,8 +195,12 @@ qpid::sys::ConnectionCodec* InterconnectFactory::create(qpid::sys::OutputControl
 {
     bool useSasl = domain->getMechanisms() != NONE;
     boost::shared_ptr<Interconnect> connection(new Interconnect(out, id, *this, useSasl, incoming, name, source, target, domain->getName()));
-    if (!relay) getInterconnects().add(name, connection);
-    else connection->setRelay(relay);
+    if (!relay) {
+        getInterconnects().add(name, connection);
+    } else {
+        connection->setRelay(relay);
+        domain->relayConnected(shared_from_this(), connection);
+    }
 
     std::auto_ptr<qpid::sys::ConnectionCodec> codec;
     if (useSasl) {
@@ -212,6 +227,23 @@ bool InterconnectFactory::connect()
     return true;
 }
 
+// Called with the Domain lock held.
+bool InterconnectFactory::addLink(const Interconnect::RelayLink& link, size_t max)
+{
+    if (!relay || linksTaken || (max && links.size() + 1 >= max)) return false;
+    links.push_back(link);
+    return true;
+}
+
+// Called with the Domain lock held.
+std::vector<Interconnect::RelayLink> InterconnectFactory::takeLinks()
+{
+    linksTaken = true;
+    std::vector<Interconnect::RelayLink> result;
+    result.swap(links);
+    return result;
+}
+
 void InterconnectFactory::failed(int, std::string text)
 {
     QPID_LOG (info, "Inter-broker connection failed (" << address << "): " << text);
@@ -223,7 +255,7 @@ void InterconnectFactory::failed(int, std::string text)
 Domain::Domain(const std::string& n, const qpid::types::Variant::Map& properties, Broker& b)
     : PersistableObject(n, "domain", properties), name(n), durable(get(DURABLE, properties)),
       broker(b), mechanisms("ANONYMOUS"), service(AMQP_SASL_SERVICENAME), minSsf(0), maxSsf(0),
-      agent(b.getManagementAgent())
+      linksPerConnection(DEFAULT_LINKS_PER_CONNECTION), agent(b.getManagementAgent())
 {
     if (!get(url, URL, properties)) {
         QPID_LOG(error, "No URL specified for domain " << name << "!");
@@ -237,6 +269,10 @@ Domain::Domain(const std::string& n, const qpid::types::Variant::Map& properties
     get(service, SASL_SERVICE, properties);
     get(minSsf, MIN_SSF, properties);
     get(maxSsf, MAX_SSF, properties);
+    get(linksPerConnection, LINKS_PER_CONNECTION, properties);
+    int credit(0);
+    if (get(credit, RELAY_CREDIT, properties) && credit > 0)
+        relayCredit.reset(new RelayCredit(credit));
     if (agent != 0) {
         domain = _qmf::Domain::shared_ptr(new _qmf::Domain(agent, this, name, durable));
         domain->set_url(url.str());
@@ -284,8 +320,36 @@ void Domain::connect(bool incoming, const std::string& name, const qpid::types::
     addPending(factory);
 }
 
+boost::shared_ptr<Relay> Domain::createRelay()
+{
+    return boost::shared_ptr<Relay>(new Relay(RELAY_BUFFER, relayCredit));
+}
+
 void Domain::connect(bool incoming, const std::string& name, const std::string& source, const std::string& target, BrokerContext& context, boost::shared_ptr<Relay> relay)
 {
+    if (linksPerConnection != 1) {
+        // Multiplex over an existing or pending connection if one has room.
+        Interconnect::RelayLink link(incoming, name, source, target, relay);
+        size_t max(std::max(linksPerConnection, 0));
+        qpid::sys::ScopedLock<qpid::sys::Mutex> l(lock);
+        for (std::vector<boost::weak_ptr<Interconnect> >::iterator i = relayConnections.begin(); i != relayConnections.end();) {
+            boost::shared_ptr<Interconnect> connection = i->lock();
+            if (!connection) {
+                i = relayConnections.erase(i);
+            } else if (connection->addLink(link, max)) {
+                QPID_LOG(debug, "Relaying " << name << " over existing connection to domain " << this->name);
+                return;
+            } else {
+                ++i;
+            }
+        }
+        for (std::set< boost::shared_ptr<InterconnectFactory> >::iterator i = pending.begin(); i != pending.end(); ++i) {
+            if ((*i)->addLink(link, max)) {
+                QPID_LOG(debug, "Relaying " << name << " over pending connection to domain " << this->name);
+                return;
+            }
+        }
+    }
     boost::shared_ptr<InterconnectFactory> factory(new InterconnectFactory(incoming, name, source, target, shared_from_this(), context, relay));
     factory->connect();
     addPending(factory);
@@ -303,5 +367,15 @@ void Domain::removePending(boost::shared_ptr<InterconnectFactory> f)
     pending.erase(f);
 }
 
+void Domain::relayConnected(boost::shared_ptr<InterconnectFactory> f, boost::shared_ptr<Interconnect> connection)
+{
+    qpid::sys::ScopedLock<qpid::sys::Mutex> l(lock);
+    std::vector<Interconnect::RelayLink> links = f->takeLinks();
+    for (std::vector<Interconnect::RelayLink>::iterator i = links.begin(); i != links.end(); ++i) {
+        connection->addLink(*i, 0);
+    }
+    relayConnections.push_back(connection);
+}
+
 
 }}} // namespace qpid::broker::amqp
@@ -31,8 +31,10 @@
 #include "qmf/org/apache/qpid/broker/Domain.h"
 #include <boost/shared_ptr.hpp>
 #include <boost/enable_shared_from_this.hpp>
+#include <boost/weak_ptr.hpp>
 #include <memory>
 #include <set>
+#include <vector>
 
 namespace qpid {
 class Sasl;
@@ -45,7 +47,9 @@ class Broker;
 namespace amqp {
 class InterconnectFactory;
 class BrokerContext;
+class Interconnect;
 class Relay;
+class RelayCredit;
 
 class Domain : public PersistableObject, public qpid::management::Manageable, public boost::enable_shared_from_this<Domain>
 {
@@ -60,6 +64,8 @@ class Domain : public PersistableObject, public qpid::management::Manageable, pu
     bool isDurable() const;
     void addPending(boost::shared_ptr<InterconnectFactory>);
     void removePending(boost::shared_ptr<InterconnectFactory>);
+    void relayConnected(boost::shared_ptr<InterconnectFactory>, boost::shared_ptr<Interconnect>);
+    boost::shared_ptr<Relay> createRelay();
     boost::shared_ptr<qpid::management::ManagementObject> GetManagementObject() const;
   private:
     std::string name;
@@ -72,6 +78,9 @@ class Domain : public PersistableObject, public qpid::management::Manageable, pu
     std::string service;
     int minSsf;
     int maxSsf;
+    int linksPerConnection;     // Relayed routes multiplexed per connection, 0 for no limit.
+    boost::shared_ptr<RelayCredit> relayCredit; // Shared by all relays if set.
+    std::vector<boost::weak_ptr<Interconnect> > relayConnections;
     boost::shared_ptr<qmf::org::apache::qpid::broker::Domain> domain;
     qpid::management::ManagementAgent* agent;
     std::set< boost::shared_ptr<InterconnectFactory> > pending;
@@ -115,7 +115,7 @@ void DecodingIncoming::readable(pn_delivery_t* delivery)
 {
     size_t pending = pn_delivery_pending(delivery);
     size_t offset = partial ? partial->getSize() : 0;
-    boost::intrusive_ptr<Message> received(new Message(offset + pending));
+    boost::intrusive_ptr<Message> received(Message::create(offset + pending));
     if (partial) {
         ::memcpy(received->getData(), partial->getData(), offset);
         partial = boost::intrusive_ptr<Message>();
@@ -43,7 +43,7 @@ namespace amqp {
 Interconnect::Interconnect(qpid::sys::OutputControl& out, const std::string& id, BrokerContext& broker, bool saslInUse,
                            bool i, const std::string& n, const std::string& s, const std::string& t, const std::string& d)
     : Connection(out, id, broker, true, true), incoming(i), name(n), source(s), target(t), domain(d), headerDiscarded(saslInUse),
-      isOpened(false), closeRequested(false), isTransportDeleted(false)
+      isOpened(false), closeRequested(false), isTransportDeleted(false), session(0), links(1)
 {}
 
 Interconnect::~Interconnect()
@@ -125,24 +125,76 @@ void Interconnect::process()
             }
             opened();
             getBroker().getConnectionObservers().opened(*this);
-            pn_session_t* s = pn_session(connection);
-            pn_session_open(s);
-            boost::shared_ptr<Session> ssn(new Session(s, *this, out));
-            sessions[s] = ssn;
+            session = pn_session(connection);
+            pn_session_open(session);
+            boost::shared_ptr<Session> ssn(new Session(session, *this, out));
+            sessions[session] = ssn;
 
-            pn_link_t* l = incoming ? pn_receiver(s, name.c_str()) : pn_sender(s, name.c_str());
+            pn_link_t* l = incoming ? pn_receiver(session, name.c_str()) : pn_sender(session, name.c_str());
             pn_link_open(l);
             ssn->attach(l, source, target, relay);
         }
+        if (isOpened) attachRequested();
         Connection::process();
+        if (isOpened) countLinks();
     }
 }
 
+/**
+ * Recount the links carried now that any detached relayed routes have been
+ * removed from the session, so that their places can be taken by new routes.
+ */
+void Interconnect::countLinks()
+{
+    Sessions::iterator ssn = sessions.find(session);
+    size_t attached = ssn == sessions.end() ? 0 : ssn->second->getLinkCount();
+    qpid::sys::ScopedLock<qpid::sys::Mutex> l(lock);
+    links = attached + requested.size();
+}
+
 void Interconnect::setRelay(boost::shared_ptr<Relay> r)
 {
     relay = r;
 }
 
+bool Interconnect::addLink(const RelayLink& link, size_t max)
+{
+    {
+        qpid::sys::ScopedLock<qpid::sys::Mutex> l(lock);
+        if (closeRequested || isTransportDeleted || (max && links >= max)) return false;
+        requested.push_back(link);
+        ++links;
+    }
+    // Before the connection opens, process() attaches requested links when it does.
+    if (isOpened) out.activateOutput();
+    return true;
+}
+
+/**
+ * Attach links for relayed routes multiplexed over this connection since it
+ * was opened. All share the session of the first link.
+ */
+void Interconnect::attachRequested()
+{
+    std::deque<RelayLink> attach;
+    {
+        qpid::sys::ScopedLock<qpid::sys::Mutex> l(lock);
+        attach.swap(requested);
+    }
+    if (attach.empty()) return;
+    Sessions::iterator ssn = sessions.find(session);
+    if (ssn == sessions.end()) {
+        QPID_LOG(warning, id << " interconnect session has ended, dropping " << attach.size() << " relayed routes");
+        return;
+    }
+    for (std::deque<RelayLink>::iterator i = attach.begin(); i != attach.end(); ++i) {
+        QPID_LOG_CAT(debug, model, id << " attaching multiplexed link " << i->name);
+        pn_link_t* l = i->incoming ? pn_receiver(session, i->name.c_str()) : pn_sender(session, i->name.c_str());
+        pn_link_open(l);
+        ssn->second->attach(l, i->source, i->target, i->relay);
+    }
+}
+
 void Interconnect::deletedFromRegistry()
 {
     closeRequested = true;
@@ -151,7 +203,10 @@ void Interconnect::deletedFromRegistry()
 
 void Interconnect::transportDeleted()
 {
-    isTransportDeleted = true;
+    {
+        qpid::sys::ScopedLock<qpid::sys::Mutex> l(lock);
+        isTransportDeleted = true;
+    }
     getInterconnects().remove(name);
 }
 
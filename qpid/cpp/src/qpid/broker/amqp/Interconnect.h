@@ -22,6 +22,8 @@
  *
  */
 #include "Connection.h"
+#include "qpid/sys/Mutex.h"
+#include <deque>
 
 namespace qpid {
 struct Address;
@@ -41,6 +43,24 @@ class Interconnect : public Connection
                  bool incoming, const std::string& name,
                  const std::string& source, const std::string& target, const std::string& domain);
     void setRelay(boost::shared_ptr<Relay>);
+
+    /** A further relayed route to attach as a link on this connection. */
+    struct RelayLink
+    {
+        bool incoming;
+        std::string name;
+        std::string source;
+        std::string target;
+        boost::shared_ptr<Relay> relay;
+        RelayLink(bool i, const std::string& n, const std::string& s, const std::string& t, boost::shared_ptr<Relay> r)
+            : incoming(i), name(n), source(s), target(t), relay(r) {}
+    };
+    /**
+     * Multiplex another relayed route over this connection.
+     *@param max the most links the connection may carry, 0 means no limit.
+     *@return false if the connection is closing or already has max links.
+     */
+    bool addLink(const RelayLink&, size_t max);
     ~Interconnect();
     size_t encode(char* buffer, size_t size);
     void deletedFromRegistry();
@@ -57,8 +77,14 @@ class Interconnect : public Connection
     bool isOpened;
     bool closeRequested;
     bool isTransportDeleted;
+    pn_session_t* session;
+    size_t links;   // Relayed routes attached or waiting to attach, recounted as links detach
+    std::deque<RelayLink> requested;
+    qpid::sys::Mutex lock;
 
     void process();
+    void attachRequested();
+    void countLinks();
 };
 }}} // namespace qpid::broker::amqp
 
@@ -30,6 +30,7 @@
 #include "qpid/types/encodings.h"
 #include "qpid/log/Statement.h"
 #include "qpid/framing/Buffer.h"
+#include <new>
 #include <string.h>
 #include <boost/lexical_cast.hpp>
 
@@ -138,8 +139,7 @@ class StringRetriever : public MapHandler
 
     bool isRequestedKey(const qpid::amqp::CharSequence& actualKey)
     {
-        //TODO: avoid allocating new string by just iterating over chars
-        return key == std::string(actualKey.data, actualKey.size);
+        return key.size() == actualKey.size && ::memcmp(key.data(), actualKey.data, actualKey.size) == 0;
     }
 };
 }
@@ -147,7 +147,7 @@ class StringRetriever : public MapHandler
 std::string Message::getPropertyAsString(const std::string& key) const
 {
     StringRetriever sr(key);
-    processProperties(sr);
+    if (!processProperty(key, sr)) processProperties(sr);
     return sr.getValue();
 }
 
@@ -238,6 +238,7 @@ namespace {
             KEY,
             VALUE
         } state;
+        bool single;
 
         void checkValue() {
             if ( state==VALUE ) state = KEY;
@@ -277,13 +278,77 @@ namespace {
         bool onStartMap(uint32_t, const CharSequence&, const CharSequence&, const Descriptor*) { return false; }
         bool onStartArray(uint32_t, const CharSequence&, const Constructor&, const Descriptor*) { return false; }
 
+        bool proceed() { return !single || state==VALUE; }
+
     public:
         PropertyAdapter(MapHandler& mh) :
             handler(mh),
-            state(KEY)
+            state(KEY),
+            single(false)
+         {}
+        // Reads only the value of the given key
+        PropertyAdapter(MapHandler& mh, const CharSequence& k) :
+            handler(mh),
+            key(k),
+            state(VALUE),
+            single(true)
          {}
     };
 
+size_t hashKey(const char* data, size_t size)
+{
+    // FNV-1a
+    size_t h = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * Records each string key of a map, with its hash, skipping the values.
+ */
+class PropertyIndexer : public Reader {
+    std::vector<std::pair<size_t, CharSequence> >& index;
+    enum {
+        KEY,
+        VALUE
+    } state;
+
+    // A value, or a key that is not a string and so is not indexed
+    void next() { state = state==KEY ? VALUE : KEY; }
+
+    void onNull(const Descriptor*) { next(); }
+    void onBoolean(bool, const Descriptor*) { next(); }
+    void onUByte(uint8_t, const Descriptor*) { next(); }
+    void onUShort(uint16_t, const Descriptor*) { next(); }
+    void onUInt(uint32_t, const Descriptor*) { next(); }
+    void onULong(uint64_t, const Descriptor*) { next(); }
+    void onByte(int8_t, const Descriptor*) { next(); }
+    void onShort(int16_t, const Descriptor*) { next(); }
+    void onInt(int32_t, const Descriptor*) { next(); }
+    void onLong(int64_t, const Descriptor*) { next(); }
+    void onFloat(float, const Descriptor*) { next(); }
+    void onDouble(double, const Descriptor*) { next(); }
+    void onUuid(const CharSequence&, const Descriptor*) { next(); }
+    void onTimestamp(int64_t, const Descriptor*) { next(); }
+    void onBinary(const CharSequence&, const Descriptor*) { next(); }
+    void onSymbol(const CharSequence&, const Descriptor*) { next(); }
+
+    void onString(const CharSequence& s, const Descriptor*) {
+        if (state==KEY) index.push_back(std::make_pair(hashKey(s.data, s.size), s));
+        next();
+    }
+
+    bool onStartList(uint32_t, const CharSequence&, const CharSequence&, const Descriptor*) { next(); return false; }
+    bool onStartMap(uint32_t, const CharSequence&, const CharSequence&, const Descriptor*) { next(); return false; }
+    bool onStartArray(uint32_t, const CharSequence&, const Constructor&, const Descriptor*) { next(); return false; }
+
+  public:
+    PropertyIndexer(std::vector<std::pair<size_t, CharSequence> >& i) : index(i), state(KEY) {}
+};
+
 void processMapData(const CharSequence& source, MapHandler& handler)
 {
     qpid::amqp::Decoder d(source.data, source.size);
@@ -297,6 +362,40 @@ void Message::processProperties(MapHandler& mh) const {
     processMapData(applicationProperties, mh);
 }
 
+/**
+ * Handles the value of a single property, using the index of property
+ * keys (building it if this is the first lookup). Returns false if the
+ * index is being built by another thread, in which case the caller
+ * should fall back to processProperties().
+ */
+bool Message::processProperty(const std::string& key, MapHandler& handler) const
+{
+    if (propertyIndexState.get() != PROPERTIES_INDEXED) {
+        if (!propertyIndexState.boolCompareAndSwap(PROPERTIES_UNINDEXED, PROPERTIES_INDEXING)) return false;
+        try {
+            qpid::amqp::Decoder d(applicationProperties.data, applicationProperties.size);
+            PropertyIndexer indexer(propertyIndex);
+            d.read(indexer);
+        } catch (...) {
+            propertyIndex.clear();
+            propertyIndexState.boolCompareAndSwap(PROPERTIES_INDEXING, PROPERTIES_UNINDEXED);
+            throw;
+        }
+        propertyIndexState.boolCompareAndSwap(PROPERTIES_INDEXING, PROPERTIES_INDEXED);
+    }
+    size_t hash = hashKey(key.data(), key.size());
+    for (PropertyIndex::const_iterator i = propertyIndex.begin(); i != propertyIndex.end(); ++i) {
+        if (i->first == hash && i->second.size == key.size() && ::memcmp(i->second.data, key.data(), key.size()) == 0) {
+            const char* value = i->second.data + i->second.size;
+            qpid::amqp::Decoder d(value, applicationProperties.size - (value - applicationProperties.data));
+            PropertyAdapter adapter(handler, i->second);
+            d.read(adapter);
+            return true;
+        }
+    }
+    return true;
+}
+
 std::string Message::getAnnotationAsString(const std::string& key) const
 {
     StringRetriever sr(key);
@@ -306,7 +405,7 @@ std::string Message::getAnnotationAsString(const std::string& key) const
 
 }
 
-uint64_t Message::getMessageSize() const { return data.size(); }
+uint64_t Message::getMessageSize() const { return size; }
 //getContent() is used primarily for decoding qmf messages in
 //management and ha, but also by the xml exchange
 std::string Message::getContent() const
@@ -314,7 +413,25 @@ std::string Message::getContent() const
     return std::string(body.data, body.size);
 }
 
-Message::Message(size_t size) : data(size), bodyDescriptor(0)
+boost::intrusive_ptr<Message> Message::create(size_t size)
+{
+    void* block = ::operator new(sizeof(Message) + size);
+    try {
+        return boost::intrusive_ptr<Message>(new (block) Message(size));
+    } catch (...) {
+        ::operator delete(block);
+        throw;
+    }
+}
+
+void Message::operator delete(void* p)
+{
+    // Unsized, as the allocation is larger than sizeof(Message)
+    ::operator delete(p);
+}
+
+Message::Message(size_t s) : data(reinterpret_cast<char*>(this) + sizeof(Message)), size(s),
+                             propertyIndexState(PROPERTIES_UNINDEXED), bodyDescriptor(0)
 {
     deliveryAnnotations.init();
     messageAnnotations.init();
@@ -331,9 +448,9 @@ Message::Message(size_t size) : data(size), bodyDescriptor(0)
     body.init();
     footer.init();
 }
-char* Message::getData() { return &data[0]; }
-const char* Message::getData() const { return &data[0]; }
-size_t Message::getSize() const { return data.size(); }
+char* Message::getData() { return data; }
+const char* Message::getData() const { return data; }
+size_t Message::getSize() const { return size; }
 
 qpid::amqp::MessageId Message::getMessageId() const
 {
@@ -492,7 +609,7 @@ void Message::encode(framing::Buffer& buffer) const
 }
 uint32_t Message::encodedSize() const
 {
-    return 4/*format indicator*/ + data.size();
+    return 4/*format indicator*/ + size;
 }
 //in 1.0 the binary header/content makes less sense and in any case
 //the functionality that split originally supported (i.e. lazy-loaded
@@ -505,8 +622,13 @@ uint32_t Message::encodedHeaderSize() const
 void Message::decodeHeader(framing::Buffer& buffer)
 {
     if (buffer.available() != getSize()) {
-        QPID_LOG(warning, "1.0 Message buffer was " << data.size() << " bytes, but " << buffer.available() << " bytes are available. Resizing.");
-        data.resize(buffer.available());
+        QPID_LOG(warning, "1.0 Message buffer was " << getSize() << " bytes, but " << buffer.available() << " bytes are available. Resizing.");
+        if (buffer.available() > getSize()) {
+            // The inline block cannot grow, move the data to the heap
+            resized.resize(buffer.available());
+            data = &resized[0];
+        }
+        size = buffer.available();
     }
     buffer.getRawData((uint8_t*) getData(), getSize());
     scan();
@@ -514,11 +636,10 @@ void Message::decodeHeader(framing::Buffer& buffer)
 }
 void Message::decodeContent(framing::Buffer& /*buffer*/) {}
 
-boost::intrusive_ptr<PersistableMessage> Message::merge(const std::map<std::string, qpid::types::Variant>& added) const
+const std::map<std::string, qpid::types::Variant>& Message::combineAnnotations(const std::map<std::string, qpid::types::Variant>& added,
+                                                                              std::map<std::string, qpid::types::Variant>& combined) const
 {
     //message- or delivery- annotations? would have to determine that from the name, for now assume always message-annotations
-    std::map<std::string, qpid::types::Variant> combined;
-    const std::map<std::string, qpid::types::Variant>* annotations(0);
     if (messageAnnotations) {
         //combine existing and added annotations (TODO: this could be
         //optimised by avoiding the decode and simply 'editing' the
@@ -527,18 +648,34 @@ boost::intrusive_ptr<PersistableMessage> Message::merge(const std::map<std::stri
         qpid::amqp::MapBuilder builder;
         qpid::amqp::Decoder decoder(messageAnnotations.data, messageAnnotations.size);
         decoder.read(builder);
-        combined = builder.getMap();
+        combined.swap(builder.getValue().asMap());
         for (std::map<std::string, qpid::types::Variant>::const_iterator i = added.begin(); i != added.end(); ++i) {
             combined[i->first] = i->second;
         }
-        annotations = &combined;
+        return combined;
     } else {
         //additions form a whole new section
-        annotations = &added;
+        return added;
     }
-    size_t annotationsSize = qpid::amqp::MessageEncoder::getEncodedSize(*annotations, true) + 3/*descriptor*/;
+}
+
+void Message::encodeMessageAnnotations(const std::map<std::string, qpid::types::Variant>& added, std::vector<char>& out) const
+{
+    std::map<std::string, qpid::types::Variant> combined;
+    const std::map<std::string, qpid::types::Variant>& annotations = combineAnnotations(added, combined);
+    out.resize(qpid::amqp::MessageEncoder::getEncodedSize(annotations, true) + 3/*descriptor*/);
+    qpid::amqp::Encoder encoder(&out[0], out.size());
+    encoder.writeMap(annotations, &qpid::amqp::message::MESSAGE_ANNOTATIONS, true);
+    out.resize(encoder.getPosition());
+}
+
+boost::intrusive_ptr<PersistableMessage> Message::merge(const std::map<std::string, qpid::types::Variant>& added) const
+{
+    std::map<std::string, qpid::types::Variant> combined;
+    const std::map<std::string, qpid::types::Variant>& annotations = combineAnnotations(added, combined);
+    size_t annotationsSize = qpid::amqp::MessageEncoder::getEncodedSize(annotations, true) + 3/*descriptor*/;
 
-    boost::intrusive_ptr<Message> copy(new Message(bareMessage.size+footer.size+deliveryAnnotations.size+annotationsSize));
+    boost::intrusive_ptr<Message> copy(create(bareMessage.size+footer.size+deliveryAnnotations.size+annotationsSize));
     size_t position(0);
     if (deliveryAnnotations.size) {
         ::memcpy(&copy->data[position], deliveryAnnotations.data, deliveryAnnotations.size);
@@ -546,7 +683,7 @@ boost::intrusive_ptr<PersistableMessage> Message::merge(const std::map<std::stri
     }
 
     qpid::amqp::Encoder encoder(&copy->data[position], annotationsSize);
-    encoder.writeMap(*annotations, &qpid::amqp::message::MESSAGE_ANNOTATIONS, true);
+    encoder.writeMap(annotations, &qpid::amqp::message::MESSAGE_ANNOTATIONS, true);
     position += encoder.getPosition();
 
     if (bareMessage) {
@@ -557,7 +694,7 @@ boost::intrusive_ptr<PersistableMessage> Message::merge(const std::map<std::stri
         ::memcpy(&copy->data[position], footer.data, footer.size);
         position += footer.size;
     }
-    copy->data.resize(position);//annotationsSize may be slightly bigger than needed if optimisations are used (e.g. smallint)
+    copy->size = position;//annotationsSize may be slightly bigger than needed if optimisations are used (e.g. smallint)
     copy->scan();
     assert(copy->messageAnnotations);
     assert(copy->bareMessage.size == bareMessage.size);
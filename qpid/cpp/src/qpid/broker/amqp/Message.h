@@ -26,6 +26,10 @@
 #include "qpid/amqp/Descriptor.h"
 #include "qpid/amqp/MessageId.h"
 #include "qpid/amqp/MessageReader.h"
+#include "qpid/sys/AtomicValue.h"
+#include <utility>
+#include <vector>
+#include <boost/intrusive_ptr.hpp>
 #include <boost/optional.hpp>
 
 namespace qpid {
@@ -51,6 +55,7 @@ class Message : public qpid::broker::Message::SharedStateImpl, private qpid::amq
     bool getTtl(uint64_t&) const;
     std::string getContent() const;
     void processProperties(qpid::amqp::MapHandler&) const;
+    bool processProperty(const std::string& key, qpid::amqp::MapHandler&) const;
     std::string printProperties() const;
     std::string getUserId() const;
     uint64_t getTimestamp() const;
@@ -74,7 +79,12 @@ class Message : public qpid::broker::Message::SharedStateImpl, private qpid::amq
     qpid::types::Variant getTypedBody() const;
     const qpid::amqp::Descriptor& getBodyDescriptor() const;
 
-    Message(size_t size);
+    /**
+     * Create a message with room for size bytes of encoded data. The data
+     * is held in the same allocation as the message itself.
+     */
+    static boost::intrusive_ptr<Message> create(size_t size);
+    static void operator delete(void*);
     char* getData();
     const char* getData() const;
     size_t getSize() const;
@@ -87,10 +97,17 @@ class Message : public qpid::broker::Message::SharedStateImpl, private qpid::amq
     void decodeContent(framing::Buffer& buffer);
     uint32_t encodedHeaderSize() const;
     boost::intrusive_ptr<PersistableMessage> merge(const std::map<std::string, qpid::types::Variant>& annotations) const;
+    /**
+     * Encode the message-annotations section with the added annotations
+     * included, for sending without building a merged copy.
+     */
+    void encodeMessageAnnotations(const std::map<std::string, qpid::types::Variant>& added, std::vector<char>& out) const;
 
     static const Message& get(const qpid::broker::Message&);
   private:
-    std::vector<char> data;
+    char* data;         // follows this object in the same allocation
+    size_t size;
+    std::vector<char> resized;  // replaces data if decodeHeader needs more room
 
     //header:
     boost::optional<bool> durable;
@@ -116,6 +133,14 @@ class Message : public qpid::broker::Message::SharedStateImpl, private qpid::amq
 
     //application-properties:
     qpid::amqp::CharSequence applicationProperties;
+    /**
+     * Hash and key of each application-property, indexed on the first
+     * lookup by name. The encoded value follows its key directly.
+     */
+    typedef std::vector<std::pair<size_t, qpid::amqp::CharSequence> > PropertyIndex;
+    enum { PROPERTIES_UNINDEXED, PROPERTIES_INDEXING, PROPERTIES_INDEXED };
+    mutable PropertyIndex propertyIndex;
+    mutable qpid::sys::AtomicValue<uint8_t> propertyIndexState;
 
     //body:
     qpid::amqp::CharSequence body;
@@ -159,6 +184,11 @@ class Message : public qpid::broker::Message::SharedStateImpl, private qpid::amq
     void onAmqpValue(const qpid::types::Variant&, const qpid::amqp::Descriptor*);
 
     void onFooter(const qpid::amqp::CharSequence&, const qpid::amqp::CharSequence&);
+
+    const std::map<std::string, qpid::types::Variant>& combineAnnotations(const std::map<std::string, qpid::types::Variant>& added,
+                                                                         std::map<std::string, qpid::types::Variant>& combined) const;
+
+    Message(size_t size);
 };
 }}} // namespace qpid::broker::amqp
 
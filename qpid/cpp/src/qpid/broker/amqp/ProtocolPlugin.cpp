@@ -153,7 +153,7 @@ boost::shared_ptr<RecoverableMessage> ProtocolImpl::recover(qpid::framing::Buffe
     if (format == 0) {
         QPID_LOG(debug, "Recovered message IS in 1.0 format");
         //this is a 1.0 format message
-        boost::intrusive_ptr<qpid::broker::amqp::Message> m(new qpid::broker::amqp::Message(buffer.available()));
+        boost::intrusive_ptr<qpid::broker::amqp::Message> m(qpid::broker::amqp::Message::create(buffer.available()));
         m->decodeHeader(buffer);
         return RecoverableMessage::shared_ptr(new RecoverableMessageImpl(qpid::broker::Message(m, m)));
     } else {
@@ -29,7 +29,39 @@ namespace qpid {
 namespace broker {
 namespace amqp {
 
-Relay::Relay(size_t max_) : credit(0), max(max_), head(0), tail(0), isDetached(false), out(0), in(0) {}
+RelayCredit::RelayCredit(size_t c) : capacity(c), used(0) {}
+size_t RelayCredit::available() const
+{
+    qpid::sys::ScopedLock<qpid::sys::Mutex> l(lock);
+    return used < capacity ? capacity - used : 0;
+}
+size_t RelayCredit::reserve(size_t count, boost::shared_ptr<Relay> relay)
+{
+    qpid::sys::ScopedLock<qpid::sys::Mutex> l(lock);
+    size_t granted = used < capacity ? std::min(count, capacity - used) : 0;
+    used += granted;
+    if (count && !granted) waiting.insert(relay);
+    return granted;
+}
+void RelayCredit::release(size_t count)
+{
+    std::set<boost::weak_ptr<Relay> > wake;
+    {
+        qpid::sys::ScopedLock<qpid::sys::Mutex> l(lock);
+        used -= std::min(count, used);
+        if (used < capacity) wake.swap(waiting);
+    }
+    for (std::set<boost::weak_ptr<Relay> >::iterator i = wake.begin(); i != wake.end(); ++i) {
+        boost::shared_ptr<Relay> relay = i->lock();
+        if (relay) relay->wakeupIncoming();
+    }
+}
+Relay::Relay(size_t max_, boost::shared_ptr<RelayCredit> p)
+    : credit(0), max(max_), head(0), tail(0), isDetached(false), out(0), in(0), pool(p), reserved(0) {}
+Relay::~Relay()
+{
+    if (pool) pool->release(buffer.size() + reserved);
+}
 void Relay::check()
 {
     if (isDetached) throw qpid::Exception("other end of relay has been detached");
@@ -63,6 +95,8 @@ void Relay::received(pn_link_t* link, pn_delivery_t* delivery)
     {
         qpid::sys::ScopedLock<qpid::sys::Mutex> l(lock);
         ++tail;
+        // The pool credit reserved for this transfer is now held by the buffer until it is popped
+        if (reserved) --reserved;
     }
     if (out) out->wakeup();
 }
@@ -78,10 +112,13 @@ BufferedTransfer& Relay::front()
 }
 void Relay::pop()
 {
-    qpid::sys::ScopedLock<qpid::sys::Mutex> l(lock);
-    buffer.pop_front();
-    if (head) --head;
-    if (tail) --tail;
+    {
+        qpid::sys::ScopedLock<qpid::sys::Mutex> l(lock);
+        buffer.pop_front();
+        if (head) --head;
+        if (tail) --tail;
+    }
+    if (pool) pool->release();
 }
 void Relay::setCredit(int c)
 {
@@ -89,10 +126,31 @@ void Relay::setCredit(int c)
     if (in) in->wakeup();
 }
 
-int Relay::getCredit() const
+/**
+ * Returns the credit the incoming link should have outstanding. With a shared
+ * pool this is the credit reserved from it, topped up towards the credit the
+ * outgoing link allows; reserved credit is kept until it is used, so this may
+ * be more than the outgoing link currently allows.
+ */
+int Relay::getCredit()
 {
+    size_t c;
+    {
+        qpid::sys::ScopedLock<qpid::sys::Mutex> l(lock);
+        c = credit > int(buffer.size()) ? std::min(credit - buffer.size(), max) : 0;
+        if (!pool) return c;
+        if (c <= reserved) return reserved;
+        c -= reserved;
+    }
+    // If the pool is exhausted we are woken when another relay frees some credit.
+    size_t granted = pool->reserve(c, shared_from_this());
     qpid::sys::ScopedLock<qpid::sys::Mutex> l(lock);
-    return std::min(credit - size(), max);
+    reserved += granted;
+    return reserved;
+}
+void Relay::wakeupIncoming()
+{
+    if (in) in->wakeup();
 }
 void Relay::attached(Outgoing* o)
 {
@@ -111,6 +169,13 @@ void Relay::detached(Outgoing*)
 }
 void Relay::detached(Incoming*)
 {
+    size_t unused;
+    {
+        qpid::sys::ScopedLock<qpid::sys::Mutex> l(lock);
+        unused = reserved;
+        reserved = 0;
+    }
+    if (pool && unused) pool->release(unused);
     in = 0;
     isDetached = true;
     QPID_LOG(info, "Incoming link detached from relay [" << this << "]");
@@ -27,7 +27,12 @@
 extern "C" {
 #include <proton/engine.h>
 }
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
 #include <deque>
+#include <set>
+#include <vector>
 
 namespace qpid {
 namespace broker {
@@ -60,25 +65,56 @@ class BufferedTransfer
     uint64_t disposition;
 };
 
+class Relay;
+
+/**
+ * Limit on the transfers buffered by all the relays routed to a domain. Credit
+ * is reserved from the pool when a relay grants it on its incoming link, and
+ * returned when the transfer is popped from the relay, so the credit granted
+ * plus the transfers buffered by all the relays never exceed the capacity. A
+ * relay whose incoming link is starved of credit by the pool waits to be woken
+ * when another relay releases credit.
+ */
+class RelayCredit
+{
+  public:
+    RelayCredit(size_t capacity);
+    size_t available() const;
+    /**
+     * Reserve up to count credits.
+     *@return the number reserved; if none could be, the relay is woken when
+     * credit is next released.
+     */
+    size_t reserve(size_t count, boost::shared_ptr<Relay>);
+    void release(size_t count=1);
+  private:
+    mutable qpid::sys::Mutex lock;
+    const size_t capacity;
+    size_t used;
+    std::set<boost::weak_ptr<Relay> > waiting; // Relays starved of credit by the pool
+};
+
 /**
  *
  */
-class Relay
+class Relay : public boost::enable_shared_from_this<Relay>
 {
   public:
-    Relay(size_t max);
+    Relay(size_t max, boost::shared_ptr<RelayCredit> pool=boost::shared_ptr<RelayCredit>());
+    ~Relay();
     void check();
     size_t size() const;
     BufferedTransfer& front();
     void pop();
     bool send(pn_link_t*);
     void received(pn_link_t* link, pn_delivery_t* delivery);
-    int getCredit() const;
+    int getCredit();
     void setCredit(int);
     void attached(Outgoing*);
     void attached(Incoming*);
     void detached(Outgoing*);
     void detached(Incoming*);
+    void wakeupIncoming();
   private:
     std::deque<BufferedTransfer> buffer;//TODO: optimise by replacing with simple circular array
     int credit;//issued by outgoing peer, decremented everytime we send a message on outgoing link
@@ -88,6 +124,8 @@ class Relay
     bool isDetached;
     Outgoing* out;
     Incoming* in;
+    boost::shared_ptr<RelayCredit> pool;
+    size_t reserved;//credit reserved from the pool and granted, but not yet used, on the incoming link
     mutable qpid::sys::Mutex lock;
 
     BufferedTransfer& push();
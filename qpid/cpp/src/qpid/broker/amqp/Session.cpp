@@ -331,7 +331,7 @@ Session::ResolvedNode Session::resolve(const std::string name, pn_terminus_t* te
                     //does this domain exist?
                     boost::shared_ptr<Domain> d = connection.getInterconnects().findDomain(domain);
                     if (d) {
-                        node.relay = boost::shared_ptr<Relay>(new Relay(1000));
+                        node.relay = d->createRelay();
                         if (incoming) {
                             d->connect(false, id, name, local, connection, node.relay);
                         } else {
@@ -808,6 +808,11 @@ bool Session::endedByManagement() const
     return detachRequested;
 }
 
+size_t Session::getLinkCount() const
+{
+    return incoming.size() + outgoing.size();
+}
+
 void Session::detachedByManagement()
 {
     detachRequested = true;
@@ -70,6 +70,7 @@ class Session : public ManagedSession, public boost::enable_shared_from_this<Ses
     void writable(pn_link_t*, pn_delivery_t*);
     bool dispatch();
     bool endedByManagement() const;
+    size_t getLinkCount() const;
     void close();
 
     /**
@@ -280,14 +280,21 @@ boost::intrusive_ptr<const qpid::broker::amqp_0_10::MessageTransfer> Translation
 void Translation::write(OutgoingFromQueue& out)
 {
     const Message* message = dynamic_cast<const Message*>(original.getPersistentContext().get());
-    //persistent context will contain any newly added annotations
+    //persistent context will contain any annotations merged so far
     if (!message) message = dynamic_cast<const Message*>(&original.getEncoding());
     if (message) {
         //write annotations
         qpid::amqp::CharSequence deliveryAnnotations = message->getDeliveryAnnotations();
         qpid::amqp::CharSequence messageAnnotations = message->getMessageAnnotations();
         if (deliveryAnnotations.size) out.write(deliveryAnnotations.data, deliveryAnnotations.size);
-        if (messageAnnotations.size) out.write(messageAnnotations.data, messageAnnotations.size);
+        if (original.hasPendingAnnotations()) {
+            //annotations added since the last merge are encoded as the message is sent
+            std::vector<char> annotations;
+            message->encodeMessageAnnotations(original.getAnnotations(), annotations);
+            out.write(&annotations[0], annotations.size());
+        } else if (messageAnnotations.size) {
+            out.write(messageAnnotations.data, messageAnnotations.size);
+        }
         //write bare message
         qpid::amqp::CharSequence bareMessage = message->getBareMessage();
         if (bareMessage.size) out.write(bareMessage.data, bareMessage.size);
@@ -287,6 +287,14 @@ uint16_t Connection::getPort ( )
     return links.getPort(mgmtId);
 }
 
+framing::FieldTable Connection::getLinkClientProperties()
+{
+    if (!link)
+        return framing::FieldTable();
+
+    return links.getClientProperties(mgmtId);
+}
+
 string Connection::getAuthCredentials()
 {
     if (!link)
@@ -147,6 +147,7 @@ class Connection : public sys::ConnectionInputHandler, public qpid::broker::Conn
     std::string getPassword();
     std::string getHost();
     uint16_t    getPort();
+    framing::FieldTable getLinkClientProperties();
 
     void notifyConnectionForced(const std::string& text);
     void setUserId(const std::string& uid);
@@ -20,6 +20,7 @@
  */
 #include "qpid/client/amqp0_10/AddressResolution.h"
 #include "qpid/amqp_0_10/Codecs.h"
+#include "qpid/Compression.h"
 #include "qpid/client/amqp0_10/MessageSource.h"
 #include "qpid/client/amqp0_10/MessageSink.h"
 #include "qpid/client/amqp0_10/OutgoingMessage.h"
@@ -97,6 +98,7 @@ const std::string X_DECLARE("x-declare");
 const std::string X_SUBSCRIBE("x-subscribe");
 const std::string X_BINDINGS("x-bindings");
 const std::string SELECTOR("selector");
+const std::string COMPRESSION("compression");
 const std::string APACHE_SELECTOR("x-apache-selector");
 const std::string QPID_FILTER("qpid.filter");
 const std::string EXCHANGE("exchange");
@@ -408,6 +410,15 @@ bool AddressResolution::is_unreliable(const Address& address)
               list_of<std::string>(UNRELIABLE)(AT_MOST_ONCE));
 }
 
+std::string AddressResolution::get_compression(const Address& address)
+{
+    std::string algorithm = (Opt(address)/LINK/COMPRESSION).str();
+    if (!algorithm.empty() && !qpid::Compression::isSupported(algorithm)) {
+        throw ResolutionError("Unsupported compression: " + algorithm);
+    }
+    return algorithm;
+}
+
 bool AddressResolution::is_reliable(const Address& address)
 {
     return in((Opt(address)/LINK/RELIABILITY).str(),
@@ -1036,6 +1047,7 @@ Verifier::Verifier()
     link[X_DECLARE] = true;
     link[X_BINDINGS] = true;
     link[SELECTOR] = true;
+    link[COMPRESSION] = true;
     defined[LINK] = link;
 }
 void Verifier::verify(const Address& address) const
@@ -57,6 +57,7 @@ class AddressResolution
     static qpid::framing::ReplyTo convert(const qpid::messaging::Address&);
     static bool is_unreliable(const qpid::messaging::Address& address);
     static bool is_reliable(const qpid::messaging::Address& address);
+    static std::string get_compression(const qpid::messaging::Address& address);
   private:
 };
 }}} // namespace qpid::client::amqp0_10
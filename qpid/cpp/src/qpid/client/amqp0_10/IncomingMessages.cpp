@@ -21,6 +21,7 @@
 #include "qpid/client/amqp0_10/IncomingMessages.h"
 #include "qpid/client/amqp0_10/AddressResolution.h"
 #include "qpid/amqp_0_10/Codecs.h"
+#include "qpid/Compression.h"
 #include "qpid/client/SessionImpl.h"
 #include "qpid/client/SessionBase_0_10Access.h"
 #include "qpid/log/Statement.h"
@@ -448,6 +449,29 @@ void populateHeaders(qpid::messaging::Message& message,
     }
 }
 
+/**
+ * Restore the body of a message compressed by the sender. If that is
+ * not possible the compressed body is delivered with the compression
+ * property left in place, so the application can tell.
+ */
+void decompress(qpid::messaging::Message& message)
+{
+    Variant::Map::iterator i = message.getProperties().find(qpid::Compression::PROPERTY);
+    if (i == message.getProperties().end()) return;
+    std::string algorithm = i->second.asString();
+    try {
+        std::string content;
+        if (qpid::Compression::decompress(algorithm, message.getContentPtr(), message.getContentSize(), content)) {
+            MessageImplAccess::get(message).getBytes().swap(content);
+            message.getProperties().erase(i);
+        } else {
+            QPID_LOG(warning, "Cannot decompress message body, unsupported compression: " << algorithm);
+        }
+    } catch (const qpid::Exception& e) {
+        QPID_LOG(error, "Cannot decompress message body: " << e.what());
+    }
+}
+
 void populateHeaders(qpid::messaging::Message& message, const AMQHeaderBody* headers)
 {
     populateHeaders(message, headers->get<DeliveryProperties>(), headers->get<MessageProperties>());
@@ -462,6 +486,7 @@ void populate(qpid::messaging::Message& message, FrameSet& command)
     message.setContent(command.getContent());
 
     populateHeaders(message, command.getHeaders());
+    decompress(message);
 }
 
 
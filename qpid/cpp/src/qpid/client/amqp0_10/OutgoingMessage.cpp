@@ -21,6 +21,7 @@
 #include "qpid/client/amqp0_10/OutgoingMessage.h"
 #include "qpid/client/amqp0_10/AddressResolution.h"
 #include "qpid/amqp_0_10/Codecs.h"
+#include "qpid/Compression.h"
 #include "qpid/types/encodings.h"
 #include "qpid/types/Variant.h"
 #include "qpid/messaging/Address.h"
@@ -116,6 +117,21 @@ void OutgoingMessage::convert(const qpid::messaging::Message& from)
     base = qpid::sys::now();
 }
 
+void OutgoingMessage::compress(const std::string& algorithm)
+{
+    //only raw bodies are compressed; maps and lists are left encoded so
+    //the broker can still translate them for 1.0 receivers
+    const std::string& contentType = message.getMessageProperties().getContentType();
+    if (contentType == qpid::amqp_0_10::MapCodec::contentType
+        || contentType == qpid::amqp_0_10::ListCodec::contentType) return;
+    std::string compressed;
+    const std::string& data = message.getData();
+    if (qpid::Compression::compress(algorithm, data.data(), data.size(), compressed)) {
+        message.getData().swap(compressed);
+        message.getMessageProperties().getApplicationHeaders().setString(qpid::Compression::PROPERTY, algorithm);
+    }
+}
+
 void OutgoingMessage::setSubject(const std::string& s)
 {
     subject = s;
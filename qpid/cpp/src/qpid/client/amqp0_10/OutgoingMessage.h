@@ -45,6 +45,7 @@ class OutgoingMessage
   public:
     OutgoingMessage();
     void convert(const qpid::messaging::Message&);
+    void compress(const std::string& algorithm);
     void setSubject(const std::string& subject);
     std::string getSubject() const;
     void send(qpid::client::AsyncSession& session, const std::string& destination, const std::string& routingKey);
@@ -32,7 +32,8 @@ namespace amqp0_10 {
 SenderImpl::SenderImpl(SessionImpl& _parent, const std::string& _name, 
                        const qpid::messaging::Address& _address, bool _autoReconnect) : 
     parent(&_parent), autoReconnect(_autoReconnect), name(_name), address(_address), state(UNRESOLVED),
-    capacity(50), window(0), flushed(false), unreliable(AddressResolution::is_unreliable(address)) {}
+    capacity(50), window(0), flushed(false), unreliable(AddressResolution::is_unreliable(address)),
+    compression(AddressResolution::get_compression(address)) {}
 
 qpid::messaging::Address SenderImpl::getAddress() const
 {
@@ -140,6 +141,7 @@ void SenderImpl::sendImpl(const qpid::messaging::Message& m)
     std::auto_ptr<OutgoingMessage> msg(new OutgoingMessage());
     msg->setSubject(m.getSubject().empty() ? address.getSubject() : m.getSubject());
     msg->convert(m);
+    if (!compression.empty()) msg->compress(compression);
     outgoing.push_back(msg.release());
     sink->send(session, name, outgoing.back());
 }
@@ -150,6 +152,7 @@ void SenderImpl::sendUnreliable(const qpid::messaging::Message& m)
     OutgoingMessage msg;
     msg.setSubject(m.getSubject().empty() ? address.getSubject() : m.getSubject());
     msg.convert(m);
+    if (!compression.empty()) msg.compress(compression);
     sink->send(session, name, msg);
 }
 
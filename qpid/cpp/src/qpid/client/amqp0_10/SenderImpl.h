@@ -77,6 +77,7 @@ class SenderImpl : public qpid::messaging::SenderImpl
     uint32_t window;
     bool flushed;
     const bool unreliable;
+    const std::string compression;
 
     uint32_t checkPendingSends(bool flush);
     // Dummy ScopedLock parameter means call with lock held
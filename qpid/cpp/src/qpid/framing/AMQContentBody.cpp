@@ -19,28 +19,63 @@
  *
  */
 #include "qpid/framing/AMQContentBody.h"
+#include "qpid/sys/Mutex.h"
+#include <algorithm>
 #include <iostream>
 
+namespace {
+// Guards the copy made by getData() const of content shared with a read buffer
+qpid::sys::Mutex sharedDataLock;
+}
+
 qpid::framing::AMQContentBody::AMQContentBody(){
 }
 
 qpid::framing::AMQContentBody::AMQContentBody(const std::string& _data) : data(_data){
 }
 
+qpid::framing::AMQContentBody::AMQContentBody(const ConstBufferRef& _ref) : ref(_ref){
+}
+
+void qpid::framing::AMQContentBody::unshare(){
+    data.assign(ref.begin(), ref.end());
+    ref = ConstBufferRef();
+}
+
+const std::string& qpid::framing::AMQContentBody::getSharedData() const{
+    // Shared content is never empty, so an empty string has not been copied yet
+    qpid::sys::Mutex::ScopedLock l(sharedDataLock);
+    if (data.empty()) data.assign(ref.begin(), ref.end());
+    return data;
+}
+
+qpid::framing::AMQContentBody qpid::framing::AMQContentBody::getFragment(uint32_t offset, uint32_t size) const{
+    if (ref.begin())
+        return AMQContentBody(ref.sub_buffer(ref.begin() + offset, ref.begin() + offset + size));
+    return AMQContentBody(data.substr(offset, size));
+}
+
 uint32_t qpid::framing::AMQContentBody::encodedSize() const{
-    return data.size();
+    return getDataSize();
 }
 void qpid::framing::AMQContentBody::encode(Buffer& buffer) const{
-    buffer.putRawData(data);
+    buffer.putRawData(reinterpret_cast<const uint8_t*>(getDataPointer()), getDataSize());
 }
 void qpid::framing::AMQContentBody::decode(Buffer& buffer, uint32_t _size){
-    buffer.getRawData(data, _size);
+    // Small content is copied so that a few retained bytes cannot pin a whole read buffer
+    if (_size >= MIN_SHARED_SIZE && uint64_t(_size) * MAX_SHARED_RATIO >= buffer.getBackingSize() &&
+        buffer.getRawDataRef(ref, _size)) {
+        data.clear();
+    } else {
+        ref = ConstBufferRef();
+        buffer.getRawData(data, _size);
+    }
 }
 
 void qpid::framing::AMQContentBody::print(std::ostream& out) const
 {
     out << "content (" << encodedSize() << " bytes)";
     const size_t max = 32;
-    out << " " << data.substr(0, max);
-    if (data.size() > max) out << "...";
+    out << " " << std::string(getDataPointer(), std::min(size_t(getDataSize()), max));
+    if (getDataSize() > max) out << "...";
 }
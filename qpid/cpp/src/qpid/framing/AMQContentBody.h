@@ -29,17 +29,44 @@
 namespace qpid {
 namespace framing {
 
+/**
+ * Content frame body. Large content decoded from a reference counted
+ * read buffer is held as a reference into that buffer rather than being
+ * copied. getDataPointer() and getDataSize() read the content in place.
+ * getData() const copies shared content into a string once, under a
+ * lock, so a shared body can still be read from several threads;
+ * getData() on a non-const body makes the content private.
+ */
 class QPID_COMMON_CLASS_EXTERN AMQContentBody :  public AMQBody
 {
-    std::string data;
+    mutable std::string data;
+    ConstBufferRef ref;
+
+    void unshare();
+    QPID_COMMON_EXTERN const std::string& getSharedData() const;
 
 public:
+    /** Content smaller than this is always copied out of the read buffer */
+    static const uint32_t MIN_SHARED_SIZE = 4096;
+    /** Content is also copied if the buffer it would keep alive is more
+     * than this many times its size, bounding the memory held by
+     * retained messages.
+     */
+    static const uint32_t MAX_SHARED_RATIO = 4;
+
     QPID_COMMON_EXTERN AMQContentBody();
     QPID_COMMON_EXTERN AMQContentBody(const std::string& data);
+    QPID_COMMON_EXTERN AMQContentBody(const ConstBufferRef& ref);
     inline virtual ~AMQContentBody(){}
     inline uint8_t type() const { return CONTENT_BODY; };
-    inline const std::string& getData() const { return data; }
-    inline std::string& getData() { return data; }
+    inline const std::string& getData() const { return ref.begin() ? getSharedData() : data; }
+    inline std::string& getData() { if (ref.begin()) unshare(); return data; }
+    inline const char* getDataPointer() const { return ref.begin() ? ref.begin() : data.data(); }
+    inline uint32_t getDataSize() const { return ref.begin() ? ref.end() - ref.begin() : data.size(); }
+    /** True if the content references a read buffer rather than owning a copy */
+    inline bool isShared() const { return ref.begin() != 0; }
+    /** Body holding size bytes of this body's content from offset, sharing it where possible */
+    QPID_COMMON_EXTERN AMQContentBody getFragment(uint32_t offset, uint32_t size) const;
     QPID_COMMON_EXTERN uint32_t encodedSize() const;
     QPID_COMMON_EXTERN void encode(Buffer& buffer) const;
     QPID_COMMON_EXTERN void decode(Buffer& buffer, uint32_t size);
@@ -324,6 +324,15 @@ void Buffer::getRawData(uint8_t* s, size_t len){
     position += len;
 }
 
+bool Buffer::getRawDataRef(ConstBufferRef& ref, uint32_t len){
+    checkAvailable(len);
+    if (!backing.begin() || data + position < backing.begin() || data + position + len > backing.end())
+        return false;
+    ref = backing.sub_buffer(data + position, data + position + len);
+    position += len;
+    return true;
+}
+
 void Buffer::dump(std::ostream& out) const {
     for (uint32_t i = position; i < size; i++)
     {
@@ -22,6 +22,7 @@
  *
  */
 
+#include "qpid/BufferRef.h"
 #include "qpid/Exception.h"
 #include "qpid/CommonImportExport.h"
 #include "qpid/sys/IntegerTypes.h"
@@ -43,6 +44,7 @@ class QPID_COMMON_CLASS_EXTERN Buffer
     uint32_t size;
     char* data;
     uint32_t position;
+    BufferRef backing;
 
   public:
     void checkAvailable(size_t count) { if (count > size - position) throw OutOfBounds(); }
@@ -58,6 +60,13 @@ class QPID_COMMON_CLASS_EXTERN Buffer
     QPID_COMMON_INLINE_EXTERN const char * getPointer() const { return data; }
     QPID_COMMON_INLINE_EXTERN char* getPointer() { return data; }
 
+    /** Set the reference counted buffer holding this buffer's data, so
+     * that decoders can keep references to it rather than copying.
+     */
+    QPID_COMMON_INLINE_EXTERN void setBacking(const BufferRef& b) { backing = b; }
+    /** Size of the reference counted buffer, 0 if there is none */
+    QPID_COMMON_INLINE_EXTERN uint32_t getBackingSize() const { return backing.end() - backing.begin(); }
+
     QPID_COMMON_EXTERN void putOctet(uint8_t i);
     QPID_COMMON_EXTERN void putShort(uint16_t i);
     QPID_COMMON_EXTERN void putLong(uint32_t i);
@@ -100,6 +109,10 @@ class QPID_COMMON_CLASS_EXTERN Buffer
 
     QPID_COMMON_EXTERN void putRawData(const uint8_t* data, size_t size);
     QPID_COMMON_EXTERN void getRawData(uint8_t* data, size_t size);
+    /** Reference the next size bytes without copying them. Returns false,
+     * consuming nothing, if this buffer has no reference counted backing.
+     */
+    QPID_COMMON_EXTERN bool getRawDataRef(ConstBufferRef& ref, uint32_t size);
 
     template <class T> void put(const T& data) { data.encode(*this); }
     template <class T> void get(T& data) { data.decode(*this); }
@@ -40,6 +40,11 @@
 // (In other words the code that required the mutable members in the class
 // definition!)
 //
+// That state only changes once between writes: newBytes goes false when
+// the values are decoded and cachedSize goes non-zero when it is computed.
+// So where the compiler provides acquire loads readers check these first
+// and only take the lock if there is work to do.
+//
 namespace qpid {
 
 using sys::Mutex;
@@ -47,47 +52,62 @@ using sys::ScopedLock;
 
 namespace framing {
 
+namespace {
+#if defined(__ATOMIC_ACQUIRE)
+// gcc >= 4.7 and clang
+const bool lockFreeReads = true;
+template <class T> T loadAcquire(const T& v) { return __atomic_load_n(&v, __ATOMIC_ACQUIRE); }
+template <class T> void storeRelease(T& v, T x) { __atomic_store_n(&v, x, __ATOMIC_RELEASE); }
+#elif defined(_MSC_VER)
+// Volatile accesses have acquire/release semantics on MSVC
+const bool lockFreeReads = true;
+template <class T> T loadAcquire(const T& v) { return *static_cast<const volatile T*>(&v); }
+template <class T> void storeRelease(T& v, T x) { *static_cast<volatile T*>(&v) = x; }
+#else
+// Readers always lock
+const bool lockFreeReads = false;
+template <class T> T loadAcquire(const T& v) { return v; }
+template <class T> void storeRelease(T& v, T x) { v = x; }
+#endif
+}
+
 FieldTable::FieldTable() :
     cachedSize(0),
     newBytes(false)
 {
 }
 
-FieldTable::FieldTable(const FieldTable& ft)
+FieldTable::FieldTable(const FieldTable& ft) :
+    cachedSize(0),
+    newBytes(false)
 {
-    ScopedLock<Mutex> l(ft.lock);   // lock _source_ FieldTable
-
-    cachedBytes = ft.cachedBytes;
-    cachedSize = ft.cachedSize;
-    newBytes = ft.newBytes;
-
     // Only copy the values if we have no raw data
     // - copying the map is expensive and we can
     //   reconstruct it if necessary from the raw data
-    if (cachedBytes) {
+    if (ft.cachedBytes) {
+        cachedBytes = ft.cachedBytes;
+        cachedSize = ft.cachedSize;
         newBytes = true;
         return;
     }
     // In practice Encoding the source field table and only copying
     // the encoded bytes is faster than copying the whole value map.
     // (Because we nearly always copy a field table internally before
-    // encoding it to send, but don't change it after the copy)
+    // encoding it to send, but don't change it after the copy). The
+    // encoding is not cached in the source, as that may be being read
+    // concurrently.
     if (!ft.values.empty()) {
-        // Side effect of getting encoded size will cache it in ft.cachedSize
-        ft.cachedBytes = boost::shared_array<uint8_t>(new uint8_t[ft.encodedSize()]);
+        uint32_t size = ft.encodedSize();
+        cachedBytes = boost::shared_array<uint8_t>(new uint8_t[size]);
+        cachedSize = size;
 
-        Buffer buffer((char*)&ft.cachedBytes[0], ft.cachedSize);
-
-        // Cut and paste ahead...
-        buffer.putLong(ft.encodedSize() - 4);
+        Buffer buffer((char*)&cachedBytes[0], size);
+        buffer.putLong(size - 4);
         buffer.putLong(ft.values.size());
         for (ValueMap::const_iterator i = ft.values.begin(); i!=ft.values.end(); ++i) {
             buffer.putShortString(i->first);
             i->second->encode(buffer);
         }
-
-        cachedBytes = ft.cachedBytes;
-        cachedSize = ft.cachedSize;
         newBytes = true;
     }
 }
@@ -103,6 +123,12 @@ FieldTable& FieldTable::operator=(const FieldTable& ft)
 }
 
 uint32_t FieldTable::encodedSize() const {
+    if (lockFreeReads) {
+        uint32_t size = loadAcquire(cachedSize);
+        if (size != 0) {
+            return size;
+        }
+    }
     ScopedLock<Mutex> l(lock);
 
     if (cachedSize != 0) {
@@ -113,7 +139,7 @@ uint32_t FieldTable::encodedSize() const {
         // shortstr_len_byte + key size + value size
         len += 1 + (i->first).size() + (i->second)->encodedSize();
     }
-    cachedSize = len;
+    storeRelease(cachedSize, len);
     return len;
 }
 
@@ -277,7 +303,6 @@ void FieldTable::encode(Buffer& buffer) const {
     // If we've still got the input field table
     // we can just copy it directly to the output
     if (cachedBytes) {
-        ScopedLock<Mutex> l(lock);
         buffer.putRawData(&cachedBytes[0], cachedSize);
     } else {
         buffer.putLong(encodedSize() - 4);
@@ -300,7 +325,6 @@ void FieldTable::decode(Buffer& buffer){
         if ((available < len) || (available < 4))
             throw IllegalArgumentException(QPID_MSG("Not enough data for field table."));
     }
-    ScopedLock<Mutex> l(lock);
     // Throw away previous stored values
     values.clear();
     // Copy data into our buffer
@@ -308,38 +332,45 @@ void FieldTable::decode(Buffer& buffer){
     cachedSize = len + 4;
     newBytes = true;
     buffer.setPosition(p);
-    buffer.getRawData(&cachedBytes[0], cachedSize);
+    buffer.getRawData(&cachedBytes[0], len + 4);
 }
 
 void FieldTable::realDecode() const
 {
+    // If we've got no raw data stored up then nothing to do
+    if (lockFreeReads && !loadAcquire(newBytes))
+        return;
+
     ScopedLock<Mutex> l(lock);
 
-    // If we've got no raw data stored up then nothing to do
     if (!newBytes)
         return;
 
-    Buffer buffer((char*)&cachedBytes[0], cachedSize);
-    uint32_t len = buffer.getLong();
-    if (len) {
-        uint32_t available = buffer.available();
-        uint32_t count = buffer.getLong();
-        uint32_t leftover = available - len;
-        while(buffer.available() > leftover && count--){
-            std::string name;
-            ValuePtr value(new FieldValue);
-
-            buffer.getShortString(name);
-            value->decode(buffer);
-            values[name] = ValuePtr(value);
+    try {
+        Buffer buffer((char*)&cachedBytes[0], cachedSize);
+        uint32_t len = buffer.getLong();
+        if (len) {
+            uint32_t available = buffer.available();
+            uint32_t count = buffer.getLong();
+            uint32_t leftover = available - len;
+            while(buffer.available() > leftover && count--){
+                std::string name;
+                ValuePtr value(new FieldValue);
+
+                buffer.getShortString(name);
+                value->decode(buffer);
+                values[name] = ValuePtr(value);
+            }
         }
+    } catch (...) {
+        values.clear();
+        throw;
     }
-    newBytes = false;
+    storeRelease(newBytes, false);
 }
 
 void FieldTable::flushRawCache()
 {
-    ScopedLock<Mutex> l(lock);
     // We can only flush the cache if there are no cached bytes to decode
     assert(newBytes==false);
     // Avoid recreating shared array unless we actually have one.
@@ -22,46 +22,63 @@
 #include "qpid/framing/Buffer.h"
 #include "qpid/log/Statement.h"
 #include "qpid/framing/reply_exceptions.h"
+#include "qpid/RefCountedBuffer.h"
 #include <algorithm>
 #include <string.h>
 
 namespace qpid {
 namespace framing {
 
-namespace {
-/** Append up to n bytes from start of buf to end of bytes. */
-void append(std::vector<char>& bytes, Buffer& buffer, size_t n) {
-    size_t oldSize = bytes.size();
-    if ((n = std::min(n, size_t(buffer.available()))) == 0)
+FrameDecoder::FrameDecoder() : fragmentSize(0) {}
+
+/** Ensure the scratch buffer can hold n bytes, keeping the current fragment. */
+void FrameDecoder::reserve(size_t n) {
+    if (scratch.unique() && size_t(scratch.end() - scratch.begin()) >= n)
         return;
-    bytes.resize(oldSize+n);
-    char* p = &bytes[oldSize];
-    buffer.getRawData(reinterpret_cast<uint8_t*>(p), n);
+    BufferRef b = RefCountedBuffer::create(std::max(n, size_t(AMQFrame::DECODE_SIZE_MIN)));
+    if (fragmentSize)
+        ::memcpy(b.begin(), scratch.begin(), fragmentSize);
+    scratch = b;
 }
+
+/** Append up to n bytes from start of buffer to the fragment. */
+void FrameDecoder::append(Buffer& buffer, size_t n) {
+    if ((n = std::min(n, size_t(buffer.available()))) == 0)
+        return;
+    assert(fragmentSize + n <= size_t(scratch.end() - scratch.begin()));
+    buffer.getRawData(reinterpret_cast<uint8_t*>(scratch.begin() + fragmentSize), n);
+    fragmentSize += n;
 }
 
 bool FrameDecoder::decode(Buffer& buffer) {
     if (buffer.available() == 0) return false;
-    if (fragment.empty()) {
+    if (fragmentSize == 0) {
         if (frame.decode(buffer)) // Decode from buffer
             return true;
-        else                    // Store fragment
-            append(fragment, buffer, buffer.available());
+        else {                  // Store fragment
+            size_t size = buffer.available();
+            if (size >= AMQFrame::DECODE_SIZE_MIN) // Make room for the whole frame
+                size = std::max(size, size_t(AMQFrame::decodeSize(buffer.getPointer() + buffer.getPosition())));
+            reserve(size);
+            append(buffer, buffer.available());
         }
+    }
     else {                      // Already have a fragment
         // Get enough data to decode the frame size.
-        if (fragment.size() < AMQFrame::DECODE_SIZE_MIN) {
-            append(fragment, buffer, AMQFrame::DECODE_SIZE_MIN - fragment.size());
+        if (fragmentSize < AMQFrame::DECODE_SIZE_MIN) {
+            append(buffer, AMQFrame::DECODE_SIZE_MIN - fragmentSize);
         }
-        if (fragment.size() >= AMQFrame::DECODE_SIZE_MIN) {
-            uint16_t size = AMQFrame::decodeSize(&fragment[0]);
-            if (size <= fragment.size())
+        if (fragmentSize >= AMQFrame::DECODE_SIZE_MIN) {
+            uint16_t size = AMQFrame::decodeSize(scratch.begin());
+            if (size <= fragmentSize)
                 throw FramingErrorException(QPID_MSG("Frame size " << size << " is too small."));
-            append(fragment, buffer, size-fragment.size());
-            Buffer b(&fragment[0], fragment.size());
+            reserve(size);
+            append(buffer, size-fragmentSize);
+            Buffer b(scratch.begin(), fragmentSize);
+            b.setBacking(scratch);
             if (frame.decode(b)) {
                 assert(b.available() == 0);
-                fragment.clear();
+                fragmentSize = 0;
                 return true;
             }
         }
@@ -70,12 +87,14 @@ bool FrameDecoder::decode(Buffer& buffer) {
 }
 
 void FrameDecoder::setFragment(const char* data, size_t size) {
-    fragment.resize(size);
-    ::memcpy(&fragment[0], data, size);
+    fragmentSize = 0;
+    reserve(size);
+    ::memcpy(scratch.begin(), data, size);
+    fragmentSize = size;
 }
 
 std::pair<const char*, size_t> FrameDecoder::getFragment() const {
-    return std::pair<const char*, size_t>(&fragment[0], fragment.size());
+    return std::pair<const char*, size_t>(scratch.begin(), fragmentSize);
 }
 
 }} // namespace qpid::framing
@@ -23,6 +23,7 @@
  */
 
 #include "qpid/framing/AMQFrame.h"
+#include "qpid/BufferRef.h"
 #include "qpid/CommonImportExport.h"
 
 namespace qpid {
@@ -31,10 +32,15 @@ namespace framing {
 /**
  * Decode a frame from buffer.  If buffer does not contain a complete
  * frame, caches the fragment for the next call to decode.
+ *
+ * Fragments are reassembled in a scratch buffer sized for the whole
+ * frame, which is reused for subsequent fragments unless the last
+ * frame decoded from it still refers to its content.
  */
 class FrameDecoder
 {
   public:
+    QPID_COMMON_EXTERN FrameDecoder();
     QPID_COMMON_EXTERN bool decode(Buffer& buffer);
     const AMQFrame& getFrame() const { return frame; }
     AMQFrame& getFrame() { return frame; }
@@ -43,9 +49,13 @@ class FrameDecoder
     std::pair<const char*, size_t> getFragment() const;
 
   private:
-    std::vector<char> fragment;
+    BufferRef scratch;
+    size_t fragmentSize;
     AMQFrame frame;
 
+    void reserve(size_t);
+    void append(Buffer&, size_t);
+
 };
 }} // namespace qpid::framing
 
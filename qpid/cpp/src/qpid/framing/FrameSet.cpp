@@ -94,8 +94,10 @@ void FrameSet::getContent(std::string& out) const {
     out.clear();
     out.reserve(getContentSize());
     for(Frames::const_iterator i = parts.begin(); i != parts.end(); i++) {
-        if (i->getBody()->type() == CONTENT_BODY)
-            out += i->castBody<AMQContentBody>()->getData();
+        if (i->getBody()->type() == CONTENT_BODY) {
+            const AMQContentBody* content = i->castBody<AMQContentBody>();
+            out.append(content->getDataPointer(), content->getDataSize());
+        }
     }
 }
 
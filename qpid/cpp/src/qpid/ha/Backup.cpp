@@ -38,6 +38,9 @@
 #include "qpid/sys/SystemInfo.h"
 #include "qpid/types/Variant.h"
 #include "qpid/log/Statement.h"
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <algorithm>
 
 namespace qpid {
 namespace ha {
@@ -59,26 +62,36 @@ void Backup::setBrokerUrl(const Url& brokers) {
     Mutex::ScopedLock l(lock);
     if (stopped) return;
     if (haBroker.getStatus() == JOINING) statusCheck->setUrl(brokers);
-    if (!link) {                // Not yet initialized
+    if (links.empty()) {        // Not yet initialized
         QPID_LOG(info, logPrefix << "Connecting to cluster: " << brokers);
         string protocol = brokers[0].protocol.empty() ? "tcp" : brokers[0].protocol;
         types::Uuid uuid(true);
-        link = broker.getLinks().declare(
-            broker::QPID_NAME_PREFIX + string("ha.link.") + uuid.str(),
-            brokers[0].host, brokers[0].port, protocol,
-            false,                  // durable
-            settings.mechanism, settings.username, settings.password,
-            false).first;     // no amq.failover - don't want to use client URL.
-        replicator = BrokerReplicator::create(haBroker, link);
+        string name = broker::QPID_NAME_PREFIX + string("ha.link.") + uuid.str();
+        for (uint32_t i = 0; i < settings.getReplicationLinks(); ++i) {
+            boost::shared_ptr<broker::Link> link = broker.getLinks().declare(
+                i ? name + "." + boost::lexical_cast<string>(i) : name,
+                brokers[0].host, brokers[0].port, protocol,
+                false,                  // durable
+                settings.mechanism, settings.username, settings.password,
+                false).first;     // no amq.failover - don't want to use client URL.
+            if (i) {
+                // Tell the primary this is not the backup's main connection.
+                FieldTable properties;
+                properties.setInt(ConnectionObserver::REPLICATION_LINK_TAG, i);
+                link->setClientProperties(properties);
+            }
+            links.push_back(link);
+        }
+        replicator = BrokerReplicator::create(haBroker, links);
         broker.getExchanges().registerExchange(replicator);
     }
-    link->setUrl(brokers);
+    std::for_each(links.begin(), links.end(), boost::bind(&broker::Link::setUrl, _1, brokers));
 }
 
 void Backup::stop(Mutex::ScopedLock&) {
     if (stopped) return;
     stopped = true;
-    if (link) link->close();
+    std::for_each(links.begin(), links.end(), boost::bind(&broker::Link::close, _1));
     if (replicator.get()) {
         replicator->shutdown();
         replicator.reset();
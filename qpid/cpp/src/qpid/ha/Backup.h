@@ -28,6 +28,7 @@
 #include "qpid/Url.h"
 #include "qpid/sys/Mutex.h"
 #include <boost/shared_ptr.hpp>
+#include <vector>
 
 namespace qpid {
 
@@ -72,7 +73,7 @@ class Backup : public Role
     HaBroker& haBroker;
     broker::Broker& broker;
     Settings settings;
-    boost::shared_ptr<broker::Link> link;
+    std::vector<boost::shared_ptr<broker::Link> > links; // links[0] is the main link.
     boost::shared_ptr<BrokerReplicator> replicator;
     std::auto_ptr<StatusCheck> statusCheck;
 };
@@ -38,16 +38,17 @@ const std::string PROTOCOL="protocol";
 const std::string HOST_NAME="host-name";
 const std::string PORT="port";
 const std::string STATUS="status";
+const std::string ID_CHECKPOINT="id-checkpoint";
 }
 
 using types::Uuid;
 using types::Variant;
 using framing::FieldTable;
 
-BrokerInfo::BrokerInfo() : status(JOINING) {}
+BrokerInfo::BrokerInfo() : status(JOINING), idCheckpoint(false) {}
 
 BrokerInfo::BrokerInfo(const types::Uuid& id, BrokerStatus s, const Address& a)
-  : address(a), systemId(id), status(s)
+  : address(a), systemId(id), status(s), idCheckpoint(true)
 {}
 
 FieldTable BrokerInfo::asFieldTable() const {
@@ -64,6 +65,7 @@ Variant::Map BrokerInfo::asMap() const {
     m[HOST_NAME] = address.host;
     m[PORT] = address.port;
     m[STATUS] = status;
+    m[ID_CHECKPOINT] = idCheckpoint;
     return m;
 }
 
@@ -89,6 +91,9 @@ void BrokerInfo::assign(const Variant::Map& m) {
                       get(m, HOST_NAME).asString(),
                       get(m, PORT).asUint16());
     status = BrokerStatus(get(m, STATUS).asUint8());
+    // Optional, absent for brokers that predate it.
+    Variant::Map::const_iterator i = m.find(ID_CHECKPOINT);
+    idCheckpoint = (i != m.end() && i->second.asBool());
 }
 
 std::ostream& BrokerInfo::printId(std::ostream& o) const {
@@ -56,6 +56,11 @@ class BrokerInfo
     Address getAddress() const { return address; }
     void setAddress(const Address& a) { address = a; }
 
+    /** True if the broker accepts an IdCheckpoint in place of the full ID set
+     * when a backup subscribes. False for brokers that predate it.
+     */
+    bool getIdCheckpoint() const { return idCheckpoint; }
+
     framing::FieldTable asFieldTable() const;
     types::Variant::Map asMap() const;
 
@@ -77,6 +82,7 @@ class BrokerInfo
     Address address;
     types::Uuid systemId;
     BrokerStatus status;
+    bool idCheckpoint;
 };
 
 std::ostream& operator<<(std::ostream&, const BrokerInfo&);
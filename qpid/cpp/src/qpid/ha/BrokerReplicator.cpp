@@ -21,6 +21,7 @@
 #include "BrokerReplicator.h"
 #include "HaBroker.h"
 #include "QueueReplicator.h"
+#include "hash.h"
 #include "qpid/broker/Broker.h"
 #include "qpid/broker/amqp_0_10/Connection.h"
 #include "qpid/broker/Queue.h"
@@ -269,19 +270,20 @@ template <class EventType> std::string key() {
 }
 
 boost::shared_ptr<BrokerReplicator> BrokerReplicator::create(
-    HaBroker& hb, const boost::shared_ptr<broker::Link>& l)
+    HaBroker& hb, const Links& l)
 {
     boost::shared_ptr<BrokerReplicator> br(new BrokerReplicator(hb, l));
     br->initialize();
     return br;
 }
 
-BrokerReplicator::BrokerReplicator(HaBroker& hb, const boost::shared_ptr<Link>& l)
+BrokerReplicator::BrokerReplicator(HaBroker& hb, const Links& l)
     : Exchange(QPID_CONFIGURATION_REPLICATOR),
       logPrefix(hb.logPrefix), replicationTest(NONE),
       haBroker(hb), broker(hb.getBroker()),
       exchanges(broker.getExchanges()), queues(broker.getQueues()),
-      link(l),
+      link(l.at(0)),
+      links(l),
       initialized(false),
       alternates(hb.getBroker().getExchanges()),
       connect(0)
@@ -771,7 +773,8 @@ boost::shared_ptr<QueueReplicator> BrokerReplicator::startQueueReplicator(
     const boost::shared_ptr<Queue>& queue)
 {
     if (replicationTest.getLevel(*queue) == ALL) {
-        return QueueReplicator::create(haBroker, queue, link);
+        return QueueReplicator::create(
+            haBroker, queue, links[hashValue(queue->getName()) % links.size()]);
     }
     return boost::shared_ptr<QueueReplicator>();
 }
@@ -888,6 +891,11 @@ void BrokerReplicator::disconnectedQueueReplicator(
 void BrokerReplicator::disconnected() {
     QPID_LOG(info, logPrefix << "Disconnected from primary " << primary);
     connect = 0;
+    // Forget the primary we were connected to. Until the next primary's
+    // membership arrives queues re-connect without assuming what it accepts.
+    BrokerInfo lost;
+    if (haBroker.getMembership().getPrimary(lost))
+        haBroker.getMembership().remove(lost.getSystemId());
     QueueReplicators qrs(broker.getExchanges());
     for_each(qrs.begin(), qrs.end(),
              boost::bind(&BrokerReplicator::disconnectedQueueReplicator, this, _1));
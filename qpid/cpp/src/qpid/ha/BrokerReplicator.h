@@ -34,6 +34,7 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/enable_shared_from_this.hpp>
 #include <set>
+#include <vector>
 
 namespace qpid {
 
@@ -75,9 +76,13 @@ class BrokerReplicator : public broker::Exchange,
 {
   public:
     typedef boost::shared_ptr<QueueReplicator> QueueReplicatorPtr;
+    typedef std::vector<boost::shared_ptr<broker::Link> > Links;
 
-    static boost::shared_ptr<BrokerReplicator> create(
-        HaBroker&, const boost::shared_ptr<broker::Link>&);
+    /** links[0] carries configuration and is used for queue replication
+     * along with any further links. Each queue is assigned to one link by
+     * hashing its name so its messages are replicated in order.
+     */
+    static boost::shared_ptr<BrokerReplicator> create(HaBroker&, const Links&);
 
     ~BrokerReplicator();
 
@@ -100,7 +105,7 @@ class BrokerReplicator : public broker::Exchange,
     QueueReplicatorPtr findQueueReplicator(const std::string& qname);
 
   private:
-    BrokerReplicator(HaBroker&, const boost::shared_ptr<broker::Link>&);
+    BrokerReplicator(HaBroker&, const Links&);
     void initialize();          // Called in create()
 
     typedef std::pair<boost::shared_ptr<broker::Queue>, bool> CreateQueueResult;
@@ -164,6 +169,7 @@ class BrokerReplicator : public broker::Exchange,
     broker::ExchangeRegistry& exchanges;
     broker::QueueRegistry& queues;
     boost::shared_ptr<broker::Link> link;
+    Links links;
     bool initialized;
     AlternateExchangeSetter alternates;
     qpid::Address primary;
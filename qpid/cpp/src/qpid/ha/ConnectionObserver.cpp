@@ -55,6 +55,11 @@ bool ConnectionObserver::getAddress(const broker::Connection& connection, Addres
     return false;
 }
 
+bool ConnectionObserver::isReplicationLink(const broker::Connection& connection) {
+    return connection.getClientProperties().find(REPLICATION_LINK_TAG) !=
+        connection.getClientProperties().end();
+}
+
 void ConnectionObserver::setObserver(const ObserverPtr& o)
 {
     sys::Mutex::ScopedLock l(lock);
@@ -117,5 +122,6 @@ void ConnectionObserver::closed(broker::Connection& connection) {
 const std::string ConnectionObserver::ADMIN_TAG="qpid.ha-admin";
 const std::string ConnectionObserver::BACKUP_TAG="qpid.ha-backup";
 const std::string ConnectionObserver::ADDRESS_TAG="qpid.ha-address";
+const std::string ConnectionObserver::REPLICATION_LINK_TAG="qpid.ha-replication-link";
 
 }} // namespace qpid::ha
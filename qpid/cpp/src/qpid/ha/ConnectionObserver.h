@@ -54,9 +54,12 @@ class ConnectionObserver : public broker::ConnectionObserver
     static const std::string ADMIN_TAG;
     static const std::string BACKUP_TAG;
     static const std::string ADDRESS_TAG;
+    static const std::string REPLICATION_LINK_TAG;
 
     static bool getBrokerInfo(const broker::Connection& connection, BrokerInfo&);
     static bool getAddress(const broker::Connection& connection, Address&);
+    /** True if connection is an additional message replication link from a backup. */
+    static bool isReplicationLink(const broker::Connection& connection);
 
     ConnectionObserver(HaBroker& haBroker, const types::Uuid& self);
 
@@ -24,6 +24,7 @@
 #include "HaBroker.h"
 #include "IdSetter.h"
 #include "Primary.h"
+#include "QueueQuorum.h"
 #include "QueueReplicator.h"
 #include "ReplicatingSubscription.h"
 #include "Settings.h"
@@ -69,16 +70,19 @@ using boost::dynamic_pointer_cast;
 //
 class HaBroker::BrokerObserver : public broker::BrokerObserver {
   public:
-    BrokerObserver(const LogPrefix& lp) : logPrefix(lp) {}
+    BrokerObserver(const LogPrefix& lp, uint32_t q) : logPrefix(lp), quorum(q) {}
 
     void queueCreate(const boost::shared_ptr<broker::Queue>& q) {
         q->getObservers().add(boost::shared_ptr<QueueSnapshot>(new QueueSnapshot));
+        uint32_t n = QueueQuorum::getQuorum(*q, quorum);
+        if (n) q->getObservers().add(boost::shared_ptr<QueueQuorum>(new QueueQuorum(n)));
         q->getMessageInterceptors().add(
             boost::shared_ptr<IdSetter>(new IdSetter(logPrefix, q->getName())));
     }
 
   private:
     const LogPrefix& logPrefix;
+    uint32_t quorum;
 };
 
 // Called in Plugin::earlyInitialize
@@ -101,7 +105,7 @@ HaBroker::HaBroker(broker::Broker& b, const Settings& s)
         broker.getConnectionObservers().add(observer);
         broker.getExchanges().registerExchange(failoverExchange);
     }
-    broker.getBrokerObservers().add(boost::shared_ptr<BrokerObserver>(new BrokerObserver(logPrefix)));
+    broker.getBrokerObservers().add(boost::shared_ptr<BrokerObserver>(new BrokerObserver(logPrefix, settings.quorum)));
 }
 
 namespace {
@@ -124,6 +128,8 @@ void HaBroker::initialize() {
     mgmtObject = _qmf::HaBroker::shared_ptr(new _qmf::HaBroker(ma, this, "ha-broker"));
     mgmtObject->set_replicateDefault(settings.replicateDefault.str());
     mgmtObject->set_systemId(systemId);
+    mgmtObject->set_replicationLinks(settings.getReplicationLinks());
+    mgmtObject->set_quorum(settings.quorum);
     ma->addObject(mgmtObject);
     membership.setMgmtObject(mgmtObject);
 
@@ -237,4 +243,52 @@ boost::shared_ptr<QueueReplicator> HaBroker::findQueueReplicator(const std::stri
         broker.getExchanges().find(QueueReplicator::replicatorName(queueName)));
 }
 
+void HaBroker::replicated(uint64_t bytes) {
+    if (!mgmtObject) return;
+    _qmf::HaBroker::PerThreadStats* stats = mgmtObject->getStatistics();
+    stats->msgsReplicated += 1;
+    stats->bytesReplicated += bytes;
+    mgmtObject->statisticsUpdated();
+}
+
+// Called once per replicated message, keep it cheap: management is only
+// updated by publishReplicationLatency.
+void HaBroker::replicationLatency(sys::Duration d) {
+    if (!mgmtObject) return;
+    uint64_t ns(d);
+    Mutex::ScopedLock l(latencyLock);
+    if (ns < uint64_t(sys::TIME_MSEC)) ++latency.under1ms;
+    else if (ns < uint64_t(10*sys::TIME_MSEC)) ++latency.under10ms;
+    else if (ns < uint64_t(100*sys::TIME_MSEC)) ++latency.under100ms;
+    else ++latency.over100ms;
+    if (latency.count == 0 || ns < latency.min) latency.min = ns;
+    if (ns > latency.max) latency.max = ns;
+    latency.total += ns;
+    ++latency.count;
+}
+
+void HaBroker::publishReplicationLatency() {
+    if (!mgmtObject) return;
+    Latency p;
+    {
+        Mutex::ScopedLock l(latencyLock);
+        if (latency.count == 0) return;
+        std::swap(p, latency);
+    }
+    _qmf::HaBroker::PerThreadStats* stats = mgmtObject->getStatistics();
+    stats->replicatedUnder1ms += p.under1ms;
+    stats->replicatedUnder10ms += p.under10ms;
+    stats->replicatedUnder100ms += p.under100ms;
+    stats->replicatedOver100ms += p.over100ms;
+    stats->replicationLatencyCount += p.count;
+    stats->replicationLatencyTotal += p.total;
+    if (stats->replicationLatencyMin > p.min) stats->replicationLatencyMin = p.min;
+    if (stats->replicationLatencyMax < p.max) stats->replicationLatencyMax = p.max;
+    mgmtObject->statisticsUpdated();
+}
+
+void HaBroker::setBackupLag(const Variant::Map& lag) {
+    if (mgmtObject) mgmtObject->set_backupLag(lag);
+}
+
 }} // namespace qpid::ha
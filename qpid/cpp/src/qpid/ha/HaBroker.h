@@ -99,6 +99,20 @@ class HaBroker : public management::Manageable
 
     boost::shared_ptr<QueueReplicator> findQueueReplicator(const std::string& queueName);
 
+    /** Count a message received by a queue replicator, for catch-up statistics. */
+    void replicated(uint64_t bytes);
+
+    /** Record the time from enqueue to acknowledgement by a backup.
+     * Accumulated locally, see publishReplicationLatency()
+     */
+    void replicationLatency(sys::Duration);
+
+    /** Publish latency recorded since the last call to management. */
+    void publishReplicationLatency();
+
+    /** Set the unacknowledged message count for each backup, keyed by system ID. */
+    void setBackupLag(const types::Variant::Map&);
+
     /** Authenticated user ID for queue create/delete */
     std::string getUserId() const { return userId; }
 
@@ -108,6 +122,13 @@ class HaBroker : public management::Manageable
   private:
     class BrokerObserver;
 
+    struct Latency {
+        uint64_t count, total, min, max;
+        uint64_t under1ms, under10ms, under100ms, over100ms;
+        Latency() : count(0), total(0), min(0), max(0),
+                    under1ms(0), under10ms(0), under100ms(0), over100ms(0) {}
+    };
+
     void setPublicUrl(const Url&);
     void setBrokerUrl(const Url&);
     void updateClientUrl(sys::Mutex::ScopedLock&);
@@ -131,6 +152,10 @@ class HaBroker : public management::Manageable
     boost::shared_ptr<Role> role;
     Membership membership;
     boost::shared_ptr<FailoverExchange> failoverExchange;
+
+    // Latency recorded since last published, protected by latencyLock
+    sys::Mutex latencyLock;
+    Latency latency;
 };
 }} // namespace qpid::ha
 
@@ -58,6 +58,12 @@ struct Options : public qpid::Options {
              "Flow control message count limit for replication, 0 means no limit")
             ("ha-flow-bytes", optValue(settings.flowBytes, "N"),
              "Flow control byte limit for replication, 0 means no limit")
+            ("ha-replication-links", optValue(settings.replicationLinks, "N"),
+             "Number of connections a backup uses to replicate queue messages. "
+             "Each queue is replicated over a single connection so messages stay in order.")
+            ("ha-quorum", optValue(settings.quorum, "N"),
+             "Number of backups that must acknowledge a message before it is completed, "
+             "0 means all backups. Can be overridden per queue with the qpid.ha-quorum argument.")
             ;
     }
 };
@@ -0,0 +1,121 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+#include "IdCheckpoint.h"
+#include "qpid/framing/Buffer.h"
+#include <algorithm>
+#include <ostream>
+
+namespace qpid {
+namespace ha {
+
+namespace {
+// 64 bit FNV-1a over the bounds of each range, independent of platform word size.
+const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+uint64_t hashLong(uint64_t h, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        h ^= (value >> (i*8)) & 0xFF;
+        h *= FNV_PRIME;
+    }
+    return h;
+}
+
+uint64_t hashRange(uint64_t h, ReplicationId first, ReplicationId last) {
+    return hashLong(hashLong(h, first.getValue()), last.getValue());
+}
+}
+
+IdCheckpoint::IdCheckpoint(const ReplicationIdSet& ids) {
+    buckets.reserve(ids.rangesSize()/RANGES_PER_BUCKET + 1);
+    size_t n = 0;
+    for (ReplicationIdSet::RangeIterator i = ids.rangesBegin(); i != ids.rangesEnd(); ++i) {
+        if (n++ % RANGES_PER_BUCKET == 0) {
+            buckets.push_back(Bucket());
+            buckets.back().first = i->first();
+            buckets.back().digest = FNV_OFFSET;
+        }
+        buckets.back().last = i->last();
+        buckets.back().digest = hashRange(buckets.back().digest, i->first(), i->last());
+    }
+}
+
+void IdCheckpoint::compare(const ReplicationIdSet& ids,
+                           ReplicationIdSet& keep, ReplicationIdSet& drop) const
+{
+    // Buckets and ranges are both in order, walk them together.
+    ReplicationIdSet::RangeIterator r = ids.rangesBegin();
+    for (Buckets::const_iterator b = buckets.begin(); b != buckets.end(); ++b) {
+        while (r != ids.rangesEnd() && r->last() < b->first) ++r;
+        // A range can overlap several buckets, so don't advance r past it here.
+        ReplicationIdSet clipped;
+        uint64_t digest = FNV_OFFSET;
+        for (ReplicationIdSet::RangeIterator i = r;
+             i != ids.rangesEnd() && !(b->last < i->first()); ++i)
+        {
+            ReplicationId first = std::max(i->first(), b->first);
+            ReplicationId last = std::min(i->last(), b->last);
+            digest = hashRange(digest, first, last);
+            clipped.add(first, last);
+        }
+        if (digest == b->digest) {
+            keep.add(clipped);
+        } else {
+            ReplicationIdSet span(b->first, b->last);
+            span -= clipped;
+            drop.add(span);
+        }
+    }
+}
+
+void IdCheckpoint::encode(framing::Buffer& b) const {
+    b.putLong(buckets.size());
+    for (Buckets::const_iterator i = buckets.begin(); i != buckets.end(); ++i) {
+        b.putLong(i->first.getValue());
+        b.putLong(i->last.getValue());
+        b.putLongLong(i->digest);
+    }
+}
+
+void IdCheckpoint::decode(framing::Buffer& b) {
+    size_t n = b.getLong();
+    buckets.clear();
+    buckets.reserve(n);
+    for ( ; n > 0; --n) {
+        Bucket bucket;
+        bucket.first = b.getLong();
+        bucket.last = b.getLong();
+        bucket.digest = b.getLongLong();
+        buckets.push_back(bucket);
+    }
+}
+
+size_t IdCheckpoint::encodedSize() const {
+    return sizeof(uint32_t) + buckets.size()*(2*sizeof(uint32_t) + sizeof(uint64_t));
+}
+
+std::ostream& operator<<(std::ostream& o, const IdCheckpoint& c) {
+    o << "checkpoint(" << c.buckets.size() << " buckets";
+    if (!c.buckets.empty()) o << " [" << c.buckets.front().first << "," << c.buckets.back().last << "]";
+    return o << ")";
+}
+
+}} // namespace qpid::ha
@@ -0,0 +1,91 @@
+#ifndef QPID_HA_IDCHECKPOINT_H
+#define QPID_HA_IDCHECKPOINT_H
+
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "types.h"
+#include "qpid/sys/IntegerTypes.h"
+#include <iosfwd>
+#include <vector>
+
+namespace qpid {
+namespace framing {
+class Buffer;
+}
+
+namespace ha {
+
+/**
+ * Compact summary of the ReplicationIdSet held by a backup queue, sent to the
+ * primary in place of the full set when the backup subscribes, its set is
+ * fragmented and the primary's BrokerInfo says it accepts checkpoints.
+ *
+ * The backup's ranges are grouped into buckets of RANGES_PER_BUCKET ranges.
+ * Each bucket records the span of IDs it covers and a digest of the backup's
+ * ranges within that span. The primary computes the same digest over its own
+ * IDs in each span: where they match the backup already has exactly those
+ * messages, where they differ the backup is told to drop everything in the
+ * span that is not on the primary, and the primary re-sends its messages in
+ * the span. The backup ignores re-sent messages it already holds.
+ *
+ * Encoded size is proportional to the number of buckets, not to the number
+ * of messages or ranges on the backup.
+ */
+class IdCheckpoint
+{
+  public:
+    static const size_t RANGES_PER_BUCKET = 64;
+
+    IdCheckpoint() {}
+    explicit IdCheckpoint(const ReplicationIdSet& backupIds);
+
+    /** Compare with the IDs on the primary.
+     *@param keep set to IDs on the primary that the backup already has.
+     *@param drop set to IDs the backup may have that are not on the primary.
+     */
+    void compare(const ReplicationIdSet& primaryIds,
+                 ReplicationIdSet& keep, ReplicationIdSet& drop) const;
+
+    size_t bucketCount() const { return buckets.size(); }
+
+    void encode(framing::Buffer&) const;
+    void decode(framing::Buffer&);
+    size_t encodedSize() const;
+
+  private:
+    struct Bucket {
+        ReplicationId first, last; // Closed range of IDs covered.
+        uint64_t digest;
+        Bucket() : digest(0) {}
+    };
+    typedef std::vector<Bucket> Buckets;
+
+    Buckets buckets;
+
+  friend std::ostream& operator<<(std::ostream&, const IdCheckpoint&);
+};
+
+std::ostream& operator<<(std::ostream&, const IdCheckpoint&);
+
+}} // namespace qpid::ha
+
+#endif  /*!QPID_HA_IDCHECKPOINT_H*/
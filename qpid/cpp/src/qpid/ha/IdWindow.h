@@ -0,0 +1,146 @@
+#ifndef QPID_HA_IDWINDOW_H
+#define QPID_HA_IDWINDOW_H
+
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "types.h"
+#include "hash.h"
+#include "qpid/sys/unordered_map.h"
+#include <deque>
+#include <vector>
+
+namespace qpid {
+namespace ha {
+
+/**
+ * Map from ReplicationId to T, optimised for IDs that arrive in roughly
+ * increasing order and are removed roughly oldest first.
+ *
+ * Values are kept in a window indexed by ID offset so insert, find and remove
+ * are O(1). The window shrinks from the front as the oldest IDs are removed
+ * and restarts at the next inserted ID when it is empty. IDs before the window
+ * or more than MAX_GAP past its end (e.g. committed transactions) are kept in
+ * a separate map. The window may later grow or restart over IDs already in
+ * that map, so an unused window slot is also looked up there.
+ *
+ * THREAD UNSAFE: the owner must serialize access.
+ */
+template <class T> class IdWindow {
+  public:
+    // Largest run of unused IDs to hold in the window before using overflow.
+    static const int32_t MAX_GAP = 4096;
+
+    IdWindow() : start(0), count(0) {}
+
+    /** Add value for id.
+     *@return false, leaving the existing value in place, if id is present.
+     */
+    bool insert(ReplicationId id, const T& value) {
+        if (count == 0) {       // Start the window at the new ID.
+            window.clear();
+            start = id;
+        }
+        int32_t offset = id - start;
+        if (offset >= 0 && offset < int32_t(window.size()) + MAX_GAP) {
+            if (size_t(offset) >= window.size()) window.resize(offset+1);
+            Slot& s = window[offset];
+            if (s.used || inOverflow(id)) return false;
+            s.value = value;
+            s.used = true;
+            ++count;
+            return true;
+        }
+        return overflow.insert(typename Overflow::value_type(id, value)).second;
+    }
+
+    /**@return the value for id, or 0 if id is not present. */
+    T* find(ReplicationId id) {
+        int32_t offset = id - start;
+        if (offset >= 0 && size_t(offset) < window.size() && window[offset].used)
+            return &window[offset].value;
+        if (overflow.empty()) return 0;
+        typename Overflow::iterator i = overflow.find(id);
+        return i == overflow.end() ? 0 : &i->second;
+    }
+
+    /** Remove id, copying its value to value.
+     *@return false if id was not present.
+     */
+    bool remove(ReplicationId id, T& value) {
+        int32_t offset = id - start;
+        if (offset >= 0 && size_t(offset) < window.size() && window[offset].used) {
+            value = window[offset].value;
+            window[offset] = Slot();
+            --count;
+            while (!window.empty() && !window.front().used) {
+                window.pop_front();
+                ++start;
+            }
+            return true;
+        }
+        typename Overflow::iterator i = overflow.find(id);
+        if (i == overflow.end()) return false;
+        value = i->second;
+        overflow.erase(i);
+        return true;
+    }
+
+    /** Append all values to values and remove them. */
+    void removeAll(std::vector<T>& values) {
+        values.reserve(values.size() + size());
+        for (typename Window::iterator i = window.begin(); i != window.end(); ++i)
+            if (i->used) values.push_back(i->value);
+        for (typename Overflow::iterator i = overflow.begin(); i != overflow.end(); ++i)
+            values.push_back(i->second);
+        window.clear();
+        count = 0;
+        overflow.clear();
+    }
+
+    size_t size() const { return count + overflow.size(); }
+    bool empty() const { return size() == 0; }
+
+    /** Number of values held outside the window. */
+    size_t overflowSize() const { return overflow.size(); }
+
+  private:
+    struct Slot {
+        T value;
+        bool used;
+        Slot() : value(), used(false) {}
+    };
+    typedef std::deque<Slot> Window; // Indexed by ID - start
+    typedef qpid::sys::unordered_map<ReplicationId, T, Hasher<ReplicationId> > Overflow;
+
+    bool inOverflow(ReplicationId id) const {
+        return !overflow.empty() && overflow.find(id) != overflow.end();
+    }
+
+    Window window;
+    ReplicationId start;
+    size_t count;               // Used slots in window.
+    Overflow overflow;
+};
+
+}} // namespace qpid::ha
+
+#endif  /*!QPID_HA_IDWINDOW_H*/
@@ -212,6 +212,17 @@ BrokerStatus Membership::getStatus(sys::Mutex::ScopedLock&) const  {
     return i->second.getStatus();
 }
 
+bool Membership::getPrimary(BrokerInfo& result) const {
+    Mutex::ScopedLock l(lock);
+    for (BrokerInfo::Map::const_iterator i = brokers.begin(); i != brokers.end(); ++i) {
+        if (isPrimary(i->second.getStatus()) && i->second.getSystemId() != self) {
+            result = i->second;
+            return true;
+        }
+    }
+    return false;
+}
+
 BrokerInfo Membership::getSelf() const  {
     Mutex::ScopedLock l(lock);
     BrokerInfo::Map::const_iterator i = brokers.find(self);
@@ -78,6 +78,9 @@ class Membership
 
     bool get(const types::Uuid& id, BrokerInfo& result) const;
 
+    /** Get the primary, if it is known and is not self. */
+    bool getPrimary(BrokerInfo& result) const;
+
     BrokerInfo getSelf() const;
     BrokerStatus getStatus() const;
     void setStatus(BrokerStatus s);
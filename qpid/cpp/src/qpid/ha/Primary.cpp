@@ -27,6 +27,7 @@
 #include "RemoteBackup.h"
 #include "ConnectionObserver.h"
 #include "QueueReplicator.h"
+#include "QueueQuorum.h"
 #include "qpid/assert.h"
 #include "qpid/broker/Broker.h"
 #include "qpid/broker/BrokerObserver.h"
@@ -91,6 +92,20 @@ class ExpectedBackupTimerTask : public sys::TimerTask {
     Primary& primary;
 };
 
+class BackupLagTimerTask : public sys::TimerTask {
+  public:
+    BackupLagTimerTask(Primary& p, sys::Timer& t)
+        : TimerTask(sys::TIME_SEC, "BackupLagTimerTask"), primary(p), timer(t) {}
+    void fire() {
+        primary.updateBackupLag();
+        setupNextFire();
+        timer.add(this);
+    }
+  private:
+    Primary& primary;
+    sys::Timer& timer;
+};
+
 class PrimaryErrorListener : public broker::SessionHandler::ErrorListener {
   public:
     PrimaryErrorListener(const LogPrefix& lp) : logPrefix(lp) {}
@@ -156,7 +171,7 @@ Primary::Primary(HaBroker& hb, const BrokerInfo::Set& expect) :
         // the QueueGuards are created.
         QPID_LOG(notice, logPrefix << "Recovering backups: " << expect);
         for (BrokerInfo::Set::const_iterator i = expect.begin(); i != expect.end(); ++i) {
-            boost::shared_ptr<RemoteBackup> backup(new RemoteBackup(*i, 0, haBroker.logPrefix));
+            boost::shared_ptr<RemoteBackup> backup(new RemoteBackup(*i, 0, haBroker));
             backups[i->getSystemId()] = backup;
             if (!backup->isReady()) expectedBackups.insert(backup);
             setCatchupQueues(backup, true); // Create guards
@@ -175,10 +190,14 @@ Primary::Primary(HaBroker& hb, const BrokerInfo::Set& expect) :
     // Allow client connections
     connectionObserver.reset(new PrimaryConnectionObserver(*this));
     haBroker.getObserver()->setObserver(connectionObserver);
+
+    lagTimerTask = new BackupLagTimerTask(*this, hb.getBroker().getTimer());
+    hb.getBroker().getTimer().add(lagTimerTask);
 }
 
 Primary::~Primary() {
     if (timerTask) timerTask->cancel();
+    lagTimerTask->cancel();
     haBroker.getBroker().getBrokerObservers().remove(brokerObserver);
     haBroker.getBroker().getSessionHandlerObservers().remove(sessionHandlerObserver);
     haBroker.getObserver()->reset();
@@ -246,6 +265,17 @@ void Primary::timeoutExpectedBackups() {
     checkReady();
 }
 
+void Primary::updateBackupLag() {
+    types::Variant::Map lag;
+    {
+        sys::Mutex::ScopedLock l(lock);
+        for (BackupMap::iterator i = backups.begin(); i != backups.end(); ++i)
+            lag[i->first.str()] = i->second->getUnacked();
+    }
+    haBroker.setBackupLag(lag); // Outside lock
+    haBroker.publishReplicationLatency();
+}
+
 void Primary::readyReplica(const ReplicatingSubscription& rs) {
     shared_ptr<RemoteBackup> backup;
     {
@@ -268,6 +298,9 @@ void Primary::addReplica(ReplicatingSubscription& rs) {
 
 // NOTE: Called with queue registry lock held.
 void Primary::queueCreate(const QueuePtr& q) {
+    // Reject an invalid quorum argument before recording the queue, the
+    // HaBroker observer that uses it may be called after us.
+    QueueQuorum::getQuorum(*q, 0);
     // Set replication argument.
     ReplicateLevel level = replicationTest.useLevel(*q);
     q->addArgument(QPID_REPLICATE, printable(level).str());
@@ -327,7 +360,7 @@ void Primary::exchangeDestroy(const ExchangePtr& ex) {
 shared_ptr<RemoteBackup> Primary::backupConnect(
     const BrokerInfo& info, broker::Connection& connection, Mutex::ScopedLock&)
 {
-    shared_ptr<RemoteBackup> backup(new RemoteBackup(info, &connection, haBroker.logPrefix));
+    shared_ptr<RemoteBackup> backup(new RemoteBackup(info, &connection, haBroker));
     queueLimits.addBackup(backup);
     backups[info.getSystemId()] = backup;
     return backup;
@@ -349,6 +382,12 @@ void Primary::opened(broker::Connection& connection) {
     BrokerInfo info;
     shared_ptr<RemoteBackup> backup;
     if (ha::ConnectionObserver::getBrokerInfo(connection, info)) {
+        if (ha::ConnectionObserver::isReplicationLink(connection)) {
+            // Extra message links do not affect membership, the backup's
+            // main link connection represents it.
+            QPID_LOG(debug, logPrefix << "Replication link from backup: " << info);
+            return;
+        }
         Mutex::ScopedLock l(lock);
         BackupMap::iterator i = backups.find(info.getSystemId());
         if (info.getStatus() == JOINING) {
@@ -400,7 +439,9 @@ void Primary::opened(broker::Connection& connection) {
 void Primary::closed(broker::Connection& connection) {
     BrokerInfo info;
     shared_ptr<RemoteBackup> backup;
-    if (ha::ConnectionObserver::getBrokerInfo(connection, info)) {
+    if (ha::ConnectionObserver::getBrokerInfo(connection, info) &&
+        !ha::ConnectionObserver::isReplicationLink(connection))
+    {
         Mutex::ScopedLock l(lock);
         BackupMap::iterator i = backups.find(info.getSystemId());
         // NOTE: It is possible for a backup connection to be rejected while we
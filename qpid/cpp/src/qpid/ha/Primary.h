@@ -100,6 +100,9 @@ class Primary : public Role
     // Called in timer thread when the deadline for expected backups expires.
     void timeoutExpectedBackups();
 
+    // Called periodically in timer thread to report backup lag and latency.
+    void updateBackupLag();
+
   private:
     typedef sys::unordered_map<
       types::Uuid, RemoteBackupPtr, Hasher<types::Uuid> > BackupMap;
@@ -139,6 +142,7 @@ class Primary : public Role
     boost::shared_ptr<broker::BrokerObserver> brokerObserver;
     boost::shared_ptr<broker::SessionHandlerObserver> sessionHandlerObserver;
     boost::intrusive_ptr<sys::TimerTask> timerTask;
+    boost::intrusive_ptr<sys::TimerTask> lagTimerTask;
     ReplicaMap replicas;
     PrimaryQueueLimits queueLimits;
 };
@@ -20,6 +20,8 @@
  */
 #include "QueueGuard.h"
 #include "BrokerInfo.h"
+#include "HaBroker.h"
+#include "QueueQuorum.h"
 #include "qpid/broker/Queue.h"
 #include "qpid/broker/QueuedMessage.h"
 #include "qpid/broker/QueueObserver.h"
@@ -47,8 +49,10 @@ class QueueGuard::QueueObserver : public broker::QueueObserver
 
 
 
-QueueGuard::QueueGuard(broker::Queue& q, const BrokerInfo& info, const LogPrefix& lp)
-    : cancelled(false), logPrefix(lp), queue(q)
+QueueGuard::QueueGuard(broker::Queue& q, const BrokerInfo& info, HaBroker& hb,
+                       const Counter& unacked_)
+    : cancelled(false), logPrefix(hb.logPrefix), queue(q), haBroker(hb),
+      unacked(unacked_)
 {
     std::ostringstream os;
     os << "Guard of " << queue.getName() << " at ";
@@ -56,6 +60,8 @@ QueueGuard::QueueGuard(broker::Queue& q, const BrokerInfo& info, const LogPrefix
     logPrefix = os.str();
     observer.reset(new QueueObserver(*this));
     queue.getObservers().add(observer);
+    quorum = queue.getObservers().findType<QueueQuorum>();
+    if (quorum) quorum->add(this);
     // Set first after adding the observer so we know that the back of the
     // queue+1 is (or will be) a guarded position.
     QueuePosition front, back;
@@ -72,51 +78,76 @@ QueueGuard::~QueueGuard() { cancel(); }
 void QueueGuard::enqueued(const Message& m) {
     // Delay completion
     ReplicationId id = m.getReplicationId();
+    Delay d;
+    d.completion = m.getIngressCompletion();
+    d.start = sys::AbsTime::now();
     Mutex::ScopedLock l(lock);
     if (cancelled) return;  // Don't record enqueues after we are cancelled.
+    if (!delayed.insert(id, d)) return; // Already delayed.
     QPID_LOG(trace, logPrefix << "Delayed completion of " << logMessageId(queue, m));
-    delayed[id] = m.getIngressCompletion();
-    m.getIngressCompletion()->startCompleter();
+    d.completion->startCompleter();
+    if (unacked) ++*unacked;
 }
 
 // NOTE: Called with message lock held.
 void QueueGuard::dequeued(const Message& m) {
     ReplicationId id = m.getReplicationId();
     QPID_LOG(trace, logPrefix << "Dequeued "  << logMessageId(queue, m));
-    Mutex::ScopedLock l(lock);
-    complete(id, l);
+    Delay d;
+    {
+        Mutex::ScopedLock l(lock);
+        if (!remove(id, d, l)) return;
+    }
+    // Not replicated, don't record latency.
+    if (d.completion) d.completion->finishCompleter();
 }
 
 void QueueGuard::cancel() {
     queue.getObservers().remove(observer);
-    Mutex::ScopedLock l(lock);
-    if (cancelled) return;
-    QPID_LOG(debug, logPrefix << "Cancelled");
-    cancelled = true;
-    while (!delayed.empty()) complete(delayed.begin(), l);
+    if (quorum) quorum->remove(this);
+    std::vector<Delay> pending;
+    {
+        Mutex::ScopedLock l(lock);
+        if (cancelled) return;
+        QPID_LOG(debug, logPrefix << "Cancelled");
+        cancelled = true;
+        if (unacked) *unacked -= uint32_t(delayed.size());
+        delayed.removeAll(pending);
+    }
+    for (std::vector<Delay>::iterator i = pending.begin(); i != pending.end(); ++i)
+        if (i->completion) i->completion->finishCompleter();
 }
 
 bool QueueGuard::complete(ReplicationId id) {
+    Delay d;
+    {
+        Mutex::ScopedLock l(lock);
+        if (!remove(id, d, l)) return false;
+    }
+    QPID_LOG(trace, logPrefix << "Completed " << queue.getName() << " =" << id);
+    if (d.completion) d.completion->finishCompleter();
+    haBroker.replicationLatency(sys::Duration(d.start, sys::AbsTime::now()));
+    if (quorum) quorum->acknowledged(id); // Outside our lock.
+    return true;
+}
+
+// NOTE: Called with the QueueQuorum lock held.
+QueueGuard::CompletionPtr QueueGuard::release(ReplicationId id) {
     Mutex::ScopedLock l(lock);
-    return complete(id, l);
+    CompletionPtr c;
+    Delay* d = delayed.find(id);
+    if (d) c.swap(d->completion);
+    if (c) QPID_LOG(trace, logPrefix << "Quorum released " << queue.getName() << " =" << id);
+    return c;
 }
 
-bool QueueGuard::complete(ReplicationId id, Mutex::ScopedLock& l) {
+bool QueueGuard::remove(ReplicationId id, Delay& d, Mutex::ScopedLock&) {
     // The same message can be completed twice, by
     // ReplicatingSubscription::acknowledged and dequeued. Remove it
-    // from the map so we only call finishCompleter() once
-    Delayed::iterator i = delayed.find(id);
-    if (i != delayed.end()) {
-        complete(i, l);
-        return true;
-    }
-    return false;
-}
-
-void QueueGuard::complete(Delayed::iterator i, Mutex::ScopedLock&) {
-    QPID_LOG(trace, logPrefix << "Completed " << queue.getName() << " =" << i->first);
-    i->second->finishCompleter();
-    delayed.erase(i);
+    // so we only call finishCompleter() once.
+    if (!delayed.remove(id, d)) return false;
+    if (unacked) --*unacked;
+    return true;
 }
 
 
@@ -24,14 +24,14 @@
 
 #include "types.h"
 #include "hash.h"
+#include "IdWindow.h"
 #include "LogPrefix.h"
 #include "qpid/types/Uuid.h"
+#include "qpid/sys/AtomicValue.h"
 #include "qpid/sys/Mutex.h"
-#include "qpid/sys/unordered_map.h"
+#include "qpid/sys/Time.h"
 #include <boost/shared_ptr.hpp>
 #include <boost/intrusive_ptr.hpp>
-#include <deque>
-#include <set>
 
 namespace qpid {
 namespace broker {
@@ -43,6 +43,8 @@ class AsyncCompletion;
 
 namespace ha {
 class BrokerInfo;
+class HaBroker;
+class QueueQuorum;
 class ReplicatingSubscription;
 
 /**
@@ -53,6 +55,18 @@ class ReplicatingSubscription;
  * The guard can be created before the ReplicatingSubscription to protect
  * messages arriving before the creation of the subscription.
  *
+ * Replication IDs are assigned in increasing order, so delayed completions are
+ * kept in an IdWindow. Transactional messages get their ID before they are
+ * enqueued so they can arrive out of order; the IdWindow keeps those aside.
+ *
+ * Completions are finished outside the guard lock, and the time from enqueue
+ * to completion is reported to the HaBroker statistics.
+ *
+ * If the queue has a QueueQuorum the guard reports acknowledgements to it, and
+ * the quorum may release a delayed completion before this guard's backup has
+ * acknowledged. The entry stays pending until the backup acknowledges so the
+ * backup's lag is still counted.
+ *
  * THREAD SAFE: Concurrent calls:
  *  - enqueued() via QueueObserver in arbitrary connection threads.
  *  - cancel(), complete() from ReplicatingSubscription in subscription thread.
@@ -60,7 +74,12 @@ class ReplicatingSubscription;
  */
 class QueueGuard {
   public:
-    QueueGuard(broker::Queue& q, const BrokerInfo&, const LogPrefix&);
+    typedef boost::intrusive_ptr<broker::AsyncCompletion> CompletionPtr;
+    typedef boost::shared_ptr<sys::AtomicValue<uint32_t> > Counter;
+
+    /**@param unacked if set, counts messages pending acknowledgement by the backup. */
+    QueueGuard(broker::Queue& q, const BrokerInfo&, HaBroker&,
+               const Counter& unacked=Counter());
     ~QueueGuard();
 
     /** QueueObserver override. Delay completion of the message.
@@ -81,6 +100,12 @@ class QueueGuard {
     /** Complete all delayed messages. */
     void cancel();
 
+    /** Called by the QueueQuorum when a quorum of backups has acknowledged id.
+     * The ID remains pending till our backup acknowledges it.
+     *@return the delayed completion, caller must call finishCompleter.
+     */
+    CompletionPtr release(ReplicationId);
+
     /** Return the first known guarded position on the queue.  It is possible
      * that the guard has seen a few messages before this point.
      */
@@ -88,20 +113,25 @@ class QueueGuard {
 
   private:
     class QueueObserver;
-    typedef qpid::sys::unordered_map<ReplicationId,
-                                     boost::intrusive_ptr<broker::AsyncCompletion>,
-                                     Hasher<ReplicationId> > Delayed;
 
-    bool complete(ReplicationId, sys::Mutex::ScopedLock &);
-    void complete(Delayed::iterator, sys::Mutex::ScopedLock &);
+    // Present till our backup acknowledges the ID.
+    struct Delay {
+        CompletionPtr completion; // Null if released by the quorum.
+        sys::AbsTime start;
+    };
+
+    bool remove(ReplicationId, Delay&, sys::Mutex::ScopedLock&);
 
     sys::Mutex lock;
     QueuePosition first;
     bool cancelled;
     LogPrefix2 logPrefix;
     broker::Queue& queue;
-    Delayed delayed;
+    HaBroker& haBroker;
+    IdWindow<Delay> delayed;
+    Counter unacked;
     boost::shared_ptr<QueueObserver> observer;
+    boost::shared_ptr<QueueQuorum> quorum;
 };
 }} // namespace qpid::ha
 
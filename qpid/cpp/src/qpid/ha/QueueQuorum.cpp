@@ -0,0 +1,96 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+#include "QueueQuorum.h"
+#include "QueueGuard.h"
+#include "qpid/broker/AsyncCompletion.h"
+#include "qpid/broker/Message.h"
+#include "qpid/broker/Queue.h"
+#include "qpid/framing/reply_exceptions.h"
+#include "qpid/Msg.h"
+#include <algorithm>
+
+namespace qpid {
+namespace ha {
+
+using sys::Mutex;
+
+const std::string QueueQuorum::QPID_HA_QUORUM(std::string(QPID_HA_PREFIX)+"quorum");
+
+uint32_t QueueQuorum::getQuorum(const broker::Queue& q, uint32_t defaultQuorum) {
+    const types::Variant::Map& args = q.getSettings().original;
+    types::Variant::Map::const_iterator i = args.find(QPID_HA_QUORUM);
+    if (i == args.end()) return defaultQuorum;
+    try {
+        return i->second.asUint32();
+    } catch (const types::InvalidConversion&) {
+        throw framing::InvalidArgumentException(
+            QPID_MSG("Invalid value for " << QPID_HA_QUORUM << ": " << i->second));
+    }
+}
+
+void QueueQuorum::add(QueueGuard* g) {
+    Mutex::ScopedLock l(lock);
+    guards.push_back(g);
+}
+
+void QueueQuorum::remove(QueueGuard* g) {
+    Mutex::ScopedLock l(lock);
+    guards.erase(std::remove(guards.begin(), guards.end(), g), guards.end());
+}
+
+void QueueQuorum::acknowledged(ReplicationId id) {
+    std::vector<QueueGuard::CompletionPtr> released;
+    {
+        Mutex::ScopedLock l(lock);
+        // Each guard completes its own delay when every backup is required.
+        if (quorum == 0 || quorum >= guards.size()) return;
+        // Only count IDs recorded by enqueued(), a late acknowledgement
+        // after dequeued() must not recreate the entry.
+        Acks::iterator a = acks.find(id);
+        if (a == acks.end()) return;
+        uint32_t n = ++a->second;
+        // Release under our lock so guards cannot be removed concurrently.
+        if (n == quorum) {
+            for (std::vector<QueueGuard*>::iterator i = guards.begin(); i != guards.end(); ++i) {
+                QueueGuard::CompletionPtr c = (*i)->release(id);
+                if (c) released.push_back(c);
+            }
+        }
+        if (n >= guards.size()) acks.erase(a);
+    }
+    for (std::vector<QueueGuard::CompletionPtr>::iterator i = released.begin();
+         i != released.end(); ++i)
+        (*i)->finishCompleter();
+}
+
+// NOTE: Called with message lock held.
+void QueueQuorum::enqueued(const broker::Message& m) {
+    Mutex::ScopedLock l(lock);
+    if (quorum && quorum < guards.size()) acks[m.getReplicationId()] = 0;
+}
+
+// NOTE: Called with message lock held.
+void QueueQuorum::dequeued(const broker::Message& m) {
+    Mutex::ScopedLock l(lock);
+    if (!acks.empty()) acks.erase(m.getReplicationId());
+}
+
+}} // namespace qpid::ha
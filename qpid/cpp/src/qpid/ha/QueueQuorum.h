@@ -0,0 +1,90 @@
+#ifndef QPID_HA_QUEUEQUORUM_H
+#define QPID_HA_QUEUEQUORUM_H
+
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "types.h"
+#include "hash.h"
+#include "qpid/broker/QueueObserver.h"
+#include "qpid/sys/Mutex.h"
+#include "qpid/sys/unordered_map.h"
+#include <vector>
+
+namespace qpid {
+namespace broker {
+class Queue;
+}
+
+namespace ha {
+class QueueGuard;
+
+/**
+ * A QueueObserver on a primary queue that completes messages once a quorum of
+ * backups has acknowledged them, instead of waiting for every backup.
+ *
+ * Each QueueGuard on the queue registers here and reports acknowledgements
+ * from its backup. When the count for a message reaches the quorum every guard
+ * releases its delayed completion. Guards for slower backups keep tracking the
+ * message until their backup acknowledges it, so those backups continue to
+ * catch up asynchronously.
+ *
+ * THREAD SAFE: Guards call acknowledged() in subscription threads,
+ * dequeued() is called under the queue's message lock.
+ */
+class QueueQuorum : public broker::QueueObserver
+{
+  public:
+    /** Queue argument to override the ha-quorum setting for one queue. */
+    static const std::string QPID_HA_QUORUM;
+
+    /** Quorum for queue q: the queue argument if present, else defaultQuorum.
+     *@throw InvalidArgumentException if the queue argument is not a valid count.
+     */
+    static uint32_t getQuorum(const broker::Queue& q, uint32_t defaultQuorum);
+
+    /**@param quorum number of backup acknowledgements required, 0 means all. */
+    explicit QueueQuorum(uint32_t quorum) : quorum(quorum) {}
+
+    void add(QueueGuard*);
+    void remove(QueueGuard*);
+
+    /** Called by a guard, outside its lock, when its backup acknowledges id. */
+    void acknowledged(ReplicationId);
+
+    // QueueObserver overrides
+    void enqueued(const broker::Message&);
+    void dequeued(const broker::Message&);
+    void acquired(const broker::Message&) {}
+    void requeued(const broker::Message&) {}
+
+  private:
+    typedef qpid::sys::unordered_map<ReplicationId, uint32_t, Hasher<ReplicationId> > Acks;
+
+    sys::Mutex lock;
+    const uint32_t quorum;
+    std::vector<QueueGuard*> guards;
+    Acks acks;
+};
+
+}} // namespace qpid::ha
+
+#endif  /*!QPID_HA_QUEUEQUORUM_H*/
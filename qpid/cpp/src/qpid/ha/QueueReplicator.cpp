@@ -21,6 +21,7 @@
 
 #include "Event.h"
 #include "HaBroker.h"
+#include "IdCheckpoint.h"
 #include "IdSetter.h"
 #include "LogPrefix.h"
 #include "QueueReplicator.h"
@@ -44,6 +45,8 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/weak_ptr.hpp>
 #include <boost/bind.hpp>
+#include <algorithm>
+#include <vector>
 
 
 namespace qpid {
@@ -262,9 +265,25 @@ void QueueReplicator::initializeBridge(Bridge& bridge, SessionHandler& sessionHa
     ReplicationIdSet snapshot;
     if (qs) {
         snapshot = qs->getSnapshot();
-        arguments.set(
-            ReplicatingSubscription::QPID_ID_SET,
-            FieldTable::ValuePtr(new Var32Value(encodeStr(snapshot), TYPE_CODE_VBIN32)));
+        // If the set is fragmented and the primary accepts it, send a
+        // checkpoint in place of the full set. An older primary ignores
+        // QPID_ID_CHECKPOINT and would treat us as empty, never dequeuing
+        // our stale messages, so it gets the full set.
+        BrokerInfo primaryInfo;
+        if (snapshot.rangesSize() > IdCheckpoint::RANGES_PER_BUCKET &&
+            haBroker.getMembership().getPrimary(primaryInfo) &&
+            primaryInfo.getIdCheckpoint())
+        {
+            arguments.set(
+                ReplicatingSubscription::QPID_ID_CHECKPOINT,
+                FieldTable::ValuePtr(
+                    new Var32Value(encodeStr(IdCheckpoint(snapshot)), TYPE_CODE_VBIN32)));
+        }
+        else {
+            arguments.set(
+                ReplicatingSubscription::QPID_ID_SET,
+                FieldTable::ValuePtr(new Var32Value(encodeStr(snapshot), TYPE_CODE_VBIN32)));
+        }
     }
     try {
         peer.getMessage().subscribe(
@@ -298,18 +317,30 @@ void QueueReplicator::dequeueEvent(const string& data, Mutex::ScopedLock&) {
     DequeueEvent e;
     decodeStr(data, e);
     QPID_LOG(trace, logPrefix << "Dequeue " << e.ids);
-    //TODO: should be able to optimise the following
-    for (ReplicationIdSet::iterator i = e.ids.begin(); i != e.ids.end(); ++i) {
-        QueuePosition position;
-        {
-            Mutex::ScopedLock l(lock);
-            PositionMap::iterator j = positions.find(*i);
-            if (j == positions.end()) continue;
-            position = j->second;
+    // Find positions of the IDs we hold. After a checkpoint the set may span
+    // far more IDs than are on the queue, so scan whichever is smaller.
+    std::vector<QueuePosition> found;
+    {
+        Mutex::ScopedLock l(lock);
+        if (size_t(e.ids.size()) > positions.size()) {
+            for (PositionMap::iterator j = positions.begin(); j != positions.end(); ++j)
+                if (e.ids.contains(j->first)) found.push_back(j->second);
+        }
+        else {
+            for (ReplicationIdSet::iterator i = e.ids.begin(); i != e.ids.end(); ++i) {
+                PositionMap::iterator j = positions.find(*i);
+                if (j != positions.end()) found.push_back(j->second);
+            }
         }
-        queue->dequeueMessageAt(position); // Outside lock, will call dequeued().
-        // positions will be cleaned up in dequeued()
     }
+    // Dequeue the batch under a single queue lock.
+    std::sort(found.begin(), found.end());
+    QueuePositionSet batch;
+    for (std::vector<QueuePosition>::iterator i = found.begin(); i != found.end(); ++i)
+        batch.add(*i);
+    // Outside lock, will call dequeued().
+    // positions will be cleaned up in dequeued()
+    if (!batch.empty()) queue->dequeueMessagesAt(batch);
 }
 
 // Called in connection thread of the queues bridge to primary.
@@ -340,6 +371,7 @@ void QueueReplicator::route(Deliverable& deliverable)
             QPID_LOG(trace, logPrefix << "Received: " << logMessageId(*queue, message));
         }
         deliver(message);       // Outside lock, will call enqueued()
+        haBroker.replicated(message.getMessageSize());
     }
     catch (const std::exception& e) {
         haBroker.shutdown(QPID_MSG(logPrefix << "Replication failed: " << e.what()));
@@ -347,8 +379,10 @@ void QueueReplicator::route(Deliverable& deliverable)
 
 }
 
+// The primary has already filtered, traced and assigned an ID to the message,
+// so bypass the queue's publish-side checks.
 void QueueReplicator::deliver(const broker::Message& m) {
-    queue->deliver(m);
+    queue->deliverReplica(m);
 }
 
 // Called via QueueObserver when message is enqueued. Could be as part of deliver()
@@ -0,0 +1,72 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+#include "QueueSnapshot.h"
+#include <algorithm>
+
+namespace qpid {
+namespace ha {
+
+using sys::Mutex;
+
+const size_t QueueSnapshot::RANGES_PER_CHUNK = 1024;
+
+ReplicationIdSet QueueSnapshot::getSnapshot() {
+    typedef Range<ReplicationId> IdRange;
+    ReplicationIdSet result;
+    Capture capture;
+    {
+        Mutex::ScopedLock l(lock);
+        if (set.rangesSize() <= RANGES_PER_CHUNK) return set;
+        capture.cursor = set.front();
+        captures.push_back(&capture);
+    }
+    try {
+        bool done = false;
+        while (!done) {
+            Mutex::ScopedLock l(lock);
+            ReplicationIdSet::RangeIterator i = std::lower_bound(
+                set.rangesBegin(), set.rangesEnd(), IdRange(capture.cursor));
+            if (i != set.rangesEnd() && i->end() == capture.cursor) ++i;
+            for (size_t n = 0; i != set.rangesEnd() && n < RANGES_PER_CHUNK; ++i, ++n) {
+                result += IdRange(std::max(i->begin(), capture.cursor), i->end());
+                capture.cursor = i->end();
+            }
+            if (i == set.rangesEnd()) {
+                captures.erase(std::find(captures.begin(), captures.end(), &capture));
+                done = true;
+            }
+        }
+    }
+    catch (...) {
+        Mutex::ScopedLock l(lock);
+        std::vector<Capture*>::iterator i = std::find(captures.begin(), captures.end(), &capture);
+        if (i != captures.end()) captures.erase(i);
+        throw;
+    }
+    // Merge changes made behind the cursor while copying, outside the lock.
+    for (size_t i = 0; i < capture.changes.size(); ++i) {
+        if (capture.changes[i].second) result += capture.changes[i].first;
+        else result -= capture.changes[i].first;
+    }
+    return result;
+}
+
+}} // namespace qpid::ha
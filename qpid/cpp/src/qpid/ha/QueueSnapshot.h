@@ -22,9 +22,12 @@
  *
  */
 
+#include "types.h"
 #include "qpid/broker/Message.h"
 #include "qpid/broker/QueueObserver.h"
 #include "qpid/sys/Mutex.h"
+#include <utility>
+#include <vector>
 
 namespace qpid {
 namespace ha {
@@ -39,28 +42,47 @@ namespace ha {
 class  QueueSnapshot : public broker::QueueObserver
 {
   public:
+    /** Maximum number of ID ranges getSnapshot() copies per lock. */
+    static const size_t RANGES_PER_CHUNK;
+
     void enqueued(const broker::Message& m) {
         sys::Mutex::ScopedLock l(lock);
         set += m.getReplicationId();
+        record(m.getReplicationId(), true, l);
     }
 
     void dequeued(const broker::Message& m) {
         sys::Mutex::ScopedLock l(lock);
         set -= m.getReplicationId();
+        record(m.getReplicationId(), false, l);
     }
 
     void acquired(const broker::Message&) {}
 
     void requeued(const broker::Message&) {}
 
-    ReplicationIdSet getSnapshot() {
-        sys::Mutex::ScopedLock l(lock);
-        return set;
-    }
+    /**
+     * Copy of the set. A large set is copied a chunk at a time so
+     * enqueue and dequeue on the queue are never held up for long;
+     * changes behind the copy are recorded and merged at the end.
+     */
+    ReplicationIdSet getSnapshot();
 
   private:
+    // A getSnapshot() in progress. IDs below cursor have been copied.
+    struct Capture {
+        ReplicationId cursor;
+        std::vector<std::pair<ReplicationId, bool> > changes; // ID, enqueued
+    };
+
+    void record(ReplicationId id, bool enqueued, sys::Mutex::ScopedLock&) {
+        for (std::vector<Capture*>::iterator i = captures.begin(); i != captures.end(); ++i)
+            if (id < (*i)->cursor) (*i)->changes.push_back(std::make_pair(id, enqueued));
+    }
+
     sys::Mutex lock;
     ReplicationIdSet set;
+    std::vector<Capture*> captures;
 };
 
 }} // namespace qpid::ha
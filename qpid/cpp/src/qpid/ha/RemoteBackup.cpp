@@ -19,6 +19,7 @@
  *
  */
 #include "RemoteBackup.h"
+#include "HaBroker.h"
 #include "QueueGuard.h"
 #include "qpid/broker/Broker.h"
 #include "qpid/broker/Connection.h"
@@ -34,9 +35,10 @@ using sys::Mutex;
 using boost::bind;
 
 RemoteBackup::RemoteBackup(
-    const BrokerInfo& info, broker::Connection* c, const LogPrefix& lp
-) : logPrefix(lp), brokerInfo(info), replicationTest(NONE),
-    started(false), connection(c), reportedReady(false)
+    const BrokerInfo& info, broker::Connection* c, HaBroker& hb
+) : haBroker(hb), logPrefix(hb.logPrefix), brokerInfo(info), replicationTest(NONE),
+    started(false), connection(c), reportedReady(false),
+    unacked(new sys::AtomicValue<uint32_t>(0))
 {
     std::ostringstream oss;
     oss << "Remote backup at " << info << ": ";
@@ -69,7 +71,7 @@ void RemoteBackup::catchupQueue(const QueuePtr& q, bool createGuard) {
         QPID_LOG(debug, logPrefix << "Catch-up queue"
                  << (createGuard ? " and guard" : "") << ": " << q->getName());
         catchupQueues.insert(q);
-        if (createGuard) guards[q].reset(new QueueGuard(*q, brokerInfo, logPrefix.prePrefix));
+        if (createGuard) guards[q].reset(new QueueGuard(*q, brokerInfo, haBroker, unacked));
     }
 }
 
@@ -90,7 +92,7 @@ void RemoteBackup::ready(const QueuePtr& q) {
 // Called via BrokerObserver::queueCreate and from catchupQueue
 void RemoteBackup::queueCreate(const QueuePtr& q) {
     if (replicationTest.getLevel(*q) == ALL)
-        guards[q].reset(new QueueGuard(*q, brokerInfo, logPrefix.prePrefix));
+        guards[q].reset(new QueueGuard(*q, brokerInfo, haBroker, unacked));
 }
 
 // Called via BrokerObserver
@@ -27,7 +27,9 @@
 #include "BrokerInfo.h"
 #include "types.h"
 #include "hash.h"
+#include "qpid/sys/AtomicValue.h"
 #include "qpid/sys/unordered_map.h"
+#include <boost/shared_ptr.hpp>
 #include <set>
 
 namespace qpid {
@@ -39,6 +41,7 @@ class Connection;
 }
 
 namespace ha {
+class HaBroker;
 class QueueGuard;
 
 /**
@@ -57,7 +60,7 @@ class RemoteBackup
     /** Note: isReady() can be true after construction
      *@param connected true if the backup is already connected.
      */
-    RemoteBackup(const BrokerInfo&, broker::Connection*, const LogPrefix&);
+    RemoteBackup(const BrokerInfo&, broker::Connection*, HaBroker&);
     ~RemoteBackup();
 
     /** Return guard associated with a queue. Used to create ReplicatingSubscription. */
@@ -96,6 +99,9 @@ class RemoteBackup
 
     void startCatchup() { started = true; }
 
+    /**@return number of messages on guarded queues not yet acknowledged by the backup. */
+    uint32_t getUnacked() const { return unacked->get(); }
+
   private:
     typedef qpid::sys::unordered_map<
       QueuePtr, GuardPtr, Hasher<boost::shared_ptr<broker::Queue> >
@@ -103,6 +109,7 @@ class RemoteBackup
 
     typedef std::set<QueuePtr> QueueSet;
 
+    HaBroker& haBroker;
     LogPrefix2 logPrefix;
     BrokerInfo brokerInfo;
     ReplicationTest replicationTest;
@@ -111,6 +118,7 @@ class RemoteBackup
     bool started;
     broker::Connection* connection;
     bool reportedReady;
+    boost::shared_ptr<sys::AtomicValue<uint32_t> > unacked; // Shared with guards.
 };
 
 }} // namespace qpid::ha
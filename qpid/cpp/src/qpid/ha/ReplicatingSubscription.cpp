@@ -20,6 +20,7 @@
  */
 
 #include "Event.h"
+#include "IdCheckpoint.h"
 #include "IdSetter.h"
 #include "QueueGuard.h"
 #include "QueueSnapshot.h"
@@ -46,10 +47,15 @@ using namespace broker;
 using namespace std;
 using sys::Mutex;
 using broker::amqp_0_10::MessageTransfer;
-namespace { const string QPID_HA(QPID_HA_PREFIX); }
+namespace {
+const string QPID_HA(QPID_HA_PREFIX);
+// Longest time a dequeue is held back while messages are flowing.
+const sys::Duration DEQUEUE_DELAY(100*sys::TIME_MSEC);
+}
 const string ReplicatingSubscription::QPID_REPLICATING_SUBSCRIPTION(QPID_HA+"repsub");
 const string ReplicatingSubscription::QPID_BROKER_INFO(QPID_HA+"info");
 const string ReplicatingSubscription::QPID_ID_SET(QPID_HA+"ids");
+const string ReplicatingSubscription::QPID_ID_CHECKPOINT(QPID_HA+"id-checkpoint");
 const string ReplicatingSubscription::QPID_QUEUE_REPLICATOR(QPID_HA+"qrep");
 
 /* Called by SemanticState::consume to create a consumer */
@@ -93,7 +99,8 @@ ReplicatingSubscription::ReplicatingSubscription(
 ) : ConsumerImpl(parent, name, queue_, ack, REPLICATOR, exclusive, tag,
                  resumeId, resumeTtl, arguments),
     logPrefix(hb.logPrefix),
-    position(0), wasStopped(false), ready(false), cancelled(false),
+    position(0), dequeueCount(0), backupNextId(0), backupNextIdKnown(false),
+    wasStopped(false), ready(false), cancelled(false),
     haBroker(hb),
     primary(boost::dynamic_pointer_cast<Primary>(haBroker.getRole()))
 {}
@@ -117,7 +124,7 @@ void ReplicatingSubscription::initialize() {
 
         // If there's already a guard (we are in failover) use it, else create one.
         if (primary) guard = primary->getGuard(queue, info);
-        if (!guard) guard.reset(new QueueGuard(*queue, info, logPrefix.prePrefix));
+        if (!guard) guard.reset(new QueueGuard(*queue, info, haBroker));
 
         // NOTE: Once the observer is attached we can have concurrent
         // calls to dequeued so we need to lock use of this->dequeues.
@@ -135,18 +142,29 @@ void ReplicatingSubscription::initialize() {
             throw ResourceDeletedException(logPrefix.get()+"Can't subscribe, queue deleted");
         }
         ReplicationIdSet primaryIds = snapshot->getSnapshot();
-        std::string backupStr = getArguments().getAsString(ReplicatingSubscription::QPID_ID_SET);
-        ReplicationIdSet backupIds;
-        if (!backupStr.empty()) backupIds = decodeStr<ReplicationIdSet>(backupStr);
-
         // Initial dequeues are messages on backup but not on primary.
-        ReplicationIdSet initDequeues = backupIds - primaryIds;
+        // Compare outside the lock, the sets may be large.
+        ReplicationIdSet initDequeues, keep;
+        std::string checkpointStr =
+            getArguments().getAsString(ReplicatingSubscription::QPID_ID_CHECKPOINT);
+        if (!checkpointStr.empty()) {
+            IdCheckpoint checkpoint = decodeStr<IdCheckpoint>(checkpointStr);
+            checkpoint.compare(primaryIds, keep, initDequeues);
+            QPID_LOG(debug, logPrefix << "Backup " << checkpoint);
+        }
+        else {
+            std::string backupStr = getArguments().getAsString(ReplicatingSubscription::QPID_ID_SET);
+            ReplicationIdSet backupIds;
+            if (!backupStr.empty()) backupIds = decodeStr<ReplicationIdSet>(backupStr);
+            initDequeues = backupIds - primaryIds;
+            keep = backupIds - initDequeues;
+        }
         QueuePosition front,back;
         queue->getRange(front, back, broker::REPLICATOR); // Outside lock, getRange locks queue
         {
             sys::Mutex::ScopedLock l(lock); // Concurrent calls to dequeued()
             dequeues += initDequeues;       // Messages on backup that are not on primary.
-            skipEnqueue = backupIds - initDequeues; // Messages already on the backup.
+            skipEnqueue = keep;             // Messages already on the backup.
             // Queue front is moving but we know this subscriptions will start at a
             // position >= front so if front is safe then position must be.
             position = front;
@@ -210,8 +228,12 @@ bool ReplicatingSubscription::deliver(
         else {
             QPID_LOG(trace, logPrefix << "Replicated " << logMessageId(*getQueue(), m));
             if (!ready && !isGuarded(l)) unready += id;
-            sendIdEvent(id, l);
+            // The backup numbers consecutive messages itself, only send an ID
+            // event when there is a gap.
+            if (!backupNextIdKnown || id != backupNextId) sendIdEvent(id, l);
             result = ConsumerImpl::deliver(c, m);
+            backupNextIdKnown = result;
+            backupNextId = id + 1;
         }
         checkReady(l);
         return result;
@@ -272,9 +294,19 @@ void ReplicatingSubscription::sendDequeueEvent(Mutex::ScopedLock& l)
 {
     if (dequeues.empty()) return;
     QPID_LOG(trace, logPrefix << "Sending dequeues " << dequeues);
-    DequeueEvent d(dequeues);
+    ReplicationIdSet ids(dequeues);
     dequeues.clear();
-    sendEvent(d, l);
+    dequeueCount = 0;
+    // An encoded ID set has a 16 bit size, send very fragmented sets in parts.
+    DequeueEvent d;
+    for (ReplicationIdSet::RangeIterator i = ids.rangesBegin(); i != ids.rangesEnd(); ++i) {
+        d.ids += *i;
+        if (d.ids.rangesSize() == MAX_EVENT_RANGES) {
+            sendEvent(d, l);
+            d.ids.clear();
+        }
+    }
+    if (!d.ids.empty()) sendEvent(d, l);
 }
 
 // Called after the message has been removed
@@ -286,7 +318,9 @@ void ReplicatingSubscription::dequeued(const broker::Message& m)
     QPID_LOG(trace, logPrefix << "Dequeued ID " << id);
     {
         Mutex::ScopedLock l(lock);
+        if (dequeues.empty()) dequeueStart = sys::AbsTime::now();
         dequeues.add(id);
+        ++dequeueCount;
     }
     notify();                   // Ensure a call to doDispatch
 }
@@ -310,17 +344,22 @@ void ReplicatingSubscription::sendEvent(const Event& event, Mutex::ScopedLock&)
 // Called in subscription's connection thread.
 bool ReplicatingSubscription::doDispatch()
 {
-    {
-        Mutex::ScopedLock l(lock);
-        if (!dequeues.empty()) sendDequeueEvent(l);
-    }
+    bool delivered = false;
     try {
-        return ConsumerImpl::doDispatch();
+        delivered = ConsumerImpl::doDispatch();
     }
     catch (const std::exception& e) {
         QPID_LOG(warning, logPrefix << " exception in dispatch: " << e.what());
-        return false;
     }
+    // While messages are flowing, collect dequeues into batches. Send them
+    // when the batch is full, the oldest has waited DEQUEUE_DELAY or there is
+    // nothing more to deliver.
+    Mutex::ScopedLock l(lock);
+    if (!delivered || dequeueCount >= DEQUEUE_BATCH ||
+        (!dequeues.empty() &&
+         sys::Duration(dequeueStart, sys::AbsTime::now()) >= DEQUEUE_DELAY))
+        sendDequeueEvent(l);
+    return delivered;
 }
 
 }} // namespace qpid::ha
@@ -27,6 +27,7 @@
 #include "qpid/broker/SemanticState.h"
 #include "qpid/broker/ConsumerFactory.h"
 #include "qpid/broker/QueueObserver.h"
+#include "qpid/sys/Time.h"
 #include <boost/enable_shared_from_this.hpp>
 #include <iosfwd>
 
@@ -95,6 +96,7 @@ class ReplicatingSubscription :
     static const std::string QPID_REPLICATING_SUBSCRIPTION;
     static const std::string QPID_BROKER_INFO;
     static const std::string QPID_ID_SET;
+    static const std::string QPID_ID_CHECKPOINT;
     // Replicator types: argument values for QPID_REPLICATING_SUBSCRIPTION argument.
     static const std::string QPID_QUEUE_REPLICATOR;
 
@@ -141,9 +143,16 @@ class ReplicatingSubscription :
     bool doDispatch();
 
   private:
+    static const uint32_t DEQUEUE_BATCH = 1000; // Dequeues sent while busy.
+    static const size_t MAX_EVENT_RANGES = 4096; // Ranges per dequeue event.
+
     LogPrefix2 logPrefix;
     QueuePosition position;
     ReplicationIdSet dequeues;  // Dequeues to be sent in next dequeue event.
+    uint32_t dequeueCount;      // Number of IDs added to dequeues since last sent.
+    sys::AbsTime dequeueStart;  // When the first ID was added to dequeues.
+    ReplicationId backupNextId; // ID the backup will assign to the next message.
+    bool backupNextIdKnown;     // False until an ID event has been sent.
     ReplicationIdSet skipEnqueue; // Enqueues to skip: messages already on backup.
     ReplicationIdSet unready;   // Unguarded, replicated and un-acknowledged.
     bool wasStopped;
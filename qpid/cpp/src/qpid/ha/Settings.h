@@ -38,7 +38,8 @@ class Settings
   public:
     Settings() : cluster(false), queueReplication(false),
                  replicateDefault(NONE), backupTimeout(10*sys::TIME_SEC),
-                 flowMessages(1000), flowBytes(0)
+                 flowMessages(1000), flowBytes(0), replicationLinks(1),
+                 quorum(0)
     {}
 
     bool cluster;               // True if we are a cluster member.
@@ -50,11 +51,14 @@ class Settings
     sys::Duration backupTimeout;
 
     uint32_t flowMessages, flowBytes;
+    uint32_t replicationLinks;  // Connections used to replicate queue messages.
+    uint32_t quorum;            // Backup acknowledgements to complete a message, 0 means all.
 
     static const uint32_t NO_LIMIT=0xFFFFFFFF;
     static uint32_t flowValue(uint32_t n) { return n ? n : NO_LIMIT; }
     uint32_t getFlowMessages() const { return flowValue(flowMessages); }
     uint32_t getFlowBytes() const { return flowValue(flowBytes); }
+    uint32_t getReplicationLinks() const { return replicationLinks ? replicationLinks : 1; }
 };
 }} // namespace qpid::ha
 
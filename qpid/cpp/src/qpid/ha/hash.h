@@ -24,6 +24,7 @@
 
 #include "qpid/types/Uuid.h"
 #include <boost/shared_ptr.hpp>
+#include <string>
 #include <utility>
 
 namespace qpid {
@@ -46,6 +47,13 @@ inline std::size_t hashValue(unsigned long v) { return static_cast<std::size_t>(
 
 inline std::size_t hashValue(const types::Uuid& v) { return v.hash(); }
 
+inline std::size_t hashValue(const std::string& v) {
+    std::size_t h = 0;
+    for (std::string::const_iterator i = v.begin(); i != v.end(); ++i)
+        h = h * 31 + static_cast<unsigned char>(*i);
+    return h;
+}
+
 template <class T> inline std::size_t hashValue(T* v) {
     std::size_t x = static_cast<std::size_t>(reinterpret_cast<std::ptrdiff_t>(v));
     return x + (x >> 3);
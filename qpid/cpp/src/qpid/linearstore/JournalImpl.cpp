@@ -21,15 +21,22 @@
 
 #include "qpid/linearstore/JournalImpl.h"
 
+#include <algorithm>
 #include "qpid/linearstore/DataTokenImpl.h"
 #include "qpid/linearstore/JournalLogImpl.h"
 #include "qpid/linearstore/journal/jexception.h"
 #include "qpid/linearstore/StoreException.h"
 #include "qpid/management/ManagementAgent.h"
 
+#include "qmf/org/apache/qpid/linearstore/ArgsJournalGetLatencyHistograms.h"
+
+namespace _qmf = ::qmf::org::apache::qpid::linearstore;
+
 namespace qpid {
 namespace linearstore {
 
+uint32_t JournalImpl::compactionRateKib = 0;
+
 InactivityFireEvent::InactivityFireEvent(JournalImpl* p,
                                          const ::qpid::sys::Duration timeout):
         ::qpid::sys::TimerTask(timeout, "JournalInactive:"+p->id()), _parent(p) {}
@@ -41,6 +48,17 @@ void InactivityFireEvent::fire() {
     }
 }
 
+CompactionFireEvent::CompactionFireEvent(JournalImpl* p,
+                                         const ::qpid::sys::Duration timeout):
+        ::qpid::sys::TimerTask(timeout, "JournalCompaction:"+p->id()), _parent(p) {}
+
+void CompactionFireEvent::fire() {
+    ::qpid::sys::Mutex::ScopedLock sl(_cfe_lock);
+    if (_parent) {
+        _parent->compactionFire();
+    }
+}
+
 GetEventsFireEvent::GetEventsFireEvent(JournalImpl* p,
                                        const ::qpid::sys::Duration timeout):
         ::qpid::sys::TimerTask(timeout, "JournalGetEvents:"+p->id()), _parent(p)
@@ -67,6 +85,8 @@ JournalImpl::JournalImpl(::qpid::sys::Timer& timer_,
                          getEventsTimerSetFlag(false),
                          writeActivityFlag(false),
                          flushTriggeredFlag(true),
+                         sharedContentFlag(false),
+                         compactionTimer(0),
                          deleteCallback(onDelete)
 {
     getEventsFireEventsPtr = new GetEventsFireEvent(this, getEventsTimeout);
@@ -93,6 +113,7 @@ JournalImpl::~JournalImpl()
 	}
     getEventsFireEventsPtr->cancel();
     inactivityFireEventPtr->cancel();
+    if (compactionFireEventPtr) compactionFireEventPtr->cancel();
 
     if (_mgmtObject.get() != 0) {
         _mgmtObject->resourceDestroy();
@@ -256,6 +277,7 @@ JournalImpl::enqueue_data_record(const void* const data_buff,
                                  ::qpid::linearstore::journal::data_tok* dtokp,
                                  const bool transient)
 {
+    dtokp->set_start_ts();
     handleIoResult(jcntl::enqueue_data_record(data_buff, tot_data_len, this_data_len, dtokp, transient));
 
     if (_mgmtObject.get() != 0)
@@ -270,6 +292,7 @@ JournalImpl::enqueue_extern_data_record(const size_t tot_data_len,
                                         ::qpid::linearstore::journal::data_tok* dtokp,
                                         const bool transient)
 {
+    dtokp->set_start_ts();
     handleIoResult(jcntl::enqueue_extern_data_record(tot_data_len, dtokp, transient));
 
     if (_mgmtObject.get() != 0)
@@ -290,6 +313,7 @@ JournalImpl::enqueue_txn_data_record(const void* const data_buff,
 {
     bool txn_incr = _mgmtObject.get() != 0 ? _tmap.in_map(xid) : false;
 
+    dtokp->set_start_ts();
     handleIoResult(jcntl::enqueue_txn_data_record(data_buff, tot_data_len, this_data_len, dtokp, xid, tpc_flag, transient));
 
     if (_mgmtObject.get() != 0)
@@ -311,6 +335,7 @@ JournalImpl::enqueue_extern_txn_data_record(const size_t tot_data_len,
 {
     bool txn_incr = _mgmtObject.get() != 0 ? _tmap.in_map(xid) : false;
 
+    dtokp->set_start_ts();
     handleIoResult(jcntl::enqueue_extern_txn_data_record(tot_data_len, dtokp, xid, tpc_flag, transient));
 
     if (_mgmtObject.get() != 0)
@@ -327,6 +352,7 @@ void
 JournalImpl::dequeue_data_record(::qpid::linearstore::journal::data_tok* const dtokp,
                                  const bool txn_coml_commit)
 {
+    dtokp->set_start_ts();
     handleIoResult(jcntl::dequeue_data_record(dtokp, txn_coml_commit));
 
     if (_mgmtObject.get() != 0)
@@ -345,6 +371,7 @@ JournalImpl::dequeue_txn_data_record(::qpid::linearstore::journal::data_tok* con
 {
     bool txn_incr = _mgmtObject.get() != 0 ? _tmap.in_map(xid) : false;
 
+    dtokp->set_start_ts();
     handleIoResult(jcntl::dequeue_txn_data_record(dtokp, xid, tpc_flag, txn_coml_commit));
 
     if (_mgmtObject.get() != 0)
@@ -374,6 +401,7 @@ void
 JournalImpl::txn_commit(::qpid::linearstore::journal::data_tok* const dtokp,
                         const std::string& xid)
 {
+    dtokp->set_start_ts();
     handleIoResult(jcntl::txn_commit(dtokp, xid));
 
     if (_mgmtObject.get() != 0)
@@ -435,6 +463,23 @@ JournalImpl::flushFire()
     }
 }
 
+void
+JournalImpl::startCompaction(::qpid::sys::Timer& timer_, const ::qpid::sys::Duration interval)
+{
+    if (compactionRateKib == 0 || compactionFireEventPtr) return;
+    compactionTimer = &timer_;
+    compactionFireEventPtr = new CompactionFireEvent(this, interval);
+    compactionTimer->add(compactionFireEventPtr);
+}
+
+void
+JournalImpl::compactionFire()
+{
+    compactJournal();
+    compactionFireEventPtr->setupNextFire();
+    compactionTimer->add(compactionFireEventPtr);
+}
+
 void
 JournalImpl::wr_aio_cb(std::vector< ::qpid::linearstore::journal::data_tok*>& dtokl)
 {
@@ -460,8 +505,25 @@ JournalImpl::wr_aio_cb(std::vector< ::qpid::linearstore::journal::data_tok*>& dt
 			    default: ;
 		    }
 	    }
+        ::qpid::linearstore::journal::time_ns cbComplete;
+        cbComplete.now();
+        switch (dtokp->wstate())
+        {
+            case ::qpid::linearstore::journal::data_tok::ENQ:
+                if (!dtokp->is_relocated())
+                    enqueueLatency.record(dtokp->start_ts(), dtokp->subm_ts(), dtokp->compl_ts(), cbComplete);
+                break;
+            case ::qpid::linearstore::journal::data_tok::DEQ:
+                dequeueLatency.record(dtokp->start_ts(), dtokp->subm_ts(), dtokp->compl_ts(), cbComplete);
+                break;
+            case ::qpid::linearstore::journal::data_tok::COMMITTED:
+                commitLatency.record(dtokp->start_ts(), dtokp->subm_ts(), dtokp->compl_ts(), cbComplete);
+                break;
+            default: ;
+        }
 	    dtokp->release();
     }
+    updateLatencyStatistics();
 }
 
 void
@@ -491,24 +553,103 @@ JournalImpl::handleIoResult(const ::qpid::linearstore::journal::iores r)
     }
 }
 
-::qpid::management::Manageable::status_t JournalImpl::ManagementMethod (uint32_t /*methodId*/,
-                                                                      ::qpid::management::Args& /*args*/,
+void
+JournalImpl::getLatencyHistograms(::qpid::types::Variant::Map& histograms) const
+{
+    ::qpid::types::Variant::Map m;
+    enqueueLatency.toMap(m);
+    histograms["enqueue"] = m;
+    m.clear();
+    dequeueLatency.toMap(m);
+    histograms["dequeue"] = m;
+    m.clear();
+    commitLatency.toMap(m);
+    histograms["commit"] = m;
+}
+
+void
+JournalImpl::resetLatencyHistograms()
+{
+    enqueueLatency.reset();
+    dequeueLatency.reset();
+    commitLatency.reset();
+}
+
+void
+JournalImpl::compactJournal()
+{
+    ::qpid::linearstore::journal::time_ns now;
+    now.now();
+    // Cap the interval at one second so that the first step or a late timer cannot cause a burst
+    const uint64_t elapsedUsec = std::min(LatencyHistogram::elapsedUsec(compactionTime, now), uint64_t(1000000));
+    compactionTime = now;
+    if (compactionRateKib == 0 || !is_ready() || is_read_only())
+        return;
+
+    uint64_t fid;
+    std::vector<uint64_t> rids;
+    if (!get_relocation_candidates(fid, rids, 256))
+        return;
+    uint64_t budget = uint64_t(compactionRateKib) * 1024 * elapsedUsec / 1000000;
+    try {
+        for (std::vector<uint64_t>::const_iterator i = rids.begin(); i != rids.end() && budget > 0; ++i) {
+            boost::intrusive_ptr<DataTokenImpl> dtokp(new DataTokenImpl);
+            dtokp->addRef(); // Released in wr_aio_cb()
+            const std::size_t relocated = relocate_data_record(*i, fid, dtokp.get());
+            if (relocated == 0) {
+                dtokp->release();
+                continue;
+            }
+            flushTriggeredFlag = false; // Flush the copies on the next inactivity timeout
+            budget = relocated < budget ? budget - relocated : 0;
+        }
+    } catch (const ::qpid::linearstore::journal::jexception& e) {
+        std::ostringstream oss;
+        oss << "Journal compaction of file 0x" << std::hex << fid << " failed: " << e.what();
+        QLS_LOG2(warning, _jid, oss.str());
+    }
+}
+
+void
+JournalImpl::updateLatencyStatistics()
+{
+    if (_mgmtObject.get() == 0)
+        return;
+    // Percentiles scan the whole histogram, so refresh the statistics at most once per second
+    ::qpid::linearstore::journal::time_ns now;
+    now.now();
+    if (now.tv_sec == latencyStatsUpdateTime.tv_sec)
+        return;
+    latencyStatsUpdateTime = now;
+    _mgmtObject->set_enqueueLatencyP50(enqueueLatency.total.percentile(50.0));
+    _mgmtObject->set_enqueueLatencyP99(enqueueLatency.total.percentile(99.0));
+    _mgmtObject->set_enqueueLatencyP999(enqueueLatency.total.percentile(99.9));
+    _mgmtObject->set_dequeueLatencyP50(dequeueLatency.total.percentile(50.0));
+    _mgmtObject->set_dequeueLatencyP99(dequeueLatency.total.percentile(99.0));
+    _mgmtObject->set_dequeueLatencyP999(dequeueLatency.total.percentile(99.9));
+    _mgmtObject->set_commitLatencyP50(commitLatency.total.percentile(50.0));
+    _mgmtObject->set_commitLatencyP99(commitLatency.total.percentile(99.0));
+    _mgmtObject->set_commitLatencyP999(commitLatency.total.percentile(99.9));
+}
+
+::qpid::management::Manageable::status_t JournalImpl::ManagementMethod (uint32_t methodId,
+                                                                      ::qpid::management::Args& args,
                                                                       std::string& /*text*/)
 {
     Manageable::status_t status = Manageable::STATUS_UNKNOWN_METHOD;
 
-/*
     switch (methodId)
     {
-    case _qmf::Journal::METHOD_EXPAND :
-        //_qmf::ArgsJournalExpand& eArgs = (_qmf::ArgsJournalExpand&) args;
-
-        // Implement "expand" using eArgs.i_by (expand-by argument)
-
-        status = Manageable::STATUS_NOT_IMPLEMENTED;
-        break;
+    case _qmf::Journal::METHOD_GETLATENCYHISTOGRAMS :
+        {
+            _qmf::ArgsJournalGetLatencyHistograms& a = dynamic_cast<_qmf::ArgsJournalGetLatencyHistograms&>(args);
+            getLatencyHistograms(a.o_histograms);
+            if (a.i_reset)
+                resetLatencyHistograms();
+            status = Manageable::STATUS_OK;
+            break;
+        }
     }
-*/
 
     return status;
 }
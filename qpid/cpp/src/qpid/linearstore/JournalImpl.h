@@ -24,8 +24,10 @@
 
 #include <boost/ptr_container/ptr_list.hpp>
 #include "qpid/broker/PersistableQueue.h"
+#include "qpid/linearstore/LatencyHistogram.h"
 #include "qpid/linearstore/journal/aio_callback.h"
 #include "qpid/linearstore/journal/jcntl.h"
+#include "qpid/linearstore/journal/time_ns.h"
 #include "qpid/linearstore/PreparedTransaction.h"
 #include "qpid/sys/Timer.h"
 
@@ -57,6 +59,19 @@ class InactivityFireEvent : public ::qpid::sys::TimerTask
     inline void cancel() { ::qpid::sys::Mutex::ScopedLock sl(_ife_lock); _parent = 0; }
 };
 
+class CompactionFireEvent : public ::qpid::sys::TimerTask
+{
+    JournalImpl* _parent;
+    ::qpid::sys::Mutex _cfe_lock;
+
+  public:
+    CompactionFireEvent(JournalImpl* p,
+                        const ::qpid::sys::Duration timeout);
+    virtual ~CompactionFireEvent() {}
+    void fire();
+    inline void cancel() { ::qpid::sys::Mutex::ScopedLock sl(_cfe_lock); _parent = 0; }
+};
+
 class GetEventsFireEvent : public ::qpid::sys::TimerTask
 {
     JournalImpl* _parent;
@@ -87,8 +102,22 @@ class JournalImpl : public ::qpid::broker::ExternalQueueStore,
 
     bool writeActivityFlag;
     bool flushTriggeredFlag;
+    bool sharedContentFlag;
     boost::intrusive_ptr< ::qpid::sys::TimerTask> inactivityFireEventPtr;
 
+    // Latency from the journal call to completion of its AIO callback, recorded in wr_aio_cb()
+    OperationLatency enqueueLatency;
+    OperationLatency dequeueLatency;
+    OperationLatency commitLatency;
+    ::qpid::linearstore::journal::time_ns latencyStatsUpdateTime;
+
+    // Online compaction of the oldest journal file. This reads journal files synchronously, so it
+    // runs on a timer of its own rather than the broker timer shared with every other journal.
+    static uint32_t compactionRateKib;  ///< KiB/s copied forward per journal, 0 = disabled
+    ::qpid::linearstore::journal::time_ns compactionTime;
+    ::qpid::sys::Timer* compactionTimer;
+    boost::intrusive_ptr< ::qpid::sys::TimerTask> compactionFireEventPtr;
+
     ::qpid::management::ManagementAgent* _agent;
     ::qmf::org::apache::qpid::linearstore::Journal::shared_ptr _mgmtObject;
     DeleteCallback deleteCallback;
@@ -184,6 +213,10 @@ class JournalImpl : public ::qpid::broker::ExternalQueueStore,
     // TimerTask callback
     void getEventsFire();
     void flushFire();
+    void compactionFire();
+
+    /** Start compacting this journal on the given timer, which must not be the broker timer */
+    void startCompaction(::qpid::sys::Timer& timer, const ::qpid::sys::Duration interval);
 
     // AIO callbacks
     virtual void wr_aio_cb(std::vector< ::qpid::linearstore::journal::data_tok*>& dtokl);
@@ -198,6 +231,16 @@ class JournalImpl : public ::qpid::broker::ExternalQueueStore,
 
     void resetDeleteCallback() { deleteCallback = DeleteCallback(); }
 
+    // If set, non-transactional enqueues store a reference into the SharedContentStore
+    inline void setSharedContent(const bool sharedContent) { sharedContentFlag = sharedContent; }
+    inline bool isSharedContent() const { return sharedContentFlag; }
+
+    void getLatencyHistograms(::qpid::types::Variant::Map& histograms) const;
+    void resetLatencyHistograms();
+
+    static inline void setCompactionRate(const uint32_t rateKib) { compactionRateKib = rateKib; }
+    static inline uint32_t getCompactionRate() { return compactionRateKib; }
+
   protected:
     void createStore();
 
@@ -208,6 +251,8 @@ class JournalImpl : public ::qpid::broker::ExternalQueueStore,
         getEventsTimerSetFlag = true;
     }
     void handleIoResult(const ::qpid::linearstore::journal::iores r);
+    void updateLatencyStatistics();
+    void compactJournal();
 
     // Management instrumentation callbacks overridden from jcntl
     inline void instr_incr_outstanding_aio_cnt() {
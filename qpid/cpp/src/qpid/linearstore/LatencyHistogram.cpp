@@ -0,0 +1,189 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "qpid/linearstore/LatencyHistogram.h"
+
+#include "qpid/linearstore/journal/time_ns.h"
+
+namespace qpid {
+namespace linearstore {
+
+LatencyHistogram::LatencyHistogram() : total(0), sum(0), max(0) {}
+
+void LatencyHistogram::record(const uint64_t usec)
+{
+    ++buckets[bucketIndex(usec)];
+    ++total;
+    sum += usec;
+    uint64_t m = max.get();
+    while (usec > m && !max.boolCompareAndSwap(m, usec))
+        m = max.get();
+}
+
+void LatencyHistogram::reset()
+{
+    // Subtract what was read rather than zeroing, so samples recorded concurrently are not lost
+    for (uint32_t i = 0; i < NUM_BUCKETS; ++i) {
+        uint64_t c = buckets[i].get();
+        if (c) buckets[i] -= c;
+    }
+    total -= total.get();
+    sum -= sum.get();
+    max -= max.get();
+}
+
+uint64_t LatencyHistogram::count() const
+{
+    return total.get();
+}
+
+uint64_t LatencyHistogram::percentile(const double pct) const
+{
+    std::vector<uint64_t> counts;
+    snapshot(counts);
+    uint64_t n = 0;
+    for (std::vector<uint64_t>::const_iterator i = counts.begin(); i != counts.end(); ++i)
+        n += *i;
+    return percentile(counts, n, pct);
+}
+
+void LatencyHistogram::snapshot(std::vector<uint64_t>& counts) const
+{
+    counts.resize(NUM_BUCKETS);
+    for (uint32_t i = 0; i < NUM_BUCKETS; ++i)
+        counts[i] = buckets[i].get();
+}
+
+void LatencyHistogram::toMap(::qpid::types::Variant::Map& map) const
+{
+    std::vector<uint64_t> counts;
+    snapshot(counts);
+    uint64_t n = 0;
+    ::qpid::types::Variant::List bucketList;
+    for (uint32_t i = 0; i < NUM_BUCKETS; ++i) {
+        if (counts[i] == 0) continue;
+        n += counts[i];
+        ::qpid::types::Variant::List b;
+        b.push_back(bucketLowerBound(i));
+        b.push_back(counts[i]);
+        bucketList.push_back(b);
+    }
+    map["count"] = n;
+    map["sumUsec"] = sum.get();
+    map["maxUsec"] = max.get();
+    map["p50Usec"] = percentile(counts, n, 50.0);
+    map["p90Usec"] = percentile(counts, n, 90.0);
+    map["p99Usec"] = percentile(counts, n, 99.0);
+    map["p999Usec"] = percentile(counts, n, 99.9);
+    map["buckets"] = bucketList; // list of [lowerBoundUsec, count] for non-empty buckets
+}
+
+uint32_t LatencyHistogram::bucketIndex(const uint64_t usec)
+{
+    if (usec < SUB_BUCKETS)
+        return usec;
+    uint32_t msb = 63 - __builtin_clzll(usec);
+    if (msb >= VALUE_BITS)
+        return NUM_BUCKETS - 1;
+    uint32_t shift = msb - SUB_BUCKET_BITS;
+    return ((shift + 1) * SUB_BUCKETS) + (uint32_t)(usec >> shift) - SUB_BUCKETS;
+}
+
+uint64_t LatencyHistogram::bucketLowerBound(const uint32_t index)
+{
+    if (index < 2 * SUB_BUCKETS)
+        return index;
+    uint32_t shift = (index / SUB_BUCKETS) - 1;
+    return (uint64_t)((index % SUB_BUCKETS) + SUB_BUCKETS) << shift;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(const uint32_t index)
+{
+    if (index < 2 * SUB_BUCKETS)
+        return index;
+    uint32_t shift = (index / SUB_BUCKETS) - 1;
+    return bucketLowerBound(index) + (1ULL << shift) - 1;
+}
+
+uint64_t LatencyHistogram::elapsedUsec(const journal::time_ns& from, const journal::time_ns& to)
+{
+    // CLOCK_REALTIME may step backwards; treat that as zero elapsed time
+    int64_t ns = ((int64_t)(to.tv_sec - from.tv_sec) * 1000000000LL) + (to.tv_nsec - from.tv_nsec);
+    return ns > 0 ? (uint64_t)ns / 1000 : 0;
+}
+
+uint64_t LatencyHistogram::percentile(const std::vector<uint64_t>& counts, const uint64_t n, const double pct)
+{
+    if (n == 0) return 0;
+    // Rank of the requested sample, rounded up so that eg p99 of 100 samples is the 99th
+    uint64_t rank = (uint64_t)((pct / 100.0) * n);
+    if ((double)rank < (pct / 100.0) * n) ++rank;
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank)
+            return bucketUpperBound(i);
+    }
+    return bucketUpperBound(NUM_BUCKETS - 1);
+}
+
+
+uint64_t OperationLatency::record(const journal::time_ns& start,
+                                  const journal::time_ns& submitted,
+                                  const journal::time_ns& aioComplete,
+                                  const journal::time_ns& callbackComplete)
+{
+    if (start.is_zero() || submitted.is_zero() || aioComplete.is_zero())
+        return 0;
+    uint64_t t = LatencyHistogram::elapsedUsec(start, callbackComplete);
+    total.record(t);
+    pageWait.record(LatencyHistogram::elapsedUsec(start, submitted));
+    aioInFlight.record(LatencyHistogram::elapsedUsec(submitted, aioComplete));
+    callback.record(LatencyHistogram::elapsedUsec(aioComplete, callbackComplete));
+    return t;
+}
+
+void OperationLatency::reset()
+{
+    total.reset();
+    pageWait.reset();
+    aioInFlight.reset();
+    callback.reset();
+}
+
+void OperationLatency::toMap(::qpid::types::Variant::Map& map) const
+{
+    ::qpid::types::Variant::Map m;
+    total.toMap(m);
+    map["total"] = m;
+    m.clear();
+    pageWait.toMap(m);
+    map["pageWait"] = m;
+    m.clear();
+    aioInFlight.toMap(m);
+    map["aioInFlight"] = m;
+    m.clear();
+    callback.toMap(m);
+    map["callback"] = m;
+}
+
+}}
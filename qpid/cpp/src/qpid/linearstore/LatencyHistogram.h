@@ -0,0 +1,101 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#ifndef QPID_LINEARSTORE_LATENCYHISTOGRAM_H
+#define QPID_LINEARSTORE_LATENCYHISTOGRAM_H
+
+#include "qpid/sys/AtomicValue.h"
+#include "qpid/types/Variant.h"
+#include <stdint.h>
+#include <vector>
+
+namespace qpid {
+namespace linearstore {
+namespace journal {
+    struct time_ns;
+}
+
+/**
+ * Log-linear latency histogram in microseconds. Each power-of-two range is split into
+ * SUB_BUCKETS linear buckets, so any recorded value is reported to within 1/SUB_BUCKETS
+ * (12.5%) of its true value. Values beyond the highest bucket are clamped into it.
+ *
+ * Counters are updated with atomic increments and never locked, so record() may be called
+ * concurrently with readers (eg the management thread) without stalling the AIO completion path.
+ */
+class LatencyHistogram
+{
+  public:
+    static const uint32_t SUB_BUCKET_BITS = 3;
+    static const uint32_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const uint32_t VALUE_BITS = 27; // Largest bucket starts at approx 2^27 usec (134 sec)
+    static const uint32_t NUM_BUCKETS = (VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    LatencyHistogram();
+
+    void record(const uint64_t usec);
+    void reset();
+
+    uint64_t count() const;
+    uint64_t percentile(const double pct) const;
+    void snapshot(std::vector<uint64_t>& counts) const;
+    void toMap(::qpid::types::Variant::Map& map) const;
+
+    static uint32_t bucketIndex(const uint64_t usec);
+    static uint64_t bucketLowerBound(const uint32_t index);
+    static uint64_t bucketUpperBound(const uint32_t index);
+    static uint64_t elapsedUsec(const journal::time_ns& from, const journal::time_ns& to);
+
+  private:
+    ::qpid::sys::AtomicValue<uint64_t> buckets[NUM_BUCKETS];
+    ::qpid::sys::AtomicValue<uint64_t> total;
+    ::qpid::sys::AtomicValue<uint64_t> sum;
+    ::qpid::sys::AtomicValue<uint64_t> max;
+
+    static uint64_t percentile(const std::vector<uint64_t>& counts, const uint64_t total, const double pct);
+};
+
+/**
+ * Latency of one journal operation type (enqueue, dequeue, txn commit) from the time it is passed
+ * to the journal until its completion callback returns, together with the three phases making up
+ * that time: waiting in the page cache for the page to be submitted, AIO in flight, and the
+ * completion callback itself.
+ */
+class OperationLatency
+{
+  public:
+    LatencyHistogram total;
+    LatencyHistogram pageWait;
+    LatencyHistogram aioInFlight;
+    LatencyHistogram callback;
+
+    // Records a completed operation if all timestamps are valid; returns the total latency in usec
+    uint64_t record(const journal::time_ns& start,
+                    const journal::time_ns& submitted,
+                    const journal::time_ns& aioComplete,
+                    const journal::time_ns& callbackComplete);
+    void reset();
+    void toMap(::qpid::types::Variant::Map& map) const;
+};
+
+}}
+
+#endif // ifndef QPID_LINEARSTORE_LATENCYHISTOGRAM_H
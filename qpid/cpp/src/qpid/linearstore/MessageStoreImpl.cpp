@@ -22,6 +22,8 @@
 #include "qpid/linearstore/MessageStoreImpl.h"
 
 #include "qpid/broker/Broker.h"
+#include "qpid/broker/Queue.h"
+#include "qpid/broker/QueueSettings.h"
 #include "qpid/framing/FieldValue.h"
 #include "qpid/linearstore/BindingDbt.h"
 #include "qpid/linearstore/BufferValue.h"
@@ -30,6 +32,7 @@
 #include "qpid/linearstore/IdDbt.h"
 #include "qpid/linearstore/JournalImpl.h"
 #include "qpid/linearstore/journal/EmptyFilePoolManager.h"
+#include "qpid/linearstore/journal/MappedFileCache.h"
 #include "qpid/linearstore/StoreException.h"
 #include "qpid/linearstore/TxnCtxt.h"
 #include "qpid/log/Statement.h"
@@ -171,6 +174,9 @@ bool MessageStoreImpl::init(const qpid::Options* options_)
     uint32_t jrnlWrCachePageSizeKib = chkJrnlWrPageCacheSize(opts->wCachePageSizeKib, "wcache-page-size");
     uint32_t tplJrnlWrCachePageSizeKib = chkJrnlWrPageCacheSize(opts->tplWCachePageSizeKib, "tpl-wcache-page-size");
     journalFlushTimeout = opts->journalFlushTimeout;
+    qpid::linearstore::journal::MappedFileCache::setBudget((std::size_t)opts->mappedReadBudgetMib * 1024 * 1024);
+    JournalImpl::setCompactionRate(opts->journalCompactionRateKib);
+    if (opts->journalCompactionRateKib && !compactionTimer.get()) compactionTimer.reset(new qpid::sys::Timer);
 
     // Pass option values to init()
     return init(opts->storeDir, efpPartition, efpFilePoolSize_kib, opts->truncateFlag, jrnlWrCachePageSizeKib,
@@ -213,6 +219,8 @@ bool MessageStoreImpl::init(const std::string& storeDir_,
     QLS_LOG(info,   "> EFP file size pool: " << defaultEfpFileSize_kib << " (KiB)");
     QLS_LOG(info,   "> Overwrite before return to EFP: " << (overwriteBeforeReturnFlag?"True":"False"));
     QLS_LOG(info,   "> Maximum journal flush time: " << journalFlushTimeout);
+    QLS_LOG(info,   "> Mapped read budget: " << (qpid::linearstore::journal::MappedFileCache::getBudget() / (1024 * 1024)) << " (MiB)");
+    QLS_LOG(info,   "> Journal compaction rate: " << JournalImpl::getCompactionRate() << " (KiB/s)");
 
     return isInit;
 }
@@ -268,6 +276,8 @@ void MessageStoreImpl::init(const bool truncateFlag)
             // However during a truncated initialization in a cluster, agent != 0. We always pass 0 as the agent for the
             // TplStore to keep things consistent in a cluster. See https://bugzilla.redhat.com/show_bug.cgi?id=681026
             tplStorePtr.reset(new TplJournalImpl(broker->getTimer(), "TplStore", getTplBaseDir(), jrnlLog, defJournalGetEventsTimeoutNs, journalFlushTimeout, 0));
+            sharedContentPtr.reset(new SharedContentStore(broker->getTimer(), getSharedContentBaseDir(), jrnlLog, defJournalGetEventsTimeoutNs,
+                                                          journalFlushTimeout, messageIdSequence));
             isInit = true;
         } catch (const DbException& e) {
             if (e.get_errno() == DB_VERSION_MISMATCH)
@@ -302,7 +312,9 @@ void MessageStoreImpl::init(const bool truncateFlag)
 
 void MessageStoreImpl::finalize()
 {
+    if (compactionTimer.get()) compactionTimer->stop();
     if (tplStorePtr.get() && tplStorePtr->is_ready()) tplStorePtr->stop(true);
+    if (sharedContentPtr.get()) sharedContentPtr->stop();
     {
         qpid::sys::Mutex::ScopedLock sl(journalListLock);
         for (JournalListMapItr i = journalList.begin(); i != journalList.end(); i++)
@@ -333,6 +345,7 @@ void MessageStoreImpl::truncateInit()
         closeDbs();
         dbs.clear();
         if (tplStorePtr->is_ready()) tplStorePtr->stop(true);
+        sharedContentPtr->stop();
         dbenv->close(0);
         isInit = false;
     }
@@ -342,6 +355,7 @@ void MessageStoreImpl::truncateInit()
     // TODO: Linearstore: harvest all discarded journal files into the empty file pool(s).
     qpid::linearstore::journal::jdir::delete_dir(getJrnlBaseDir());
     qpid::linearstore::journal::jdir::delete_dir(getTplBaseDir());
+    qpid::linearstore::journal::jdir::delete_dir(getSharedContentBaseDir());
     QLS_LOG(info, "Store directory " << getStoreTopLevelDir() << " was truncated.");
 }
 
@@ -356,6 +370,13 @@ void MessageStoreImpl::chkTplStoreInit()
     }
 }
 
+void MessageStoreImpl::chkSharedContentStoreInit()
+{
+    if (!sharedContentPtr->isReady()) {
+        sharedContentPtr->initialize(getEmptyFilePool(defaultEfpPartitionNumber, defaultEfpFileSize_kib), wCacheNumPages, wCachePgSizeSblks);
+    }
+}
+
 void MessageStoreImpl::open(db_ptr db_,
                             DbTxn* txn_,
                             const char* file_,
@@ -413,12 +434,15 @@ void MessageStoreImpl::create(qpid::broker::PersistableQueue& queue_,
     jQueue = new JournalImpl(broker->getTimer(), queue_.getName(), getJrnlDir(queue_.getName()), jrnlLog,
                              defJournalGetEventsTimeoutNs, journalFlushTimeout, agent,
                              boost::bind(&MessageStoreImpl::journalDeleted, this, _1));
+    if (compactionTimer.get()) jQueue->startCompaction(*compactionTimer, journalFlushTimeout);
     {
         qpid::sys::Mutex::ScopedLock sl(journalListLock);
         journalList[queue_.getName()]=jQueue;
     }
 
     queue_.setExternalQueueStore(dynamic_cast<qpid::broker::ExternalQueueStore*>(jQueue));
+    const qpid::broker::Queue* brokerQueue = dynamic_cast<const qpid::broker::Queue*>(&queue_);
+    jQueue->setSharedContent(brokerQueue && brokerQueue->getSettings().sharedContent);
     try {
         jQueue->initialize(getEmptyFilePool(args_), wCacheNumPages, wCachePgSizeSblks);
     } catch (const qpid::linearstore::journal::jexception& e) {
@@ -471,6 +495,7 @@ void MessageStoreImpl::destroy(qpid::broker::PersistableQueue& queue_)
     qpid::broker::ExternalQueueStore* eqs = queue_.getExternalQueueStore();
     if (eqs) {
         JournalImpl* jQueue = static_cast<JournalImpl*>(eqs);
+        if (jQueue->isSharedContent()) sharedContentPtr->releaseAll(jQueue);
         jQueue->delete_jrnl_files();
         queue_.setExternalQueueStore(0); // will delete the journal if exists
         {
@@ -593,6 +618,7 @@ void MessageStoreImpl::recover(qpid::broker::RecoveryManager& registry_)
     checkInit();
     txn_list prepared;
     recoverLockedMappings(prepared);
+    recoverSharedContentStore();
 
     std::ostringstream oss;
     oss << "Recovered transaction prepared list:";
@@ -610,6 +636,7 @@ void MessageStoreImpl::recover(qpid::broker::RecoveryManager& registry_)
     try {
         //read all queues, calls recoversMessages for each queue
         recoverQueues(txn, registry_, queues, prepared, messages);
+        sharedContentPtr->recoverComplete();
 
         //recover exchange & bindings:
         recoverExchanges(txn, registry_, exchanges);
@@ -729,16 +756,19 @@ void MessageStoreImpl::recoverQueues(TxnCtxt& txn,
         jQueue = new JournalImpl(broker->getTimer(), queueName, getJrnlDir(queueName),jrnlLog,
                                  defJournalGetEventsTimeoutNs, journalFlushTimeout, agent,
                                  boost::bind(&MessageStoreImpl::journalDeleted, this, _1));
+        if (compactionTimer.get()) jQueue->startCompaction(*compactionTimer, journalFlushTimeout);
         {
             qpid::sys::Mutex::ScopedLock sl(journalListLock);
             journalList[queueName] = jQueue;
         }
         queue->setExternalQueueStore(dynamic_cast<qpid::broker::ExternalQueueStore*>(jQueue));
+        jQueue->setSharedContent(queue->getSettings().sharedContent);
 
         try
         {
             long rcnt = 0L;     // recovered msg count
             long idcnt = 0L;    // in-doubt msg count
+            std::vector<uint64_t> danglingRefs; // shared content references with no content
             uint64_t thisHighestRid = 0ULL;
             jQueue->recover(boost::dynamic_pointer_cast<qpid::linearstore::journal::EmptyFilePoolManager>(efpMgr), wCacheNumPages, wCachePgSizeSblks, &prepared, thisHighestRid, key.id);
 
@@ -763,9 +793,18 @@ void MessageStoreImpl::recoverQueues(TxnCtxt& txn,
                 highestRid = thisHighestRid;
             else if (thisHighestRid - highestRid < 0x8000000000000000ULL) // RFC 1982 comparison for unsigned 64-bit
                 highestRid = thisHighestRid;
-            recoverMessages(txn, registry, queue, prepared, messages, rcnt, idcnt);
+            recoverMessages(txn, registry, queue, prepared, messages, rcnt, idcnt, danglingRefs);
             QLS_LOG(info, "Recovered queue \"" << queueName << "\": " << rcnt << " messages recovered; " << idcnt << " messages in-doubt.");
             jQueue->recover_complete(); // start journal.
+            for (std::vector<uint64_t>::const_iterator i = danglingRefs.begin(); i != danglingRefs.end(); ++i) {
+                boost::intrusive_ptr<DataTokenImpl> ddtokp(new DataTokenImpl);
+                ddtokp->set_external_rid(true);
+                ddtokp->set_rid(messageIdSequence.next());
+                ddtokp->set_dequeue_rid(*i);
+                ddtokp->set_wstate(DataTokenImpl::ENQ);
+                ddtokp->addRef();
+                jQueue->dequeue_data_record(ddtokp.get(), false);
+            }
         } catch (const qpid::linearstore::journal::jexception& e) {
             THROW_STORE_EXCEPTION(std::string("Queue ") + queueName + ": recoverQueues() failed: " + e.what());
         }
@@ -876,7 +915,8 @@ void MessageStoreImpl::recoverMessages(TxnCtxt& /*txn*/,
                                        txn_list& prepared,
                                        message_index& messages,
                                        long& rcnt,
-                                       long& idcnt)
+                                       long& idcnt,
+                                       std::vector<uint64_t>& danglingRefs)
 {
     size_t preambleLength = sizeof(uint32_t)/*header size*/;
 
@@ -912,6 +952,30 @@ void MessageStoreImpl::recoverMessages(TxnCtxt& /*txn*/,
                 qpid::broker::RecoverableMessage::shared_ptr msg;
                 char* data = (char*)dbuff;
 
+                uint64_t sharedId;
+                std::vector<char> content;
+                if (!externalFlag && SharedContentStore::isReference(data, dbuffSize, sharedId)) {
+                    if (!sharedContentPtr->recoverReference(jc, sharedId, content)) {
+                        // Content was released after the queue record was written but before its dequeue was
+                        // written, or the content record itself never reached disk
+                        QLS_LOG(warning, "Queue \"" << queue->getName() << "\": no shared content for rid=0x" << std::hex << dtok.rid()
+                                << std::dec << ", discarding record");
+                        danglingRefs.push_back(dtok.rid());
+                        dtok.reset();
+                        dtok.set_wstate(DataTokenImpl::NONE);
+                        if (xidbuff) {
+                            ::free(xidbuff);
+                            xidbuff = NULL;
+                        }
+                        ::free(dbuff);
+                        dbuff = NULL;
+                        aio_sleep_cnt = 0;
+                        break;
+                    }
+                    data = &content[0];
+                    dbuffSize = content.size();
+                }
+
                 unsigned headerSize;
                 if (externalFlag) {
                     msg = getExternMessage(recovery, dtok.rid(), headerSize); // large message external to jrnl
@@ -1061,6 +1125,16 @@ void MessageStoreImpl::recoverTplStore()
     }
 }
 
+void MessageStoreImpl::recoverSharedContentStore()
+{
+    uint64_t thisHighestRid = 0ULL;
+    sharedContentPtr->recover(boost::dynamic_pointer_cast<qpid::linearstore::journal::EmptyFilePoolManager>(efpMgr), wCacheNumPages, wCachePgSizeSblks, thisHighestRid);
+    if (highestRid == 0ULL)
+        highestRid = thisHighestRid;
+    else if (thisHighestRid - highestRid  < 0x8000000000000000ULL) // RFC 1982 comparison for unsigned 64-bit
+        highestRid = thisHighestRid;
+}
+
 void MessageStoreImpl::recoverLockedMappings(txn_list& txns)
 {
     if (!tplStorePtr->is_ready())
@@ -1198,7 +1272,13 @@ void MessageStoreImpl::store(const qpid::broker::PersistableQueue* queue_,
             dtokp->set_rid(message_->getPersistenceId()); // set the messageID into the Journal header (record-id)
 
             JournalImpl* jc = static_cast<JournalImpl*>(queue_->getExternalQueueStore());
-            if (txn_->getXid().empty()) {
+            if (txn_->getXid().empty() && jc->isSharedContent()) {
+                // Write the message once to the shared content store, and only a reference to this queue
+                std::vector<char> refBuff;
+                chkSharedContentStoreInit();
+                sharedContentPtr->acquire(jc, message_, buff, refBuff);
+                jc->enqueue_data_record(&refBuff[0], refBuff.size(), refBuff.size(), dtokp.get(), !message_->isPersistent());
+            } else if (txn_->getXid().empty()) {
                 jc->enqueue_data_record(&buff[0], size, size, dtokp.get(), !message_->isPersistent());
             } else {
                 jc->enqueue_txn_data_record(&buff[0], size, size, dtokp.get(), txn_->getXid(), txn_->isTPC(), !message_->isPersistent());
@@ -1239,6 +1319,16 @@ void MessageStoreImpl::dequeue(qpid::broker::TransactionContext* ctxt_,
     if (ctxt_) txn->addXidRecord(queue_.getExternalQueueStore());
     async_dequeue(ctxt_, msg_, queue_);
     msg_->dequeueComplete();
+
+    // Transactional dequeues may yet be aborted, so their shared content is released on commit
+    JournalImpl* jc = static_cast<JournalImpl*>(queue_.getExternalQueueStore());
+    if (jc->isSharedContent()) {
+        if (ctxt_) {
+            txn->addSharedRef(jc, messageId);
+        } else {
+            sharedContentPtr->release(jc, messageId);
+        }
+    }
 }
 
 void MessageStoreImpl::async_dequeue(qpid::broker::TransactionContext* ctxt_,
@@ -1288,6 +1378,12 @@ void MessageStoreImpl::completed(TxnCtxt& txn_,
             tplStorePtr->dequeue_txn_data_record(txn_.getDtok(), txn_.getXid(), txn_.isTPC(), commit_);
         }
         txn_.complete(commit_);
+        TxnCtxt::sharedRefList sharedRefs;
+        txn_.takeSharedRefs(sharedRefs);
+        if (commit_) {
+            for (TxnCtxt::sharedRefList::const_iterator i = sharedRefs.begin(); i != sharedRefs.end(); ++i)
+                sharedContentPtr->release(i->first, i->second);
+        }
         if (mgmtObject.get() != 0) {
             mgmtObject->dec_tplTransactionDepth();
             if (commit_)
@@ -1506,6 +1602,13 @@ std::string MessageStoreImpl::getTplBaseDir()
     return dir.str();
 }
 
+std::string MessageStoreImpl::getSharedContentBaseDir()
+{
+    std::ostringstream dir;
+    dir << storeDir << "/" << storeTopLevelDir << "/content2/" ;
+    return dir.str();
+}
+
 std::string MessageStoreImpl::getJrnlDir(const std::string& queueName_)
 {
     std::ostringstream oss;
@@ -1528,7 +1631,9 @@ MessageStoreImpl::StoreOptions::StoreOptions(const std::string& name_) :
                                              efpPartition(defEfpPartition),
                                              efpFileSizeKib(defEfpFileSizeKib),
                                              overwriteBeforeReturnFlag(defOverwriteBeforeReturnFlag),
-                                             journalFlushTimeout(defJournalFlushTimeoutNs)
+                                             journalFlushTimeout(defJournalFlushTimeoutNs),
+                                             mappedReadBudgetMib(defMappedReadBudgetMib),
+                                             journalCompactionRateKib(defJournalCompactionRateKib)
 {
     addOptions()
         ("store-dir", qpid::optValue(storeDir, "DIR"),
@@ -1556,6 +1661,14 @@ MessageStoreImpl::StoreOptions::StoreOptions(const std::string& name_) :
                 "considerations justify it as it makes the store somewhat slower.")
         ("journal-flush-timeout", qpid::optValue(journalFlushTimeout, "SECONDS"),
                 "Maximum time to wait to flush journal")
+        ("mapped-read-budget", qpid::optValue(mappedReadBudgetMib, "N"),
+                "Maximum address space in MiB used to memory-map sealed journal files when reading records "
+                "back during recovery. Files are mapped read-only and released least recently used first. "
+                "0 disables mapping, in which case records are read using file I/O.")
+        ("journal-compaction-rate", qpid::optValue(journalCompactionRateKib, "N"),
+                "Rate in KiB/s per queue at which still-enqueued records are copied out of the oldest journal "
+                "file so that it can be returned to the Empty File Pool. 0 (the default) disables compaction. "
+                "Journals written with compaction enabled cannot be recovered by brokers which predate it.")
         ;
 }
 
@@ -30,6 +30,7 @@
 #include "qpid/linearstore/journal/jcfg.h"
 #include "qpid/linearstore/journal/EmptyFilePoolTypes.h"
 #include "qpid/linearstore/PreparedTransaction.h"
+#include "qpid/linearstore/SharedContentStore.h"
 #include "qpid/sys/Time.h"
 
 #include "qmf/org/apache/qpid/linearstore/Store.h"
@@ -85,6 +86,8 @@ class MessageStoreImpl : public qpid::broker::MessageStore, public qpid::managem
         uint64_t efpFileSizeKib;
         bool overwriteBeforeReturnFlag;
         qpid::sys::Duration journalFlushTimeout;
+        uint32_t mappedReadBudgetMib;
+        uint32_t journalCompactionRateKib;
     };
 
   private:
@@ -105,6 +108,8 @@ class MessageStoreImpl : public qpid::broker::MessageStore, public qpid::managem
     static const uint16_t defEfpPartition = 1;
     static const uint64_t defEfpFileSizeKib = 512 * QLS_SBLK_SIZE_KIB;
     static const bool defOverwriteBeforeReturnFlag = false;
+    static const uint32_t defMappedReadBudgetMib = 256;
+    static const uint32_t defJournalCompactionRateKib = 0;
     static const std::string storeTopLevelDir;
 
     // FIXME aconway 2010-03-09: was 10ms
@@ -123,8 +128,12 @@ class MessageStoreImpl : public qpid::broker::MessageStore, public qpid::managem
     // Pointer to Transaction Prepared List (TPL) journal instance
     boost::shared_ptr<TplJournalImpl> tplStorePtr;
     qpid::sys::Mutex tplInitLock;
+    // Broker-wide content journal for queues using qpid.store_shared_content
+    SharedContentStore::shared_ptr sharedContentPtr;
     JournalListMap journalList;
     qpid::sys::Mutex journalListLock;
+    // Runs journal compaction, which does blocking file reads, off the broker timer
+    boost::shared_ptr<qpid::sys::Timer> compactionTimer;
     qpid::sys::Mutex bdbLock;
 
     IdSequence queueIdSequence;
@@ -179,7 +188,8 @@ class MessageStoreImpl : public qpid::broker::MessageStore, public qpid::managem
                          txn_list& locked,
                          message_index& prepared,
                          long& rcnt,
-                         long& idcnt);
+                         long& idcnt,
+                         std::vector<uint64_t>& danglingRefs);
     qpid::broker::RecoverableMessage::shared_ptr getExternMessage(qpid::broker::RecoveryManager& recovery,
                                                                   uint64_t mId,
                                                                   unsigned& headerSize);
@@ -198,6 +208,7 @@ class MessageStoreImpl : public qpid::broker::MessageStore, public qpid::managem
                        txn_list& locked,
                        message_index& prepared);
     void recoverTplStore();
+    void recoverSharedContentStore();
     void recoverLockedMappings(txn_list& txns);
     TxnCtxt* check(qpid::broker::TransactionContext* ctxt);
     uint64_t msgEncode(std::vector<char>& buff, const boost::intrusive_ptr<qpid::broker::PersistableMessage>& message);
@@ -238,11 +249,13 @@ class MessageStoreImpl : public qpid::broker::MessageStore, public qpid::managem
     std::string getJrnlBaseDir();
     std::string getBdbBaseDir();
     std::string getTplBaseDir();
+    std::string getSharedContentBaseDir();
     inline void checkInit() {
         // TODO: change the default dir to ~/.qpidd
         if (!isInit) { init("/tmp"); isInit = true; }
     }
     void chkTplStoreInit();
+    void chkSharedContentStoreInit();
 
   public:
     typedef boost::shared_ptr<MessageStoreImpl> shared_ptr;
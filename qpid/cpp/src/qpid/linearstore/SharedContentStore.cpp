@@ -0,0 +1,269 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "qpid/linearstore/SharedContentStore.h"
+
+#include "qpid/broker/PersistableMessage.h"
+#include "qpid/framing/Buffer.h"
+#include "qpid/linearstore/DataTokenImpl.h"
+#include "qpid/linearstore/IdSequence.h"
+#include "qpid/linearstore/JournalImpl.h"
+#include "qpid/linearstore/JournalLogImpl.h"
+#include "qpid/linearstore/StoreException.h"
+#include "qpid/linearstore/journal/EmptyFilePoolManager.h"
+#include "qpid/linearstore/journal/jdir.h"
+#include "qpid/log/Statement.h"
+
+#include <algorithm>
+
+namespace qpid {
+namespace linearstore {
+
+SharedContentStore::SharedContentStore(::qpid::sys::Timer& timer,
+                                       const std::string& journalDirectory,
+                                       JournalLogImpl& journalLogRef,
+                                       const ::qpid::sys::Duration getEventsTimeout,
+                                       const ::qpid::sys::Duration flushTimeout,
+                                       IdSequence& messageIdSequence_) :
+        journal(new JournalImpl(timer, "SharedContentStore", journalDirectory, journalLogRef, getEventsTimeout, flushTimeout, 0)),
+        directory(journalDirectory),
+        messageIdSequence(messageIdSequence_)
+{}
+
+SharedContentStore::~SharedContentStore() {}
+
+void SharedContentStore::initialize(::qpid::linearstore::journal::EmptyFilePool* efpp,
+                                    const uint16_t wCacheNumPages,
+                                    const uint32_t wCachePgSizeSblks)
+{
+    ::qpid::sys::Mutex::ScopedLock sl(lock);
+    if (!journal->is_ready()) {
+        ::qpid::linearstore::journal::jdir::create_dir(directory);
+        journal->initialize(efpp, wCacheNumPages, wCachePgSizeSblks);
+    }
+}
+
+bool SharedContentStore::isReady() const
+{
+    return journal->is_ready();
+}
+
+void SharedContentStore::acquire(const JournalImpl* queueJournal,
+                                 const boost::intrusive_ptr< ::qpid::broker::PersistableMessage>& msg,
+                                 const std::vector<char>& encodedMsg,
+                                 std::vector<char>& refBuff)
+{
+    const uint64_t persistenceId = msg->getPersistenceId();
+    bool first;
+    {
+        ::qpid::sys::Mutex::ScopedLock sl(lock);
+        // The content record of an earlier use of this id must be dequeued before it is rewritten
+        while (releasing.count(persistenceId)) lock.wait();
+        std::pair<RefMap::iterator, bool> r = refs.insert(RefMap::value_type(persistenceId, RefList()));
+        r.first->second.push_back(queueJournal);
+        first = r.second;
+        if (first) writing.insert(persistenceId);
+    }
+    if (first) {
+        // First reference: write the content, outside the lock so that other queues are not held
+        // up behind the journal. The message is not complete until this record is on disk as well
+        // as the queue reference record.
+        boost::intrusive_ptr<DataTokenImpl> dtokp(new DataTokenImpl);
+        dtokp->addRef();
+        dtokp->setSourceMessage(msg);
+        dtokp->set_external_rid(true);
+        dtokp->set_rid(persistenceId);
+        msg->enqueueStart();
+        try {
+            journal->enqueue_data_record(&encodedMsg[0], encodedMsg.size(), encodedMsg.size(), dtokp.get(), false);
+        } catch (...) {
+            {
+                // Undo only this reference, others may have been added meanwhile. They refer to
+                // content that was never written, so it is not dequeued when they are released.
+                ::qpid::sys::Mutex::ScopedLock sl(lock);
+                writing.erase(persistenceId);
+                RefMap::iterator i = refs.find(persistenceId);
+                if (i != refs.end()) {
+                    removeRef(i, queueJournal);
+                    if (i->second.empty()) refs.erase(i);
+                    else unwritten.insert(persistenceId);
+                }
+            }
+            msg->enqueueComplete();
+            throw;
+        }
+        bool unreferenced = false;
+        {
+            ::qpid::sys::Mutex::ScopedLock sl(lock);
+            writing.erase(persistenceId);
+            // Every reference may have been released while the content was being written
+            RefMap::iterator i = refs.find(persistenceId);
+            if (i != refs.end() && i->second.empty()) {
+                refs.erase(i);
+                releasing.insert(persistenceId);
+                unreferenced = true;
+            }
+        }
+        if (unreferenced) dequeue(persistenceId);
+    }
+    refBuff.resize(refRecordSize);
+    ::qpid::framing::Buffer buffer(&refBuff[0], refRecordSize);
+    buffer.putLong(refMarker);
+    buffer.putLongLong(persistenceId);
+}
+
+void SharedContentStore::release(const JournalImpl* queueJournal, const uint64_t persistenceId)
+{
+    {
+        ::qpid::sys::Mutex::ScopedLock sl(lock);
+        RefMap::iterator i = refs.find(persistenceId);
+        if (i == refs.end() || !removeRef(i, queueJournal) || writing.count(persistenceId)) return;
+        refs.erase(i);
+        if (unwritten.erase(persistenceId)) return;
+        releasing.insert(persistenceId);
+    }
+    dequeue(persistenceId);
+}
+
+void SharedContentStore::releaseAll(const JournalImpl* queueJournal)
+{
+    std::vector<uint64_t> ids;
+    {
+        ::qpid::sys::Mutex::ScopedLock sl(lock);
+        for (RefMap::iterator i = refs.begin(); i != refs.end(); ) {
+            if (removeRef(i, queueJournal) && !writing.count(i->first)) {
+                if (!unwritten.erase(i->first)) {
+                    ids.push_back(i->first);
+                    releasing.insert(i->first);
+                }
+                refs.erase(i++);
+            } else {
+                ++i;
+            }
+        }
+    }
+    for (std::vector<uint64_t>::const_iterator i = ids.begin(); i != ids.end(); ++i)
+        dequeue(*i);
+}
+
+bool SharedContentStore::isReference(const char* data, const std::size_t size, uint64_t& persistenceId)
+{
+    if (size != refRecordSize) return false;
+    ::qpid::framing::Buffer buffer(const_cast<char*>(data), refRecordSize);
+    if (buffer.getLong() != refMarker) return false;
+    persistenceId = buffer.getLongLong();
+    return true;
+}
+
+void SharedContentStore::recover(boost::shared_ptr< ::qpid::linearstore::journal::EmptyFilePoolManager> efpm,
+                                 const uint16_t wCacheNumPages,
+                                 const uint32_t wCachePgSizeSblks,
+                                 uint64_t& highestRid)
+{
+    if (!::qpid::linearstore::journal::jdir::exists(directory)) return;
+    ::qpid::sys::Mutex::ScopedLock sl(lock);
+    try {
+        journal->recover(efpm, wCacheNumPages, wCachePgSizeSblks, 0, highestRid, 0);
+    } catch (const ::qpid::linearstore::journal::jexception& e) {
+        THROW_STORE_EXCEPTION(std::string("SharedContentStore: recover() failed: ") + e.what());
+    }
+    QLS_LOG(info, "Recovered shared content store: " << journal->get_enq_cnt() << " message(s)");
+}
+
+bool SharedContentStore::recoverReference(const JournalImpl* queueJournal, const uint64_t persistenceId, std::vector<char>& content)
+{
+    ::qpid::sys::Mutex::ScopedLock sl(lock);
+    if (!journal->is_ready()) return false;
+    try {
+        if (!journal->read_enqueued_record(persistenceId, content)) return false;
+    } catch (const ::qpid::linearstore::journal::jexception& e) {
+        THROW_STORE_EXCEPTION(std::string("SharedContentStore: recoverReference() failed: ") + e.what());
+    }
+    refs[persistenceId].push_back(queueJournal);
+    return true;
+}
+
+void SharedContentStore::recoverComplete()
+{
+    std::vector<uint64_t> unreferenced;
+    {
+        ::qpid::sys::Mutex::ScopedLock sl(lock);
+        if (!journal->is_ready()) return;
+        std::vector<uint64_t> rids;
+        journal->enq_rid_list(rids);
+        journal->recover_complete();
+        for (std::vector<uint64_t>::const_iterator i = rids.begin(); i != rids.end(); ++i) {
+            if (refs.find(*i) == refs.end()) {
+                unreferenced.push_back(*i);
+                releasing.insert(*i);
+            }
+        }
+    }
+    for (std::vector<uint64_t>::const_iterator i = unreferenced.begin(); i != unreferenced.end(); ++i)
+        dequeue(*i);
+    if (!unreferenced.empty()) {
+        QLS_LOG(info, "Shared content store: released " << unreferenced.size() << " unreferenced message(s)");
+    }
+}
+
+void SharedContentStore::stop()
+{
+    if (journal->is_ready()) journal->stop(true);
+}
+
+// Called with lock held, returns true if the last reference was removed
+bool SharedContentStore::removeRef(RefMap::iterator i, const JournalImpl* queueJournal)
+{
+    RefList::iterator j = std::find(i->second.begin(), i->second.end(), queueJournal);
+    if (j == i->second.end()) return false;
+    i->second.erase(j);
+    return i->second.empty();
+}
+
+// Called without lock held, after moving persistenceId from refs to releasing. The record is
+// written outside the lock as the journal has its own locking; a concurrent acquire() of the same
+// id waits until it is done.
+void SharedContentStore::dequeue(const uint64_t persistenceId)
+{
+    boost::intrusive_ptr<DataTokenImpl> ddtokp(new DataTokenImpl);
+    ddtokp->set_external_rid(true);
+    ddtokp->set_rid(messageIdSequence.next());
+    ddtokp->set_dequeue_rid(persistenceId);
+    ddtokp->set_wstate(DataTokenImpl::ENQ);
+    ddtokp->addRef();
+    try {
+        journal->dequeue_data_record(ddtokp.get(), false);
+    } catch (const ::qpid::linearstore::journal::jexception& e) {
+        ddtokp->release();
+        released(persistenceId);
+        THROW_STORE_EXCEPTION(std::string("SharedContentStore: dequeue() failed: ") + e.what());
+    }
+    released(persistenceId);
+}
+
+void SharedContentStore::released(const uint64_t persistenceId)
+{
+    ::qpid::sys::Mutex::ScopedLock sl(lock);
+    releasing.erase(persistenceId);
+    lock.notifyAll();
+}
+
+}} // namespace qpid::linearstore
@@ -0,0 +1,150 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#ifndef QPID_LINEARSTORE_SHAREDCONTENTSTORE_H
+#define QPID_LINEARSTORE_SHAREDCONTENTSTORE_H
+
+#include "qpid/linearstore/journal/EmptyFilePoolTypes.h"
+#include "qpid/sys/Monitor.h"
+#include "qpid/sys/Time.h"
+#include <boost/intrusive_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace qpid {
+namespace broker {
+    class PersistableMessage;
+}
+namespace sys {
+    class Timer;
+}
+namespace linearstore {
+namespace journal {
+    class EmptyFilePool;
+    class EmptyFilePoolManager;
+}
+
+class IdSequence;
+class JournalImpl;
+class JournalLogImpl;
+
+/**
+ * Broker-wide journal holding the encoded form of persistent messages enqueued on queues
+ * declared with qpid.store_shared_content. The message is written to this journal once, using
+ * its persistence id as the record id, and each queue journal records only a short reference
+ * to it. This avoids writing the same message body once per queue when a message is routed to
+ * many durable queues.
+ *
+ * The set of queue journals referring to each message is kept in memory and is rebuilt from the
+ * queue journals on recovery; content is read from the content journal as each reference is
+ * recovered, and any content record left unreferenced after recovery is dequeued. Only
+ * non-transactional enqueues use references. A transactional dequeue releases its reference when
+ * the transaction commits, so an abort can never leave a queue referring to content that has
+ * already been released.
+ *
+ * This relies on a message having a single persistence id however many queues it is routed to,
+ * which holds because the broker merges any annotations into the message before it is routed.
+ */
+class SharedContentStore
+{
+  public:
+    typedef boost::shared_ptr<SharedContentStore> shared_ptr;
+
+    SharedContentStore(::qpid::sys::Timer& timer,
+                       const std::string& journalDirectory,
+                       JournalLogImpl& journalLogRef,
+                       const ::qpid::sys::Duration getEventsTimeout,
+                       const ::qpid::sys::Duration flushTimeout,
+                       IdSequence& messageIdSequence);
+    ~SharedContentStore();
+
+    /** Initialize the content journal if it was not recovered */
+    void initialize(::qpid::linearstore::journal::EmptyFilePool* efpp,
+                    const uint16_t wCacheNumPages,
+                    const uint32_t wCachePgSizeSblks);
+
+    /**
+     * Add a reference from a queue journal to the message content, writing it to the content
+     * journal on the first reference. The message ingress completion is held until the content
+     * record is on disk. The queue record to be written in place of the full message is
+     * returned in refBuff.
+     */
+    void acquire(const JournalImpl* queueJournal,
+                 const boost::intrusive_ptr< ::qpid::broker::PersistableMessage>& msg,
+                 const std::vector<char>& encodedMsg,
+                 std::vector<char>& refBuff);
+
+    /**
+     * Remove a reference from a queue journal to the message content, dequeuing it on the last
+     * reference. Does nothing if the queue journal holds the full message rather than a reference.
+     */
+    void release(const JournalImpl* queueJournal, const uint64_t persistenceId);
+
+    /** Remove all references from a queue journal that is being deleted */
+    void releaseAll(const JournalImpl* queueJournal);
+
+    /** Test if a queue journal record is a reference, and if so which message it refers to */
+    static bool isReference(const char* data, const std::size_t size, uint64_t& persistenceId);
+
+    // Recovery: recover() must be called before the queue journals are read, and
+    // recoverComplete() after all the queues have been recovered.
+    void recover(boost::shared_ptr< ::qpid::linearstore::journal::EmptyFilePoolManager> efpm,
+                 const uint16_t wCacheNumPages,
+                 const uint32_t wCachePgSizeSblks,
+                 uint64_t& highestRid);
+    /**
+     * Read recovered content for a reference from the content journal and record the reference,
+     * returns false if not found. Content is read on demand, so no content is held in memory
+     * across the recovery of the queues.
+     */
+    bool recoverReference(const JournalImpl* queueJournal, const uint64_t persistenceId, std::vector<char>& content);
+    void recoverComplete();
+
+    void stop();
+    bool isReady() const;
+
+  private:
+    typedef std::vector<const JournalImpl*> RefList;
+    typedef std::map<uint64_t, RefList> RefMap;
+
+    static const uint32_t refMarker = 0xffffffff;
+    static const std::size_t refRecordSize = sizeof(uint32_t) + sizeof(uint64_t);
+
+    boost::shared_ptr<JournalImpl> journal;
+    const std::string directory;
+    IdSequence& messageIdSequence;
+    RefMap refs;
+    std::set<uint64_t> writing;     // Content records still being written, which must not be dequeued yet
+    std::set<uint64_t> releasing;   // Content records being dequeued, which must not be rewritten yet
+    std::set<uint64_t> unwritten;   // Referenced content whose write failed, which must not be dequeued
+    ::qpid::sys::Monitor lock;
+
+    void dequeue(const uint64_t persistenceId);
+    void released(const uint64_t persistenceId);
+    bool removeRef(RefMap::iterator i, const JournalImpl* queueJournal);
+};
+
+}} // namespace qpid::linearstore
+
+#endif // ifndef QPID_LINEARSTORE_SHAREDCONTENTSTORE_H
@@ -26,6 +26,8 @@
 #include "qpid/broker/TransactionalStore.h"
 #include "qpid/linearstore/IdSequence.h"
 #include "qpid/sys/uuid.h"
+#include <utility>
+#include <vector>
 
 class DbEnv;
 class DbTxn;
@@ -52,7 +54,12 @@ class TxnCtxt : public qpid::broker::TransactionContext
     typedef ipqdef::iterator ipqItr;
     typedef std::auto_ptr<qpid::sys::Mutex::ScopedLock> AutoScopedLock;
 
+  public:
+    typedef std::vector<std::pair<JournalImpl*, uint64_t> > sharedRefList;
+
+  protected:
     ipqdef impactedQueues; // list of Queues used in the txn
+    sharedRefList sharedRefs; // shared content references dequeued in the txn, released on commit
     IdSequence* loggedtx;
     boost::intrusive_ptr<DataTokenImpl> dtokp;
     AutoScopedLock globalHolder;
@@ -88,6 +95,8 @@ class TxnCtxt : public qpid::broker::TransactionContext
     virtual const std::string& getXid();
 
     void addXidRecord(qpid::broker::ExternalQueueStore* queue);
+    inline void addSharedRef(JournalImpl* jc, const uint64_t persistenceId) { sharedRefs.push_back(std::make_pair(jc, persistenceId)); }
+    inline void takeSharedRefs(sharedRefList& refs) { refs.swap(sharedRefs); sharedRefs.clear(); }
     inline void prepare(JournalImpl* _preparedXidStorePtr) { preparedXidStorePtr = _preparedXidStorePtr; }
     void complete(bool commit);
     bool impactedQueuesEmpty();
@@ -174,6 +174,30 @@ uint64_t LinearFileController::getCurrentSerial() const {
     return currentJournalFilePtr_->getSerial();
 }
 
+uint32_t LinearFileController::getCurrentSubmittedDblkCount() const {
+    assertCurrentJournalFileValid("getCurrentSubmittedDblkCount");
+    return currentJournalFilePtr_->getSubmittedDblkCount();
+}
+
+bool LinearFileController::getRelocationSourceFile(uint64_t& fileSeqNumber,
+                                                   uint64_t& serial,
+                                                   std::string& fqFileName) {
+    slock l(journalFileListMutex_);
+    // The oldest file is only considered once at least two newer files exist, so that it can no longer
+    // be receiving writes and all of its AIO operations are long complete
+    if (journalFileList_.size() < 3) {
+        return false;
+    }
+    JournalFile* jfp = journalFileList_.front();
+    if (jfp == currentJournalFilePtr_ || jfp->isNoEnqueuedRecordsRemaining() || jfp->getOutstandingAioOperationCount() > 0) {
+        return false;
+    }
+    fileSeqNumber = jfp->getFileSeqNum();
+    serial = jfp->getSerial();
+    fqFileName = jfp->getFqFileName();
+    return true;
+}
+
 bool LinearFileController::isEmpty() const {
     assertCurrentJournalFileValid("isEmpty");
     return currentJournalFilePtr_->isEmpty();
@@ -93,8 +93,14 @@ public:
 
     uint64_t getCurrentFileSeqNum() const;
     uint64_t getCurrentSerial() const;
+    uint32_t getCurrentSubmittedDblkCount() const;
     bool isEmpty() const;
 
+    // Compaction support: oldest file, if sealed and still holding enqueued records
+    bool getRelocationSourceFile(uint64_t& fileSeqNumber,
+                                 uint64_t& serial,
+                                 std::string& fqFileName);
+
     // Debug aid
     const std::string status(const uint8_t indentDepth) const;
 
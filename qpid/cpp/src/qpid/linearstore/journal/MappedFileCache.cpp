@@ -0,0 +1,158 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "qpid/linearstore/journal/MappedFileCache.h"
+
+#include <fcntl.h>
+#include "qpid/linearstore/journal/jerrno.h"
+#include "qpid/linearstore/journal/jexception.h"
+#include "qpid/linearstore/journal/slock.h"
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace qpid {
+namespace linearstore {
+namespace journal {
+
+// static
+std::size_t MappedFileCache::s_budget_ = 0;
+// static
+std::size_t MappedFileCache::s_totalMappedSize_ = 0;
+// static
+smutex MappedFileCache::s_mutex_;
+
+MappedFileCache::Mapping_t::Mapping_t(const uint64_t fileNumber, const char* address, const std::size_t size) :
+                fileNumber_(fileNumber),
+                address_(address),
+                size_(size)
+{}
+
+MappedFileCache::MappedFileCache() :
+                mappedSize_(0)
+{}
+
+MappedFileCache::~MappedFileCache() {
+    clear();
+}
+
+const char* MappedFileCache::get(const uint64_t fileNumber, const std::string& fqFileName, std::size_t& fileSize) {
+    mappingMapItr_t i = mappingMap_.find(fileNumber);
+    if (i != mappingMap_.end()) {
+        lruList_.splice(lruList_.begin(), lruList_, i->second);
+        fileSize = i->second->size_;
+        return i->second->address_;
+    }
+    if (s_budget_ == 0) {
+        return 0;
+    }
+
+    int fd = ::open(fqFileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::ostringstream oss;
+        oss << "file=\"" << fqFileName << "\"" << FORMAT_SYSERR(errno);
+        throw jexception(jerrno::JERR__FILEIO, oss.str(), "MappedFileCache", "get");
+    }
+    struct stat s;
+    if (::fstat(fd, &s) < 0) {
+        ::close(fd);
+        std::ostringstream oss;
+        oss << "file=\"" << fqFileName << "\"" << FORMAT_SYSERR(errno);
+        throw jexception(jerrno::JERR__FILEIO, oss.str(), "MappedFileCache", "get");
+    }
+    std::size_t size = s.st_size;
+    if (size == 0 || size > s_budget_) {
+        ::close(fd);
+        return 0;
+    }
+    if (!reserve(size)) {
+        ::close(fd);
+        return 0;
+    }
+    void* addr = ::mmap(0, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        // Not fatal; the caller falls back to reading the file
+        slock l(s_mutex_);
+        s_totalMappedSize_ -= size;
+        return 0;
+    }
+    ::madvise(addr, size, MADV_SEQUENTIAL);
+
+    lruList_.push_front(Mapping_t(fileNumber, (const char*)addr, size));
+    mappingMap_[fileNumber] = lruList_.begin();
+    mappedSize_ += size;
+    fileSize = size;
+    return (const char*)addr;
+}
+
+void MappedFileCache::clear() {
+    slock l(s_mutex_);
+    while (!lruList_.empty()) {
+        unmapLeastRecentlyUsed();
+    }
+}
+
+// static
+void MappedFileCache::setBudget(const std::size_t budget) {
+    s_budget_ = budget;
+}
+
+// static
+std::size_t MappedFileCache::getBudget() {
+    return s_budget_;
+}
+
+// static
+std::size_t MappedFileCache::totalMappedSize() {
+    slock l(s_mutex_);
+    return s_totalMappedSize_;
+}
+
+// protected
+// Accounts for required bytes against the store-wide budget, first releasing this cache's least recently
+// used mappings as needed. Returns false, releasing nothing, if the mappings of other caches leave too
+// little room.
+bool MappedFileCache::reserve(const std::size_t required) {
+    slock l(s_mutex_);
+    if (s_totalMappedSize_ - mappedSize_ + required > s_budget_) {
+        return false;
+    }
+    while (s_totalMappedSize_ + required > s_budget_) {
+        unmapLeastRecentlyUsed();
+    }
+    s_totalMappedSize_ += required;
+    return true;
+}
+
+// protected
+// Must be called with s_mutex_ held
+void MappedFileCache::unmapLeastRecentlyUsed() {
+    Mapping_t& m = lruList_.back();
+    ::munmap((void*)m.address_, m.size_);
+    mappedSize_ -= m.size_;
+    s_totalMappedSize_ -= m.size_;
+    mappingMap_.erase(m.fileNumber_);
+    lruList_.pop_back();
+}
+
+}}}
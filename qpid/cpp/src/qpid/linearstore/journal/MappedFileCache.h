@@ -0,0 +1,89 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#ifndef QPID_LINEARSTORE_JOURNAL_MAPPEDFILECACHE_H_
+#define QPID_LINEARSTORE_JOURNAL_MAPPEDFILECACHE_H_
+
+#include <list>
+#include <map>
+#include "qpid/linearstore/journal/smutex.h"
+#include <stdint.h>
+#include <string>
+
+namespace qpid {
+namespace linearstore {
+namespace journal {
+
+/**
+ * LRU of read-only memory mappings of sealed (fully written) journal files, used to read records
+ * without seek/read syscalls or stream buffering. The total size of the files mapped at any one
+ * time by all caches in the store is bounded by a store-wide address space budget; when a new mapping
+ * would exceed it, the least recently used mappings of this cache are released first. If mappings held
+ * by other caches still leave too little room, the file is not mapped. A budget of 0 disables mapping
+ * altogether.
+ *
+ * Only files which will not be written again may be mapped. A mapping must not outlive the file's
+ * ownership by its journal, as files are returned to the Empty File Pool and reused; call clear()
+ * before that can happen.
+ */
+class MappedFileCache
+{
+protected:
+    struct Mapping_t {
+        uint64_t fileNumber_;
+        const char* address_;
+        std::size_t size_;
+        Mapping_t(const uint64_t fileNumber, const char* address, const std::size_t size);
+    };
+    typedef std::list<Mapping_t> mappingList_t;
+    typedef mappingList_t::iterator mappingListItr_t;
+    typedef std::map<uint64_t, mappingListItr_t> mappingMap_t;
+    typedef mappingMap_t::iterator mappingMapItr_t;
+
+    static std::size_t s_budget_;               ///< Upper bound on total mapped bytes
+    static std::size_t s_totalMappedSize_;      ///< Bytes currently mapped by all caches
+    static smutex s_mutex_;                     ///< Protects s_totalMappedSize_
+    mappingList_t lruList_;                     ///< Mappings, most recently used first
+    mappingMap_t mappingMap_;                   ///< File number to position in lruList_
+    std::size_t mappedSize_;                    ///< Total bytes currently mapped
+
+public:
+    MappedFileCache();
+    virtual ~MappedFileCache();
+
+    // Returns a pointer to the start of the mapped file and sets fileSize, or 0 if the file cannot be
+    // mapped within the budget. The pointer remains valid until the next call to get() or clear().
+    const char* get(const uint64_t fileNumber, const std::string& fqFileName, std::size_t& fileSize);
+    void clear();
+    inline std::size_t mappedSize() const { return mappedSize_; }
+
+    static void setBudget(const std::size_t budget);
+    static std::size_t getBudget();
+    static std::size_t totalMappedSize();
+
+protected:
+    bool reserve(const std::size_t required);
+    void unmapLeastRecentlyUsed();
+};
+
+}}}
+
+#endif // QPID_LINEARSTORE_JOURNAL_MAPPEDFILECACHE_H_
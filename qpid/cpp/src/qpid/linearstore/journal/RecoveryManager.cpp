@@ -23,6 +23,7 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <iomanip>
 #include "qpid/linearstore/journal/Checksum.h"
 #include "qpid/linearstore/journal/data_tok.h"
@@ -201,26 +202,32 @@ bool RecoveryManager::readNextRemainingRecord(void** const dataPtrPtr,
         }
     } while (!foundRecord);
 
-    if (!inFileStream_.is_open() || currentJournalFileItr_->first != recordIdListConstItr_->fileId_) {
-        if (!getFile(recordIdListConstItr_->fileId_, false)) {
+    ::enq_hdr_t enqueueHeader;
+    ::rec_tail_t enqueueTail;
+    const char* mappedXidPtr = 0;
+    const char* mappedDataPtr = 0;
+    const bool mappedFlag = getMappedRecord(enqueueHeader, mappedXidPtr, mappedDataPtr, enqueueTail);
+    if (!mappedFlag) {
+        if (!inFileStream_.is_open() || currentJournalFileItr_->first != recordIdListConstItr_->fileId_) {
+            if (!getFile(recordIdListConstItr_->fileId_, false)) {
+                std::ostringstream oss;
+                oss << "Failed to open file with file-id=" << recordIdListConstItr_->fileId_;
+                throw jexception(jerrno::JERR__FILEIO, oss.str(), "RecoveryManager", "readNextRemainingRecord");
+            }
+        }
+        inFileStream_.seekg(recordIdListConstItr_->fileOffset_, std::ifstream::beg);
+        if (!inFileStream_.good()) {
             std::ostringstream oss;
-            oss << "Failed to open file with file-id=" << recordIdListConstItr_->fileId_;
+            oss << "Could not find offset 0x" << std::hex << recordIdListConstItr_->fileOffset_ << " in file " << getCurrentFileName();
             throw jexception(jerrno::JERR__FILEIO, oss.str(), "RecoveryManager", "readNextRemainingRecord");
         }
-    }
-    inFileStream_.seekg(recordIdListConstItr_->fileOffset_, std::ifstream::beg);
-    if (!inFileStream_.good()) {
-        std::ostringstream oss;
-        oss << "Could not find offset 0x" << std::hex << recordIdListConstItr_->fileOffset_ << " in file " << getCurrentFileName();
-        throw jexception(jerrno::JERR__FILEIO, oss.str(), "RecoveryManager", "readNextRemainingRecord");
-    }
 
-    ::enq_hdr_t enqueueHeader;
-    inFileStream_.read((char*)&enqueueHeader, sizeof(::enq_hdr_t));
-    if (inFileStream_.gcount() != sizeof(::enq_hdr_t)) {
-        std::ostringstream oss;
-        oss << "Could not read enqueue header from file " << getCurrentFileName() << " at offset 0x" << std::hex << recordIdListConstItr_->fileOffset_;
-        throw jexception(jerrno::JERR__FILEIO, oss.str(), "RecoveryManager", "readNextRemainingRecord");
+        inFileStream_.read((char*)&enqueueHeader, sizeof(::enq_hdr_t));
+        if (inFileStream_.gcount() != sizeof(::enq_hdr_t)) {
+            std::ostringstream oss;
+            oss << "Could not read enqueue header from file " << getCurrentFileName() << " at offset 0x" << std::hex << recordIdListConstItr_->fileOffset_;
+            throw jexception(jerrno::JERR__FILEIO, oss.str(), "RecoveryManager", "readNextRemainingRecord");
+        }
     }
     // check flags
     transient = ::is_enq_transient(&enqueueHeader);
@@ -234,7 +241,11 @@ bool RecoveryManager::readNextRemainingRecord(void** const dataPtrPtr,
         oss << "xidPtr, size=0x" << std::hex << xidSize;
         throw jexception(jerrno::JERR__MALLOC, oss.str(), "RecoveryManager", "readNextRemainingRecord");
     }
-    readJournalData((char*)*xidPtrPtr, xidSize);
+    if (mappedFlag) {
+        ::memcpy(*xidPtrPtr, mappedXidPtr, xidSize);
+    } else {
+        readJournalData((char*)*xidPtrPtr, xidSize);
+    }
 
     // read data
     dataSize = enqueueHeader._dsize;
@@ -244,7 +255,11 @@ bool RecoveryManager::readNextRemainingRecord(void** const dataPtrPtr,
         oss << "dataPtr, size=0x" << std::hex << dataSize;
         throw jexception(jerrno::JERR__MALLOC, oss.str(), "RecoveryManager", "readNextRemainingRecord");
     }
-    readJournalData((char*)*dataPtrPtr, dataSize);
+    if (mappedFlag) {
+        ::memcpy(*dataPtrPtr, mappedDataPtr, dataSize);
+    } else {
+        readJournalData((char*)*dataPtrPtr, dataSize);
+    }
 
     // Check enqueue record checksum
     Checksum checksum;
@@ -255,8 +270,9 @@ bool RecoveryManager::readNextRemainingRecord(void** const dataPtrPtr,
     if (dataSize > 0) {
         checksum.addData((const unsigned char*)*dataPtrPtr, dataSize);
     }
-    ::rec_tail_t enqueueTail;
-    readJournalData((char*)&enqueueTail, sizeof(::rec_tail_t));
+    if (!mappedFlag) {
+        readJournalData((char*)&enqueueTail, sizeof(::rec_tail_t));
+    }
     uint32_t cs = checksum.getChecksum();
     uint16_t res = ::rec_tail_check(&enqueueTail, &enqueueHeader._rhdr, cs);
     if (res != 0) {
@@ -289,10 +305,55 @@ bool RecoveryManager::readNextRemainingRecord(void** const dataPtrPtr,
     return true;
 }
 
+// Reads the data of a single enqueue record, which may span files, without disturbing the sequential
+// read of remaining records. Returns false if no enqueue record with recordId is found at fileOffset.
+bool RecoveryManager::readRecord(const uint64_t fileId,
+                                 const std::streamoff fileOffset,
+                                 const uint64_t recordId,
+                                 std::vector<char>& data) {
+    if (!inFileStream_.is_open() || currentJournalFileItr_->first != fileId) {
+        if (!getFile(fileId, false)) {
+            return false;
+        }
+    }
+    inFileStream_.seekg(fileOffset, std::ifstream::beg);
+    ::enq_hdr_t enqueueHeader;
+    inFileStream_.read((char*)&enqueueHeader, sizeof(::enq_hdr_t));
+    if (inFileStream_.gcount() != sizeof(::enq_hdr_t) ||
+        enqueueHeader._rhdr._magic != QLS_ENQ_MAGIC ||
+        enqueueHeader._rhdr._rid != recordId ||
+        ::is_enq_external(&enqueueHeader)) {
+        inFileStream_.clear();
+        return false;
+    }
+
+    Checksum checksum;
+    checksum.addData((const unsigned char*)&enqueueHeader, sizeof(::enq_hdr_t));
+    if (enqueueHeader._xidsize > 0) {
+        std::vector<char> xid(enqueueHeader._xidsize);
+        readJournalData(&xid[0], xid.size());
+        checksum.addData((const unsigned char*)&xid[0], xid.size());
+    }
+    data.resize(enqueueHeader._dsize);
+    if (!data.empty()) {
+        readJournalData(&data[0], data.size());
+        checksum.addData((const unsigned char*)&data[0], data.size());
+    }
+    ::rec_tail_t enqueueTail;
+    readJournalData((char*)&enqueueTail, sizeof(::rec_tail_t));
+    if (::rec_tail_check(&enqueueTail, &enqueueHeader._rhdr, checksum.getChecksum()) != 0) {
+        std::ostringstream oss;
+        oss << "Bad record tail: rid=0x" << std::hex << recordId << " file-id=0x" << fileId << " offset=0x" << fileOffset;
+        throw jexception(jerrno::JERR_JREC_BADRECTAIL, oss.str(), "RecoveryManager", "readRecord");
+    }
+    return true;
+}
+
 void RecoveryManager::recoveryComplete() {
     if(inFileStream_.is_open()) {
         inFileStream_.close();
     }
+    mappedFileCache_.clear();
 }
 
 void RecoveryManager::setLinearFileControllerJournals(lfcAddJournalFileFn fnPtr,
@@ -546,6 +607,40 @@ uint64_t RecoveryManager::getCurrentFileNumber() const {
     return currentJournalFileItr_->first;
 }
 
+// Locates the record at recordIdListConstItr_ in a mapped journal file. Only sealed files (all but the last
+// file, which is still being written) are mapped, and only records lying entirely within one file are read
+// this way; false is returned otherwise and the caller must read the record from the file stream.
+bool RecoveryManager::getMappedRecord(::enq_hdr_t& enqueueHeader,
+                                      const char*& xidPtr,
+                                      const char*& dataPtr,
+                                      ::rec_tail_t& enqueueTail) {
+    if (MappedFileCache::getBudget() == 0) {
+        return false;
+    }
+    fileNumberMapConstItr_t fileItr = fileNumberMap_.find(recordIdListConstItr_->fileId_);
+    if (fileItr == fileNumberMap_.end() || fileItr->first == fileNumberMap_.rbegin()->first) {
+        return false;
+    }
+    std::size_t fileSize = 0;
+    const char* filePtr = mappedFileCache_.get(fileItr->first, fileItr->second->journalFilePtr_->getFqFileName(), fileSize);
+    if (filePtr == 0) {
+        return false;
+    }
+    const std::size_t recordOffset = recordIdListConstItr_->fileOffset_;
+    if (recordOffset + sizeof(::enq_hdr_t) > fileSize) {
+        return false;
+    }
+    ::memcpy(&enqueueHeader, filePtr + recordOffset, sizeof(::enq_hdr_t));
+    const std::size_t recordSize = sizeof(::enq_hdr_t) + enqueueHeader._xidsize + enqueueHeader._dsize + sizeof(::rec_tail_t);
+    if (recordOffset + recordSize > fileSize) {
+        return false; // Record continues in next file
+    }
+    xidPtr = filePtr + recordOffset + sizeof(::enq_hdr_t);
+    dataPtr = xidPtr + enqueueHeader._xidsize;
+    ::memcpy(&enqueueTail, dataPtr + enqueueHeader._dsize, sizeof(::rec_tail_t));
+    return true;
+}
+
 bool RecoveryManager::getFile(const uint64_t fileNumber, bool jumpToFirstRecordOffsetFlag) {
     if (inFileStream_.is_open()) {
         inFileStream_.close();
@@ -674,7 +769,13 @@ bool RecoveryManager::getNextRecordHeader()
                             throw jexception(jerrno::JERR_MAP_NOTFOUND, oss.str(), "RecoveryManager", "getNextRecordHeader");
                         }
                     } else {
-                        if (enqueueMapRef_.insert_pfid(h._rid, start_fid, file_pos) < enq_map::EMAP_OK) { // fail
+                        uint64_t old_fid;
+                        // A relocated (compacted) copy supersedes the original if that is still present in
+                        // the journal; if the original file has since been released, it is a plain enqueue.
+                        if (er.is_relocated() &&
+                            enqueueMapRef_.relocate_pfid(h._rid, start_fid, file_pos, old_fid) == enq_map::EMAP_OK) {
+                            fileNumberMap_[old_fid]->journalFilePtr_->decrEnqueuedRecordCount();
+                        } else if (enqueueMapRef_.insert_pfid(h._rid, start_fid, file_pos) < enq_map::EMAP_OK) { // fail
                             // The only error code emap::insert_pfid() returns is enq_map::EMAP_DUP_RID.
                             std::ostringstream oss;
                             oss << std::hex << "rid=0x" << h._rid << " _pfid=0x" << start_fid;
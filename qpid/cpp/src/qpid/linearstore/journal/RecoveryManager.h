@@ -25,11 +25,14 @@
 #include <fstream>
 #include <map>
 #include "qpid/linearstore/journal/LinearFileController.h"
+#include "qpid/linearstore/journal/MappedFileCache.h"
 #include <stdint.h>
 #include <vector>
 
+struct enq_hdr_t;
 struct file_hdr_t;
 struct rec_hdr_t;
+struct rec_tail_t;
 
 namespace qpid {
 namespace linearstore {
@@ -98,6 +101,7 @@ protected:
     std::ifstream inFileStream_;
     recordIdList_t recordIdList_;
     recordIdListConstItr_t recordIdListConstItr_;
+    MappedFileCache mappedFileCache_;           ///< Mappings of sealed files for reading remaining records
 
 public:
     RecoveryManager(const std::string& journalDirectory,
@@ -122,6 +126,10 @@ public:
                                  bool& external,
                                  data_tok* const dtokp,
                                  bool ignore_pending_txns);
+    bool readRecord(const uint64_t fileId,
+                    const std::streamoff fileOffset,
+                    const uint64_t recordId,
+                    std::vector<char>& data);
     void recoveryComplete();
     void setLinearFileControllerJournals(lfcAddJournalFileFn fnPtr,
                                          LinearFileController* lfcPtr);
@@ -136,6 +144,10 @@ protected:
                       const uint64_t start_fid,
                       const std::streampos recordOffset);
     std::string getCurrentFileName() const;
+    bool getMappedRecord(::enq_hdr_t& enqueueHeader,
+                         const char*& xidPtr,
+                         const char*& dataPtr,
+                         ::rec_tail_t& enqueueTail);
     uint64_t getCurrentFileNumber() const;
     bool getFile(const uint64_t fileNumber, bool jumpToFirstRecordOffsetFlag);
     bool getNextFile(bool jumpToFirstRecordOffsetFlag);
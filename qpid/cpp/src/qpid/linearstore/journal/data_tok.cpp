@@ -42,7 +42,12 @@ data_tok::data_tok():
     _rid(0),
     _xid(),
     _dequeue_rid(0),
-    _external_rid(false)
+    _external_rid(false),
+    _start_ts(),
+    _subm_ts(),
+    _compl_ts(),
+    _relocated(false),
+    _relocated_fid(0)
 {
     slock s(_mutex);
     _icnt = _cnt++;
@@ -110,6 +115,11 @@ data_tok::reset()
     _fid = 0;
     _rid = 0;
     _xid.clear();
+    _start_ts.set_zero();
+    _subm_ts.set_zero();
+    _compl_ts.set_zero();
+    _relocated = false;
+    _relocated_fid = 0;
 }
 
 // debug aid
@@ -30,6 +30,7 @@ class data_tok;
 
 #include <cassert>
 #include "qpid/linearstore/journal/smutex.h"
+#include "qpid/linearstore/journal/time_ns.h"
 
 namespace qpid {
 namespace linearstore {
@@ -80,6 +81,11 @@ namespace journal {
         std::string _xid;           ///< XID set by enqueue operation
         uint64_t    _dequeue_rid;   ///< RID of data set by dequeue operation
         bool        _external_rid;  ///< Flag to indicate external setting of rid
+        time_ns     _start_ts;      ///< Time operation was passed to the journal (latency instrumentation)
+        time_ns     _subm_ts;       ///< Time last page containing this record was submitted to AIO
+        time_ns     _compl_ts;      ///< Time AIO completion event for last page was returned
+        bool        _relocated;     ///< Enqueue is a compaction copy of an existing record
+        uint64_t    _relocated_fid; ///< FID holding the original record being relocated
 
     public:
         data_tok();
@@ -122,6 +128,18 @@ namespace journal {
         inline void set_xid(const void* xidp, const std::size_t xid_len)
                 { _xid.assign((const char*)xidp, xid_len); }
 
+        inline const time_ns& start_ts() const { return _start_ts; }
+        inline void set_start_ts() { _start_ts.now(); _subm_ts.set_zero(); _compl_ts.set_zero(); }
+        inline const time_ns& subm_ts() const { return _subm_ts; }
+        inline const time_ns& compl_ts() const { return _compl_ts; }
+        inline void set_aio_ts(const time_ns& subm_ts, const time_ns& compl_ts)
+                { _subm_ts = subm_ts; _compl_ts = compl_ts; }
+
+        inline bool is_relocated() const { return _relocated; }
+        inline uint64_t relocated_fid() const { return _relocated_fid; }
+        inline void set_relocated(const uint64_t relocated_fid)
+                { _relocated = true; _relocated_fid = relocated_fid; }
+
         void reset();
 
         // debug aid
@@ -22,6 +22,7 @@
 #include "qpid/linearstore/journal/enq_map.h"
 
 #include "qpid/linearstore/journal/slock.h"
+#include <algorithm>
 
 namespace qpid {
 namespace linearstore {
@@ -36,9 +37,21 @@ int16_t enq_map::EMAP_FALSE = 0;
 int16_t enq_map::EMAP_TRUE = 1;
 
 enq_map::enq_map():
-        _map(){}
+        _window(),
+        _base_key(0),
+        _sparse(),
+        _size(0),
+        _thin_run(0),
+        _bypass(false),
+        _probe_key(0),
+        _probe_cnt(0),
+        _scan_pfid(0),
+        _scan_rid(0),
+        _scan_window(false){}
 
-enq_map::~enq_map() {}
+enq_map::~enq_map() {
+    clear();
+}
 
 
 short
@@ -50,14 +63,13 @@ enq_map::insert_pfid(const uint64_t rid, const uint64_t pfid, const std::streamp
 short
 enq_map::insert_pfid(const uint64_t rid, const uint64_t pfid, const std::streampos file_posn, const bool locked)
 {
-    std::pair<emap_itr, bool> ret;
-    emap_data_struct_t rec(pfid, file_posn, locked);
-    {
-        slock s(_mutex);
-        ret = _map.insert(emap_param(rid, rec));
-    }
-    if (ret.second == false)
+    slock s(_mutex);
+    uint64_t bit;
+    if (find_chunk(rid, bit) != 0 || _sparse.find(rid) != _sparse.end())
         return EMAP_DUP_RID;
+    if (!insert_chunk(rid, pfid, std::streamoff(file_posn), locked))
+        _sparse.insert(emap_param(rid, emap_data_struct_t(pfid, file_posn, locked)));
+    ++_size;
     return EMAP_OK;
 }
 
@@ -65,8 +77,16 @@ short
 enq_map::get_pfid(const uint64_t rid, uint64_t& pfid)
 {
     slock s(_mutex);
-    emap_itr itr = _map.find(rid);
-    if (itr == _map.end()) // not found in map
+    uint64_t bit;
+    chunk_t* cp = find_chunk(rid, bit);
+    if (cp != 0) {
+        if (cp->_locked & bit)
+            return EMAP_LOCKED;
+        pfid = cp->_pfid[rid & (CHUNK_SIZE - 1)];
+        return EMAP_OK;
+    }
+    emap_itr itr = _sparse.find(rid);
+    if (itr == _sparse.end()) // not found in map
         return EMAP_RID_NOT_FOUND;
     if (itr->second._lock)
         return EMAP_LOCKED;
@@ -78,21 +98,40 @@ short
 enq_map::get_remove_pfid(const uint64_t rid, uint64_t& pfid, const bool txn_flag)
 {
     slock s(_mutex);
-    emap_itr itr = _map.find(rid);
-    if (itr == _map.end()) // not found in map
+    uint64_t bit;
+    chunk_t* cp = find_chunk(rid, bit);
+    if (cp != 0) {
+        if ((cp->_locked & bit) && !txn_flag) // locked, but not a commit/abort
+            return EMAP_LOCKED;
+        pfid = cp->_pfid[rid & (CHUNK_SIZE - 1)];
+        remove_chunk_bit(rid >> CHUNK_SHIFT, cp, bit);
+        --_size;
+        return EMAP_OK;
+    }
+    emap_itr itr = _sparse.find(rid);
+    if (itr == _sparse.end()) // not found in map
         return EMAP_RID_NOT_FOUND;
     if (itr->second._lock && !txn_flag) // locked, but not a commit/abort
         return EMAP_LOCKED;
     pfid = itr->second._pfid;
-    _map.erase(itr);
+    _sparse.erase(itr);
+    --_size;
     return EMAP_OK;
 }
 
 short
 enq_map::get_file_posn(const uint64_t rid, std::streampos& file_posn) {
     slock s(_mutex);
-    emap_itr itr = _map.find(rid);
-    if (itr == _map.end()) // not found in map
+    uint64_t bit;
+    chunk_t* cp = find_chunk(rid, bit);
+    if (cp != 0) {
+        if (cp->_locked & bit)
+            return EMAP_LOCKED;
+        file_posn = cp->_file_posn[rid & (CHUNK_SIZE - 1)];
+        return EMAP_OK;
+    }
+    emap_itr itr = _sparse.find(rid);
+    if (itr == _sparse.end()) // not found in map
         return EMAP_RID_NOT_FOUND;
     if (itr->second._lock)
         return EMAP_LOCKED;
@@ -100,11 +139,45 @@ enq_map::get_file_posn(const uint64_t rid, std::streampos& file_posn) {
     return EMAP_OK;
 }
 
+short
+enq_map::relocate_pfid(const uint64_t rid, const uint64_t pfid, const std::streampos file_posn, uint64_t& old_pfid) {
+    slock s(_mutex);
+    uint64_t bit;
+    chunk_t* cp = find_chunk(rid, bit);
+    if (cp != 0) {
+        if (cp->_locked & bit)
+            return EMAP_LOCKED;
+        const uint64_t offs = rid & (CHUNK_SIZE - 1);
+        old_pfid = cp->_pfid[offs];
+        cp->_pfid[offs] = pfid;
+        cp->_file_posn[offs] = file_posn;
+        return EMAP_OK;
+    }
+    emap_itr itr = _sparse.find(rid);
+    if (itr == _sparse.end()) // not found in map
+        return EMAP_RID_NOT_FOUND;
+    if (itr->second._lock)
+        return EMAP_LOCKED;
+    old_pfid = itr->second._pfid;
+    itr->second._pfid = pfid;
+    itr->second._file_posn = file_posn;
+    return EMAP_OK;
+}
+
 short
 enq_map::get_data(const uint64_t rid, emap_data_struct_t& eds) {
     slock s(_mutex);
-    emap_itr itr = _map.find(rid);
-    if (itr == _map.end()) // not found in map
+    uint64_t bit;
+    chunk_t* cp = find_chunk(rid, bit);
+    if (cp != 0) {
+        const uint64_t offs = rid & (CHUNK_SIZE - 1);
+        eds._pfid = cp->_pfid[offs];
+        eds._file_posn = cp->_file_posn[offs];
+        eds._lock = (cp->_locked & bit) != 0;
+        return EMAP_OK;
+    }
+    emap_itr itr = _sparse.find(rid);
+    if (itr == _sparse.end()) // not found in map
         return EMAP_RID_NOT_FOUND;
     eds._pfid = itr->second._pfid;
     eds._file_posn = itr->second._file_posn;
@@ -116,8 +189,12 @@ bool
 enq_map::is_enqueued(const uint64_t rid, bool ignore_lock)
 {
     slock s(_mutex);
-    emap_itr itr = _map.find(rid);
-    if (itr == _map.end()) // not found in map
+    uint64_t bit;
+    chunk_t* cp = find_chunk(rid, bit);
+    if (cp != 0)
+        return ignore_lock || (cp->_locked & bit) == 0;
+    emap_itr itr = _sparse.find(rid);
+    if (itr == _sparse.end()) // not found in map
         return false;
     if (!ignore_lock && itr->second._lock) // locked
         return false;
@@ -128,8 +205,14 @@ short
 enq_map::lock(const uint64_t rid)
 {
     slock s(_mutex);
-    emap_itr itr = _map.find(rid);
-    if (itr == _map.end()) // not found in map
+    uint64_t bit;
+    chunk_t* cp = find_chunk(rid, bit);
+    if (cp != 0) {
+        cp->_locked |= bit;
+        return EMAP_OK;
+    }
+    emap_itr itr = _sparse.find(rid);
+    if (itr == _sparse.end()) // not found in map
         return EMAP_RID_NOT_FOUND;
     itr->second._lock = true;
     return EMAP_OK;
@@ -139,8 +222,14 @@ short
 enq_map::unlock(const uint64_t rid)
 {
     slock s(_mutex);
-    emap_itr itr = _map.find(rid);
-    if (itr == _map.end()) // not found in map
+    uint64_t bit;
+    chunk_t* cp = find_chunk(rid, bit);
+    if (cp != 0) {
+        cp->_locked &= ~bit;
+        return EMAP_OK;
+    }
+    emap_itr itr = _sparse.find(rid);
+    if (itr == _sparse.end()) // not found in map
         return EMAP_RID_NOT_FOUND;
     itr->second._lock = false;
     return EMAP_OK;
@@ -150,31 +239,278 @@ short
 enq_map::is_locked(const uint64_t rid)
 {
     slock s(_mutex);
-    emap_itr itr = _map.find(rid);
-    if (itr == _map.end()) // not found in map
+    uint64_t bit;
+    chunk_t* cp = find_chunk(rid, bit);
+    if (cp != 0)
+        return (cp->_locked & bit) ? EMAP_TRUE : EMAP_FALSE;
+    emap_itr itr = _sparse.find(rid);
+    if (itr == _sparse.end()) // not found in map
         return EMAP_RID_NOT_FOUND;
     return itr->second._lock ? EMAP_TRUE : EMAP_FALSE;
 }
 
+void
+enq_map::clear()
+{
+    slock s(_mutex);
+    for (chunk_window::iterator i = _window.begin(); i != _window.end(); ++i)
+        delete *i;
+    _window.clear();
+    _base_key = 0;
+    _sparse.clear();
+    _size = 0;
+    _thin_run = 0;
+    _bypass = false;
+    _probe_key = 0;
+    _probe_cnt = 0;
+    _scan_rid = 0;
+    _scan_window = false;
+}
+
 void
 enq_map::rid_list(std::vector<uint64_t>& rv)
 {
     rv.clear();
     {
         slock s(_mutex);
-        for (emap_itr itr = _map.begin(); itr != _map.end(); itr++)
+        rv.reserve(_size);
+        for (uint64_t i = 0; i < _window.size(); ++i) {
+            const chunk_t* cp = _window[i];
+            if (cp == 0) continue;
+            for (uint64_t offs = 0; offs < CHUNK_SIZE; ++offs) {
+                if (cp->_present & (1ULL << offs))
+                    rv.push_back(((_base_key + i) << CHUNK_SHIFT) + offs);
+            }
+        }
+        for (emap_itr itr = _sparse.begin(); itr != _sparse.end(); itr++)
             rv.push_back(itr->first);
     }
+    std::sort(rv.begin(), rv.end());
+}
+
+void
+enq_map::rid_list(const uint64_t pfid, std::vector<uint64_t>& rv, const std::size_t max_cnt)
+{
+    // Called on every compaction tick, so each call searches at most SCAN_LIMIT records and holds the
+    // mutex for at most SCAN_BATCH of them at a time. The next call for the same pfid resumes where
+    // this one stopped, so the whole map is covered over successive calls. Old records that pin a
+    // file have usually been folded into _sparse, so each pass searches it before the window.
+    rv.clear();
+    std::size_t searched = 0;
+    bool wrapped = false;
+    while (!wrapped && searched < SCAN_LIMIT && rv.size() < max_cnt) {
+        slock s(_mutex);
+        if (pfid != _scan_pfid) {
+            _scan_pfid = pfid;
+            _scan_rid = 0;
+            _scan_window = false;
+        }
+        std::size_t n = 0;
+        if (!_scan_window) {
+            emap_itr itr = _sparse.lower_bound(_scan_rid);
+            for (; itr != _sparse.end() && n < SCAN_BATCH && rv.size() < max_cnt; ++itr, ++n) {
+                if (!itr->second._lock && itr->second._pfid == pfid)
+                    rv.push_back(itr->first);
+            }
+            if (itr == _sparse.end()) {
+                _scan_rid = 0;
+                _scan_window = true;
+            } else {
+                _scan_rid = itr->first;
+            }
+        } else {
+            const uint64_t end_key = _base_key + _window.size();
+            uint64_t key = std::max(_scan_rid >> CHUNK_SHIFT, _base_key);
+            for (; key < end_key && n < SCAN_BATCH && rv.size() < max_cnt; ++key, n += CHUNK_SIZE) {
+                const chunk_t* cp = _window[key - _base_key];
+                if (cp == 0) continue;
+                for (uint64_t offs = 0; offs < CHUNK_SIZE && rv.size() < max_cnt; ++offs) {
+                    const uint64_t bit = 1ULL << offs;
+                    if ((cp->_present & bit) && !(cp->_locked & bit) && cp->_pfid[offs] == pfid)
+                        rv.push_back((key << CHUNK_SHIFT) + offs);
+                }
+            }
+            if (key >= end_key) {
+                _scan_rid = 0;
+                _scan_window = false;
+                wrapped = true; // End of a full pass
+            } else {
+                _scan_rid = key << CHUNK_SHIFT;
+            }
+        }
+        searched += n;
+    }
+    std::sort(rv.begin(), rv.end());
 }
 
 void
 enq_map::pfid_list(std::vector<uint64_t>& fv)
 {
+    std::vector<std::pair<uint64_t, uint64_t> > rfv; // rid, pfid
     fv.clear();
     {
         slock s(_mutex);
-        for (emap_itr itr = _map.begin(); itr != _map.end(); itr++)
-            fv.push_back(itr->second._pfid);
+        rfv.reserve(_size);
+        for (uint64_t i = 0; i < _window.size(); ++i) {
+            const chunk_t* cp = _window[i];
+            if (cp == 0) continue;
+            for (uint64_t offs = 0; offs < CHUNK_SIZE; ++offs) {
+                if (cp->_present & (1ULL << offs))
+                    rfv.push_back(std::make_pair(((_base_key + i) << CHUNK_SHIFT) + offs, cp->_pfid[offs]));
+            }
+        }
+        for (emap_itr itr = _sparse.begin(); itr != _sparse.end(); itr++)
+            rfv.push_back(std::make_pair(itr->first, itr->second._pfid));
+    }
+    std::sort(rfv.begin(), rfv.end());
+    fv.reserve(rfv.size());
+    for (std::vector<std::pair<uint64_t, uint64_t> >::const_iterator i = rfv.begin(); i != rfv.end(); ++i)
+        fv.push_back(i->second);
+}
+
+// --- protected functions (all called with _mutex held) ---
+
+enq_map::chunk_t*
+enq_map::find_chunk(const uint64_t rid, uint64_t& bit) const
+{
+    const uint64_t key = rid >> CHUNK_SHIFT;
+    if (key < _base_key || key - _base_key >= _window.size())
+        return 0;
+    chunk_t* cp = _window[key - _base_key];
+    if (cp == 0)
+        return 0;
+    bit = 1ULL << (rid & (CHUNK_SIZE - 1));
+    return (cp->_present & bit) ? cp : 0;
+}
+
+bool
+enq_map::insert_chunk(const uint64_t rid, const uint64_t pfid, const std::streamoff file_posn, const bool locked)
+{
+    const uint64_t key = rid >> CHUNK_SHIFT;
+    if (_bypass) {
+        // Rids are too spread out for chunks (eg a store-wide sequence shared by many queues); go
+        // back to the window once a whole chunk's worth of rids has been dense enough
+        if (key > _probe_key) {
+            if (_probe_cnt >= SPARSE_THRESHOLD) {
+                _bypass = false;
+                _thin_run = 0;
+            } else {
+                _probe_key = key;
+                _probe_cnt = 0;
+            }
+        }
+        if (_bypass) {
+            if (key == _probe_key)
+                ++_probe_cnt;
+            return false;
+        }
+    }
+    if (_window.empty()) {
+        _base_key = key;
+    } else if (key < _base_key) {
+        return false; // behind the window, keep in _sparse
+    }
+    const uint64_t old_size = _window.size();
+    if (key - _base_key >= old_size) {
+        if (key - _base_key - old_size > MAX_GAP_CHUNKS) {
+            // Rid jump too large to bridge with empty slots, restart the window at this rid
+            fold_all();
+            _base_key = key;
+        }
+        while (_base_key + _window.size() <= key)
+            _window.push_back(0);
+    }
+    const uint64_t idx = key - _base_key;
+    chunk_t*& cp = _window[idx];
+    if (cp == 0) {
+        if (idx + RECENT_CHUNKS < _window.size())
+            return false; // old slot that has been folded, keep in _sparse
+        cp = new chunk_t;
+    }
+    const uint64_t offs = rid & (CHUNK_SIZE - 1);
+    const uint64_t bit = 1ULL << offs;
+    cp->_present |= bit;
+    if (locked)
+        cp->_locked |= bit;
+    cp->_pfid[offs] = pfid;
+    cp->_file_posn[offs] = file_posn;
+    ++cp->_cnt;
+    ++cp->_ins;
+
+    if (_window.size() > old_size) {
+        // Fold sparse chunks leaving the recent window, and a sparse chunk at the front which
+        // would otherwise pin the window (eg a few old unconsumed records)
+        for (uint64_t i = old_size; i < _window.size(); ++i) {
+            if (i < RECENT_CHUNKS || _window[i - RECENT_CHUNKS] == 0)
+                continue;
+            const chunk_t* lp = _window[i - RECENT_CHUNKS];
+            _thin_run = lp->_ins < SPARSE_THRESHOLD ? _thin_run + 1 : 0;
+            if (lp->_cnt < SPARSE_THRESHOLD)
+                fold_chunk(i - RECENT_CHUNKS);
+        }
+        if (_thin_run >= SPARSE_RUN) {
+            // Chunks keep being filled too thinly, insert straight into _sparse from now on
+            fold_all();
+            _bypass = true;
+            _probe_key = key;
+            _probe_cnt = 0;
+            return true;
+        }
+        if (_window.size() > 2 * RECENT_CHUNKS && _window.front() != 0 && _window.front()->_cnt < SPARSE_THRESHOLD)
+            fold_chunk(0);
+        trim_front();
+    }
+    return true;
+}
+
+void
+enq_map::remove_chunk_bit(const uint64_t key, chunk_t* cp, const uint64_t bit)
+{
+    cp->_present &= ~bit;
+    cp->_locked &= ~bit;
+    if (--cp->_cnt == 0) {
+        const uint64_t idx = key - _base_key;
+        if (idx + RECENT_CHUNKS < _window.size()) {
+            delete cp;
+            _window[idx] = 0;
+            trim_front();
+        }
+    }
+}
+
+void
+enq_map::fold_chunk(const uint64_t idx)
+{
+    chunk_t* cp = _window[idx];
+    const uint64_t base_rid = (_base_key + idx) << CHUNK_SHIFT;
+    for (uint64_t offs = 0; offs < CHUNK_SIZE && cp->_present != 0; ++offs) {
+        const uint64_t bit = 1ULL << offs;
+        if (cp->_present & bit) {
+            _sparse.insert(emap_param(base_rid + offs,
+                                      emap_data_struct_t(cp->_pfid[offs], cp->_file_posn[offs], (cp->_locked & bit) != 0)));
+            cp->_present &= ~bit;
+        }
+    }
+    delete cp;
+    _window[idx] = 0;
+}
+
+void
+enq_map::fold_all()
+{
+    for (uint64_t i = 0; i < _window.size(); ++i) {
+        if (_window[i] != 0)
+            fold_chunk(i);
+    }
+    _window.clear();
+}
+
+void
+enq_map::trim_front()
+{
+    while (!_window.empty() && _window.front() == 0) {
+        _window.pop_front();
+        ++_base_key;
     }
 }
 
@@ -23,6 +23,8 @@
 #define QPID_LINEARSTORE_JOURNAL_ENQ_MAP_H
 
 #include "qpid/linearstore/journal/smutex.h"
+#include <deque>
+#include <map>
 #include <vector>
 
 namespace qpid {
@@ -48,6 +50,20 @@ namespace journal {
 *   rid3 --- [ pfid, txn_lock ]
 *   ...
 * </pre>
+*
+* Since rids are issued in monotonically increasing order, the map is stored as a window of
+* fixed-size chunks indexed by rid offset rather than as one tree node per record. Each chunk
+* holds the pfid and file position of CHUNK_SIZE consecutive rids plus presence and lock
+* bitmaps. Chunks that have fallen behind the most recent insertions and have become sparsely
+* populated (eg a few old records that are never consumed) are folded into a conventional
+* ordered map so that they do not pin the chunk window; rids that arrive below the start of the
+* window (eg from a late transaction commit) are also kept there.
+*
+* Rids come from a store-wide sequence, so a journal shared out with many other busy queues sees
+* only every Nth rid and its chunks are too thinly filled to pay for themselves. When several
+* chunks in a row have been filled below SPARSE_THRESHOLD, the map folds its window and inserts
+* straight into the ordered map. It returns to the window once the rids of one chunk are dense
+* enough again.
 */
 class enq_map
 {
@@ -72,7 +88,37 @@ public:
     typedef emap::iterator emap_itr;
 
 private:
-    emap _map;
+    static const uint64_t CHUNK_SHIFT = 6;
+    static const uint64_t CHUNK_SIZE = 1ULL << CHUNK_SHIFT;        ///< Rids per chunk (one bitmap word)
+    static const uint32_t SPARSE_THRESHOLD = CHUNK_SIZE / 8;       ///< Chunks below this count are folded into _sparse
+    static const uint64_t RECENT_CHUNKS = 4;                       ///< Chunks at the window tail are never folded
+    static const uint64_t MAX_GAP_CHUNKS = 1024;                   ///< Largest rid jump bridged by empty window slots
+    static const uint32_t SPARSE_RUN = 2 * RECENT_CHUNKS;          ///< Thinly filled chunks in a row before the window is bypassed
+    static const uint32_t SCAN_BATCH = 1024;                       ///< Records searched per mutex hold by rid_list(pfid, ...)
+    static const uint32_t SCAN_LIMIT = 16 * SCAN_BATCH;            ///< Records searched per call of rid_list(pfid, ...)
+
+    typedef struct chunk_t {
+        uint64_t        _present;                   ///< Bitmap: rid offset in use
+        uint64_t        _locked;                    ///< Bitmap: rid offset txn locked
+        uint32_t        _cnt;                       ///< Number of bits set in _present
+        uint32_t        _ins;                       ///< Number of rids ever inserted
+        uint64_t        _pfid[CHUNK_SIZE];
+        std::streamoff  _file_posn[CHUNK_SIZE];
+        chunk_t() : _present(0), _locked(0), _cnt(0), _ins(0) {}
+    } chunk_t;
+    typedef std::deque<chunk_t*> chunk_window;
+
+    chunk_window _window;                           ///< Chunk for rid r is _window[(r >> CHUNK_SHIFT) - _base_key]
+    uint64_t _base_key;                             ///< Chunk key (rid >> CHUNK_SHIFT) of _window.front()
+    emap _sparse;                                   ///< Rids not held in _window
+    uint32_t _size;                                 ///< Total records in _window and _sparse
+    uint32_t _thin_run;                             ///< Thinly filled chunks that have just left the recent window
+    bool _bypass;                                   ///< True while inserts go straight to _sparse
+    uint64_t _probe_key;                            ///< While bypassing, chunk key of the latest insert
+    uint32_t _probe_cnt;                            ///< While bypassing, inserts with chunk key _probe_key
+    uint64_t _scan_pfid;                            ///< File searched by the last rid_list(pfid, ...)
+    uint64_t _scan_rid;                             ///< Where the next rid_list(pfid, ...) resumes
+    bool _scan_window;                              ///< True if it resumes in _window, false in _sparse
     smutex _mutex;
 
 public:
@@ -84,16 +130,26 @@ public:
     short get_pfid(const uint64_t rid, uint64_t& pfid); // >=0=pfid; -1=rid not found; -2=locked
     short get_remove_pfid(const uint64_t rid, uint64_t& pfid, const bool txn_flag = false); // >=0=pfid; -1=rid not found; -2=locked
     short get_file_posn(const uint64_t rid, std::streampos& file_posn); // -1=rid not found; -2=locked
+    short relocate_pfid(const uint64_t rid, const uint64_t pfid, const std::streampos file_posn, uint64_t& old_pfid); // 0=ok; -1=rid not found; -2=locked
     short get_data(const uint64_t rid, emap_data_struct_t& eds);
     bool is_enqueued(const uint64_t rid, bool ignore_lock = false);
     short lock(const uint64_t rid); // 0=ok; -1=rid not found
     short unlock(const uint64_t rid); // 0=ok; -1=rid not found
     short is_locked(const uint64_t rid); // 1=true; 0=false; -1=rid not found
-    inline void clear() { _map.clear(); }
-    inline bool empty() const { return _map.empty(); }
-    inline uint32_t size() const { return uint32_t(_map.size()); }
+    void clear();
+    inline bool empty() const { return _size == 0; }
+    inline uint32_t size() const { return _size; }
     void rid_list(std::vector<uint64_t>& rv);
     void pfid_list(std::vector<uint64_t>& fv);
+    void rid_list(const uint64_t pfid, std::vector<uint64_t>& rv, const std::size_t max_cnt); // unlocked rids in file pfid, searching part of the map per call
+
+private:
+    chunk_t* find_chunk(const uint64_t rid, uint64_t& bit) const;
+    bool insert_chunk(const uint64_t rid, const uint64_t pfid, const std::streamoff file_posn, const bool locked);
+    void remove_chunk_bit(const uint64_t key, chunk_t* cp, const uint64_t bit);
+    void fold_chunk(const uint64_t idx);
+    void fold_all();
+    void trim_front();
 };
 
 }}}
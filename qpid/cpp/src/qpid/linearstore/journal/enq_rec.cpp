@@ -54,6 +54,7 @@ enq_rec::reset(const uint64_t serial, const uint64_t rid, const void* const dbuf
     _enq_hdr._rhdr._rid = rid;
     ::set_enq_transient(&_enq_hdr, transient);
     ::set_enq_external(&_enq_hdr, external);
+    ::set_enq_relocated(&_enq_hdr, false);
     _enq_hdr._xidsize = xidlen;
     _enq_hdr._dsize = dlen;
     _xidp = xidp;
@@ -57,6 +57,8 @@ public:
     std::size_t get_data(void** const datapp);
     inline bool is_transient() const { return ::is_enq_transient(&_enq_hdr); }
     inline bool is_external() const { return ::is_enq_external(&_enq_hdr); }
+    inline bool is_relocated() const { return ::is_enq_relocated(&_enq_hdr); }
+    inline void set_relocated(const bool relocated) { ::set_enq_relocated(&_enq_hdr, relocated); }
     std::string& str(std::string& str) const;
     inline std::size_t data_size() const { return _enq_hdr._dsize; }
     inline std::size_t xid_size() const { return _enq_hdr._xidsize; }
@@ -21,7 +21,9 @@
 
 #include "qpid/linearstore/journal/jcntl.h"
 
+#include <fstream>
 #include <iomanip>
+#include "qpid/linearstore/journal/Checksum.h"
 #include "qpid/linearstore/journal/data_tok.h"
 #include "qpid/linearstore/journal/JournalLog.h"
 
@@ -234,6 +236,19 @@ jcntl::read_data_record(void** const datapp,
     return RHM_IORES_EMPTY;
 }
 
+bool
+jcntl::read_enqueued_record(const uint64_t rid,
+                            std::vector<char>& data)
+{
+    check_rstatus("read_enqueued_record");
+    if (!_readonly_flag)
+        throw jexception(jerrno::JERR_JCNTL_NOTRECOVERED, "jcntl", "read_enqueued_record");
+    enq_map::emap_data_struct_t eds;
+    if (_emap.get_data(rid, eds) != enq_map::EMAP_OK)
+        return false;
+    return _recoveryManager.readRecord(eds._pfid, eds._file_posn, rid, data);
+}
+
 iores
 jcntl::dequeue_data_record(data_tok* const dtokp,
                            const bool txn_coml_commit)
@@ -296,6 +311,82 @@ jcntl::is_txn_synced(const std::string& xid)
     return res;
 }
 
+bool
+jcntl::get_relocation_candidates(uint64_t& fid,
+                                 std::vector<uint64_t>& rids,
+                                 const std::size_t max_cnt)
+{
+    rids.clear();
+    if (_readonly_flag || !_init_flag || _stop_flag)
+        return false;
+    uint64_t serial;
+    std::string fqFileName;
+    if (!_linearFileController.getRelocationSourceFile(fid, serial, fqFileName))
+        return false;
+    _emap.rid_list(fid, rids, max_cnt);
+    return !rids.empty();
+}
+
+std::size_t
+jcntl::relocate_data_record(const uint64_t rid,
+                            const uint64_t fid,
+                            data_tok* dtokp)
+{
+    check_wstatus("relocate_data_record");
+    uint64_t src_fid;
+    uint64_t serial;
+    std::string fqFileName;
+    if (!_linearFileController.getRelocationSourceFile(src_fid, serial, fqFileName) || src_fid != fid)
+        return 0;
+    enq_map::emap_data_struct_t eds;
+    if (_emap.get_data(rid, eds) != enq_map::EMAP_OK || eds._lock || eds._pfid != fid)
+        return 0;
+
+    // Read and validate the original record; the source file is sealed, so no lock is needed here
+    std::ifstream ifs(fqFileName.c_str(), std::ios_base::in | std::ios_base::binary);
+    ifs.seekg(eds._file_posn);
+    ::enq_hdr_t hdr;
+    ifs.read((char*)&hdr, sizeof(::enq_hdr_t));
+    if (ifs.gcount() != sizeof(::enq_hdr_t) ||
+        ::rec_hdr_check(&hdr._rhdr, QLS_ENQ_MAGIC, QLS_JRNL_VERSION, serial) != 0 ||
+        hdr._rhdr._rid != rid ||
+        ::is_enq_transient(&hdr) ||
+        ::is_enq_external(&hdr) ||
+        hdr._xidsize != 0) // The xid must be preserved for the TPL and prepared transactions, so leave these in place
+        return 0;
+    std::vector<char> data(hdr._dsize);
+    ::rec_tail_t tail;
+    if (hdr._dsize) {
+        ifs.read(&data[0], hdr._dsize);
+        if (ifs.gcount() != (std::streamsize)hdr._dsize)
+            return 0; // Record continues in next file
+    }
+    ifs.read((char*)&tail, sizeof(::rec_tail_t));
+    if (ifs.gcount() != sizeof(::rec_tail_t))
+        return 0;
+    Checksum checksum;
+    checksum.addData((const unsigned char*)&hdr, sizeof(::enq_hdr_t));
+    if (hdr._dsize)
+        checksum.addData((const unsigned char*)&data[0], hdr._dsize);
+    if (::rec_tail_check(&tail, &hdr._rhdr, checksum.getChecksum()) != 0)
+        return 0;
+
+    iores r;
+    {
+        slock s(_wr_mutex);
+        if (_emap.get_data(rid, eds) != enq_map::EMAP_OK || eds._lock || eds._pfid != fid)
+            return 0; // Dequeued or locked while the record was being read
+        dtokp->set_external_rid(true);
+        dtokp->set_rid(rid);
+        dtokp->set_relocated(fid);
+        while (handle_aio_wait(_wmgr.enqueue(hdr._dsize ? &data[0] : 0, hdr._dsize, hdr._dsize, dtokp, 0, 0,
+                                             false, false, false), r, dtokp)) ;
+    }
+    if (r != RHM_IORES_SUCCESS)
+        return 0;
+    return sizeof(::enq_hdr_t) + hdr._dsize + sizeof(::rec_tail_t);
+}
+
 int32_t
 jcntl::get_wr_events(timespec* const timeout)
 {
@@ -354,6 +354,22 @@ public:
                            data_tok* const dtokp,
                            bool ignore_pending_txns);
 
+    /**
+    * \brief Reads the data of an enqueued record by record id, during recovery only.
+    *
+    * Unlike read_data_record(), records may be read in any order and more than once. The record
+    * is located through the enqueue map, so no record data needs to be held in memory between reads.
+    *
+    * \param rid Record id of the enqueued record.
+    * \param data Set to the record data.
+    *
+    * \return false if rid is not enqueued or is external.
+    *
+    * \exception jexception if the journal is not being recovered or the record is corrupt.
+    */
+    bool read_enqueued_record(const uint64_t rid,
+                              std::vector<char>& data);
+
     /**
     * \brief Dequeues (marks as no longer needed) data record in journal.
     *
@@ -439,6 +455,37 @@ public:
     */
     bool is_txn_synced(const std::string& xid);
 
+    /**
+    * \brief Find records which pin the oldest journal file and which may be relocated to the current file.
+    *
+    * The oldest file is only considered once it is two or more files behind the current file and
+    * still holds enqueued records; otherwise false is returned.
+    *
+    * \param fid Set to the file sequence number of the file holding the candidate records.
+    * \param rids Filled with up to max_cnt unlocked record ids from that file.
+    * \param max_cnt Maximum number of record ids to return.
+    */
+    bool get_relocation_candidates(uint64_t& fid,
+                                   std::vector<uint64_t>& rids,
+                                   const std::size_t max_cnt);
+
+    /**
+    * \brief Copy a still-enqueued record from file fid to the current journal file.
+    *
+    * The copy keeps the record id and is flagged as relocated. The original file is released
+    * only once the copy has been written to disk. Transient, external, transactional and
+    * file-spanning records are not relocated.
+    *
+    * \param rid Record id of the enqueued record.
+    * \param fid File sequence number obtained from get_relocation_candidates().
+    * \param dtokp Pointer to data_tok instance used to track the copy through the journal.
+    *
+    * \return Number of bytes relocated, or 0 if the record was skipped.
+    */
+    std::size_t relocate_data_record(const uint64_t rid,
+                                     const uint64_t fid,
+                                     data_tok* dtokp);
+
     /**
     * \brief Forces a check for returned AIO write events.
     *
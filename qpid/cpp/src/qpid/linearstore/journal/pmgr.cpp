@@ -32,7 +32,8 @@ pmgr::page_cb::page_cb(uint16_t index):
         _wdblks(0),
         _pdtokl(0),
         _jfp(0),
-        _pbuff(0)
+        _pbuff(0),
+        _subm_ts()
 {}
 
 // TODO: almost identical to pmgr::page_state_str() below - resolve
@@ -27,6 +27,7 @@
 #include "qpid/linearstore/journal/deq_rec.h"
 #include "qpid/linearstore/journal/enq_map.h"
 #include "qpid/linearstore/journal/enq_rec.h"
+#include "qpid/linearstore/journal/time_ns.h"
 #include "qpid/linearstore/journal/txn_map.h"
 #include "qpid/linearstore/journal/txn_rec.h"
 
@@ -69,6 +70,7 @@ public:
         std::deque<data_tok*>* _pdtokl; ///< Page message tokens list
         JournalFile* _jfp;          ///< Journal file for incrementing compl counts
         void* _pbuff;               ///< Page buffer
+        time_ns _subm_ts;           ///< Time page was submitted to AIO
 
         page_cb(uint16_t index);   ///< Convenience constructor
         const char* state_str() const; ///< Return state as string for this pcb
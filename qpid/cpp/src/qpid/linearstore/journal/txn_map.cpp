@@ -22,6 +22,7 @@
 #include "qpid/linearstore/journal/txn_map.h"
 
 #include "qpid/linearstore/journal/slock.h"
+#include <algorithm>
 
 namespace qpid {
 namespace linearstore {
@@ -93,20 +94,9 @@ txn_map::~txn_map() {}
 bool
 txn_map::insert_txn_data(const std::string& xid, const txn_data_t& td)
 {
-    bool ok = true;
     slock s(_mutex);
-    xmap_itr itr = _map.find(xid);
-    if (itr == _map.end()) // not found in map
-    {
-        txn_data_list_t list;
-        list.push_back(td);
-        std::pair<xmap_itr, bool> ret = _map.insert(xmap_param(xid, list));
-        if (!ret.second) // duplicate
-            ok = false;
-    }
-    else
-        itr->second.push_back(td);
-    return ok;
+    _map[xid].push_back(td);
+    return true;
 }
 
 const txn_data_list_t
@@ -132,7 +122,8 @@ txn_map::get_remove_tdata_list(const std::string& xid)
     xmap_itr itr = _map.find(xid);
     if (itr == _map.end()) // not found in map
         return _empty_data_list;
-    txn_data_list_t list = itr->second;
+    txn_data_list_t list;
+    list.swap(itr->second);
     _map.erase(itr);
     return list;
 }
@@ -154,7 +145,7 @@ txn_map::enq_cnt()
 uint32_t
 txn_map::deq_cnt()
 {
-    return cnt(true);
+    return cnt(false);
 }
 
 uint32_t
@@ -217,13 +208,11 @@ txn_map::data_exists(const std::string& xid, const uint64_t rid)
     bool found = false;
     {
         slock s(_mutex);
-        txn_data_list_t tdl = get_tdata_list_nolock(xid);
-        tdl_itr_t itr = tdl.begin();
-        while (itr != tdl.end() && !found)
-        {
+        xmap_itr xitr = _map.find(xid);
+        if (xitr == _map.end()) // not found in map
+            return false;
+        for (tdl_const_itr_t itr = xitr->second.begin(); itr != xitr->second.end() && !found; itr++)
             found = itr->rid_ == rid;
-            itr++;
-        }
     }
     return found;
 }
@@ -236,8 +225,8 @@ txn_map::is_enq(const uint64_t rid)
         slock s(_mutex);
         for (xmap_itr i = _map.begin(); i != _map.end() && !found; i++)
         {
-            txn_data_list_t list = i->second;
-            for (tdl_itr_t j = list.begin(); j < list.end() && !found; j++)
+            const txn_data_list_t& list = i->second;
+            for (tdl_const_itr_t j = list.begin(); j < list.end() && !found; j++)
             {
                 if (j->enq_flag_)
                     found = j->rid_ == rid;
@@ -255,9 +244,11 @@ txn_map::xid_list(std::vector<std::string>& xv)
     xv.clear();
     {
         slock s(_mutex);
+        xv.reserve(_map.size());
         for (xmap_itr itr = _map.begin(); itr != _map.end(); itr++)
             xv.push_back(itr->first);
     }
+    std::sort(xv.begin(), xv.end());
 }
 
 }}}
@@ -23,7 +23,8 @@
 #define QPID_LINEARSTORE_JOURNAL_TXN_MAP_H
 
 #include "qpid/linearstore/journal/smutex.h"
-#include <map>
+#include "qpid/sys/unordered_map.h"
+#include <string>
 #include <vector>
 
 namespace qpid {
@@ -102,6 +103,9 @@ namespace journal {
     *   xid3 --- vector< [ rid, drid, pfid, enq_flag, commit_flag, aio_compl ] >
     *   ...
     * </pre>
+    *
+    * The xids are hashed rather than ordered, as every enqueue and dequeue within a transaction
+    * looks up its xid; xid_list() returns them sorted.
     */
     class txn_map
     {
@@ -115,7 +119,7 @@ namespace journal {
 
     private:
         typedef std::pair<std::string, txn_data_list_t> xmap_param;
-        typedef std::map<std::string, txn_data_list_t> xmap;
+        typedef qpid::sys::unordered_map<std::string, txn_data_list_t> xmap;
         typedef xmap::iterator xmap_itr;
 
         xmap _map;
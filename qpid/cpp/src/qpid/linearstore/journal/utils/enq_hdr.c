@@ -23,6 +23,7 @@
 
 //static const uint16_t ENQ_HDR_TRANSIENT_MASK = 0x10;
 //static const uint16_t ENQ_HDR_EXTERNAL_MASK = 0x20;
+//static const uint16_t ENQ_HDR_RELOCATED_MASK = 0x40;
 
 void enq_hdr_init(enq_hdr_t* dest, const uint32_t magic, const uint16_t version, const uint16_t uflag,
                   const uint64_t serial, const uint64_t rid, const uint64_t xidsize, const uint64_t dsize) {
@@ -55,6 +56,15 @@ void set_enq_external(enq_hdr_t *eh, const bool external) {
                                   eh->_rhdr._uflag & (~ENQ_HDR_EXTERNAL_MASK);
 }
 
+bool is_enq_relocated(const enq_hdr_t *eh) {
+    return eh->_rhdr._uflag & ENQ_HDR_RELOCATED_MASK;
+}
+
+void set_enq_relocated(enq_hdr_t *eh, const bool relocated) {
+    eh->_rhdr._uflag = relocated ? eh->_rhdr._uflag | ENQ_HDR_RELOCATED_MASK :
+                                   eh->_rhdr._uflag & (~ENQ_HDR_RELOCATED_MASK);
+}
+
 bool validate_enq_hdr(enq_hdr_t *eh, const uint32_t magic, const uint16_t version, const uint64_t rid) {
     return eh->_rhdr._magic == magic &&
            eh->_rhdr._version == version &&
@@ -64,6 +64,7 @@ typedef struct enq_hdr_t {
 
 static const uint16_t ENQ_HDR_TRANSIENT_MASK = 0x10;
 static const uint16_t ENQ_HDR_EXTERNAL_MASK = 0x20;
+static const uint16_t ENQ_HDR_RELOCATED_MASK = 0x40;
 
 void enq_hdr_init(enq_hdr_t* dest, const uint32_t magic, const uint16_t version, const uint16_t uflag,
                   const uint64_t serial, const uint64_t rid, const uint64_t xidsize, const uint64_t dsize);
@@ -72,6 +73,8 @@ bool is_enq_transient(const enq_hdr_t *eh);
 void set_enq_transient(enq_hdr_t *eh, const bool transient);
 bool is_enq_external(const enq_hdr_t *eh);
 void set_enq_external(enq_hdr_t *eh, const bool external);
+bool is_enq_relocated(const enq_hdr_t *eh);
+void set_enq_relocated(enq_hdr_t *eh, const bool relocated);
 bool validate_enq_hdr(enq_hdr_t *eh, const uint32_t magic, const uint16_t version, const uint64_t rid);
 
 #pragma pack()
@@ -43,6 +43,7 @@ wmgr::wmgr(jcntl* jc,
         _max_dtokpp(0),
         _max_io_wait_us(0),
         _cached_offset_dblks(0),
+        _enq_posn(0),
         _enq_busy(false),
         _deq_busy(false),
         _abort_busy(false),
@@ -61,6 +62,7 @@ wmgr::wmgr(jcntl* jc,
         _max_dtokpp(max_dtokpp),
         _max_io_wait_us(max_iowait_us),
         _cached_offset_dblks(0),
+        _enq_posn(0),
         _enq_busy(false),
         _deq_busy(false),
         _abort_busy(false),
@@ -151,6 +153,7 @@ wmgr::enqueue(const void* const data_buff,
 
     uint64_t rid = (dtokp->external_rid() | cont) ? dtokp->rid() : _lfc.getNextRecordId();
     _enq_rec.reset(_lfc.getCurrentSerial(), rid, data_buff, tot_data_len, xid_ptr, xid_len, transient, external);
+    _enq_rec.set_relocated(dtokp->is_relocated());
     if (!cont)
     {
         dtokp->set_rid(rid);
@@ -176,6 +179,7 @@ wmgr::enqueue(const void* const data_buff,
         // Remember fid which contains the record header in case record is split over several files
         if (data_offs_dblks == 0) {
             dtokp->set_fid(_lfc.getCurrentFileSeqNum());
+            _enq_posn = curr_file_posn();
         }
         _pg_offset_dblks += ret;
         _cached_offset_dblks += ret;
@@ -200,11 +204,22 @@ wmgr::enqueue(const void* const data_buff,
             if (xid_len) // If part of transaction, add to transaction map
             {
                 std::string xid((const char*)xid_ptr, xid_len);
-                _tmap.insert_txn_data(xid, txn_data_t(rid, 0, dtokp->fid(), 0, true, tpc_flag, false));
+                _tmap.insert_txn_data(xid, txn_data_t(rid, 0, dtokp->fid(), _enq_posn, true, tpc_flag, false));
+            }
+            else if (dtokp->is_relocated())
+            {
+                // The original stays counted against its file until this copy is on disk (see get_events())
+                uint64_t old_fid;
+                if (_emap.relocate_pfid(rid, dtokp->fid(), _enq_posn, old_fid) < enq_map::EMAP_OK) // fail
+                {
+                    std::ostringstream oss;
+                    oss << std::hex << "rid=0x" << rid << " _pfid=0x" << dtokp->fid();
+                    throw jexception(jerrno::JERR_MAP_NOTFOUND, oss.str(), "wmgr", "enqueue");
+                }
             }
             else
             {
-                if (_emap.insert_pfid(rid, dtokp->fid(), 0) < enq_map::EMAP_OK) // fail
+                if (_emap.insert_pfid(rid, dtokp->fid(), _enq_posn) < enq_map::EMAP_OK) // fail
                 {
                     // The only error code emap::insert_pfid() returns is enq_map::EMAP_DUP_RID.
                     std::ostringstream oss;
@@ -551,7 +566,7 @@ wmgr::commit(data_tok* dtokp,
             {
                 if (itr->enq_flag_) // txn enqueue
                 {
-                    if (_emap.insert_pfid(itr->rid_, itr->fid_, 0) < enq_map::EMAP_OK) // fail
+                    if (_emap.insert_pfid(itr->rid_, itr->fid_, itr->foffs_) < enq_map::EMAP_OK) // fail
                     {
                         // The only error code emap::insert_pfid() returns is enq_map::EMAP_DUP_RID.
                         std::ostringstream oss;
@@ -602,6 +617,15 @@ wmgr::commit(data_tok* dtokp,
     return res;
 }
 
+// Offset in the current file at which the next record encoded into the page cache will land
+uint64_t
+wmgr::curr_file_posn() const
+{
+    const uint32_t fhdr_dblks = QLS_JRNL_FHDR_RES_SIZE_SBLKS * QLS_SBLK_SIZE_DBLKS;
+    const uint32_t subm_dblks = _lfc.getCurrentSubmittedDblkCount();
+    return uint64_t((subm_dblks < fhdr_dblks ? fhdr_dblks : subm_dblks) + _cached_offset_dblks) * QLS_DBLK_SIZE_BYTES;
+}
+
 void
 wmgr::file_header_check(const uint64_t rid,
                         const bool cont,
@@ -693,6 +717,7 @@ wmgr::write_flush()
 
             std::size_t pg_offs = (_pg_offset_dblks - _cached_offset_dblks) * QLS_DBLK_SIZE_BYTES;
             aio_cb* aiocbp = &_aio_cb_arr[_pg_index];
+            _page_cb_arr[_pg_index]._subm_ts.now();
             _lfc.asyncPageWrite(_ioctx, aiocbp, (char*)_page_ptr_arr[_pg_index] + pg_offs, _cached_offset_dblks);
             _page_cb_arr[_pg_index]._state = AIO_PENDING;
             _aio_evt_rem++;
@@ -794,15 +819,22 @@ wmgr::get_events(timespec* const timeout,
             uint32_t s = pcbp->_pdtokl->size();
             std::vector<data_tok*> dtokl;
             dtokl.reserve(s);
+            time_ns compl_ts;
+            compl_ts.now();
             for (uint32_t k=0; k<s; k++)
             {
                 data_tok* dtokp = pcbp->_pdtokl->at(k);
                 if (dtokp->decr_pg_cnt() == 0)
                 {
+                    dtokp->set_aio_ts(pcbp->_subm_ts, compl_ts);
                     pending_txn_map_itr_t it;
                     switch (dtokp->wstate())
                     {
                     case data_tok::ENQ_SUBM:
+                        if (dtokp->is_relocated()) {
+                            // Relocated copy is now durable, release the original
+                            _lfc.decrEnqueuedRecordCount(dtokp->relocated_fid());
+                        }
                         dtokl.push_back(dtokp);
                         tot_data_toks++;
                         dtokp->set_wstate(data_tok::ENQ);
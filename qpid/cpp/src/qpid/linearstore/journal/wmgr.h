@@ -62,6 +62,7 @@ private:
     uint32_t _max_dtokpp;           ///< Max data writes per page
     uint32_t _max_io_wait_us;       ///< Max wait in microseconds till submit
     uint32_t _cached_offset_dblks;  ///< Amount of unwritten data in page (dblocks)
+    uint64_t _enq_posn;             ///< File offset of header of enqueue record in progress
 
     // TODO: Convert _enq_busy etc into a proper threadsafe lock
     // TODO: Convert to enum? Are these encodes mutually exclusive?
@@ -138,6 +139,7 @@ private:
                           const bool external = false) const;
     void dequeue_check(const std::string& xid,
                        const uint64_t drid);
+    uint64_t curr_file_posn() const;
     void file_header_check(const uint64_t rid,
                            const bool cont,
                            const uint32_t rec_dblks_rem);
@@ -23,6 +23,7 @@
 #include "qpid/messaging/amqp/AddressHelper.h"
 #include "qpid/messaging/Address.h"
 #include "qpid/messaging/AddressImpl.h"
+#include "qpid/Compression.h"
 #include "qpid/amqp/descriptors.h"
 #include "qpid/types/encodings.h"
 #include "qpid/log/Statement.h"
@@ -70,6 +71,7 @@ const std::string DURABLE("durable");
 const std::string NAME("name");
 const std::string RELIABILITY("reliability");
 const std::string SELECTOR("selector");
+const std::string COMPRESSION("compression");
 const std::string FILTER("filter");
 const std::string DESCRIPTOR("descriptor");
 const std::string VALUE("value");
@@ -260,6 +262,10 @@ AddressHelper::AddressHelper(const Address& address) :
     getOption(node, PROPERTIES, properties);
     getOption(node, CAPABILITIES, capabilities);
     getOption(link, RELIABILITY, reliability);
+    getOption(link, COMPRESSION, compression);
+    if (!compression.empty() && !qpid::Compression::isSupported(compression)) {
+        throw qpid::messaging::AddressError("Unsupported compression: " + compression);
+    }
     durableNode = test(node, DURABLE);
     durableLink = test(link, DURABLE);
     timeout = get(link, TIMEOUT, durableLink && reliability != AT_LEAST_ONCE ? DEFAULT_DURABLE_TIMEOUT : DEFAULT_TIMEOUT);
@@ -575,6 +581,11 @@ bool AddressHelper::isUnreliable() const
         (reliability.empty() && browse); // A browser defaults to unreliable.
 }
 
+const std::string& AddressHelper::getCompression() const
+{
+    return compression;
+}
+
 const qpid::types::Variant::Map& AddressHelper::getNodeProperties() const
 {
     return node;
@@ -766,6 +777,7 @@ Verifier::Verifier()
     link[X_BINDINGS] = true;
     link[SELECTOR] = true;
     link[FILTER] = true;
+    link[COMPRESSION] = true;
     defined[LINK] = link;
 }
 void Verifier::verify(const Address& address) const
@@ -42,6 +42,7 @@ class AddressHelper
 
     bool isNameNull() const;
     bool isUnreliable() const;
+    const std::string& getCompression() const;
     const qpid::types::Variant::Map& getNodeProperties() const;
     bool getLinkSource(std::string& out) const;
     bool getLinkTarget(std::string& out) const;
@@ -72,6 +73,7 @@ class AddressHelper
     std::string name;
     std::string type;
     std::string reliability;
+    std::string compression;
     bool durableNode;
     bool durableLink;
     uint32_t timeout;
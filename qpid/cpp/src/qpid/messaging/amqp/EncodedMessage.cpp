@@ -22,6 +22,7 @@
 #include "qpid/messaging/Address.h"
 #include "qpid/messaging/exceptions.h"
 #include "qpid/messaging/MessageImpl.h"
+#include "qpid/Compression.h"
 #include "qpid/Exception.h"
 #include "qpid/amqp/Decoder.h"
 #include "qpid/amqp/DataBuilder.h"
@@ -31,6 +32,7 @@
 #include "qpid/types/encodings.h"
 #include "qpid/log/Statement.h"
 #include <boost/lexical_cast.hpp>
+#include <algorithm>
 #include <string.h>
 
 namespace qpid {
@@ -114,6 +116,31 @@ void EncodedMessage::init(qpid::messaging::MessageImpl& impl)
     } catch (const qpid::Exception& e) {
         throw FetchError(e.what());
     }
+    decompress();
+}
+
+/**
+ * Restore the body of a message compressed by the sender. This is
+ * done up front rather than in getBody(), so that populate() knows
+ * whether to hide the compression property. If the body cannot be
+ * restored it is delivered as received with the property left in
+ * place, as for 0-10, so the application can tell.
+ */
+void EncodedMessage::decompress()
+{
+    if (compression.empty()) return;
+    if (content.isVoid() && (bodyType.empty()
+                             || bodyType == qpid::amqp::typecodes::BINARY_NAME
+                             || bodyType == qpid::types::encodings::UTF8
+                             || bodyType == qpid::types::encodings::ASCII)) {
+        try {
+            if (qpid::Compression::decompress(compression, body.data, body.size, decompressed)) return;
+            QPID_LOG(warning, "Cannot decompress message body, unsupported compression: " << compression);
+        } catch (const qpid::Exception& e) {
+            QPID_LOG(error, "Cannot decompress message body: " << e.what());
+        }
+    }
+    compression.clear();
 }
 void EncodedMessage::setNestAnnotationsOption(bool b) { nestAnnotations = b; }
 
@@ -130,6 +157,21 @@ void merge(qpid::types::Variant::Map& map, const qpid::types::Variant::Map& addi
         }
     }
 }
+
+std::string getCompression(const CharSequence& properties)
+{
+    //most messages are not compressed, so look for the key in the
+    //raw data before paying for a decode of the whole map
+    const char* end = properties.data + properties.size;
+    if (std::search(properties.data, end, qpid::Compression::PROPERTY.begin(), qpid::Compression::PROPERTY.end()) == end) {
+        return std::string();
+    }
+    Variant::Map map;
+    qpid::amqp::Decoder decoder(properties.data, properties.size);
+    decoder.readMap(map);
+    Variant::Map::const_iterator i = map.find(qpid::Compression::PROPERTY);
+    return i == map.end() ? std::string() : i->second.asString();
+}
 }
 
 void EncodedMessage::populate(qpid::types::Variant::Map& map) const
@@ -139,6 +181,8 @@ void EncodedMessage::populate(qpid::types::Variant::Map& map) const
         if (applicationProperties) {
             qpid::amqp::Decoder decoder(applicationProperties.data, applicationProperties.size);
             decoder.readMap(map);
+            //the body is restored by getBody(), so hide the marker
+            if (!compression.empty()) map.erase(qpid::Compression::PROPERTY);
         }
         //add in 'x-amqp-' prefixed values
         if (!!firstAcquirer) {
@@ -238,8 +282,13 @@ void EncodedMessage::getBody(std::string& raw, qpid::types::Variant& c) const
                 || bodyType == qpid::types::encodings::UTF8
                 || bodyType == qpid::types::encodings::ASCII)
             {
-                c = std::string(body.data, body.size);
-                c.setEncoding(bodyType);
+                if (!compression.empty()) {
+                    c = decompressed;
+                    c.setEncoding(bodyType);
+                } else {
+                    c = std::string(body.data, body.size);
+                    c.setEncoding(bodyType);
+                }
             } else if (bodyType == qpid::amqp::typecodes::LIST_NAME) {
                 qpid::amqp::ListBuilder builder;
                 qpid::amqp::Decoder decoder(body.data, body.size);
@@ -332,7 +381,11 @@ void EncodedMessage::InitialScan::onGroupId(const qpid::amqp::CharSequence& v) {
 void EncodedMessage::InitialScan::onGroupSequence(uint32_t i) { em.groupSequence = i; }
 void EncodedMessage::InitialScan::onReplyToGroupId(const qpid::amqp::CharSequence& v) { em.replyToGroupId = v; }
 
-void EncodedMessage::InitialScan::onApplicationProperties(const qpid::amqp::CharSequence& v, const qpid::amqp::CharSequence&) { em.applicationProperties = v; }
+void EncodedMessage::InitialScan::onApplicationProperties(const qpid::amqp::CharSequence& v, const qpid::amqp::CharSequence&)
+{
+    em.applicationProperties = v;
+    em.compression = getCompression(v);
+}
 void EncodedMessage::InitialScan::onDeliveryAnnotations(const qpid::amqp::CharSequence& v, const qpid::amqp::CharSequence&) { em.deliveryAnnotations = v; }
 void EncodedMessage::InitialScan::onMessageAnnotations(const qpid::amqp::CharSequence& v, const qpid::amqp::CharSequence&) { em.messageAnnotations = v; }
 
@@ -173,15 +173,18 @@ class EncodedMessage
     qpid::amqp::CharSequence replyToGroupId;
     //application-properties:
     qpid::amqp::CharSequence applicationProperties;
+    std::string compression;//algorithm the sender compressed the body with, if any
     //application data:
     qpid::amqp::CharSequence body;
     std::string bodyType;
     qpid::types::Variant content;
+    std::string decompressed;//body restored from a compressed message
 
     //footer:
     qpid::amqp::CharSequence footer;
 
     void init();
+    void decompress();
     //not implemented:
     EncodedMessage& operator=(const EncodedMessage&);
 };
@@ -25,6 +25,7 @@
 #include "util.h"
 #include "qpid/messaging/AddressImpl.h"
 #include "qpid/messaging/exceptions.h"
+#include "qpid/Compression.h"
 #include "qpid/Exception.h"
 #include "qpid/amqp/descriptors.h"
 #include "qpid/amqp/MapHandler.h"
@@ -54,6 +55,7 @@ SenderContext::SenderContext(pn_session_t* session, const std::string& n,
     address(a),
     helper(address),
     nextId(0), capacity(50), unreliable(helper.isUnreliable()),
+    compression(helper.getCompression()),
     setToOnSend(setToOnSend_),
     transaction(coord)
 {}
@@ -103,7 +105,7 @@ bool SenderContext::send(const qpid::messaging::Message& message, SenderContext:
             state = transaction->getSendState();
         if (unreliable) {
             Delivery delivery(nextId++);
-            delivery.encode(MessageImplAccess::get(message), address, setToOnSend);
+            delivery.encode(MessageImplAccess::get(message), address, setToOnSend, compression);
             delivery.send(sender, unreliable, state);
             *out = 0;
             return true;
@@ -111,7 +113,7 @@ bool SenderContext::send(const qpid::messaging::Message& message, SenderContext:
             deliveries.push_back(Delivery(nextId++));
             try {
                 Delivery& delivery = deliveries.back();
-                delivery.encode(MessageImplAccess::get(message), address, setToOnSend);
+                delivery.encode(MessageImplAccess::get(message), address, setToOnSend, compression);
                 delivery.send(sender, unreliable, state);
                 *out = &delivery;
                 return true;
@@ -369,12 +371,16 @@ bool startsWith(const std::string& input, const std::string& pattern)
 class ApplicationPropertiesAdapter : public qpid::amqp::MessageEncoder::ApplicationProperties
 {
   public:
-    ApplicationPropertiesAdapter(const qpid::types::Variant::Map& h) : headers(h) {}
+    ApplicationPropertiesAdapter(const qpid::types::Variant::Map& h, const std::string& c) : headers(h), compression(c) {}
     void handle(qpid::amqp::MapHandler& h) const
     {
+        if (!compression.empty()) {
+            h.handleString(convert(qpid::Compression::PROPERTY), convert(compression), convert(EMPTY));
+        }
         for (qpid::types::Variant::Map::const_iterator i = headers.begin(); i != headers.end(); ++i) {
             //strip out values with special keys as they are sent in standard fields
-            if (!startsWith(i->first, X_AMQP) || i->first == X_AMQP_0_10_APP_ID) {
+            if ((!startsWith(i->first, X_AMQP) || i->first == X_AMQP_0_10_APP_ID)
+                && (compression.empty() || i->first != qpid::Compression::PROPERTY)) {
                 qpid::amqp::CharSequence key(convert(i->first));
                 switch (i->second.getType()) {
                   case qpid::types::VAR_VOID:
@@ -429,6 +435,7 @@ class ApplicationPropertiesAdapter : public qpid::amqp::MessageEncoder::Applicat
     }
   private:
     const qpid::types::Variant::Map& headers;
+    const std::string& compression;
 
     static qpid::amqp::CharSequence convert(const std::string& in)
     {
@@ -453,7 +460,8 @@ void SenderContext::Delivery::reset()
     token = 0;
 }
 
-void SenderContext::Delivery::encode(const qpid::messaging::MessageImpl& msg, const qpid::messaging::Address& address, bool setToField)
+void SenderContext::Delivery::encode(const qpid::messaging::MessageImpl& msg, const qpid::messaging::Address& address, bool setToField,
+                                     const std::string& compression)
 {
     try {
         boost::shared_ptr<const EncodedMessage> original = msg.getEncoded();
@@ -477,13 +485,18 @@ void SenderContext::Delivery::encode(const qpid::messaging::MessageImpl& msg, co
         } else {
             HeaderAdapter header(msg);
             PropertiesAdapter properties(msg, address.getSubject(), setToField ? address.getName() : EMPTY);
-            ApplicationPropertiesAdapter applicationProperties(msg.getHeaders());
+            //only raw bodies are compressed; structured content is sent as an AmqpValue
+            std::string compressed;
+            bool isCompressed = !compression.empty() && msg.getContent().isVoid()
+                && qpid::Compression::compress(compression, msg.getBytes().data(), msg.getBytes().size(), compressed);
+            const std::string& body = isCompressed ? compressed : msg.getBytes();
+            ApplicationPropertiesAdapter applicationProperties(msg.getHeaders(), isCompressed ? compression : EMPTY);
             //compute size:
             size_t contentSize = qpid::amqp::MessageEncoder::getEncodedSize(header)
                 + qpid::amqp::MessageEncoder::getEncodedSize(properties)
                 + qpid::amqp::MessageEncoder::getEncodedSize(applicationProperties);
             if (msg.getContent().isVoid()) {
-                contentSize += qpid::amqp::MessageEncoder::getEncodedSizeForContent(msg.getBytes());
+                contentSize += qpid::amqp::MessageEncoder::getEncodedSizeForContent(body);
             } else {
                 contentSize += qpid::amqp::MessageEncoder::getEncodedSizeForValue(msg.getContent()) + 3/*descriptor*/;
             }
@@ -501,8 +514,8 @@ void SenderContext::Delivery::encode(const qpid::messaging::MessageImpl& msg, co
             if (!msg.getContent().isVoid()) {
                 //write as AmqpValue
                 encoder.writeValue(msg.getContent(), &qpid::amqp::message::AMQP_VALUE);
-            } else if (msg.getBytes().size()) {
-                encoder.writeBinary(msg.getBytes(), &qpid::amqp::message::DATA);//structured content not yet directly supported
+            } else if (body.size()) {
+                encoder.writeBinary(body, &qpid::amqp::message::DATA);//structured content not yet directly supported
             }
             if (encoder.getPosition() < encoded.getSize()) {
                 QPID_LOG(debug, "Trimming buffer from " << encoded.getSize() << " to " << encoder.getPosition());
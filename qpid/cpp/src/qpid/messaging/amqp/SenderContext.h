@@ -53,7 +53,8 @@ class SenderContext
     {
       public:
         Delivery(int32_t id);
-        void encode(const qpid::messaging::MessageImpl& message, const qpid::messaging::Address&, bool setToField);
+        void encode(const qpid::messaging::MessageImpl& message, const qpid::messaging::Address&, bool setToField,
+                    const std::string& compression=std::string());
         void send(pn_link_t*, bool unreliable, const types::Variant& state=types::Variant());
         bool delivered();
         bool accepted();
@@ -107,6 +108,7 @@ class SenderContext
     Deliveries deliveries;
     uint32_t capacity;
     bool unreliable;
+    const std::string compression;
     bool setToOnSend;
     boost::shared_ptr<Transaction> transaction;
 
@@ -22,6 +22,7 @@
  */
 
 #include "qpid/CommonImportExport.h"
+#include "qpid/RefCountedBuffer.h"
 
 #include "qpid/sys/IntegerTypes.h"
 
@@ -84,6 +85,7 @@ struct AsynchIOBufferBase {
     int32_t byteCount;
     int32_t dataStart;
     int32_t dataCount;
+    BufferRef ref;  // Set if bytes is reference counted, see detach()
     
     AsynchIOBufferBase(char* const b, const int32_t s) :
         bytes(b),
@@ -91,6 +93,14 @@ struct AsynchIOBufferBase {
         dataStart(0),
         dataCount(0)
     {}
+
+    AsynchIOBufferBase(const BufferRef& r) :
+        bytes(r.begin()),
+        byteCount(r.end() - r.begin()),
+        dataStart(0),
+        dataCount(0),
+        ref(r)
+    {}
     
     virtual ~AsynchIOBufferBase()
     {}
@@ -101,6 +111,18 @@ struct AsynchIOBufferBase {
             dataStart = 0;
         }
     }
+
+    /** If decoded frames still reference this buffer, move any unconsumed
+     * data to new memory so that the buffer can be reused for reading.
+     */
+    void detach() {
+        if (ref.unique()) return;
+        BufferRef fresh = RefCountedBuffer::create(byteCount);
+        ::memcpy(fresh.begin(), bytes + dataStart, dataCount);
+        ref = fresh;
+        bytes = fresh.begin();
+        dataStart = 0;
+    }
 };
 
 /*
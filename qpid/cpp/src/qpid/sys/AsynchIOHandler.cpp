@@ -135,7 +135,11 @@ void AsynchIOHandler::readbuff(AsynchIO& , AsynchIO::BufferBase* buff) {
     size_t decoded = 0;
     if (codec) {                // Already initiated
         try {
-            decoded = codec->decode(buff->bytes+buff->dataStart, buff->dataCount);
+            if (buff->ref.begin()) {
+                decoded = codec->decodeShared(buff->ref, buff->bytes+buff->dataStart, buff->dataCount);
+            } else {
+                decoded = codec->decode(buff->bytes+buff->dataStart, buff->dataCount);
+            }
         }catch(const std::exception& e){
             QPID_LOG(error, e.what());
             readError = true;
@@ -173,9 +177,12 @@ void AsynchIOHandler::readbuff(AsynchIO& , AsynchIO::BufferBase* buff) {
         // Adjust buffer for used bytes and then "unread them"
         buff->dataStart += decoded;
         buff->dataCount -= decoded;
+        buff->detach();
         aio->unread(buff);
     } else {
         // Give whole buffer back to aio subsystem
+        buff->dataCount = 0;
+        buff->detach();
         aio->queueReadBuffer(buff);
     }
 }
@@ -21,6 +21,7 @@
  * under the License.
  *
  */
+#include "qpid/BufferRef.h"
 #include <cstddef>
 
 namespace qpid {
@@ -40,6 +41,15 @@ class Codec
      */
     virtual std::size_t decode(const char* buffer, std::size_t size) = 0;
 
+    /** Decode from a region of the reference counted buffer backing.
+     * Codecs that can keep references into the buffer instead of copying
+     * from it override this; by default it is the same as decode().
+     */
+    virtual std::size_t decodeShared(const BufferRef& backing, const char* buffer, std::size_t size) {
+        (void) backing;
+        return decode(buffer, size);
+    }
+
 
     /** Encode into buffer, return number of bytes encoded */
     virtual std::size_t encode(char* buffer, std::size_t size) = 0;
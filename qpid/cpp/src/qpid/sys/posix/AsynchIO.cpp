@@ -40,7 +40,6 @@
 
 #include <boost/bind.hpp>
 #include <boost/lexical_cast.hpp>
-#include <boost/shared_array.hpp>
 
 namespace qpid {
 namespace sys {
@@ -293,7 +292,6 @@ private:
     std::deque<BufferBase*> bufferQueue;
     std::deque<BufferBase*> writeQueue;
     std::vector<BufferBase> buffers;
-    boost::shared_array<char> bufferMemory;
     bool queuedClose;
     /**
      * This flag is used to detect and handle concurrency between
@@ -337,14 +335,13 @@ void AsynchIO::start(Poller::shared_ptr poller) {
 }
 
 void AsynchIO::createBuffers(uint32_t size) {
-    // Allocate all the buffer memory at once
-    bufferMemory.reset(new char[size*BufferCount]);
-
     // Create the Buffer structs in a vector
-    // And push into the buffer queue
+    // And push into the buffer queue.
+    // Each buffer's memory is reference counted so that decoded frames can
+    // refer to it after the buffer has been given back (see AsynchIOHandler)
     buffers.reserve(BufferCount);
     for (uint32_t i = 0; i < BufferCount; i++) {
-        buffers.push_back(BufferBase(&bufferMemory[i*size], size));
+        buffers.push_back(BufferBase(RefCountedBuffer::create(size)));
         queueReadBuffer(&buffers[i]);
     }
 }
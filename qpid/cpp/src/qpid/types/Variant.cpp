@@ -26,6 +26,7 @@
 #include <boost/algorithm/string.hpp>
 #include <algorithm>
 #include <limits>
+#include <new>
 #include <sstream>
 
 namespace qpid {
@@ -34,6 +35,10 @@ namespace types {
 namespace {
 const std::string EMPTY;
 const std::string PREFIX("invalid conversion: ");
+
+typedef std::string String;
+typedef Variant::Map Map;
+typedef Variant::List List;
 }
 
 InvalidConversion::InvalidConversion(const std::string& msg) : Exception(PREFIX + msg) {}
@@ -95,6 +100,15 @@ class VariantImpl
     Variant::List descriptors;         // Optional descriptors for described value.
 
   private:
+    // Space for the largest of the non-scalar values, which are
+    // constructed in place rather than allocated separately.
+    union Storage {
+        char uuid[sizeof(Uuid)];
+        char map[sizeof(Variant::Map)];
+        char list[sizeof(Variant::List)];
+        char string[sizeof(std::string)];
+    };
+
     VariantType type;
     union {
         bool b;
@@ -108,16 +122,23 @@ class VariantImpl
         int64_t i64;
         float f;
         double d;
-        Uuid* uuid;
-        Variant::Map* map;
-        Variant::List* list;
-        std::string* string;
+        void* align;
+        char object[sizeof(Storage)];
     } value;
     std::string encoding;       // Optional encoding for variable length data.
 
+    Uuid& uuid() { return *reinterpret_cast<Uuid*>(value.object); }
+    const Uuid& uuid() const { return *reinterpret_cast<const Uuid*>(value.object); }
+    Variant::Map& map() { return *reinterpret_cast<Variant::Map*>(value.object); }
+    const Variant::Map& map() const { return *reinterpret_cast<const Variant::Map*>(value.object); }
+    Variant::List& list() { return *reinterpret_cast<Variant::List*>(value.object); }
+    const Variant::List& list() const { return *reinterpret_cast<const Variant::List*>(value.object); }
+    std::string& string() { return *reinterpret_cast<std::string*>(value.object); }
+    const std::string& string() const { return *reinterpret_cast<const std::string*>(value.object); }
+
   template<class T> T convertFromString() const
     {
-        const std::string& s = *value.string;
+        const std::string& s = string();
 
         try {
             // Extra shenanigans to work around negative zero
@@ -152,33 +173,33 @@ void VariantImpl::set(int32_t i) { reset(); type = VAR_INT32; value.i32 = i; }
 void VariantImpl::set(int64_t i) { reset(); type = VAR_INT64; value.i64 = i; }
 void VariantImpl::set(float f) { reset(); type = VAR_FLOAT; value.f = f; }
 void VariantImpl::set(double d) { reset(); type = VAR_DOUBLE; value.d = d; }
-void VariantImpl::set(const std::string& s, const std::string& e) { reset();  type = VAR_STRING; encoding = e; value.string = new std::string(s); }
+void VariantImpl::set(const std::string& s, const std::string& e) { reset(); new (value.object) std::string(s); type = VAR_STRING; encoding = e; }
 
 void VariantImpl::set(const Variant::Map& m) {
     reset();
+    new (value.object) Variant::Map(m);
     type = VAR_MAP;
-    value.map = new Variant::Map(m);
 }
 
-void VariantImpl::set(const Variant::List& l) { reset(); type = VAR_LIST; value.list = new Variant::List(l); }
+void VariantImpl::set(const Variant::List& l) { reset(); new (value.object) Variant::List(l); type = VAR_LIST; }
 
-void VariantImpl::set(const Uuid& u) { reset(); type = VAR_UUID; value.uuid = new Uuid(u); }
+void VariantImpl::set(const Uuid& u) { reset(); new (value.object) Uuid(u); type = VAR_UUID; }
 
 VariantImpl::~VariantImpl() { reset(); }
 
 void VariantImpl::reset() {
     switch (type) {
       case VAR_STRING:
-        delete value.string;
+        string().~String();
         break;
       case VAR_MAP:
-        delete value.map;
+        map().~Map();
         break;
       case VAR_LIST:
-        delete value.list;
+        list().~List();
         break;
       case VAR_UUID:
-        delete value.uuid;
+        uuid().~Uuid();
         break;
       default:
         break;
@@ -238,7 +259,7 @@ bool VariantImpl::asBool() const
       case VAR_INT16: return value.i16;
       case VAR_INT32: return value.i32;
       case VAR_INT64: return value.i64;
-      case VAR_STRING: return toBool(*value.string);
+      case VAR_STRING: return toBool(string());
       default: throw InvalidConversion(QPID_MSG("Cannot convert from " << getTypeName(type) << " to " << getTypeName(VAR_BOOL)));
     }
 }
@@ -517,8 +538,8 @@ std::string VariantImpl::asString() const
       case VAR_INT64: return boost::lexical_cast<std::string>(value.i64);
       case VAR_DOUBLE: return boost::lexical_cast<std::string>(value.d);
       case VAR_FLOAT: return boost::lexical_cast<std::string>(value.f);
-      case VAR_STRING: return *value.string;
-      case VAR_UUID: return value.uuid->str();
+      case VAR_STRING: return string();
+      case VAR_UUID: return uuid().str();
       case VAR_LIST: return toString(asList());
       case VAR_MAP: return toString(asMap());
       default: throw InvalidConversion(QPID_MSG("Cannot convert from " << getTypeName(type) << " to " << getTypeName(VAR_STRING)));
@@ -527,7 +548,7 @@ std::string VariantImpl::asString() const
 Uuid VariantImpl::asUuid() const
 {
     switch(type) {
-      case VAR_UUID: return *value.uuid;
+      case VAR_UUID: return uuid();
       default: throw InvalidConversion(QPID_MSG("Cannot convert from " << getTypeName(type) << " to " << getTypeName(VAR_UUID)));
     }
 }
@@ -548,8 +569,8 @@ bool VariantImpl::isEqualTo(VariantImpl& other) const
           case VAR_INT64: return value.i64 == other.value.i64;
           case VAR_DOUBLE: return value.d == other.value.d;
           case VAR_FLOAT: return value.f == other.value.f;
-          case VAR_STRING: return *value.string == *other.value.string;
-          case VAR_UUID: return *value.uuid == *other.value.uuid;
+          case VAR_STRING: return string() == other.string();
+          case VAR_UUID: return uuid() == other.uuid();
           case VAR_LIST: return equal(asList(), other.asList());
           case VAR_MAP: return equal(asMap(), other.asMap());
         }
@@ -560,7 +581,7 @@ bool VariantImpl::isEqualTo(VariantImpl& other) const
 const Variant::Map& VariantImpl::asMap() const
 {
     switch(type) {
-      case VAR_MAP: return *value.map;
+      case VAR_MAP: return map();
       default: throw InvalidConversion(QPID_MSG("Cannot convert from " << getTypeName(type) << " to " << getTypeName(VAR_MAP)));
     }
 }
@@ -568,7 +589,7 @@ const Variant::Map& VariantImpl::asMap() const
 Variant::Map& VariantImpl::asMap()
 {
     switch(type) {
-      case VAR_MAP: return *value.map;
+      case VAR_MAP: return map();
       default: throw InvalidConversion(QPID_MSG("Cannot convert from " << getTypeName(type) << " to " << getTypeName(VAR_MAP)));
     }
 }
@@ -576,7 +597,7 @@ Variant::Map& VariantImpl::asMap()
 const Variant::List& VariantImpl::asList() const
 {
     switch(type) {
-      case VAR_LIST: return *value.list;
+      case VAR_LIST: return list();
       default: throw InvalidConversion(QPID_MSG("Cannot convert from " << getTypeName(type) << " to " << getTypeName(VAR_LIST)));
     }
 }
@@ -584,7 +605,7 @@ const Variant::List& VariantImpl::asList() const
 Variant::List& VariantImpl::asList()
 {
     switch(type) {
-      case VAR_LIST: return *value.list;
+      case VAR_LIST: return list();
       default: throw InvalidConversion(QPID_MSG("Cannot convert from " << getTypeName(type) << " to " << getTypeName(VAR_LIST)));
     }
 }
@@ -592,7 +613,7 @@ Variant::List& VariantImpl::asList()
 std::string& VariantImpl::getString()
 {
     switch(type) {
-      case VAR_STRING: return *value.string;
+      case VAR_STRING: return string();
       default: throw InvalidConversion(QPID_MSG("Variant is not a string; use asString() if conversion is required."));
     }
 }
@@ -600,7 +621,7 @@ std::string& VariantImpl::getString()
 const std::string& VariantImpl::getString() const
 {
     switch(type) {
-      case VAR_STRING: return *value.string;
+      case VAR_STRING: return string();
       default: throw InvalidConversion(QPID_MSG("Variant is not a string; use asString() if conversion is required."));
     }
 }
@@ -663,7 +684,7 @@ void VariantImpl::set(const Variant& v)
       case VAR_INT64: set(v.asInt64()); break;
       case VAR_FLOAT: set(v.asFloat()); break;
       case VAR_DOUBLE: set(v.asDouble()); break;
-      case VAR_STRING: set(v.asString(), v.getEncoding()); break;
+      case VAR_STRING: set(v.getString(), v.getEncoding()); break;
       case VAR_MAP: set(v.asMap()); break;
       case VAR_LIST: set(v.asList()); break;
       case VAR_UUID: set(v.asUuid()); break;
@@ -691,7 +712,7 @@ Variant::Variant(const char* s) : impl(new VariantImpl()) { impl->set(std::strin
 Variant::Variant(const char* s, const char* encoding) : impl(new VariantImpl()) { impl->set(std::string(s), std::string(encoding)); }
 Variant::Variant(const Map& m) : impl(new VariantImpl()) { impl->set(m); }
 Variant::Variant(const List& l) : impl(new VariantImpl()) { impl->set(l); }
-Variant::Variant(const Variant& v) : impl(new VariantImpl()) { impl->set(v); }
+Variant::Variant(const Variant& v) : impl(0) { if (v.impl) { impl = new VariantImpl(); impl->set(v); } }
 Variant::Variant(const Uuid& u) : impl(new VariantImpl()) { impl->set(u); }
 
 Variant::~Variant() { if (impl) delete impl; }
@@ -800,7 +821,7 @@ Variant& Variant::operator=(const List& l)
 
 Variant& Variant::operator=(const Variant& v)
 {
-    assure(impl)->set(v);
+    if (&v != this) assure(impl)->set(v);
     return *this;
 }
 
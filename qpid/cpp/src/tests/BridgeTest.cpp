@@ -0,0 +1,173 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "qpid/broker/Bridge.h"
+#include "unit_test.h"
+
+namespace qpid {
+namespace tests {
+
+QPID_AUTO_TEST_SUITE(BridgeTestSuite)
+
+using broker::Bridge;
+
+namespace {
+const std::string ORIGIN("origin");
+
+Bridge::PendingBinding pending(const std::string& key, bool bind, bool coalesce=true) {
+    Bridge::PendingBinding p;
+    p.key = key;
+    p.id = std::make_pair(key, ORIGIN);
+    p.bind = bind;
+    p.coalesce = coalesce;
+    return p;
+}
+
+// Keys of the changes left in batch, with "+" for bind and "-" for unbind.
+std::string keys(const std::vector<Bridge::PendingBinding>& batch) {
+    std::string result;
+    for (size_t i = 0; i < batch.size(); ++i)
+        result += (batch[i].bind ? "+" : "-") + batch[i].key;
+    return result;
+}
+}
+
+QPID_AUTO_TEST_CASE(testOrderKept) {
+    std::vector<Bridge::PendingBinding> batch;
+    Bridge::BindingIds propagated;
+    batch.push_back(pending("a", true));
+    batch.push_back(pending("b", true));
+    batch.push_back(pending("c", true));
+    Bridge::coalesceBindings(batch, propagated);
+    BOOST_CHECK_EQUAL(keys(batch), "+a+b+c");
+    BOOST_CHECK_EQUAL(propagated.size(), 3u);
+}
+
+QPID_AUTO_TEST_CASE(testLastChangeWins) {
+    std::vector<Bridge::PendingBinding> batch;
+    Bridge::BindingIds propagated;
+    batch.push_back(pending("a", true));
+    batch.push_back(pending("b", true));
+    batch.push_back(pending("a", false));
+    batch.push_back(pending("b", false));
+    batch.push_back(pending("b", true));
+    Bridge::coalesceBindings(batch, propagated);
+    // a was never on the peer, so its bind and unbind cancel out.
+    BOOST_CHECK_EQUAL(keys(batch), "+b");
+    BOOST_CHECK(propagated.count(std::make_pair(std::string("b"), ORIGIN)));
+    BOOST_CHECK(!propagated.count(std::make_pair(std::string("a"), ORIGIN)));
+}
+
+QPID_AUTO_TEST_CASE(testDuplicatesDropped) {
+    std::vector<Bridge::PendingBinding> batch;
+    Bridge::BindingIds propagated;
+    batch.push_back(pending("a", true));
+    batch.push_back(pending("a", true));
+    Bridge::coalesceBindings(batch, propagated);
+    BOOST_CHECK_EQUAL(keys(batch), "+a");
+
+    // Already bound on the peer: a later batch with another bind sends nothing.
+    batch.clear();
+    batch.push_back(pending("a", true));
+    Bridge::coalesceBindings(batch, propagated);
+    BOOST_CHECK(batch.empty());
+
+    // Unbind of a key the peer never had sends nothing.
+    batch.push_back(pending("b", false));
+    Bridge::coalesceBindings(batch, propagated);
+    BOOST_CHECK(batch.empty());
+
+    // Unbind then rebind of a bound key leaves the peer as it is.
+    batch.push_back(pending("a", false));
+    batch.push_back(pending("a", true));
+    Bridge::coalesceBindings(batch, propagated);
+    BOOST_CHECK(batch.empty());
+    BOOST_CHECK_EQUAL(propagated.size(), 1u);
+
+    batch.push_back(pending("a", false));
+    Bridge::coalesceBindings(batch, propagated);
+    BOOST_CHECK_EQUAL(keys(batch), "-a");
+    BOOST_CHECK(propagated.empty());
+}
+
+// Changes with extra arguments or other operations are always sent, in order.
+QPID_AUTO_TEST_CASE(testUncoalesced) {
+    std::vector<Bridge::PendingBinding> batch;
+    Bridge::BindingIds propagated;
+    batch.push_back(pending("a", true));
+    batch.push_back(pending("x", true, false));
+    batch.push_back(pending("x", true, false));
+    batch.push_back(pending("b", true));
+    batch.push_back(pending("a", true));
+    Bridge::coalesceBindings(batch, propagated);
+    BOOST_CHECK_EQUAL(keys(batch), "+x+x+b+a");
+    BOOST_CHECK_EQUAL(propagated.size(), 2u);
+}
+
+namespace {
+const uint32_t CREDIT = 100;
+const sys::Duration RTT(100*sys::TIME_MSEC);
+}
+
+QPID_AUTO_TEST_CASE(testCreditUnknownRtt) {
+    BOOST_CHECK_EQUAL(Bridge::adaptCreditWindow(CREDIT, CREDIT, 100000, 0), CREDIT);
+}
+
+// While the window limits the rate, rate*rtt is about the window and the
+// window doubles each visit up to the limit.
+QPID_AUTO_TEST_CASE(testCreditGrowth) {
+    uint32_t window = CREDIT;
+    for (int i = 0; i < 5; ++i) {
+        uint32_t rate = uint32_t(uint64_t(window) * sys::TIME_SEC / int64_t(RTT));
+        uint32_t next = Bridge::adaptCreditWindow(window, CREDIT, rate, RTT);
+        BOOST_CHECK_EQUAL(next, 2*window);
+        window = next;
+    }
+    uint32_t rate = 10*Bridge::MAX_ADAPTIVE_CREDIT;
+    window = Bridge::adaptCreditWindow(window, CREDIT, rate, RTT);
+    BOOST_CHECK_EQUAL(window, Bridge::MAX_ADAPTIVE_CREDIT);
+    BOOST_CHECK_EQUAL(Bridge::adaptCreditWindow(window, CREDIT, rate, RTT),
+                      Bridge::MAX_ADAPTIVE_CREDIT);
+}
+
+// Once the link is the limit the measured rate stops growing and so does the window.
+QPID_AUTO_TEST_CASE(testCreditSteady) {
+    uint32_t window = 4000;
+    uint32_t rate = 15000;      // 1500 messages per rtt, window is not the limit.
+    BOOST_CHECK_EQUAL(Bridge::adaptCreditWindow(window, CREDIT, rate, RTT), window);
+}
+
+QPID_AUTO_TEST_CASE(testCreditShrink) {
+    uint32_t window = 6400;
+    // A small dip in the rate does not shrink the window.
+    BOOST_CHECK_EQUAL(Bridge::adaptCreditWindow(window, CREDIT, 20000, RTT), window);
+    // A large drop in the rate does.
+    BOOST_CHECK_EQUAL(Bridge::adaptCreditWindow(window, CREDIT, 5000, RTT), 1000u);
+    // So does a drop in the rtt.
+    BOOST_CHECK_EQUAL(Bridge::adaptCreditWindow(window, CREDIT, 20000, RTT/10), 400u);
+    // An idle link goes back to the configured credit, never below.
+    BOOST_CHECK_EQUAL(Bridge::adaptCreditWindow(window, CREDIT, 0, RTT), CREDIT);
+    BOOST_CHECK_EQUAL(Bridge::adaptCreditWindow(CREDIT, CREDIT, 0, RTT), CREDIT);
+}
+
+QPID_AUTO_TEST_SUITE_END()
+
+}} // namespace qpid::tests
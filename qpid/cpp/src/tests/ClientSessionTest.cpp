@@ -327,6 +327,37 @@ QPID_AUTO_TEST_CASE(testRelease) {
     fix.session.close();
 }
 
+QPID_AUTO_TEST_CASE(testCancelWithUnacked) {
+    ClientSessionFixture fix;
+
+    const uint count=10;
+    for (uint i = 0; i < count; i++) {
+        Message m((boost::format("Message_%1%") % (i+1)).str(), "my-queue");
+        fix.session.messageTransfer(arg::content=m);
+    }
+
+    fix.subs.setAutoStop(false);
+    fix.subs.start();
+    SubscriptionSettings settings;
+    settings.autoAck = 0;
+
+    SimpleListener l1;
+    Subscription s1 = fix.subs.subscribe(l1, "my-queue", settings);
+    l1.waitFor(count);
+    // Cancelling drops the broker's consumer while its deliveries are unacked.
+    s1.cancel();
+    BOOST_CHECK_EQUAL(count, fix.session.queueQuery(string("my-queue")).getMessageCount());
+
+    // The cancelled deliveries can still be accepted.
+    s1.accept(s1.getUnaccepted());
+    fix.session.sync();
+    BOOST_CHECK_EQUAL(0u, fix.session.queueQuery(string("my-queue")).getMessageCount());
+
+    fix.subs.stop();
+    fix.subs.wait();
+    fix.session.close();
+}
+
 QPID_AUTO_TEST_CASE(testCompleteOnAccept) {
     ClientSessionFixture fix;
     const uint count = 8;
@@ -0,0 +1,116 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "qpid/Compression.h"
+#include "qpid/Exception.h"
+
+#include "unit_test.h"
+
+#include <string>
+
+namespace qpid {
+namespace tests {
+
+QPID_AUTO_TEST_SUITE(CompressionTestSuite)
+
+namespace {
+std::string payload(size_t size)
+{
+    std::string s;
+    for (size_t i = 0; s.size() < size; ++i) {
+        s += "{\"id\": ";
+        s += char('0' + i % 10);
+        s += ", \"name\": \"item\", \"tags\": [\"a\", \"b\"]}, ";
+    }
+    s.resize(size);
+    return s;
+}
+}
+
+QPID_AUTO_TEST_CASE(testRoundTrip)
+{
+    if (!Compression::isSupported(Compression::DEFLATE)) return;
+    std::string in = payload(64*1024);
+    std::string compressed;
+    BOOST_CHECK(Compression::compress(Compression::DEFLATE, in.data(), in.size(), compressed));
+    BOOST_CHECK(compressed.size() < in.size());
+    std::string out;
+    BOOST_CHECK(Compression::decompress(Compression::DEFLATE, compressed.data(), compressed.size(), out));
+    BOOST_CHECK(out == in);
+}
+
+QPID_AUTO_TEST_CASE(testSmallBodyNotCompressed)
+{
+    std::string in = payload(Compression::MIN_SIZE - 1);
+    std::string out;
+    BOOST_CHECK(!Compression::compress(Compression::DEFLATE, in.data(), in.size(), out));
+    BOOST_CHECK(out.empty());
+}
+
+QPID_AUTO_TEST_CASE(testIncompressibleBodyNotCompressed)
+{
+    std::string in;
+    uint32_t x = 12345;
+    for (size_t i = 0; i < 4096; ++i) {
+        x = x * 1103515245 + 12345;
+        in += char(x >> 24);
+    }
+    std::string out;
+    BOOST_CHECK(!Compression::compress(Compression::DEFLATE, in.data(), in.size(), out));
+}
+
+QPID_AUTO_TEST_CASE(testUnsupportedAlgorithm)
+{
+    BOOST_CHECK(!Compression::isSupported("no-such-algorithm"));
+    std::string in = payload(4096);
+    std::string out;
+    BOOST_CHECK(!Compression::compress("no-such-algorithm", in.data(), in.size(), out));
+    BOOST_CHECK(!Compression::decompress("no-such-algorithm", in.data(), in.size(), out));
+}
+
+QPID_AUTO_TEST_CASE(testCorruptData)
+{
+    if (!Compression::isSupported(Compression::DEFLATE)) return;
+    std::string in = payload(4096);
+    std::string compressed;
+    BOOST_CHECK(Compression::compress(Compression::DEFLATE, in.data(), in.size(), compressed));
+    std::string out;
+    BOOST_CHECK_THROW(Compression::decompress(Compression::DEFLATE, compressed.data(), compressed.size()/2, out), qpid::Exception);
+    BOOST_CHECK_THROW(Compression::decompress(Compression::DEFLATE, in.data(), in.size(), out), qpid::Exception);
+}
+
+QPID_AUTO_TEST_CASE(testDecompressLimit)
+{
+    if (!Compression::isSupported(Compression::DEFLATE)) return;
+    std::string in(1024*1024, 'x');
+    std::string compressed;
+    BOOST_CHECK(Compression::compress(Compression::DEFLATE, in.data(), in.size(), compressed));
+    std::string out;
+    BOOST_CHECK_THROW(Compression::decompress(Compression::DEFLATE, compressed.data(), compressed.size(), out, in.size() - 1),
+                      qpid::Exception);
+    BOOST_CHECK(out.empty());
+    BOOST_CHECK(Compression::decompress(Compression::DEFLATE, compressed.data(), compressed.size(), out, in.size()));
+    BOOST_CHECK(out == in);
+}
+
+QPID_AUTO_TEST_SUITE_END()
+
+}} // namespace qpid::tests
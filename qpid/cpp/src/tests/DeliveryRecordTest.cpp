@@ -24,6 +24,7 @@
 #include "unit_test.h"
 #include <iostream>
 #include <memory>
+#include <vector>
 #include <boost/format.hpp>
 
 using namespace qpid::broker;
@@ -49,7 +50,7 @@ QPID_AUTO_TEST_CASE(testSort)
 
     list<DeliveryRecord> records;
     for (list<SequenceNumber>::iterator i = ids.begin(); i != ids.end(); i++) {
-        DeliveryRecord r(QueueCursor(CONSUMER), framing::SequenceNumber(), SequenceNumber(), Queue::shared_ptr(), "tag", Consumer::shared_ptr(), false, false, false);
+        DeliveryRecord r(QueueCursor(CONSUMER), framing::SequenceNumber(), SequenceNumber(), Queue::shared_ptr(), DeliveryRecord::Tag(new std::string("tag")), Consumer::shared_ptr(), false, false, false);
         r.setId(*i);
         records.push_back(r);
     }
@@ -61,6 +62,89 @@ QPID_AUTO_TEST_CASE(testSort)
     }
 }
 
+namespace {
+DeliveryRecords makeRecords(uint32_t count)
+{
+    DeliveryRecord::Tag tag(new std::string("tag"));
+    DeliveryRecords records;
+    for (uint32_t i = 1; i <= count; ++i) {
+        DeliveryRecord r(QueueCursor(CONSUMER), SequenceNumber(), SequenceNumber(), Queue::shared_ptr(), tag, Consumer::shared_ptr(), false, false, false);
+        r.setId(i);
+        records.push_back(r);
+    }
+    return records;
+}
+
+struct Collect
+{
+    std::vector<uint32_t>& ids;
+    bool result;
+    Collect(std::vector<uint32_t>& i, bool r) : ids(i), result(r) {}
+    bool operator()(DeliveryRecord& r) { ids.push_back(r.getId().getValue()); return result; }
+};
+}
+
+QPID_AUTO_TEST_CASE(testForEachInSet)
+{
+    DeliveryRecords records = makeRecords(10);
+    SequenceSet ids;
+    ids.add(2, 4);
+    ids.add(7);
+    ids.add(12, 20);//beyond the last record
+    std::vector<uint32_t> visited;
+    forEachInSet(records, ids, Collect(visited, false));
+    uint32_t expected[] = {2, 3, 4, 7};
+    BOOST_CHECK_EQUAL_COLLECTIONS(visited.begin(), visited.end(), expected, expected + 4);
+    BOOST_CHECK_EQUAL(records.size(), 10u);
+}
+
+QPID_AUTO_TEST_CASE(testRemoveInSet)
+{
+    DeliveryRecords records = makeRecords(10);
+    SequenceSet ids;
+    ids.add(1, 3);
+    ids.add(6, 7);
+    ids.add(10);
+    std::vector<uint32_t> visited;
+    removeInSet(records, ids, Collect(visited, true));
+    BOOST_CHECK_EQUAL(visited.size(), 6u);
+    uint32_t remaining[] = {4, 5, 8, 9};
+    BOOST_CHECK_EQUAL(records.size(), 4u);
+    for (size_t i = 0; i < records.size(); ++i) {
+        BOOST_CHECK_EQUAL(records[i].getId().getValue(), remaining[i]);
+    }
+
+    //records for which the predicate is false are kept
+    visited.clear();
+    ids.clear();
+    ids.add(1, 10);
+    removeInSet(records, ids, Collect(visited, false));
+    BOOST_CHECK_EQUAL(visited.size(), 4u);
+    BOOST_CHECK_EQUAL(records.size(), 4u);
+}
+
+QPID_AUTO_TEST_CASE(testCancelByTag)
+{
+    DeliveryRecord::Tag tag(new std::string("tag"));
+    DeliveryRecord::Tag other(new std::string("tag"));
+    DeliveryRecords records;
+    for (uint32_t i = 1; i <= 4; ++i) {
+        DeliveryRecord r(QueueCursor(CONSUMER), SequenceNumber(), SequenceNumber(), Queue::shared_ptr(), i % 2 ? tag : other, Consumer::shared_ptr(), false, false, true);
+        r.setId(i);
+        records.push_back(r);
+    }
+    //records are matched on the shared tag, not on its value, and the
+    //tag stays valid after the consumer that owned it has gone
+    DeliveryRecord::Tag cancelled = tag;
+    tag.reset();
+    for (DeliveryRecords::iterator i = records.begin(); i != records.end(); ++i) {
+        i->cancel(cancelled);
+    }
+    for (size_t i = 0; i < records.size(); ++i) {
+        BOOST_CHECK_EQUAL(records[i].isCancelled(), i % 2 == 0);
+        BOOST_CHECK_EQUAL(records[i].getTag(), "tag");
+    }
+}
 
 QPID_AUTO_TEST_SUITE_END()
 
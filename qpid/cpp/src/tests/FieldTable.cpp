@@ -20,10 +20,13 @@
  */
 #include <iostream>
 #include <algorithm>
+#include <sstream>
 #include "qpid/framing/Array.h"
 #include "qpid/framing/FieldTable.h"
 #include "qpid/framing/FieldValue.h"
 #include "qpid/framing/List.h"
+#include "qpid/sys/Runnable.h"
+#include "qpid/sys/Thread.h"
 
 #include "unit_test.h"
 
@@ -210,6 +213,53 @@ QPID_AUTO_TEST_CASE(test64GetAndSetConverts)
 
 }
 
+namespace {
+struct Reader : qpid::sys::Runnable
+{
+    const FieldTable& table;
+    size_t matched;
+
+    Reader(const FieldTable& t) : table(t), matched(0) {}
+    void run()
+    {
+        for (int i = 0; i < 100; ++i) {
+            std::stringstream key;
+            key << "key-" << i;
+            if (table.getAsInt(key.str()) == i) ++matched;
+        }
+    }
+};
+}
+
+QPID_AUTO_TEST_CASE(testConcurrentLazyDecode)
+{
+    FieldTable source;
+    for (int i = 0; i < 100; ++i) {
+        std::stringstream key;
+        key << "key-" << i;
+        source.setInt(key.str(), i);
+    }
+    char buff[4096];
+    Buffer wbuffer(buff, sizeof(buff));
+    wbuffer.put(source);
+
+    for (int n = 0; n < 20; ++n) {
+        Buffer rbuffer(buff, sizeof(buff));
+        FieldTable table;
+        rbuffer.get(table);
+
+        // Readers race to decode the table for the first time
+        Reader r1(table), r2(table), r3(table), r4(table);
+        qpid::sys::Thread t1(r1), t2(r2), t3(r3), t4(r4);
+        t1.join(); t2.join(); t3.join(); t4.join();
+        BOOST_CHECK_EQUAL(100u, r1.matched);
+        BOOST_CHECK_EQUAL(100u, r2.matched);
+        BOOST_CHECK_EQUAL(100u, r3.matched);
+        BOOST_CHECK_EQUAL(100u, r4.matched);
+        BOOST_CHECK(table == source);
+    }
+}
+
 QPID_AUTO_TEST_SUITE_END()
 
 }} // namespace qpid::tests
@@ -24,7 +24,11 @@
 #include "qpid/framing/FrameDecoder.h"
 #include "qpid/framing/AMQContentBody.h"
 #include "qpid/framing/Buffer.h"
+#include "qpid/RefCountedBuffer.h"
+#include "qpid/sys/AsynchIO.h"
+#include <string.h>
 #include <string>
+#include <vector>
 
 
 namespace qpid {
@@ -72,6 +76,107 @@ QPID_AUTO_TEST_CASE(testByteFragments) {
 }
 
 
+QPID_AUTO_TEST_CASE(testSharedContent) {
+    string large = makeData(AMQContentBody::MIN_SHARED_SIZE);
+    string small = makeData(42);
+    string encoded = encodeFrame(large) + encodeFrame(small);
+    BufferRef ref = RefCountedBuffer::create(encoded.size());
+    ::memcpy(ref.begin(), encoded.data(), encoded.size());
+    Buffer buf(ref.begin(), encoded.size());
+    buf.setBacking(ref);
+
+    AMQFrame f1, f2;
+    BOOST_REQUIRE(f1.decode(buf));
+    BOOST_REQUIRE(f2.decode(buf));
+    const AMQContentBody* c1 = f1.castBody<AMQContentBody>();
+    const AMQContentBody* c2 = f2.castBody<AMQContentBody>();
+    // Large content references the buffer, small content is copied
+    BOOST_CHECK(c1->isShared());
+    BOOST_CHECK(c1->getDataPointer() >= ref.begin() && c1->getDataPointer() < ref.end());
+    BOOST_CHECK(!c2->isShared());
+    BOOST_CHECK_EQUAL(large, string(c1->getDataPointer(), c1->getDataSize()));
+    BOOST_CHECK_EQUAL(small, getData(f2));
+
+    // Re-encoding shared content reproduces the original frame
+    string reencoded;
+    reencoded.resize(f1.encodedSize());
+    Buffer out(&reencoded[0], reencoded.size());
+    f1.encode(out);
+    BOOST_CHECK_EQUAL(encodeFrame(large), reencoded);
+
+    // getData() on a const body copies once without unsharing, on a non-const body it makes a private copy
+    BOOST_CHECK_EQUAL(large, getData(f1));
+    BOOST_CHECK(c1->isShared());
+    const AMQContentBody& constBody = *c1;
+    BOOST_CHECK(&constBody.getData() == &constBody.getData());
+    BOOST_CHECK(c1->isShared());
+    BOOST_CHECK_EQUAL(large, f1.castBody<AMQContentBody>()->getData());
+    BOOST_CHECK(!c1->isShared());
+}
+
+QPID_AUTO_TEST_CASE(testSmallContentNotShared) {
+    // Content that would pin a much larger buffer is copied
+    string large = makeData(AMQContentBody::MIN_SHARED_SIZE);
+    string encoded = encodeFrame(large);
+    size_t backingSize = encoded.size() * AMQContentBody::MAX_SHARED_RATIO + 1;
+    BufferRef ref = RefCountedBuffer::create(backingSize);
+    ::memcpy(ref.begin(), encoded.data(), encoded.size());
+    Buffer buf(ref.begin(), encoded.size());
+    buf.setBacking(ref);
+
+    AMQFrame f;
+    BOOST_REQUIRE(f.decode(buf));
+    BOOST_CHECK(!f.castBody<AMQContentBody>()->isShared());
+    BOOST_CHECK_EQUAL(large, getData(f));
+}
+
+QPID_AUTO_TEST_CASE(testDetachSharedBuffer) {
+    string large = makeData(AMQContentBody::MIN_SHARED_SIZE);
+    string encoded = encodeFrame(large);
+    sys::AsynchIOBufferBase buff(RefCountedBuffer::create(2*encoded.size()));
+    ::memcpy(buff.bytes, encoded.data(), encoded.size());
+    ::memcpy(buff.bytes+encoded.size(), encoded.data(), 10); // Partial second frame
+    buff.dataCount = encoded.size() + 10;
+
+    AMQFrame f;
+    {
+        Buffer buf(buff.bytes, buff.dataCount);
+        buf.setBacking(buff.ref);
+        BOOST_REQUIRE(f.decode(buf));
+        BOOST_REQUIRE(!f.decode(buf));
+        buff.dataStart += buf.getPosition();
+        buff.dataCount -= buf.getPosition();
+    }
+    char* old = buff.bytes;
+    buff.detach();
+    // Unconsumed bytes moved to new memory, decoded frame unaffected by reuse
+    BOOST_CHECK(buff.bytes != old);
+    BOOST_CHECK_EQUAL(buff.dataStart, 0);
+    BOOST_CHECK_EQUAL(string(buff.bytes, 10), encoded.substr(0, 10));
+    BOOST_CHECK_EQUAL(large, string(f.castBody<AMQContentBody>()->getDataPointer(), large.size()));
+    old = buff.bytes;
+    buff.detach();
+    BOOST_CHECK(buff.bytes == old); // Nothing references the new memory
+}
+
+QPID_AUTO_TEST_CASE(testSplitAtEveryOffset) {
+    string large = makeData(AMQContentBody::MIN_SHARED_SIZE);
+    string small = makeData(42);
+    string encoded = encodeFrame(large) + encodeFrame(small) + encodeFrame(large);
+    FrameDecoder decoder;
+    for (size_t split = 1; split < encoded.size(); ++split) {
+        vector<AMQFrame> frames;
+        Buffer first(&encoded[0], split);
+        while (decoder.decode(first)) frames.push_back(decoder.getFrame());
+        Buffer second(&encoded[split], encoded.size() - split);
+        while (decoder.decode(second)) frames.push_back(decoder.getFrame());
+        // Frames still held must not be overwritten by later reassembly
+        BOOST_REQUIRE_EQUAL(frames.size(), 3u);
+        BOOST_CHECK_EQUAL(large, getData(frames[0]));
+        BOOST_CHECK_EQUAL(small, getData(frames[1]));
+        BOOST_CHECK_EQUAL(large, getData(frames[2]));
+    }
+}
 
 QPID_AUTO_TEST_SUITE_END()
 
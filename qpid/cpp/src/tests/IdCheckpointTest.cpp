@@ -0,0 +1,176 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "qpid/ha/BrokerInfo.h"
+#include "qpid/ha/IdCheckpoint.h"
+#include "qpid/framing/Buffer.h"
+#include "qpid/framing/BufferTypes.h"
+#include "unit_test.h"
+
+namespace qpid {
+namespace tests {
+
+QPID_AUTO_TEST_SUITE(IdCheckpointTestSuite)
+
+using ha::IdCheckpoint;
+using ha::ReplicationId;
+using ha::ReplicationIdSet;
+using framing::encodeStr;
+using framing::decodeStr;
+
+namespace {
+const uint32_t BUCKETS = 4;
+const uint32_t RANGES = IdCheckpoint::RANGES_PER_BUCKET * BUCKETS;
+const ReplicationId FIRST = 1;
+const ReplicationId LAST = 2*RANGES - 1;
+
+// Every other ID from FIRST, so each ID is its own range and the set is fragmented.
+ReplicationIdSet fragmented(uint32_t ranges=RANGES) {
+    ReplicationIdSet s;
+    for (uint32_t i = 0; i < ranges; ++i) s.add(2*i + 1);
+    return s;
+}
+
+ReplicationIdSet intersect(const ReplicationIdSet& a, const ReplicationIdSet& b) {
+    return a - (a - b);
+}
+
+// Check the guarantees the primary relies on: only IDs both sides hold are kept,
+// everything the backup holds that the primary does not is dropped, and nothing
+// the primary holds is dropped.
+void checkCompare(const ReplicationIdSet& backup, const ReplicationIdSet& primary,
+                  ReplicationIdSet& keep, ReplicationIdSet& drop)
+{
+    IdCheckpoint checkpoint(backup);
+    checkpoint.compare(primary, keep, drop);
+    BOOST_CHECK((keep - intersect(backup, primary)).empty());
+    BOOST_CHECK(((backup - primary) - drop).empty());
+    BOOST_CHECK(intersect(drop, primary).empty());
+}
+}
+
+QPID_AUTO_TEST_CASE(testBuckets)
+{
+    BOOST_CHECK_EQUAL(IdCheckpoint(fragmented()).bucketCount(), BUCKETS);
+    BOOST_CHECK_EQUAL(IdCheckpoint(fragmented(RANGES + 1)).bucketCount(), BUCKETS + 1);
+    BOOST_CHECK_EQUAL(IdCheckpoint(ReplicationIdSet()).bucketCount(), 0u);
+}
+
+QPID_AUTO_TEST_CASE(testSameIds)
+{
+    ReplicationIdSet ids = fragmented();
+    ReplicationIdSet keep, drop;
+    checkCompare(ids, ids, keep, drop);
+    BOOST_CHECK(keep == ids);
+    BOOST_CHECK(drop.empty());
+}
+
+QPID_AUTO_TEST_CASE(testBackupHasExtraIds)
+{
+    ReplicationIdSet backup = fragmented();
+    ReplicationIdSet primary = backup;
+    primary.remove(3);          // Dequeued on the primary, in the first bucket.
+    ReplicationIdSet keep, drop;
+    checkCompare(backup, primary, keep, drop);
+    BOOST_CHECK(drop.contains(3));
+    // Only the first bucket differs, the others are kept.
+    BOOST_CHECK_EQUAL(keep.size(), backup.size() - IdCheckpoint::RANGES_PER_BUCKET);
+    BOOST_CHECK(!keep.contains(FIRST));
+    BOOST_CHECK(keep.contains(2*IdCheckpoint::RANGES_PER_BUCKET + 1)); // First ID of the second bucket.
+}
+
+QPID_AUTO_TEST_CASE(testPrimaryHasExtraIds)
+{
+    ReplicationIdSet backup = fragmented();
+    ReplicationIdSet primary = backup;
+    // Enqueued on the primary while the backup was away, in the last bucket.
+    primary.add(LAST - 1);
+    ReplicationIdSet keep, drop;
+    checkCompare(backup, primary, keep, drop);
+    BOOST_CHECK(!keep.contains(LAST - 1)); // Must be sent to the backup.
+    BOOST_CHECK(!keep.contains(LAST));     // Bucket differs, re-sent.
+    BOOST_CHECK(intersect(drop, backup).empty()); // Nothing the backup holds is stale.
+    BOOST_CHECK_EQUAL(keep.size(), backup.size() - IdCheckpoint::RANGES_PER_BUCKET);
+}
+
+QPID_AUTO_TEST_CASE(testRangesSpanBuckets)
+{
+    // The primary holds contiguous ranges covering several backup buckets.
+    ReplicationIdSet backup = fragmented();
+    ReplicationIdSet primary(FIRST, LAST);
+    ReplicationIdSet keep, drop;
+    checkCompare(backup, primary, keep, drop);
+    BOOST_CHECK(keep.empty());
+    BOOST_CHECK(drop.empty());
+
+    // And the other way about.
+    ReplicationIdSet keep2, drop2;
+    checkCompare(primary, backup, keep2, drop2);
+    BOOST_CHECK(keep2.empty());
+    BOOST_CHECK(drop2 == primary - backup);
+}
+
+QPID_AUTO_TEST_CASE(testEmpty)
+{
+    ReplicationIdSet ids = fragmented();
+    ReplicationIdSet keep, drop;
+    checkCompare(ReplicationIdSet(), ids, keep, drop);
+    BOOST_CHECK(keep.empty());
+    BOOST_CHECK(drop.empty());
+    checkCompare(ids, ReplicationIdSet(), keep, drop);
+    BOOST_CHECK(keep.empty());
+    BOOST_CHECK((ids - drop).empty());
+}
+
+QPID_AUTO_TEST_CASE(testEncodeDecode)
+{
+    ReplicationIdSet backup = fragmented(RANGES + 7);
+    ReplicationIdSet primary = backup;
+    primary.remove(FIRST);
+    IdCheckpoint checkpoint(backup);
+    std::string encoded = encodeStr(checkpoint);
+    BOOST_CHECK_EQUAL(encoded.size(), checkpoint.encodedSize());
+    IdCheckpoint decoded = decodeStr<IdCheckpoint>(encoded);
+    BOOST_CHECK_EQUAL(decoded.bucketCount(), checkpoint.bucketCount());
+    ReplicationIdSet keep, drop, keep2, drop2;
+    checkpoint.compare(primary, keep, drop);
+    decoded.compare(primary, keep2, drop2);
+    BOOST_CHECK(keep == keep2);
+    BOOST_CHECK(drop == drop2);
+}
+
+QPID_AUTO_TEST_CASE(testBrokerInfoAdvertisesCheckpoint)
+{
+    // Backups only send a checkpoint to a primary that advertises it.
+    ha::BrokerInfo info(types::Uuid(true), ha::ACTIVE);
+    BOOST_CHECK(info.getIdCheckpoint());
+    BOOST_CHECK(ha::BrokerInfo(info.asMap()).getIdCheckpoint());
+    BOOST_CHECK(ha::BrokerInfo(info.asFieldTable()).getIdCheckpoint());
+
+    // A broker that predates checkpoints does not send the field.
+    types::Variant::Map old = info.asMap();
+    old.erase("id-checkpoint");
+    BOOST_CHECK(!ha::BrokerInfo(old).getIdCheckpoint());
+}
+
+QPID_AUTO_TEST_SUITE_END()
+
+}} // namespace qpid::tests
@@ -0,0 +1,181 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "qpid/ha/IdWindow.h"
+#include "unit_test.h"
+#include <algorithm>
+
+namespace qpid {
+namespace tests {
+
+QPID_AUTO_TEST_SUITE(IdWindowTestSuite)
+
+using ha::IdWindow;
+using ha::ReplicationId;
+
+typedef IdWindow<int> Window;
+
+QPID_AUTO_TEST_CASE(testInOrder) {
+    Window w;
+    BOOST_CHECK(w.empty());
+    for (int i = 1; i <= 10; ++i) BOOST_CHECK(w.insert(i, i*10));
+    BOOST_CHECK_EQUAL(w.size(), 10u);
+    BOOST_CHECK_EQUAL(w.overflowSize(), 0u);
+    BOOST_REQUIRE(w.find(5));
+    BOOST_CHECK_EQUAL(*w.find(5), 50);
+    BOOST_CHECK(!w.find(0));
+    BOOST_CHECK(!w.find(11));
+    int v = 0;
+    for (int i = 1; i <= 10; ++i) {
+        BOOST_CHECK(w.remove(i, v));
+        BOOST_CHECK_EQUAL(v, i*10);
+    }
+    BOOST_CHECK(w.empty());
+    BOOST_CHECK(!w.remove(1, v));
+}
+
+QPID_AUTO_TEST_CASE(testDuplicate) {
+    Window w;
+    BOOST_CHECK(w.insert(1, 1));
+    BOOST_CHECK(!w.insert(1, 2));
+    BOOST_CHECK_EQUAL(*w.find(1), 1);
+    BOOST_CHECK(w.insert(100000, 3)); // Overflow
+    BOOST_CHECK(!w.insert(100000, 4));
+    BOOST_CHECK_EQUAL(*w.find(100000), 3);
+    BOOST_CHECK_EQUAL(w.size(), 2u);
+}
+
+// Removing out of order leaves a hole, the front only advances past removed IDs.
+QPID_AUTO_TEST_CASE(testRemoveOutOfOrder) {
+    Window w;
+    for (int i = 1; i <= 5; ++i) w.insert(i, i);
+    int v = 0;
+    BOOST_CHECK(w.remove(3, v));
+    BOOST_CHECK(!w.remove(3, v));
+    BOOST_CHECK(!w.find(3));
+    BOOST_CHECK(w.remove(1, v));
+    BOOST_CHECK(!w.find(1));
+    BOOST_CHECK_EQUAL(*w.find(2), 2);
+    BOOST_CHECK_EQUAL(w.size(), 3u);
+    // Re-inserting behind the front of the window goes to overflow.
+    BOOST_CHECK(w.insert(1, 11));
+    BOOST_CHECK_EQUAL(w.overflowSize(), 1u);
+    BOOST_CHECK_EQUAL(*w.find(1), 11);
+    // A hole inside the window is re-used.
+    BOOST_CHECK(w.insert(3, 33));
+    BOOST_CHECK_EQUAL(w.overflowSize(), 1u);
+    BOOST_CHECK_EQUAL(*w.find(3), 33);
+}
+
+QPID_AUTO_TEST_CASE(testGap) {
+    Window w;
+    w.insert(1, 1);
+    // Up to MAX_GAP unused IDs past the end stay in the window.
+    BOOST_CHECK(w.insert(1 + Window::MAX_GAP, 2));
+    BOOST_CHECK_EQUAL(w.overflowSize(), 0u);
+    // Further past the end goes to overflow.
+    ReplicationId far = 2 + 3*Window::MAX_GAP;
+    BOOST_CHECK(w.insert(far, 3));
+    BOOST_CHECK_EQUAL(w.overflowSize(), 1u);
+    int v = 0;
+    BOOST_CHECK(w.remove(far, v));
+    BOOST_CHECK_EQUAL(v, 3);
+    BOOST_CHECK_EQUAL(w.overflowSize(), 0u);
+    BOOST_CHECK_EQUAL(w.size(), 2u);
+}
+
+// An empty window restarts at the next ID, however far away.
+QPID_AUTO_TEST_CASE(testRestart) {
+    Window w;
+    int v = 0;
+    w.insert(1, 1);
+    w.remove(1, v);
+    BOOST_CHECK(w.insert(1000000, 2));
+    BOOST_CHECK(w.insert(1000001, 3));
+    BOOST_CHECK_EQUAL(w.overflowSize(), 0u);
+    BOOST_CHECK_EQUAL(w.size(), 2u);
+}
+
+// The window can grow or restart over IDs that were put in overflow.
+QPID_AUTO_TEST_CASE(testOverflowInsideWindow) {
+    Window w;
+    int v = 0;
+    w.insert(1, 1);
+    ReplicationId far = 2 + 3*Window::MAX_GAP;
+    BOOST_CHECK(w.insert(far, 2));
+    BOOST_CHECK_EQUAL(w.overflowSize(), 1u);
+    // Grow the window past far.
+    for (ReplicationId id = 2; id < far + 10; id = id + Window::MAX_GAP/2)
+        if (id != far) w.insert(id, 0);
+    BOOST_CHECK(w.find(far));
+    BOOST_CHECK_EQUAL(*w.find(far), 2);
+    BOOST_CHECK(!w.insert(far, 3));
+    BOOST_CHECK_EQUAL(*w.find(far), 2);
+
+    // Restart an emptied window below an overflowed ID.
+    Window r;
+    r.insert(100, 1);
+    BOOST_CHECK(r.insert(100 + 3*Window::MAX_GAP, 2));
+    r.remove(100, v);
+    BOOST_CHECK(r.insert(50 + 3*Window::MAX_GAP, 3));
+    BOOST_CHECK(r.find(100 + 3*Window::MAX_GAP));
+    BOOST_CHECK(!r.insert(100 + 3*Window::MAX_GAP, 4));
+    BOOST_CHECK_EQUAL(r.size(), 2u);
+    BOOST_CHECK(r.remove(100 + 3*Window::MAX_GAP, v));
+    BOOST_CHECK_EQUAL(v, 2);
+    BOOST_CHECK(!r.find(100 + 3*Window::MAX_GAP));
+}
+
+QPID_AUTO_TEST_CASE(testWrapAround) {
+    Window w;
+    ReplicationId id(0xFFFFFFF0);
+    for (int i = 0; i < 32; ++i, ++id) BOOST_CHECK(w.insert(id, i));
+    BOOST_CHECK_EQUAL(w.overflowSize(), 0u);
+    BOOST_CHECK_EQUAL(*w.find(ReplicationId(0xFFFFFFFF)), 15);
+    BOOST_CHECK_EQUAL(*w.find(ReplicationId(0)), 16);
+    int v = 0;
+    id = 0xFFFFFFF0;
+    for (int i = 0; i < 32; ++i, ++id) {
+        BOOST_CHECK(w.remove(id, v));
+        BOOST_CHECK_EQUAL(v, i);
+    }
+    BOOST_CHECK(w.empty());
+}
+
+QPID_AUTO_TEST_CASE(testRemoveAll) {
+    Window w;
+    for (int i = 1; i <= 5; ++i) w.insert(i, i);
+    w.insert(100000, 6);
+    int v = 0;
+    w.remove(2, v);
+    std::vector<int> values;
+    w.removeAll(values);
+    std::sort(values.begin(), values.end());
+    int expect[] = { 1, 3, 4, 5, 6 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(), expect, expect+5);
+    BOOST_CHECK(w.empty());
+    BOOST_CHECK_EQUAL(w.overflowSize(), 0u);
+    BOOST_CHECK(!w.find(1));
+}
+
+QPID_AUTO_TEST_SUITE_END()
+
+}} // namespace qpid::tests
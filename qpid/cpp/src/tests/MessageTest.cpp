@@ -84,6 +84,49 @@ QPID_AUTO_TEST_CASE(testMessageProperties)
   BOOST_CHECK_EQUAL(msg.getProperty("abcdef").getType(), qpid::types::VAR_VOID);
 }
 
+QPID_AUTO_TEST_CASE(testAnnotationsMergedLazily)
+{
+    qpid::types::Variant::Map properties;
+    properties["durable"] = true;
+    Message msg = MessageUtils::createMessage(properties, "abc");
+    boost::intrusive_ptr<PersistableMessage> original = msg.getPersistentContext();
+    msg.addAnnotation("x-qpid.sequence", (uint64_t) 1);
+
+    // Adding an annotation does not re-encode the message
+    BOOST_CHECK(msg.hasPendingAnnotations());
+    BOOST_CHECK(msg.getPersistentContext() == original);
+    BOOST_CHECK_EQUAL((uint64_t) 1, msg.getAnnotation("x-qpid.sequence").asUint64());
+
+    msg.mergeAnnotations();
+    BOOST_CHECK(!msg.hasPendingAnnotations());
+    BOOST_CHECK(msg.getPersistentContext() != original);
+    msg.mergeAnnotations();
+    BOOST_CHECK(!msg.hasPendingAnnotations());
+}
+
+QPID_AUTO_TEST_CASE(testAnnotationsMergedBeforeCopy)
+{
+    qpid::types::Variant::Map properties;
+    properties["durable"] = true;
+    Message msg = MessageUtils::createMessage(properties, "abc");
+    msg.addAnnotation("x-qpid.sequence", (uint64_t) 1);
+    msg.mergeAnnotations();
+
+    // Copies made after merging, e.g. one per queue when routed, share
+    // a single persistent context that already carries the annotation.
+    Message a(msg), b(msg);
+    BOOST_CHECK(a.getPersistentContext() == b.getPersistentContext());
+    BOOST_CHECK(a.getPersistentContext() == msg.getPersistentContext());
+
+    std::vector<char> bytes(a.getPersistentContext()->encodedSize());
+    qpid::framing::Buffer buffer(&bytes[0], bytes.size());
+    a.getPersistentContext()->encode(buffer);
+    buffer.reset();
+    ProtocolRegistry registry(std::set<std::string>(), 0);
+    Message decoded = registry.decode(buffer);
+    BOOST_CHECK_EQUAL(string("1"), decoded.getPropertyAsString("x-qpid.sequence"));
+}
+
 QPID_AUTO_TEST_SUITE_END()
 
 }} // namespace qpid::tests
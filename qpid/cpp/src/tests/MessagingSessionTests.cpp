@@ -27,6 +27,7 @@
 #include "qpid/messaging/Receiver.h"
 #include "qpid/messaging/Sender.h"
 #include "qpid/messaging/Session.h"
+#include "qpid/Compression.h"
 #include "qpid/client/Connection.h"
 #include "qpid/client/Session.h"
 #include "qpid/framing/ExchangeQueryResult.h"
@@ -1623,6 +1624,75 @@ QPID_AUTO_TEST_CASE(testPriorityRingEviction)
     BOOST_CHECK(!receiver.fetch(msg, Duration::IMMEDIATE));
 }
 
+QPID_AUTO_TEST_CASE(testCompressedSendReceive)
+{
+    if (!qpid::Compression::isSupported(qpid::Compression::DEFLATE)) return;
+    QueueFixture fix;
+    Sender sender = fix.session.createSender(fix.queue + "; {link:{compression:deflate}}");
+    std::string content;
+    for (uint i = 0; content.size() < 8*1024; ++i) {
+        content += (boost::format("{\"id\": %1%, \"name\": \"item\"}, ") % i).str();
+    }
+    Message out(content);
+    out.setProperty("a", "b");
+    sender.send(out);
+    Receiver receiver = fix.session.createReceiver(fix.queue);
+    Message in = receiver.fetch(Duration::SECOND * 5);
+    fix.session.acknowledge();
+    BOOST_CHECK_EQUAL(in.getContent(), content);
+    BOOST_CHECK_EQUAL(in.getProperties()["a"].asString(), "b");
+    BOOST_CHECK(in.getProperties().find(qpid::Compression::PROPERTY) == in.getProperties().end());
+}
+
+QPID_AUTO_TEST_CASE(testCompressionSkipsMapContent)
+{
+    if (!qpid::Compression::isSupported(qpid::Compression::DEFLATE)) return;
+    QueueFixture fix;
+    Sender sender = fix.session.createSender(fix.queue + "; {link:{compression:deflate}}");
+    Variant::Map content;
+    for (uint i = 0; i < 512; ++i) {
+        content[(boost::format("key_%1%") % i).str()] = "a repetitive value";
+    }
+    Message out;
+    out.setContentObject(content);
+    sender.send(out);
+    Receiver receiver = fix.session.createReceiver(fix.queue);
+    Message in = receiver.fetch(Duration::SECOND * 5);
+    fix.session.acknowledge();
+    //structured content is sent as is, so the broker can translate it
+    BOOST_CHECK(in.getProperties().find(qpid::Compression::PROPERTY) == in.getProperties().end());
+    BOOST_CHECK_EQUAL(in.getContentObject().asMap().size(), content.size());
+    BOOST_CHECK_EQUAL(in.getContentObject().asMap()["key_7"].asString(), "a repetitive value");
+}
+
+QPID_AUTO_TEST_CASE(testUndecompressableBodyDelivered)
+{
+    QueueFixture fix;
+    Sender sender = fix.session.createSender(fix.queue);
+    Message out(std::string(4096, 'x'));
+    out.setProperty(qpid::Compression::PROPERTY, qpid::Compression::DEFLATE);
+    sender.send(out);
+    Receiver receiver = fix.session.createReceiver(fix.queue);
+    Message in;
+    {
+        ScopedSuppressLogging sl;
+        BOOST_CHECK(receiver.fetch(in, Duration::SECOND * 5));
+    }
+    fix.session.acknowledge();
+    //the body could not be restored, so it is delivered as received
+    //and the property is left for the application to see
+    BOOST_CHECK_EQUAL(in.getContent(), out.getContent());
+    BOOST_CHECK_EQUAL(in.getProperties()[qpid::Compression::PROPERTY].asString(), qpid::Compression::DEFLATE);
+}
+
+QPID_AUTO_TEST_CASE(testUnsupportedCompression)
+{
+    QueueFixture fix;
+    ScopedSuppressLogging sl;
+    BOOST_CHECK_THROW(fix.session.createSender(fix.queue + "; {link:{compression:no-such-algorithm}}"),
+                      qpid::messaging::AddressError);
+}
+
 QPID_AUTO_TEST_SUITE_END()
 
 }} // namespace qpid::tests
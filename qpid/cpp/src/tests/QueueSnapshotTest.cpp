@@ -0,0 +1,150 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "qpid/ha/QueueSnapshot.h"
+#include "qpid/sys/Runnable.h"
+#include "qpid/sys/Thread.h"
+#include "unit_test.h"
+#include <vector>
+
+namespace qpid {
+namespace tests {
+
+QPID_AUTO_TEST_SUITE(QueueSnapshotTestSuite)
+
+using ha::QueueSnapshot;
+using ha::ReplicationId;
+using ha::ReplicationIdSet;
+
+namespace {
+const uint32_t BASE = 1000;
+const uint32_t OPS = 20000;
+
+broker::Message message(ReplicationId id) {
+    broker::Message m;
+    m.setReplicationId(id);
+    return m;
+}
+
+// Every other ID from BASE so each ID is its own range.
+void fill(QueueSnapshot& qs, ReplicationIdSet& ids, uint32_t ranges) {
+    for (uint32_t i = 0; i < ranges; ++i) {
+        ReplicationId id = BASE + 2*i;
+        qs.enqueued(message(id));
+        ids += id;
+    }
+}
+
+struct Op {
+    ReplicationId id;
+    bool enqueue;
+};
+
+// Alternate enqueues that fill gaps and dequeues, near the front of the set
+// (behind the snapshot cursor for most of a copy) and near the back (ahead of
+// it), so the copy and the merge of recorded changes are both exercised.
+std::vector<Op> makeOps(uint32_t ranges) {
+    std::vector<Op> ops;
+    for (uint32_t j = 0; j < OPS/4; ++j) {
+        ReplicationId low = BASE + 2*j, high = BASE + 2*(ranges - 1 - j);
+        Op enqLow = { low + 1, true }, deqHigh = { high, false };
+        Op deqLow = { low, false }, enqHigh = { high - 1, true };
+        ops.push_back(enqLow);
+        ops.push_back(deqHigh);
+        ops.push_back(deqLow);
+        ops.push_back(enqHigh);
+    }
+    return ops;
+}
+
+class Mutator : public sys::Runnable {
+  public:
+    Mutator(QueueSnapshot& q, const std::vector<Op>& o) : qs(q), ops(o) {}
+    void run() {
+        for (size_t i = 0; i < ops.size(); ++i) {
+            if (ops[i].enqueue) qs.enqueued(message(ops[i].id));
+            else qs.dequeued(message(ops[i].id));
+        }
+    }
+  private:
+    QueueSnapshot& qs;
+    const std::vector<Op>& ops;
+};
+
+// A snapshot must equal the initial IDs with some prefix of ops applied.
+// Return the length of the prefix, fail if there is none.
+size_t checkPrefix(const ReplicationIdSet& snapshot, ReplicationIdSet expect,
+                   const std::vector<Op>& ops)
+{
+    size_t applied = 0;
+    while (applied < ops.size() &&
+           snapshot.contains(ops[applied].id) == ops[applied].enqueue)
+        ++applied;
+    for (size_t i = 0; i < applied; ++i) {
+        if (ops[i].enqueue) expect += ops[i].id;
+        else expect -= ops[i].id;
+    }
+    BOOST_CHECK_MESSAGE(snapshot == expect, "snapshot is not the set after " << applied << " ops");
+    return applied;
+}
+}
+
+QPID_AUTO_TEST_CASE(testSmall) {
+    QueueSnapshot qs;
+    ReplicationIdSet ids;
+    fill(qs, ids, 10);
+    BOOST_CHECK(qs.getSnapshot() == ids);
+    qs.dequeued(message(BASE));
+    ids -= BASE;
+    BOOST_CHECK(qs.getSnapshot() == ids);
+}
+
+QPID_AUTO_TEST_CASE(testChunked) {
+    QueueSnapshot qs;
+    ReplicationIdSet ids;
+    fill(qs, ids, 3*QueueSnapshot::RANGES_PER_CHUNK + 7);
+    ReplicationIdSet snapshot = qs.getSnapshot();
+    BOOST_CHECK_EQUAL(snapshot.rangesSize(), ids.rangesSize());
+    BOOST_CHECK(snapshot == ids);
+}
+
+QPID_AUTO_TEST_CASE(testConcurrentChanges) {
+    const uint32_t ranges = 64*QueueSnapshot::RANGES_PER_CHUNK;
+    QueueSnapshot qs;
+    ReplicationIdSet ids;
+    fill(qs, ids, ranges);
+    std::vector<Op> ops = makeOps(ranges);
+    Mutator mutator(qs, ops);
+    sys::Thread thread(mutator);
+    size_t applied = 0;
+    while (applied < ops.size()) {
+        size_t next = checkPrefix(qs.getSnapshot(), ids, ops);
+        BOOST_CHECK(next >= applied); // Snapshots never go backwards.
+        if (next < applied) break;
+        applied = next;
+    }
+    thread.join();
+    BOOST_CHECK_EQUAL(checkPrefix(qs.getSnapshot(), ids, ops), ops.size());
+}
+
+QPID_AUTO_TEST_SUITE_END()
+
+}} // namespace qpid::tests
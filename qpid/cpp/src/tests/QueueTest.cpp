@@ -624,6 +624,24 @@ QPID_AUTO_TEST_CASE(testSetPositionPriority) {
     BOOST_CHECK_EQUAL("1", c->lastMessage.getContent());
 }
 
+QPID_AUTO_TEST_CASE(testDeliverReplica) {
+    QueueSettings settings;
+    settings.traceExcludes = "b";
+    Queue::shared_ptr q(new Queue("my-queue", settings));
+
+    // A message that would be excluded on delivery is kept when replicated.
+    qpid::types::Variant::Map properties;
+    properties["x-qpid.trace"] = "a,b";
+    q->deliver(MessageUtils::createMessage(properties, "excluded"));
+    BOOST_CHECK_EQUAL(0u, q->getMessageCount());
+    q->deliverReplica(MessageUtils::createMessage(properties, "replica"));
+    BOOST_CHECK_EQUAL(1u, q->getMessageCount());
+
+    TestConsumer::shared_ptr c(new TestConsumer("test", true));
+    BOOST_CHECK(q->dispatch(c));
+    BOOST_CHECK_EQUAL("replica", c->lastMessage.getContent());
+}
+
 QPID_AUTO_TEST_SUITE_END()
 
 }} // namespace qpid::tests
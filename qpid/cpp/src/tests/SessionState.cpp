@@ -58,8 +58,8 @@ string str(const AMQFrame& f) {
     if (c) return c->getData(); // Return data for content frames.
     return "H";                 // Must be a header.
 }
-// Make a string from a range of frames.
-string str(const boost::iterator_range<vector<AMQFrame>::const_iterator>& frames) {
+// Make a string from a list of frames.
+string str(const vector<AMQFrame>& frames) {
     string (*strFrame)(const AMQFrame&) = str;
     return applyAccumulate(frames.begin(), frames.end(), string(), ptr_fun(strFrame));
 }
@@ -211,6 +211,48 @@ QPID_AUTO_TEST_CASE(testPeerCompleted) {
     BOOST_CHECK_EQUAL(str(s.senderExpected(SessionPoint(4,0))), "CeCf");
 }
 
+QPID_AUTO_TEST_CASE(testPartialReplay) {
+    qpid::SessionState s;
+    s.setTimeout(1);
+    s.senderGetCommandPoint();
+    transfers(s, "a");
+    transferN(s, "xyz");
+    uint64_t offset = transferFrameSize();
+    BOOST_CHECK_EQUAL(str(s.senderExpected(SessionPoint(1, offset))), "xyz");
+    offset += contentFrameSize();
+    BOOST_CHECK_EQUAL(str(s.senderExpected(SessionPoint(1, offset))), "yz");
+    offset += contentFrameSize();
+    BOOST_CHECK_EQUAL(str(s.senderExpected(SessionPoint(1, offset))), "z");
+    // Not on a frame boundary
+    BOOST_CHECK_THROW(s.senderExpected(SessionPoint(1, offset-1)), qpid::Exception);
+    s.senderConfirmed(SessionPoint(1));
+    BOOST_CHECK_EQUAL(str(s.senderExpected(SessionPoint(1, offset))), "z");
+}
+
+QPID_AUTO_TEST_CASE(testReplayManyChunks) {
+    qpid::SessionState::Configuration c(0);
+    qpid::SessionState s(SessionId(), c);
+    s.setTimeout(1);
+    s.senderGetCommandPoint();
+    // Enough content to need several replay chunks.
+    const size_t count = 200;
+    string expected;
+    for (size_t i = 0; i < count; ++i) {
+        string content(1000, 'a' + i%26);
+        transfer1(s, content);
+        if (i >= count/2) expected += "C" + content;
+    }
+    s.senderConfirmed(SessionPoint(count/2));
+    vector<AMQFrame> replay = s.senderExpected(SessionPoint(count/2));
+    BOOST_CHECK_EQUAL(str(replay), expected);
+    // Replayed frames are unaffected by confirming and sending more.
+    s.senderConfirmed(SessionPoint(count));
+    for (size_t i = 0; i < count; ++i)
+        transfer1(s, string(1000, 'x'));
+    BOOST_CHECK_EQUAL(str(replay), expected);
+    BOOST_CHECK_EQUAL(str(s.senderExpected(SessionPoint(2*count-1))), "C" + string(1000, 'x'));
+}
+
 QPID_AUTO_TEST_CASE(testReceive) {
     // Advance expected/received correctly
     qpid::SessionState s;
@@ -18,8 +18,11 @@
  */
 #include "qpid/broker/TopicKeyNode.h"
 #include "qpid/broker/TopicExchange.h"
+#include "qpid/broker/FedOps.h"
+#include "qpid/broker/Queue.h"
 #include "unit_test.h"
 #include "test_tools.h"
+#include <algorithm>
 
 using namespace qpid::broker;
 using namespace std;
@@ -88,6 +91,11 @@ public:
         bindingTree.iterateAll( testFinder );
     }
 
+    void getCovered(const std::string& pattern, BindingVec& bindings) {
+        TestFinder testFinder(bindings);
+        bindingTree.iterateCovered( normalize(pattern), testFinder );
+    }
+
 private:
     TestBindingNode bindingTree;
 };
@@ -137,6 +145,42 @@ namespace {
         }
         return true;
     }
+
+    // the bindings in bv subsumed by pattern, sorted
+    TopicExchange::TopicExchangeTester::BindingVec subsumed(
+        const std::string& pattern, const TopicExchange::TopicExchangeTester::BindingVec& bv)
+    {
+        TopicExchange::TopicExchangeTester::BindingVec result;
+        for (size_t i = 0; i < bv.size(); ++i)
+            if (TopicExchange::subsumes(TopicExchange::normalize(pattern), bv[i]))
+                result.push_back(bv[i]);
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    // records the binding changes an exchange propagates to dynamic bridges
+    class RecordingBridge : public Exchange::DynamicBridge {
+      public:
+        std::vector<std::string> ops;
+        void propagateBinding(const std::string& key, const std::string&, const std::string& op,
+                              const std::string&, framing::FieldTable*) {
+            ops.push_back((op == fedOpUnbind ? "unbind " : "bind ") + key);
+        }
+        void sendReorigin() {}
+        bool containsLocalTag(const std::string&) const { return false; }
+        const std::string& getLocalTag() const { return tag; }
+        std::vector<std::string> take() {
+            std::vector<std::string> result;
+            result.swap(ops);
+            return result;
+        }
+      private:
+        std::string tag;
+    };
+
+    std::vector<std::string> strings(const char** s, size_t n) {
+        return std::vector<std::string>(s, s+n);
+    }
 }
 
 
@@ -153,6 +197,30 @@ QPID_AUTO_TEST_CASE(testNormalize)
     CHECK_NORMALIZED("*.*.*.#", "*.#.#.*.*.#");
 }
 
+#define CHECK_SUBSUMES(pattern, key) BOOST_CHECK(TopicExchange::subsumes(pattern, key));
+#define CHECK_NOT_SUBSUMES(pattern, key) BOOST_CHECK(!TopicExchange::subsumes(pattern, key));
+
+QPID_AUTO_TEST_CASE(testSubsumes)
+{
+    CHECK_SUBSUMES("a.b.c", "a.b.c");
+    CHECK_SUBSUMES("a.*.c", "a.b.c");
+    CHECK_SUBSUMES("a.*.c", "a.*.c");
+    CHECK_SUBSUMES("#", "");
+    CHECK_SUBSUMES("#", "a.*.*.#");
+    CHECK_SUBSUMES("a.#", "a");
+    CHECK_SUBSUMES("a.#", "a.b.*.#");
+    CHECK_SUBSUMES("*.#", "*.*.#");
+    CHECK_SUBSUMES("#.c", "a.*.c");
+    CHECK_SUBSUMES("a.#.c", "a.b.#.c");
+    CHECK_NOT_SUBSUMES("a.b.c", "a.*.c");
+    CHECK_NOT_SUBSUMES("a.*.c", "a.#.c");
+    CHECK_NOT_SUBSUMES("a.*", "a.#");
+    CHECK_NOT_SUBSUMES("*.#", "#");
+    CHECK_NOT_SUBSUMES("a.#", "b.#");
+    CHECK_NOT_SUBSUMES("a.#.c", "a.#");
+    CHECK_NOT_SUBSUMES("a.b", "a.b.c");
+}
+
 QPID_AUTO_TEST_CASE(testPlain)
 {
     TopicExchange::TopicExchangeTester tt;
@@ -403,6 +471,92 @@ QPID_AUTO_TEST_CASE(testMultiple)
     }
 }
 
+// iterateCovered() must visit every binding a pattern subsumes.
+QPID_AUTO_TEST_CASE(testIterateCovered)
+{
+    TopicExchange::TopicExchangeTester tt;
+    const char* bindings[] = {
+        "a", "a.b", "a.b.c", "a.*", "a.*.c", "a.#", "a.b.#", "a.#.c", "*.b",
+        "*.#", "#", "#.c", "b.c", "b.*", "x.y.z", "*.*.c", "", "a.b.c.d"
+    };
+    const size_t nBindings = sizeof(bindings)/sizeof(bindings[0]);
+    for (size_t i = 0; i < nBindings; ++i) BOOST_CHECK(tt.addBindingKey(bindings[i]));
+    TopicExchange::TopicExchangeTester::BindingVec all;
+    tt.getAll(all);
+
+    const char* patterns[] = { "a.b.*", "*.*", "#.#.c", "a.*.#", "x.#", "q.*", "*" };
+    std::vector<std::string> checks(bindings, bindings + nBindings);
+    checks.insert(checks.end(), patterns, patterns + sizeof(patterns)/sizeof(patterns[0]));
+    for (size_t i = 0; i < checks.size(); ++i) {
+        TopicExchange::TopicExchangeTester::BindingVec covered;
+        tt.getCovered(checks[i], covered);
+        TopicExchange::TopicExchangeTester::BindingVec expect = subsumed(checks[i], all);
+        TopicExchange::TopicExchangeTester::BindingVec actual = subsumed(checks[i], covered);
+        BOOST_CHECK_MESSAGE(expect == actual, "covered by [" << checks[i] << "]");
+    }
+    // Literal prefixes prune the search.
+    TopicExchange::TopicExchangeTester::BindingVec covered;
+    tt.getCovered("x.#", covered);
+    BOOST_CHECK_EQUAL(covered.size(), 1u);
+}
+
+// A wildcard binding withdraws the keys it covers after it is propagated;
+// removing it re-propagates them before it is withdrawn.
+QPID_AUTO_TEST_CASE(testAggregateLocalBindings)
+{
+    TopicExchange x("x");
+    RecordingBridge bridge;
+    x.registerDynamicBridge(&bridge);
+    Queue::shared_ptr q(new Queue("q"));
+
+    x.bind(q, "a.b", 0);
+    x.bind(q, "a.c", 0);
+    const char* bind1[] = { "bind a.b", "bind a.c" };
+    BOOST_CHECK(bridge.take() == strings(bind1, 2));
+
+    x.bind(q, "a.*", 0);
+    const char* bind2[] = { "bind a.*", "unbind a.b", "unbind a.c" };
+    BOOST_CHECK(bridge.take() == strings(bind2, 3));
+
+    x.bind(q, "a.d", 0);        // Covered, not propagated
+    x.unbind(q, "a.d", 0);
+    BOOST_CHECK(bridge.take().empty());
+
+    x.unbind(q, "a.*", 0);
+    const char* unbind1[] = { "bind a.b", "bind a.c", "unbind a.*" };
+    BOOST_CHECK(bridge.take() == strings(unbind1, 3));
+
+    x.unbind(q, "a.b", 0);
+    x.unbind(q, "a.c", 0);
+    const char* unbind2[] = { "unbind a.b", "unbind a.c" };
+    BOOST_CHECK(bridge.take() == strings(unbind2, 2));
+    x.removeDynamicBridge(&bridge);
+}
+
+// Keys covered by more than one pattern stay withdrawn till the last goes.
+QPID_AUTO_TEST_CASE(testAggregateNestedBindings)
+{
+    TopicExchange x("x");
+    RecordingBridge bridge;
+    x.registerDynamicBridge(&bridge);
+    Queue::shared_ptr q(new Queue("q"));
+
+    x.bind(q, "a.b.c", 0);
+    x.bind(q, "a.*.c", 0);
+    x.bind(q, "#", 0);
+    const char* bind[] = { "bind a.b.c", "bind a.*.c", "unbind a.b.c", "bind #", "unbind a.*.c" };
+    BOOST_CHECK(bridge.take() == strings(bind, 5));
+
+    x.unbind(q, "#", 0);        // a.b.c is still covered by a.*.c
+    const char* unbind1[] = { "bind a.*.c", "unbind #" };
+    BOOST_CHECK(bridge.take() == strings(unbind1, 2));
+
+    x.unbind(q, "a.*.c", 0);
+    const char* unbind2[] = { "bind a.b.c", "unbind a.*.c" };
+    BOOST_CHECK(bridge.take() == strings(unbind2, 2));
+    x.removeDynamicBridge(&bridge);
+}
+
 QPID_AUTO_TEST_SUITE_END()
 
 }} // namespace qpid::tests
@@ -0,0 +1,188 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+/**
+ * Measures the time taken to scan an AMQP 1.0 message with
+ * MessageReader, as done by the broker on receipt of each message and
+ * by the client on receipt of each message. Not a test, run by hand.
+ */
+
+#include "qpid/amqp/CharSequence.h"
+#include "qpid/amqp/Decoder.h"
+#include "qpid/amqp/Encoder.h"
+#include "qpid/amqp/MessageReader.h"
+#include "qpid/amqp/descriptors.h"
+#include "qpid/sys/Time.h"
+#include "qpid/types/Uuid.h"
+#include "qpid/types/Variant.h"
+#include "qpid/types/encodings.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace qpid {
+namespace tests {
+
+using qpid::amqp::CharSequence;
+using qpid::amqp::Descriptor;
+using qpid::types::Variant;
+
+/**
+ * Records just enough of what it is told to check that the message
+ * was decoded correctly.
+ */
+class Scanner : public qpid::amqp::MessageReader
+{
+  public:
+    Scanner() : priority(0), ttl(0), fields(0) {}
+
+    void onDurable(bool) { ++fields; }
+    void onPriority(uint8_t v) { priority = v; ++fields; }
+    void onTtl(uint32_t v) { ttl = v; ++fields; }
+    void onFirstAcquirer(bool) { ++fields; }
+    void onDeliveryCount(uint32_t) { ++fields; }
+
+    void onMessageId(uint64_t) { ++fields; }
+    void onMessageId(const CharSequence&, qpid::types::VariantType) { ++fields; }
+    void onUserId(const CharSequence&) { ++fields; }
+    void onTo(const CharSequence& v) { to = v; ++fields; }
+    void onSubject(const CharSequence& v) { subject = v; ++fields; }
+    void onReplyTo(const CharSequence&) { ++fields; }
+    void onCorrelationId(uint64_t) { ++fields; }
+    void onCorrelationId(const CharSequence&, qpid::types::VariantType) { ++fields; }
+    void onContentType(const CharSequence&) { ++fields; }
+    void onContentEncoding(const CharSequence&) { ++fields; }
+    void onAbsoluteExpiryTime(int64_t) { ++fields; }
+    void onCreationTime(int64_t) { ++fields; }
+    void onGroupId(const CharSequence&) { ++fields; }
+    void onGroupSequence(uint32_t) { ++fields; }
+    void onReplyToGroupId(const CharSequence&) { ++fields; }
+
+    void onApplicationProperties(const CharSequence&, const CharSequence&) { ++fields; }
+    void onDeliveryAnnotations(const CharSequence&, const CharSequence&) { ++fields; }
+    void onMessageAnnotations(const CharSequence&, const CharSequence&) { ++fields; }
+
+    void onData(const CharSequence& v) { data = v; ++fields; }
+    void onAmqpSequence(const CharSequence&) { ++fields; }
+    void onAmqpValue(const CharSequence&, const std::string&, const Descriptor*) { ++fields; }
+    void onAmqpValue(const Variant&, const Descriptor*) { ++fields; }
+
+    void onFooter(const CharSequence&, const CharSequence&) { ++fields; }
+
+    uint8_t priority;
+    uint32_t ttl;
+    CharSequence to;
+    CharSequence subject;
+    CharSequence data;
+    size_t fields;
+};
+
+Variant utf8(const std::string& s)
+{
+    Variant v(s);
+    v.setEncoding(qpid::types::encodings::UTF8);
+    return v;
+}
+
+Variant ascii(const std::string& s)
+{
+    Variant v(s);
+    v.setEncoding(qpid::types::encodings::ASCII);
+    return v;
+}
+
+size_t encode(std::vector<char>& buffer)
+{
+    Variant::List header;
+    header.push_back(true);
+    header.push_back((uint8_t) 7);
+    header.push_back((uint32_t) 60000);
+    header.push_back(false);
+    header.push_back((uint32_t) 1);
+
+    Variant::List properties;
+    properties.push_back(qpid::types::Uuid(true));
+    properties.push_back(std::string("guest"));
+    properties.push_back(utf8("amq.topic"));
+    properties.push_back(utf8("news.sport.results"));
+    properties.push_back(utf8("reply-queue"));
+    properties.push_back((uint64_t) 123456789);
+    properties.push_back(ascii("text/plain"));
+    properties.push_back(ascii("utf-8"));
+    properties.push_back(Variant());
+    properties.push_back(Variant());
+    properties.push_back(utf8("group-a"));
+    properties.push_back((uint32_t) 42);
+    properties.push_back(utf8("group-b"));
+
+    Variant::Map applicationProperties;
+    for (size_t i = 0; i < 10; ++i) {
+        std::stringstream key;
+        key << "property-" << i;
+        applicationProperties[key.str()] = (uint32_t) i;
+    }
+
+    qpid::amqp::Encoder encoder(&buffer[0], buffer.size());
+    encoder.writeList(header, &qpid::amqp::message::HEADER);
+    encoder.writeList(properties, &qpid::amqp::message::PROPERTIES);
+    encoder.writeMap(applicationProperties, &qpid::amqp::message::APPLICATION_PROPERTIES);
+    encoder.writeBinary(std::string(256, 'x'), &qpid::amqp::message::DATA);
+    return encoder.getPosition();
+}
+
+int run(int argc, char** argv)
+{
+    size_t count = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    std::vector<char> buffer(4096);
+    size_t size = encode(buffer);
+
+    size_t fields = 0;
+    qpid::sys::AbsTime start = qpid::sys::AbsTime::now();
+    for (size_t i = 0; i < count; ++i) {
+        Scanner scanner;
+        qpid::amqp::Decoder decoder(&buffer[0], size);
+        decoder.read(scanner);
+        if (scanner.priority != 7 || scanner.ttl != 60000 || scanner.to.size != 9
+            || scanner.subject.size != 18 || scanner.data.size != 256) {
+            std::cerr << "Message was not decoded correctly" << std::endl;
+            return 1;
+        }
+        fields += scanner.fields;
+    }
+    qpid::sys::Duration elapsed(start, qpid::sys::AbsTime::now());
+    std::cout << size << " byte message, " << double(fields)/count << " fields: "
+              << double(elapsed)/count << " ns per message" << std::endl;
+    return 0;
+}
+
+}} // namespace qpid::tests
+
+int main(int argc, char** argv)
+{
+    try {
+        return qpid::tests::run(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
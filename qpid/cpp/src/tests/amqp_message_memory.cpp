@@ -0,0 +1,116 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+/**
+ * Measures heap usage of AMQP 1.0 messages held by the broker: the
+ * number of allocations and bytes needed to receive, annotate and
+ * (optionally) persist a small message. Not a test, run by hand.
+ */
+
+#include "qpid/broker/Message.h"
+#include "qpid/broker/amqp/Message.h"
+#include "qpid/amqp/Encoder.h"
+#include "qpid/amqp/descriptors.h"
+#include "qpid/types/Variant.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <vector>
+
+namespace {
+size_t allocations = 0;
+size_t allocated = 0;
+}
+
+void* operator new(size_t size)
+{
+    ++allocations;
+    allocated += size;
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) throw()
+{
+    std::free(p);
+}
+
+namespace qpid {
+namespace tests {
+
+std::vector<char> encodeMessage(size_t contentSize)
+{
+    qpid::types::Variant::Map properties;
+    properties["priority-class"] = "standard";
+    properties["sequence"] = 1;
+    std::string content(contentSize, 'x');
+
+    std::vector<char> buffer(contentSize + 256);
+    qpid::amqp::Encoder encoder(&buffer[0], buffer.size());
+    encoder.writeMap(properties, &qpid::amqp::message::APPLICATION_PROPERTIES);
+    encoder.writeBinary(content, &qpid::amqp::message::DATA);
+    buffer.resize(encoder.getPosition());
+    return buffer;
+}
+
+int run(int argc, char** argv)
+{
+    size_t count = argc > 1 ? std::atoi(argv[1]) : 10000;
+    size_t contentSize = argc > 2 ? std::atoi(argv[2]) : 200;
+    bool persist = argc > 3 && std::string(argv[3]) == "persist";
+
+    std::vector<char> encoded = encodeMessage(contentSize);
+    std::vector<qpid::broker::Message> messages;
+    messages.reserve(count);
+
+    size_t startAllocations = allocations;
+    size_t startAllocated = allocated;
+    for (size_t i = 0; i < count; ++i) {
+        boost::intrusive_ptr<qpid::broker::amqp::Message> received = qpid::broker::amqp::Message::create(encoded.size());
+        std::memcpy(received->getData(), &encoded[0], encoded.size());
+        received->scan();
+        qpid::broker::Message message(received, received);
+        message.addAnnotation("x-qpid.sequence", (uint64_t) i);
+        if (persist) message.getPersistentContext();
+        messages.push_back(message);
+    }
+    size_t n = allocations - startAllocations;
+    size_t bytes = allocated - startAllocated;
+    std::cout << "messages: " << count << " (" << encoded.size() << " bytes encoded)" << std::endl
+              << "allocations per message: " << double(n)/count << std::endl
+              << "bytes allocated per message: " << double(bytes)/count << std::endl;
+    return 0;
+}
+
+}} // namespace qpid::tests
+
+int main(int argc, char** argv)
+{
+    try {
+        return qpid::tests::run(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,182 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+/**
+ * Compares looking up application-properties of an AMQP 1.0 message by
+ * scanning the whole map (as processProperties() does) with looking
+ * them up through the message's property index. Each routed message
+ * has a few properties looked up by name, as message groups, LVQ keys
+ * and header match filters do, both directly and through
+ * broker::Message::getProperty(). Not a test, run by hand.
+ */
+
+#include "qpid/broker/amqp/Message.h"
+#include "qpid/broker/Message.h"
+#include "qpid/amqp/CharSequence.h"
+#include "qpid/amqp/Encoder.h"
+#include "qpid/amqp/MapHandler.h"
+#include "qpid/amqp/descriptors.h"
+#include "qpid/sys/Time.h"
+#include "qpid/types/Variant.h"
+#include "qpid/types/encodings.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace qpid {
+namespace tests {
+
+using qpid::amqp::CharSequence;
+
+/**
+ * Counts the values decoded while looking for a property.
+ */
+class CountingHandler : public qpid::amqp::MapHandler
+{
+  public:
+    CountingHandler(const std::string& k) : key(k), found(false), decoded(0) {}
+    void handleVoid(const CharSequence& k) { handle(k); }
+    void handleBool(const CharSequence& k, bool) { handle(k); }
+    void handleUint8(const CharSequence& k, uint8_t) { handle(k); }
+    void handleUint16(const CharSequence& k, uint16_t) { handle(k); }
+    void handleUint32(const CharSequence& k, uint32_t) { handle(k); }
+    void handleUint64(const CharSequence& k, uint64_t) { handle(k); }
+    void handleInt8(const CharSequence& k, int8_t) { handle(k); }
+    void handleInt16(const CharSequence& k, int16_t) { handle(k); }
+    void handleInt32(const CharSequence& k, int32_t) { handle(k); }
+    void handleInt64(const CharSequence& k, int64_t) { handle(k); }
+    void handleFloat(const CharSequence& k, float) { handle(k); }
+    void handleDouble(const CharSequence& k, double) { handle(k); }
+    void handleString(const CharSequence& k, const CharSequence&, const CharSequence&) { handle(k); }
+
+    const std::string key;
+    bool found;
+    size_t decoded;
+  private:
+    void handle(const CharSequence& k)
+    {
+        ++decoded;
+        if (key.size() == k.size && ::memcmp(key.data(), k.data, k.size) == 0) found = true;
+    }
+};
+
+boost::intrusive_ptr<qpid::broker::amqp::Message> createMessage(size_t propertyCount)
+{
+    qpid::types::Variant::Map properties;
+    for (size_t i = 0; i < propertyCount; ++i) {
+        std::stringstream key;
+        key << "property-" << i;
+        properties[key.str()] = (uint32_t) i;
+    }
+    properties["group-id"] = "group-a";
+    properties["lvq-key"] = "key-b";
+    properties["region"] = "emea";
+    properties["group-id"].setEncoding(qpid::types::encodings::UTF8);
+    properties["lvq-key"].setEncoding(qpid::types::encodings::UTF8);
+    properties["region"].setEncoding(qpid::types::encodings::UTF8);
+
+    std::vector<char> buffer(propertyCount * 32 + 256);
+    qpid::amqp::Encoder encoder(&buffer[0], buffer.size());
+    encoder.writeMap(properties, &qpid::amqp::message::APPLICATION_PROPERTIES);
+    encoder.writeBinary(std::string(64, 'x'), &qpid::amqp::message::DATA);
+
+    boost::intrusive_ptr<qpid::broker::amqp::Message> message = qpid::broker::amqp::Message::create(encoder.getPosition());
+    ::memcpy(message->getData(), &buffer[0], encoder.getPosition());
+    message->scan();
+    return message;
+}
+
+void report(const std::string& name, size_t count, size_t decoded, qpid::sys::Duration elapsed)
+{
+    std::cout << name << ": " << double(decoded)/count << " values decoded, "
+              << double(elapsed)/count << " ns per routed message" << std::endl;
+}
+
+int run(int argc, char** argv)
+{
+    size_t count = argc > 1 ? std::atoi(argv[1]) : 100000;
+    size_t propertyCount = argc > 2 ? std::atoi(argv[2]) : 10;
+    const char* names[] = { "group-id", "lvq-key", "region" };
+    const size_t lookups = sizeof(names)/sizeof(names[0]);
+
+    std::vector<boost::intrusive_ptr<qpid::broker::amqp::Message> > messages;
+    for (size_t i = 0; i < count; ++i) messages.push_back(createMessage(propertyCount));
+
+    size_t decoded = 0;
+    qpid::sys::AbsTime start = qpid::sys::AbsTime::now();
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t j = 0; j < lookups; ++j) {
+            CountingHandler handler(names[j]);
+            messages[i]->processProperties(handler);
+            if (!handler.found) throw std::logic_error("property not found by scan");
+            decoded += handler.decoded;
+        }
+    }
+    report("scan", count, decoded, qpid::sys::Duration(start, qpid::sys::AbsTime::now()));
+
+    decoded = 0;
+    start = qpid::sys::AbsTime::now();
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t j = 0; j < lookups; ++j) {
+            CountingHandler handler(names[j]);
+            messages[i]->processProperty(handler.key, handler);
+            if (!handler.found) throw std::logic_error("property not found by index");
+            decoded += handler.decoded;
+        }
+    }
+    report("index", count, decoded, qpid::sys::Duration(start, qpid::sys::AbsTime::now()));
+
+    // broker::Message::getProperty() looks values up through the same index
+    std::vector<qpid::broker::Message> wrapped;
+    for (size_t i = 0; i < count; ++i) {
+        boost::intrusive_ptr<qpid::broker::amqp::Message> m = createMessage(propertyCount);
+        wrapped.push_back(qpid::broker::Message(m, m));
+    }
+    start = qpid::sys::AbsTime::now();
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t j = 0; j < lookups; ++j) {
+            if (wrapped[i].getProperty(names[j]).getType() != qpid::types::VAR_STRING)
+                throw std::logic_error("property not found by getProperty()");
+        }
+    }
+    std::cout << "getProperty: " << double(qpid::sys::Duration(start, qpid::sys::AbsTime::now()))/count
+              << " ns per routed message" << std::endl;
+    if (wrapped[0].getProperty("region").asString() != "emea" ||
+        wrapped[0].getProperty("property-0").asUint32() != 0 ||
+        wrapped[0].getProperty("missing").getType() != qpid::types::VAR_VOID)
+        throw std::logic_error("getProperty() returned the wrong value");
+    return 0;
+}
+
+}} // namespace qpid::tests
+
+int main(int argc, char** argv)
+{
+    try {
+        return qpid::tests::run(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
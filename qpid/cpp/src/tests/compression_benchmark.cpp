@@ -0,0 +1,113 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+/**
+ * Measures compression of message bodies: for JSON-like payloads of a
+ * range of sizes reports the compression ratio, the time to compress
+ * and decompress each body and the resulting throughput. Not a test,
+ * run by hand.
+ */
+
+#include "qpid/Compression.h"
+#include "qpid/Exception.h"
+#include "qpid/sys/Time.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace qpid {
+namespace tests {
+
+std::string payload(size_t size)
+{
+    std::ostringstream out;
+    out << "[";
+    for (size_t i = 0; out.tellp() < std::streampos(size); ++i) {
+        out << "{\"id\": " << i << ", \"timestamp\": " << 1400000000 + i * 37
+            << ", \"symbol\": \"SYM" << i % 97 << "\", \"price\": " << (i * 7919) % 10000 << "." << i % 100
+            << ", \"tags\": [\"wan\", \"feed\", \"level" << i % 3 << "\"]}, ";
+    }
+    std::string s = out.str();
+    s.resize(size);
+    return s;
+}
+
+double throughput(size_t bytes, qpid::sys::Duration elapsed)
+{
+    return (double(bytes) / (1024*1024)) / (double(elapsed) / qpid::sys::TIME_SEC);
+}
+
+void measure(const std::string& algorithm, size_t size, size_t count)
+{
+    std::string body = payload(size);
+    std::string compressed;
+    qpid::sys::AbsTime start = qpid::sys::AbsTime::now();
+    for (size_t i = 0; i < count; ++i) {
+        compressed.clear();
+        qpid::Compression::compress(algorithm, body.data(), body.size(), compressed);
+    }
+    qpid::sys::Duration compressTime(start, qpid::sys::AbsTime::now());
+    if (compressed.empty()) {
+        std::cout << "body " << size << ": not compressed" << std::endl;
+        return;
+    }
+    std::string decompressed;
+    start = qpid::sys::AbsTime::now();
+    for (size_t i = 0; i < count; ++i) {
+        qpid::Compression::decompress(algorithm, compressed.data(), compressed.size(), decompressed);
+    }
+    qpid::sys::Duration decompressTime(start, qpid::sys::AbsTime::now());
+    if (decompressed != body) throw qpid::Exception("Decompressed body does not match original");
+
+    std::cout << "body " << size << ": ratio " << double(compressed.size())/size
+              << ", compress " << double(compressTime)/count/qpid::sys::TIME_USEC << " us ("
+              << throughput(size*count, compressTime) << " MB/s)"
+              << ", decompress " << double(decompressTime)/count/qpid::sys::TIME_USEC << " us ("
+              << throughput(size*count, decompressTime) << " MB/s)" << std::endl;
+}
+
+int run(int argc, char** argv)
+{
+    std::string algorithm = argc > 1 ? argv[1] : qpid::Compression::DEFLATE;
+    if (!qpid::Compression::isSupported(algorithm)) {
+        std::cerr << "Compression not supported: " << algorithm << std::endl;
+        return 1;
+    }
+    const size_t total = 64*1024*1024;
+    for (size_t size = 1024; size <= 4*1024*1024; size *= 4) {
+        measure(algorithm, size, total / size);
+    }
+    return 0;
+}
+
+}} // namespace qpid::tests
+
+int main(int argc, char** argv)
+{
+    try {
+        return qpid::tests::run(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
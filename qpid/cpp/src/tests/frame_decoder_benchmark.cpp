@@ -0,0 +1,123 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+/**
+ * Measures FrameDecoder when frames straddle the buffers they arrive
+ * in: a stream of content frames is split at every offset within a
+ * frame and the time and heap allocations per frame reported. Not a
+ * test, run by hand.
+ */
+
+#include "qpid/framing/AMQContentBody.h"
+#include "qpid/framing/AMQFrame.h"
+#include "qpid/framing/Buffer.h"
+#include "qpid/framing/FrameDecoder.h"
+#include "qpid/sys/Time.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+namespace {
+size_t allocations = 0;
+}
+
+void* operator new(size_t size)
+{
+    ++allocations;
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) throw()
+{
+    std::free(p);
+}
+
+namespace qpid {
+namespace tests {
+
+using namespace qpid::framing;
+
+std::string encodeFrame(size_t size)
+{
+    AMQFrame frame((AMQContentBody(std::string(size, 'x'))));
+    std::string encoded;
+    encoded.resize(frame.encodedSize());
+    Buffer buffer(&encoded[0], encoded.size());
+    frame.encode(buffer);
+    return encoded;
+}
+
+/**
+ * Decode two copies of a frame, delivered in two buffers split at
+ * every offset within the first frame.
+ */
+void measure(size_t size, size_t step)
+{
+    std::string frame = encodeFrame(size);
+    std::string encoded = frame + frame;
+    FrameDecoder decoder;
+    size_t frames = 0;
+    size_t bytes = 0;
+    size_t startAllocations = allocations;
+    qpid::sys::AbsTime start = qpid::sys::AbsTime::now();
+    for (size_t split = 1; split < frame.size(); split += step) {
+        Buffer first(&encoded[0], split);
+        while (decoder.decode(first)) {
+            bytes += decoder.getFrame().getBody()->encodedSize();
+            ++frames;
+        }
+        Buffer second(&encoded[split], encoded.size() - split);
+        while (decoder.decode(second)) {
+            bytes += decoder.getFrame().getBody()->encodedSize();
+            ++frames;
+        }
+    }
+    qpid::sys::Duration elapsed(start, qpid::sys::AbsTime::now());
+    std::cout << "content " << size << ": " << double(elapsed)/frames << " ns, "
+              << double(allocations - startAllocations)/frames << " allocations per frame ("
+              << frames << " frames, " << bytes << " bytes)" << std::endl;
+}
+
+int run(int argc, char** argv)
+{
+    size_t step = argc > 1 ? std::atoi(argv[1]) : 1;
+    measure(64, 1);
+    measure(1024, step);
+    measure(AMQContentBody::MIN_SHARED_SIZE, step);
+    measure(65535 - AMQFrame::frameOverhead(), step);
+    return 0;
+}
+
+}} // namespace qpid::tests
+
+int main(int argc, char** argv)
+{
+    try {
+        return qpid::tests::run(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
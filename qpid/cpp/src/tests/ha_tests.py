@@ -880,6 +880,80 @@ acl deny all all
         cluster[2].wait_address("xx")
         self.assertEqual(cluster[2].agent.getExchange("xx").values["bindingCount"], 0)
 
+    def test_batched_dequeue_failover(self):
+        """Dequeues collected into batches while messages are flowing, and ID events
+        for gaps left by messages consumed before replication, must leave the
+        backups consistent with the primary before and after failover"""
+        cluster = HaCluster(self, 3)
+        sn = cluster[0].connect().session()
+        s = sn.sender("q;{create:always}")
+        r = sn.receiver("q", capacity=0)
+        # Interleave sends with fetches so some messages are consumed before
+        # they are replicated.
+        for i in xrange(2000):
+            s.send(str(i))
+            if i % 2: sn.acknowledge(r.fetch(timeout=1))
+        expect = [str(i) for i in xrange(1000, 2000)]
+        cluster[0].assert_browse("q", expect)
+        cluster[1].assert_browse_backup("q", expect)
+        cluster[2].assert_browse_backup("q", expect)
+        # Fragment the queue: acknowledge every other message, release the rest.
+        r = cluster[0].connect().session().receiver("q", capacity=0)
+        for i in xrange(500):
+            r.fetch(timeout=1)
+            r.session.acknowledge(r.fetch(timeout=1))
+        r.session.connection.close()
+        expect = expect[::2]
+        cluster[0].assert_browse("q", expect)
+        cluster[1].assert_browse_backup("q", expect)
+        cluster[2].assert_browse_backup("q", expect)
+        cluster.kill(0)
+        cluster[1].wait_status("active")
+        cluster[1].assert_browse("q", expect)
+        cluster[2].assert_browse_backup("q", expect)
+        # Dequeues on the new primary replicate to the remaining backup.
+        r = cluster[1].connect().session().receiver("q")
+        for m in expect[:100]: self.assertEqual(m, r.fetch(timeout=1).content)
+        r.session.acknowledge()
+        cluster[2].assert_browse_backup("q", expect[100:])
+
+    def test_replication_links(self):
+        """Queues spread over several replication links keep their message order
+        on the backups and across failover"""
+        cluster = HaCluster(self, 3, args=["--ha-replication-links=3"])
+        for b in cluster:
+            hb = b.agent.getHaBroker()
+            hb.update()
+            self.assertEqual(3, hb.replicationLinks)
+        qs = ["q%s"%i for i in xrange(8)]
+        sn = cluster[0].connect().session()
+        senders = [sn.sender("%s;{create:always}"%q) for q in qs]
+        # Interleave sends so all links carry messages at the same time.
+        msgs = [str(i) for i in xrange(100)]
+        for m in msgs:
+            for s in senders: s.send(m)
+        for q in qs:
+            cluster[1].assert_browse_backup(q, msgs)
+            cluster[2].assert_browse_backup(q, msgs)
+        cluster.kill(0)
+        cluster[1].wait_status("active")
+        cluster[2].wait_status("ready")
+        # Send more on the new primary, the remaining backup follows in order.
+        sn = cluster[1].connect().session()
+        more = [str(i) for i in xrange(100, 200)]
+        for q in qs:
+            s = sn.sender(q)
+            for m in more: s.send(m)
+        for q in qs:
+            cluster[1].assert_browse(q, msgs+more)
+            cluster[2].assert_browse_backup(q, msgs+more)
+        # Consume on the new primary, the backup follows the dequeues.
+        for q in qs:
+            r = sn.receiver(q)
+            for m in msgs: self.assertEqual(m, r.fetch(timeout=1).content)
+        sn.acknowledge()
+        for q in qs: cluster[2].assert_browse_backup(q, more)
+
     def test_resource_limit_bug(self):
         """QPID-5666 Regression test: Incorrect resource limit exception for queue creation."""
         cluster = HaCluster(self, 3)
@@ -1207,6 +1281,81 @@ class RecoveryTests(HaBrokerTest):
         s.sender("q;{create:always}").send("x")
         self.assertEqual("x", s.receiver("q").fetch(0).content)
 
+class QuorumTests(HaBrokerTest):
+    """Tests for completing messages once a quorum of backups acknowledges."""
+
+    def quorum_cluster(self, args=[]):
+        """Start a primary and two ready backups, return the cluster and the
+        system ID of the second backup, which the tests stall."""
+        cluster = HaCluster(self, 3, args=args)
+        for b in cluster[1:]: b.wait_status("ready")
+        return cluster, str(cluster[2].qmf().systemId)
+
+    def backup_lag(self, cluster, backup):
+        return cluster[0].qmf().backupLag.get(backup)
+
+    def test_quorum(self):
+        """Verify that messages complete when one of two backups acknowledges,
+        that the stalled backup catches up and that its lag is reported."""
+        cluster, stalled = self.quorum_cluster(["--ha-quorum=1"])
+        self.assertEqual(cluster[0].qmf().quorum, 1)
+        s = cluster[0].connect().session().sender("q;{create:always}")
+        for b in cluster[1:]: b.wait_backup("q")
+        os.kill(cluster[2].pid, signal.SIGSTOP)
+        try:
+            for i in xrange(10): s.send(str(i), sync=False)
+            s.sync(timeout=5)   # Completed by cluster[1] alone
+            self.assertEqual(s.unsettled(), 0)
+            assert retry(lambda: self.backup_lag(cluster, stalled) == 10), \
+                "lag=%s" % self.backup_lag(cluster, stalled)
+        finally:
+            os.kill(cluster[2].pid, signal.SIGCONT)
+        cluster[2].assert_browse_backup("q", [str(i) for i in xrange(10)])
+        assert retry(lambda: self.backup_lag(cluster, stalled) == 0), \
+            "lag=%s" % self.backup_lag(cluster, stalled)
+        cluster[1].assert_browse_backup("q", [str(i) for i in xrange(10)])
+
+    def test_quorum_argument(self):
+        """Verify that the qpid.ha-quorum queue argument overrides the default
+        of waiting for all backups."""
+        cluster, stalled = self.quorum_cluster()
+        ssn = cluster[0].connect().session()
+        s1 = ssn.sender("q1;{create:always,node:{x-declare:{arguments:{'qpid.ha-quorum':1}}}}")
+        s2 = ssn.sender("q2;{create:always}")
+        for b in cluster[1:]:
+            b.wait_backup("q1")
+            b.wait_backup("q2")
+        os.kill(cluster[2].pid, signal.SIGSTOP)
+        try:
+            s1.send("x", sync=False)
+            s1.sync(timeout=5)
+            self.assertEqual(s1.unsettled(), 0)
+            s2.send("y", sync=False)
+            self.assertRaises(qpid.messaging.Timeout, s2.sync, timeout=.1)
+            self.assertEqual(s2.unsettled(), 1)
+        finally:
+            os.kill(cluster[2].pid, signal.SIGCONT)
+        s2.sync(timeout=5)
+        self.assertEqual(s2.unsettled(), 0)
+        cluster[2].assert_browse_backup("q1", ["x"])
+        cluster[2].assert_browse_backup("q2", ["y"])
+
+    def test_quorum_invalid(self):
+        """Verify that a queue with an invalid qpid.ha-quorum argument is
+        rejected at declare and is not created or replicated."""
+        cluster = HaCluster(self, 2)
+        l = LogLevel(ERROR) # Hide expected WARNING log messages from the client.
+        try:
+            ssn = cluster[0].connect().session()
+            self.assertRaises(
+                Exception, ssn.sender,
+                "q;{create:always,node:{x-declare:{arguments:{'qpid.ha-quorum':'x'}}}}")
+        finally: l.restore()
+        cluster[0].wait_no_queue("q")
+        ssn = cluster[0].connect().session()
+        ssn.sender("q;{create:always}").send("x")
+        cluster[1].assert_browse_backup("q", ["x"])
+
 class StoreTests(HaBrokerTest):
     """Test for HA with persistence."""
 
@@ -257,6 +257,67 @@ class AmqpBrokerTest(BrokerTest):
         #send to q on broker B through brokerA
         self.send_and_receive(send_config=Config(self.broker, address="q@BrokerB"), recv_config=Config(brokerB))
 
+    def relay_routes(self, brokerB, count, properties):
+        """Start count concurrent relayed routes to queues on brokerB, returning the senders
+        once a message sent over each route has arrived"""
+        agentB = brokerB.agent
+        properties.update({"url":brokerB.host_port(), "sasl_mechanisms":"NONE"})
+        self.agent.create("domain", "BrokerB", properties)
+        senders = []
+        for i in range(count):
+            agentB.create("queue", "q%s" % i)
+            sender = self.sender(Config(self.broker, address="q%s@BrokerB" % i))
+            sender._set_cloexec_flag(sender.stdin)
+            sender.stdin.write("first\n")
+            sender.stdin.flush()
+            senders.append(sender)
+        for i in range(count):
+            assert retry(lambda: agentB.getQueue("q%s" % i).msgDepth == 1), "route %s not established" % i
+        return senders
+
+    def test_relay_multiplexed(self):
+        brokerB = self.amqp_broker()
+        connections = len(brokerB.agent.getAllConnections())
+        senders = self.relay_routes(brokerB, 4, {"links_per_connection":2})
+        # Four routes share two connections
+        self.assertEqual(connections + 2, len(brokerB.agent.getAllConnections()))
+        for i, sender in enumerate(senders):
+            for j in range(100):
+                sender.stdin.write("message-%s\n" % j)
+            sender.stdin.close()
+            sender.wait()
+        for i in range(4):
+            receiver = self.receiver(Config(brokerB, address="q%s" % i))
+            assert receiver.stdout.readline().rstrip() == "first"
+            for j in range(100):
+                l = receiver.stdout.readline().rstrip()
+                assert l == "message-%s" % j, (i, j, l)
+            receiver.wait()
+
+    def test_relay_links_released(self):
+        brokerB = self.amqp_broker()
+        brokerB.agent.create("queue", "q")
+        self.agent.create("domain", "BrokerB", {"url":brokerB.host_port(), "sasl_mechanisms":"NONE", "links_per_connection":2})
+        connections = len(brokerB.agent.getAllConnections())
+        # Each route detaches when its sender exits, leaving room for the next on the same connection
+        for i in range(4):
+            self.send_and_receive(send_config=Config(self.broker, address="q@BrokerB"), recv_config=Config(brokerB, address="q"), count=10)
+        self.assertEqual(connections + 1, len(brokerB.agent.getAllConnections()))
+
+    def test_relay_credit(self):
+        brokerB = self.amqp_broker()
+        senders = self.relay_routes(brokerB, 4, {"relay_credit":10})
+        # Relays sharing a pool smaller than their own buffers still deliver everything
+        for sender in senders:
+            for j in range(500):
+                sender.stdin.write("message-%s\n" % j)
+            sender.stdin.flush()
+        for sender in senders:
+            sender.stdin.close()
+            sender.wait()
+        for i in range(4):
+            assert retry(lambda: brokerB.agent.getQueue("q%s" % i).msgDepth == 501), "q%s incomplete" % i
+
     def test_reconnect(self):
         receiver_cmd = ["qpid-receive",
                "--broker", self.broker.host_port(),
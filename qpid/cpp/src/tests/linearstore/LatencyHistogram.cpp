@@ -0,0 +1,148 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "../unit_test.h"
+
+#include "qpid/linearstore/LatencyHistogram.h"
+#include "qpid/linearstore/journal/time_ns.h"
+
+using qpid::linearstore::LatencyHistogram;
+using qpid::linearstore::journal::time_ns;
+
+namespace qpid {
+namespace tests {
+
+QPID_AUTO_TEST_SUITE(LatencyHistogramSuite)
+
+QPID_AUTO_TEST_CASE(bucketIndexExactBelowTwoRanges)
+{
+    // The first 2 * SUB_BUCKETS buckets hold one value each
+    for (uint64_t v = 0; v < 2 * LatencyHistogram::SUB_BUCKETS; ++v) {
+        BOOST_CHECK_EQUAL(LatencyHistogram::bucketIndex(v), v);
+        BOOST_CHECK_EQUAL(LatencyHistogram::bucketLowerBound(v), v);
+        BOOST_CHECK_EQUAL(LatencyHistogram::bucketUpperBound(v), v);
+    }
+}
+
+QPID_AUTO_TEST_CASE(bucketIndexBoundaries)
+{
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketIndex(16), 16U);
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketIndex(17), 16U);
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketIndex(18), 17U);
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketIndex(31), 23U);
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketIndex(32), 24U);
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketIndex(35), 24U);
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketIndex(36), 25U);
+
+    // Every value lies within its bucket and buckets are contiguous
+    for (uint64_t v = 0; v < (1 << 16); ++v) {
+        uint32_t i = LatencyHistogram::bucketIndex(v);
+        BOOST_CHECK_LE(LatencyHistogram::bucketLowerBound(i), v);
+        BOOST_CHECK_GE(LatencyHistogram::bucketUpperBound(i), v);
+    }
+    for (uint32_t i = 0; i + 1 < LatencyHistogram::NUM_BUCKETS; ++i)
+        BOOST_CHECK_EQUAL(LatencyHistogram::bucketLowerBound(i + 1), LatencyHistogram::bucketUpperBound(i) + 1);
+}
+
+QPID_AUTO_TEST_CASE(bucketIndexClamped)
+{
+    const uint32_t last = LatencyHistogram::NUM_BUCKETS - 1;
+    const uint64_t top = 1ULL << LatencyHistogram::VALUE_BITS;
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketIndex(top - 1), last);
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketUpperBound(last), top - 1);
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketIndex(top), last);
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketIndex(~0ULL), last);
+}
+
+QPID_AUTO_TEST_CASE(percentileEmpty)
+{
+    LatencyHistogram h;
+    BOOST_CHECK_EQUAL(h.count(), 0U);
+    BOOST_CHECK_EQUAL(h.percentile(0.0), 0U);
+    BOOST_CHECK_EQUAL(h.percentile(50.0), 0U);
+    BOOST_CHECK_EQUAL(h.percentile(100.0), 0U);
+
+    qpid::types::Variant::Map m;
+    h.toMap(m);
+    BOOST_CHECK_EQUAL(m["count"].asUint64(), 0U);
+    BOOST_CHECK_EQUAL(m["p99Usec"].asUint64(), 0U);
+    BOOST_CHECK(m["buckets"].asList().empty());
+}
+
+QPID_AUTO_TEST_CASE(percentileSmallValuesExact)
+{
+    LatencyHistogram h;
+    for (uint64_t v = 1; v <= 8; ++v)
+        h.record(v);
+    BOOST_CHECK_EQUAL(h.count(), 8U);
+    BOOST_CHECK_EQUAL(h.percentile(0.0), 1U);
+    BOOST_CHECK_EQUAL(h.percentile(12.5), 1U);
+    BOOST_CHECK_EQUAL(h.percentile(13.0), 2U);
+    BOOST_CHECK_EQUAL(h.percentile(50.0), 4U);
+    BOOST_CHECK_EQUAL(h.percentile(100.0), 8U);
+}
+
+QPID_AUTO_TEST_CASE(percentileUniform)
+{
+    LatencyHistogram h;
+    for (uint64_t v = 1; v <= 100; ++v)
+        h.record(v);
+    // Reported as the upper bound of the bucket holding the ranked sample
+    BOOST_CHECK_EQUAL(h.percentile(1.0), 1U);
+    BOOST_CHECK_EQUAL(h.percentile(50.0), 51U);  // 50 is in [48, 51]
+    BOOST_CHECK_EQUAL(h.percentile(90.0), 95U);  // 90 is in [88, 95]
+    BOOST_CHECK_EQUAL(h.percentile(99.0), 103U); // 99 is in [96, 103]
+    BOOST_CHECK_EQUAL(h.percentile(100.0), 103U);
+
+    qpid::types::Variant::Map m;
+    h.toMap(m);
+    BOOST_CHECK_EQUAL(m["count"].asUint64(), 100U);
+    BOOST_CHECK_EQUAL(m["sumUsec"].asUint64(), 5050U);
+    BOOST_CHECK_EQUAL(m["maxUsec"].asUint64(), 100U);
+    BOOST_CHECK_EQUAL(m["p50Usec"].asUint64(), 51U);
+}
+
+QPID_AUTO_TEST_CASE(percentileOutlier)
+{
+    LatencyHistogram h;
+    for (int i = 0; i < 999; ++i)
+        h.record(10);
+    h.record(1000000);
+    BOOST_CHECK_EQUAL(h.percentile(50.0), 10U);
+    BOOST_CHECK_EQUAL(h.percentile(99.8), 10U);
+    const uint64_t p = h.percentile(100.0);
+    BOOST_CHECK_LE(1000000U, p);
+    BOOST_CHECK_GT(1000000U + 1000000U / LatencyHistogram::SUB_BUCKETS, p);
+
+    h.reset();
+    BOOST_CHECK_EQUAL(h.count(), 0U);
+    BOOST_CHECK_EQUAL(h.percentile(100.0), 0U);
+}
+
+QPID_AUTO_TEST_CASE(elapsedUsec)
+{
+    BOOST_CHECK_EQUAL(LatencyHistogram::elapsedUsec(time_ns(1, 500000), time_ns(2, 1500)), 999501U);
+    BOOST_CHECK_EQUAL(LatencyHistogram::elapsedUsec(time_ns(2, 0), time_ns(1, 0)), 0U);
+}
+
+QPID_AUTO_TEST_SUITE_END()
+
+}}
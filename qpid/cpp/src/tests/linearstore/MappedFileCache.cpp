@@ -0,0 +1,145 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "../unit_test.h"
+
+#include "qpid/linearstore/journal/MappedFileCache.h"
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace qpid::linearstore::journal;
+
+namespace qpid {
+namespace tests {
+
+QPID_AUTO_TEST_SUITE(MappedFileCacheTestSuite)
+
+namespace {
+const std::size_t FILE_SIZE = 64 * 1024;
+
+// Journal-like files of FILE_SIZE bytes, removed on destruction
+struct Files
+{
+    std::vector<std::string> names;
+
+    Files(std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i) {
+            std::ostringstream name;
+            name << "/tmp/MappedFileCache_" << ::getpid() << "_" << i << ".jrnl";
+            std::ofstream f(name.str().c_str(), std::ios_base::out | std::ios_base::binary);
+            f << std::string(FILE_SIZE, char('a' + i));
+            names.push_back(name.str());
+        }
+    }
+
+    ~Files()
+    {
+        for (std::vector<std::string>::const_iterator i = names.begin(); i != names.end(); ++i) {
+            ::unlink(i->c_str());
+        }
+    }
+};
+
+const char* get(MappedFileCache& cache, const Files& files, std::size_t i)
+{
+    std::size_t size = 0;
+    const char* p = cache.get(i, files.names[i], size);
+    if (p) BOOST_CHECK_EQUAL(size, FILE_SIZE);
+    return p;
+}
+}
+
+QPID_AUTO_TEST_CASE(testBudgetDisablesMapping)
+{
+    Files files(1);
+    MappedFileCache::setBudget(0);
+    MappedFileCache cache;
+    BOOST_CHECK(!get(cache, files, 0));
+    BOOST_CHECK_EQUAL(MappedFileCache::totalMappedSize(), 0u);
+}
+
+QPID_AUTO_TEST_CASE(testLeastRecentlyUsedEvicted)
+{
+    Files files(3);
+    MappedFileCache::setBudget(2 * FILE_SIZE);
+    MappedFileCache cache;
+    const char* p0 = get(cache, files, 0);
+    BOOST_REQUIRE(p0);
+    BOOST_CHECK_EQUAL(p0[0], 'a');
+    BOOST_REQUIRE(get(cache, files, 1));
+    BOOST_CHECK(get(cache, files, 0) == p0); // Already mapped, now most recently used
+    const char* p2 = get(cache, files, 2);   // Evicts file 1
+    BOOST_REQUIRE(p2);
+    BOOST_CHECK_EQUAL(p2[FILE_SIZE - 1], 'c');
+    BOOST_CHECK_EQUAL(cache.mappedSize(), 2 * FILE_SIZE);
+    BOOST_CHECK_EQUAL(MappedFileCache::totalMappedSize(), 2 * FILE_SIZE);
+    cache.clear();
+    BOOST_CHECK_EQUAL(cache.mappedSize(), 0u);
+    BOOST_CHECK_EQUAL(MappedFileCache::totalMappedSize(), 0u);
+}
+
+QPID_AUTO_TEST_CASE(testBudgetSharedByAllCaches)
+{
+    Files files(4);
+    MappedFileCache::setBudget(3 * FILE_SIZE);
+    MappedFileCache a;
+    MappedFileCache b;
+    BOOST_REQUIRE(get(a, files, 0));
+    BOOST_REQUIRE(get(a, files, 1));
+    BOOST_REQUIRE(get(b, files, 2));
+    BOOST_CHECK_EQUAL(MappedFileCache::totalMappedSize(), 3 * FILE_SIZE);
+
+    // b may only make room by releasing its own mappings
+    BOOST_REQUIRE(get(b, files, 3));
+    BOOST_CHECK_EQUAL(a.mappedSize(), 2 * FILE_SIZE);
+    BOOST_CHECK_EQUAL(b.mappedSize(), FILE_SIZE);
+    BOOST_CHECK_EQUAL(MappedFileCache::totalMappedSize(), 3 * FILE_SIZE);
+
+    // A cache holding nothing cannot map past the budget used by the others
+    MappedFileCache c;
+    BOOST_CHECK(!get(c, files, 0));
+    BOOST_CHECK_EQUAL(c.mappedSize(), 0u);
+
+    b.clear();
+    BOOST_CHECK(get(c, files, 0));
+    BOOST_CHECK_EQUAL(MappedFileCache::totalMappedSize(), 3 * FILE_SIZE);
+}
+
+QPID_AUTO_TEST_CASE(testDestructorReleasesBudget)
+{
+    Files files(1);
+    MappedFileCache::setBudget(FILE_SIZE);
+    {
+        MappedFileCache cache;
+        BOOST_REQUIRE(get(cache, files, 0));
+        BOOST_CHECK_EQUAL(MappedFileCache::totalMappedSize(), FILE_SIZE);
+    }
+    BOOST_CHECK_EQUAL(MappedFileCache::totalMappedSize(), 0u);
+}
+
+QPID_AUTO_TEST_SUITE_END()
+
+}} // namespace qpid::tests
@@ -0,0 +1,285 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "../unit_test.h"
+
+#include "qpid/linearstore/journal/enq_map.h"
+#include <algorithm>
+#include <vector>
+
+using namespace qpid::linearstore::journal;
+
+namespace qpid {
+namespace tests {
+
+QPID_AUTO_TEST_SUITE(enq_map_suite)
+
+namespace {
+bool contains(const std::vector<uint64_t>& v, const uint64_t rid)
+{
+    return std::find(v.begin(), v.end(), rid) != v.end();
+}
+}
+
+QPID_AUTO_TEST_CASE(constructor)
+{
+    enq_map e;
+    BOOST_CHECK(e.empty());
+    BOOST_CHECK_EQUAL(e.size(), 0U);
+}
+
+QPID_AUTO_TEST_CASE(insert_get)
+{
+    const uint64_t rid_begin = 0xffffffff00000000ULL;
+    const uint64_t rid_end   = 0xffffffff00000200ULL;
+    enq_map e;
+    for (uint64_t rid = rid_begin; rid < rid_end; rid += 4)
+        BOOST_CHECK_EQUAL(e.insert_pfid(rid, (rid - rid_begin) / 4, rid * 16), enq_map::EMAP_OK);
+    BOOST_CHECK(!e.empty());
+    BOOST_CHECK_EQUAL(e.size(), 128U);
+
+    for (uint64_t rid = rid_begin; rid < rid_end; rid += 6) {
+        uint64_t pfid;
+        std::streampos file_posn;
+        BOOST_CHECK_EQUAL(e.is_enqueued(rid), rid % 4 == 0);
+        if (rid % 4 == 0) {
+            BOOST_CHECK_EQUAL(e.get_pfid(rid, pfid), enq_map::EMAP_OK);
+            BOOST_CHECK_EQUAL(pfid, (rid - rid_begin) / 4);
+            BOOST_CHECK_EQUAL(e.get_file_posn(rid, file_posn), enq_map::EMAP_OK);
+            BOOST_CHECK(file_posn == std::streampos(rid * 16));
+            BOOST_CHECK_EQUAL(e.insert_pfid(rid, 0, 0), enq_map::EMAP_DUP_RID);
+        } else {
+            BOOST_CHECK_EQUAL(e.get_pfid(rid, pfid), enq_map::EMAP_RID_NOT_FOUND);
+        }
+    }
+    BOOST_CHECK_EQUAL(e.size(), 128U);
+    e.clear();
+    BOOST_CHECK(e.empty());
+    BOOST_CHECK_EQUAL(e.size(), 0U);
+}
+
+QPID_AUTO_TEST_CASE(get_remove)
+{
+    enq_map e;
+    for (uint64_t rid = 0; rid < 512; rid += 4)
+        BOOST_CHECK_EQUAL(e.insert_pfid(rid, rid / 4, 0), enq_map::EMAP_OK);
+    for (uint64_t rid = 0; rid < 512; rid += 6) {
+        uint64_t pfid;
+        if (rid % 4 == 0) {
+            BOOST_CHECK_EQUAL(e.get_remove_pfid(rid, pfid), enq_map::EMAP_OK);
+            BOOST_CHECK_EQUAL(pfid, rid / 4);
+            BOOST_CHECK(!e.is_enqueued(rid));
+        } else {
+            BOOST_CHECK_EQUAL(e.get_remove_pfid(rid, pfid), enq_map::EMAP_RID_NOT_FOUND);
+        }
+    }
+    BOOST_CHECK_EQUAL(e.size(), 85U);
+}
+
+QPID_AUTO_TEST_CASE(lock_unlock)
+{
+    // Every second record is inserted locked
+    enq_map e;
+    bool locked = false;
+    for (uint64_t rid = 0; rid < 512; rid += 4) {
+        BOOST_CHECK_EQUAL(e.insert_pfid(rid, 1, 0, locked), enq_map::EMAP_OK);
+        locked = !locked;
+    }
+    BOOST_CHECK_EQUAL(e.lock(1), enq_map::EMAP_RID_NOT_FOUND);
+    BOOST_CHECK_EQUAL(e.unlock(2), enq_map::EMAP_RID_NOT_FOUND);
+
+    for (uint64_t rid = 0; rid < 512; rid += 4) {
+        uint64_t pfid;
+        const bool exp_locked = rid % 8 != 0;
+        BOOST_CHECK_EQUAL(e.is_locked(rid), exp_locked ? enq_map::EMAP_TRUE : enq_map::EMAP_FALSE);
+        BOOST_CHECK_EQUAL(e.is_enqueued(rid), !exp_locked);
+        BOOST_CHECK(e.is_enqueued(rid, true));
+        if (exp_locked) {
+            BOOST_CHECK_EQUAL(e.get_pfid(rid, pfid), enq_map::EMAP_LOCKED);
+            BOOST_CHECK_EQUAL(e.get_remove_pfid(rid, pfid), enq_map::EMAP_LOCKED);
+            BOOST_CHECK_EQUAL(e.unlock(rid), enq_map::EMAP_OK);
+            BOOST_CHECK_EQUAL(e.get_pfid(rid, pfid), enq_map::EMAP_OK);
+            BOOST_CHECK_EQUAL(e.lock(rid), enq_map::EMAP_OK);
+            BOOST_CHECK_EQUAL(e.get_pfid(rid, pfid), enq_map::EMAP_LOCKED);
+        }
+    }
+
+    // A commit or abort removes locked records
+    for (uint64_t rid = 0; rid < 512; rid += 4) {
+        uint64_t pfid;
+        BOOST_CHECK_EQUAL(e.get_remove_pfid(rid, pfid, true), enq_map::EMAP_OK);
+    }
+    BOOST_CHECK(e.empty());
+}
+
+QPID_AUTO_TEST_CASE(lists)
+{
+    enq_map e;
+    std::vector<uint64_t> exp_rids;
+    std::vector<uint64_t> exp_pfids;
+    for (uint64_t rid = 0; rid < 512; rid += 4) {
+        BOOST_CHECK_EQUAL(e.insert_pfid(rid, rid / 4, 0), enq_map::EMAP_OK);
+        exp_rids.push_back(rid);
+        exp_pfids.push_back(rid / 4);
+    }
+    std::vector<uint64_t> rids;
+    e.rid_list(rids);
+    BOOST_CHECK(rids == exp_rids);
+    std::vector<uint64_t> pfids;
+    e.pfid_list(pfids);
+    BOOST_CHECK(pfids == exp_pfids);
+}
+
+QPID_AUTO_TEST_CASE(sparse_fallback)
+{
+    // Rids below the window (eg from a late transaction commit) and rids after a jump too large to
+    // bridge are kept in the ordered map and behave like any other record
+    enq_map e;
+    for (uint64_t rid = 1000; rid < 1000 + 64 * 8; ++rid)
+        BOOST_CHECK_EQUAL(e.insert_pfid(rid, 1, 0), enq_map::EMAP_OK);
+    BOOST_CHECK_EQUAL(e.insert_pfid(10, 2, 0, true), enq_map::EMAP_OK);
+    BOOST_CHECK_EQUAL(e.insert_pfid(10, 2, 0), enq_map::EMAP_DUP_RID);
+    const uint64_t far_rid = 1ULL << 40;
+    BOOST_CHECK_EQUAL(e.insert_pfid(far_rid, 3, 0), enq_map::EMAP_OK);
+    BOOST_CHECK_EQUAL(e.size(), 64U * 8 + 2);
+
+    uint64_t pfid;
+    BOOST_CHECK_EQUAL(e.get_pfid(10, pfid), enq_map::EMAP_LOCKED);
+    BOOST_CHECK_EQUAL(e.unlock(10), enq_map::EMAP_OK);
+    BOOST_CHECK_EQUAL(e.get_pfid(10, pfid), enq_map::EMAP_OK);
+    BOOST_CHECK_EQUAL(pfid, 2U);
+    BOOST_CHECK_EQUAL(e.get_pfid(1000, pfid), enq_map::EMAP_OK);
+    BOOST_CHECK_EQUAL(pfid, 1U);
+    BOOST_CHECK_EQUAL(e.get_pfid(far_rid, pfid), enq_map::EMAP_OK);
+    BOOST_CHECK_EQUAL(pfid, 3U);
+
+    std::vector<uint64_t> rids;
+    e.rid_list(rids);
+    BOOST_CHECK_EQUAL(rids.size(), e.size());
+    BOOST_CHECK_EQUAL(rids.front(), 10U);
+    BOOST_CHECK_EQUAL(rids.back(), far_rid);
+    BOOST_CHECK(contains(rids, 1000));
+
+    for (std::vector<uint64_t>::const_iterator i = rids.begin(); i != rids.end(); ++i)
+        BOOST_CHECK_EQUAL(e.get_remove_pfid(*i, pfid), enq_map::EMAP_OK);
+    BOOST_CHECK(e.empty());
+}
+
+QPID_AUTO_TEST_CASE(spread_rids)
+{
+    // Rids come from a store-wide sequence, so with many busy queues each journal only sees every
+    // Nth rid and chunks stay nearly empty. The map must still hold every record, and must go back
+    // to chunks once the rids are dense again.
+    const uint64_t queues = 100;
+    const uint64_t count = 5000;
+    enq_map e;
+    for (uint64_t i = 0; i < count; ++i)
+        BOOST_CHECK_EQUAL(e.insert_pfid(i * queues + 7, i / 1000, i), enq_map::EMAP_OK);
+    BOOST_CHECK_EQUAL(e.size(), count);
+
+    const uint64_t dense_begin = count * queues + 7;
+    for (uint64_t rid = dense_begin; rid < dense_begin + 64 * 16; ++rid)
+        BOOST_CHECK_EQUAL(e.insert_pfid(rid, 9, 0), enq_map::EMAP_OK);
+    BOOST_CHECK_EQUAL(e.size(), count + 64 * 16);
+
+    uint64_t pfid;
+    for (uint64_t i = 0; i < count; ++i) {
+        BOOST_CHECK_EQUAL(e.get_pfid(i * queues + 7, pfid), enq_map::EMAP_OK);
+        BOOST_CHECK_EQUAL(pfid, i / 1000);
+        BOOST_CHECK(!e.is_enqueued(i * queues + 8));
+    }
+    std::vector<uint64_t> rids;
+    e.rid_list(4, rids, 2000);
+    BOOST_CHECK_EQUAL(rids.size(), 1000U);
+    BOOST_CHECK_EQUAL(rids.front(), 4000 * queues + 7);
+
+    // Remove in dequeue order, interleaved with more spread inserts
+    for (uint64_t i = 0; i < count; ++i) {
+        BOOST_CHECK_EQUAL(e.get_remove_pfid(i * queues + 7, pfid), enq_map::EMAP_OK);
+        BOOST_CHECK_EQUAL(e.insert_pfid(dense_begin + 64 * 16 + i * queues, 5, 0), enq_map::EMAP_OK);
+    }
+    BOOST_CHECK_EQUAL(e.size(), count + 64 * 16);
+    for (uint64_t rid = dense_begin; rid < dense_begin + 64 * 16; ++rid)
+        BOOST_CHECK_EQUAL(e.get_remove_pfid(rid, pfid), enq_map::EMAP_OK);
+    for (uint64_t i = 0; i < count; ++i)
+        BOOST_CHECK_EQUAL(e.get_remove_pfid(dense_begin + 64 * 16 + i * queues, pfid), enq_map::EMAP_OK);
+    BOOST_CHECK(e.empty());
+}
+
+QPID_AUTO_TEST_CASE(rid_list_pfid_sparse)
+{
+    // A few old records left in a chunk that has fallen behind the window are folded into the
+    // sparse map; they are the ones compaction looks for.
+    enq_map e;
+    for (uint64_t rid = 0; rid < 64; ++rid)
+        BOOST_CHECK_EQUAL(e.insert_pfid(rid, 1, rid * 128), enq_map::EMAP_OK);
+    uint64_t pfid;
+    for (uint64_t rid = 0; rid < 64; ++rid) {
+        if (rid != 5 && rid != 17 && rid != 40)
+            BOOST_CHECK_EQUAL(e.get_remove_pfid(rid, pfid), enq_map::EMAP_OK);
+    }
+    for (uint64_t rid = 64; rid < 64 * 20; ++rid)
+        BOOST_CHECK_EQUAL(e.insert_pfid(rid, 2, rid * 128), enq_map::EMAP_OK);
+    BOOST_CHECK_EQUAL(e.lock(17), enq_map::EMAP_OK);
+
+    std::vector<uint64_t> rids;
+    e.rid_list(1, rids, 256);
+    BOOST_CHECK_EQUAL(rids.size(), 2U); // Locked rid 17 is not a candidate
+    BOOST_CHECK(contains(rids, 5));
+    BOOST_CHECK(contains(rids, 40));
+
+    e.rid_list(2, rids, 10);
+    BOOST_CHECK_EQUAL(rids.size(), 10U);
+}
+
+QPID_AUTO_TEST_CASE(rid_list_pfid_resumes)
+{
+    // Each call searches only part of a large map, the next call resumes where it stopped
+    const uint64_t count = 100000;
+    enq_map e;
+    for (uint64_t rid = 0; rid < count; ++rid)
+        BOOST_CHECK_EQUAL(e.insert_pfid(rid, 2, rid * 128), enq_map::EMAP_OK);
+    for (uint64_t rid = count; rid < count + 10; ++rid)
+        BOOST_CHECK_EQUAL(e.insert_pfid(rid, 1, rid * 128), enq_map::EMAP_OK);
+
+    std::vector<uint64_t> rids;
+    e.rid_list(1, rids, 256);
+    BOOST_CHECK(rids.empty());
+    std::size_t calls = 1;
+    while (rids.empty() && calls < 100) {
+        e.rid_list(1, rids, 256);
+        ++calls;
+    }
+    BOOST_CHECK_EQUAL(rids.size(), 10U);
+    BOOST_CHECK_EQUAL(rids.front(), count);
+    BOOST_CHECK(calls < 10);
+
+    // The search wraps round, so records behind the resume point are found again
+    for (calls = 0; calls < 10; ++calls) {
+        e.rid_list(1, rids, 256);
+        if (!rids.empty()) break;
+    }
+    BOOST_CHECK_EQUAL(rids.size(), 10U);
+}
+
+QPID_AUTO_TEST_SUITE_END()
+
+}} // namespace qpid::tests
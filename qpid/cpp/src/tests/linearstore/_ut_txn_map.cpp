@@ -0,0 +1,146 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "../unit_test.h"
+
+#include "qpid/linearstore/journal/txn_map.h"
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace qpid::linearstore::journal;
+
+namespace qpid {
+namespace tests {
+
+QPID_AUTO_TEST_SUITE(txn_map_suite)
+
+namespace {
+const std::string make_xid(const uint64_t rid)
+{
+    std::stringstream ss;
+    ss << "XID-" << std::setfill('0') << std::setw(16) << std::hex << rid << "-0123456789abcdef";
+    return ss.str();
+}
+}
+
+QPID_AUTO_TEST_CASE(constructor)
+{
+    txn_data_t td(0x123456789abcdef0ULL, 0xfedcba9876543210ULL, 0xfedcU, 0x1000U, true, false, false);
+    BOOST_CHECK_EQUAL(td.rid_, 0x123456789abcdef0ULL);
+    BOOST_CHECK_EQUAL(td.drid_, 0xfedcba9876543210ULL);
+    BOOST_CHECK_EQUAL(td.fid_, 0xfedcU);
+    BOOST_CHECK_EQUAL(td.foffs_, 0x1000U);
+    BOOST_CHECK(td.enq_flag_);
+    BOOST_CHECK(!td.aio_compl_);
+
+    txn_map t;
+    BOOST_CHECK(t.empty());
+    BOOST_CHECK_EQUAL(t.size(), 0U);
+}
+
+QPID_AUTO_TEST_CASE(insert_get)
+{
+    const uint64_t rid_begin = 0xffffffff00000000ULL;
+    const uint64_t rid_end   = 0xffffffff00000200ULL;
+    txn_map t;
+    for (uint64_t rid = rid_begin; rid < rid_end; rid += 4)
+        BOOST_CHECK(t.insert_txn_data(make_xid(rid), txn_data_t(rid, ~rid, rid & 0xff, 0, false, false, false)));
+    BOOST_CHECK(!t.empty());
+    BOOST_CHECK_EQUAL(t.size(), 128U);
+
+    for (uint64_t rid = rid_begin; rid < rid_end; rid += 6) {
+        const std::string xid = make_xid(rid);
+        BOOST_CHECK_EQUAL(t.in_map(xid), rid % 4 == 0);
+        const txn_data_list_t tdl = t.get_tdata_list(xid);
+        BOOST_CHECK_EQUAL(tdl.size(), rid % 4 == 0 ? 1U : 0U);
+        if (!tdl.empty()) {
+            BOOST_CHECK_EQUAL(tdl[0].rid_, rid);
+            BOOST_CHECK_EQUAL(tdl[0].drid_, ~rid);
+        }
+    }
+}
+
+QPID_AUTO_TEST_CASE(get_remove)
+{
+    // Several operations under one xid are kept in the order they were added
+    txn_map t;
+    const std::string xid = make_xid(1);
+    for (uint64_t rid = 1; rid <= 10; ++rid)
+        t.insert_txn_data(xid, txn_data_t(rid, 0, 0, 0, rid % 2 == 1, false, false));
+    t.insert_txn_data(make_xid(2), txn_data_t(11, 0, 0, 0, true, false, false));
+    BOOST_CHECK_EQUAL(t.size(), 2U);
+    BOOST_CHECK_EQUAL(t.enq_cnt(), 6U);
+    BOOST_CHECK_EQUAL(t.deq_cnt(), 5U);
+
+    const txn_data_list_t tdl = t.get_remove_tdata_list(xid);
+    BOOST_CHECK_EQUAL(tdl.size(), 10U);
+    for (std::size_t i = 0; i < tdl.size(); ++i)
+        BOOST_CHECK_EQUAL(tdl[i].rid_, i + 1);
+    BOOST_CHECK(!t.in_map(xid));
+    BOOST_CHECK(t.get_remove_tdata_list(xid).empty());
+    BOOST_CHECK_EQUAL(t.size(), 1U);
+    t.clear();
+    BOOST_CHECK(t.empty());
+}
+
+QPID_AUTO_TEST_CASE(aio_compl)
+{
+    txn_map t;
+    const std::string xid = make_xid(1);
+    BOOST_CHECK_EQUAL(t.is_txn_synced(xid), txn_map::TMAP_XID_NOT_FOUND);
+    BOOST_CHECK_EQUAL(t.set_aio_compl(xid, 1), txn_map::TMAP_XID_NOT_FOUND);
+    t.insert_txn_data(xid, txn_data_t(1, 0, 0, 0, true, false, false));
+    t.insert_txn_data(xid, txn_data_t(2, 100, 0, 0, false, false, false));
+    BOOST_CHECK_EQUAL(t.is_txn_synced(xid), txn_map::TMAP_NOT_SYNCED);
+    BOOST_CHECK_EQUAL(t.set_aio_compl(xid, 3), txn_map::TMAP_RID_NOT_FOUND);
+    BOOST_CHECK_EQUAL(t.set_aio_compl(xid, 1), txn_map::TMAP_OK);
+    BOOST_CHECK_EQUAL(t.is_txn_synced(xid), txn_map::TMAP_NOT_SYNCED);
+    BOOST_CHECK_EQUAL(t.set_aio_compl(xid, 2), txn_map::TMAP_OK);
+    BOOST_CHECK_EQUAL(t.is_txn_synced(xid), txn_map::TMAP_SYNCED);
+
+    BOOST_CHECK(t.data_exists(xid, 2));
+    BOOST_CHECK(!t.data_exists(xid, 3));
+    BOOST_CHECK(!t.data_exists(make_xid(2), 1));
+    // An enqueue is found by its rid, a dequeue by the rid it dequeues
+    BOOST_CHECK(t.is_enq(1));
+    BOOST_CHECK(t.is_enq(100));
+    BOOST_CHECK(!t.is_enq(2));
+}
+
+QPID_AUTO_TEST_CASE(xid_list)
+{
+    // The xids are hashed, but are listed in order
+    txn_map t;
+    std::vector<std::string> exp_xids;
+    for (uint64_t rid = 200; rid > 0; --rid) {
+        t.insert_txn_data(make_xid(rid * 7), txn_data_t(rid, 0, 0, 0, true, false, false));
+        exp_xids.insert(exp_xids.begin(), make_xid(rid * 7));
+    }
+    std::vector<std::string> xids;
+    t.xid_list(xids);
+    BOOST_CHECK(xids == exp_xids);
+}
+
+QPID_AUTO_TEST_SUITE_END()
+
+}} // namespace qpid::tests
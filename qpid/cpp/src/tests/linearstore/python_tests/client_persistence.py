@@ -17,7 +17,7 @@
 # under the License.
 #
 
-import os
+import os, re, time
 
 from brokertest import EXPECT_EXIT_OK
 from store_test import StoreTest, Qmf, store_args
@@ -119,6 +119,50 @@ class ExchangeQueueTests(StoreTest):
         self.check_messages(broker, "q3", [msg1, msg2], True)
 
 
+    def test_shared_content_fanout(self):
+        """Test fanout to durable queues storing their message content in the shared content store"""
+        broker = self.broker(store_args(), name="test_shared_content_fanout", expect=EXPECT_EXIT_OK)
+        ssn = broker.connect().session()
+        snd = ssn.sender("TestSharedContent; {create: always, node: {type: topic, x-declare: {type: fanout}}}")
+        for q in ["sc1", "sc2", "sc3"]:
+            ssn.receiver("TestSharedContent; {link: {name: \"%s\", durable: True, reliability:at-least-once, "
+                         "x-declare: {arguments: {'qpid.store_shared_content': True}}}}" % q)
+        msg1 = Message("Msg1", durable=True, correlation_id="Msg0001")
+        snd.send(msg1)
+        msg2 = Message("Msg2", durable=True, correlation_id="Msg0002")
+        snd.send(msg2)
+        broker.terminate()
+
+        # Consuming from one queue must not release the content still referenced by the others
+        broker = self.broker(store_args(), name="test_shared_content_fanout", expect=EXPECT_EXIT_OK)
+        self.check_messages(broker, "sc1", [msg1, msg2], empty=True)
+        broker.terminate()
+
+        broker = self.broker(store_args(), name="test_shared_content_fanout")
+        self.check_messages(broker, "sc2", [msg1, msg2], True)
+        self.check_messages(broker, "sc3", [msg1, msg2], True)
+
+    def test_shared_content_txn_dequeue(self):
+        """Test that committed transactional dequeues release their shared content references"""
+        broker = self.broker(store_args(), name="test_shared_content_txn_dequeue", expect=EXPECT_EXIT_OK)
+        ssn = broker.connect().session()
+        snd = ssn.sender("TestSharedContentTxn; {create: always, node: {type: topic, x-declare: {type: fanout}}}")
+        for q in ["sctx1", "sctx2"]:
+            ssn.receiver("TestSharedContentTxn; {link: {name: \"%s\", durable: True, reliability:at-least-once, "
+                         "x-declare: {arguments: {'qpid.store_shared_content': True}}}}" % q)
+        msg1 = Message("Msg1", durable=True, correlation_id="Msg0001")
+        snd.send(msg1)
+        self.check_messages(broker, "sctx1", [msg1], transactional=True, empty=True)
+        self.check_messages(broker, "sctx2", [msg1], transactional=True, empty=True)
+        broker.terminate()
+
+        # Nothing may be left for recovery to release
+        broker = self.broker(store_args(), name="test_shared_content_txn_dequeue")
+        self.check_messages(broker, "sctx1", [], emtpy_flag=True)
+        self.check_messages(broker, "sctx2", [], emtpy_flag=True)
+        self.assertEqual(self._get_hits(broker, re.compile("Shared content store: released [0-9]+ unreferenced")), [])
+
+
     def test_message_reject(self):
         broker = self.broker(store_args(), name="test_message_reject", expect=EXPECT_EXIT_OK)
         ssn = broker.connect().session()
@@ -237,3 +281,36 @@ class RedeliveredTests(StoreTest):
         self.assertEqual(msg_content, rcv_msg.content)
         self.assertTrue(rcv_msg.redelivered)
         
+
+
+class CompactionTests(StoreTest):
+    """
+    Test recovery of journals in which still-enqueued records have been relocated by compaction
+    """
+
+    def test_relocated_recovery(self):
+        """Test that a message pinning the oldest journal file is recovered exactly once after relocation"""
+        args = store_args() + ["--efp-file-size", "64", "--journal-compaction-rate", "1024"]
+        broker = self.broker(args, name="test_relocated_recovery", expect=EXPECT_EXIT_OK)
+        ssn = broker.connect().session()
+        snd = ssn.sender("tcr; {create:always, node:{type:queue, durable:True}}")
+        rcv = ssn.receiver("tcr; {create:always, node:{type:queue, durable:True}}")
+        pinned = Message("pinned", durable=True, correlation_id="Msg0000")
+        snd.send(pinned)
+        self.assertEqual(rcv.fetch(timeout=1).content, pinned.content) # Left unacknowledged
+        # Write and consume enough messages that the file holding the pinned record is no longer current
+        for i in range(1, 201):
+            snd.send(Message("x"*1024, durable=True, correlation_id="Msg%04d" % i))
+            ssn.acknowledge(message=rcv.fetch(timeout=1))
+        ssn.sync()
+        time.sleep(2) # Allow the compaction timer to relocate the pinned record
+        broker.terminate()
+
+        # The original and the relocated copy are both in the journal, only one may be recovered
+        broker = self.broker(args, name="test_relocated_recovery", expect=EXPECT_EXIT_OK)
+        self.check_message(broker, "tcr", pinned, empty=True, ack=False).close()
+        broker.terminate()
+
+        # Recover again from the journal written by the recovered broker
+        broker = self.broker(args, name="test_relocated_recovery")
+        self.check_message(broker, "tcr", pinned, empty=True)
@@ -0,0 +1,157 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+/**
+ * Measures the cost of encoding and decoding a Variant::Map with the
+ * AMQP 0-10 MapCodec and with the AMQP 1.0 Encoder/Decoder: time and
+ * heap allocations per map. Not a test, run by hand.
+ */
+
+#include "qpid/amqp/Decoder.h"
+#include "qpid/amqp/Encoder.h"
+#include "qpid/amqp_0_10/Codecs.h"
+#include "qpid/sys/Time.h"
+#include "qpid/types/Variant.h"
+#include "qpid/types/encodings.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <vector>
+
+namespace {
+size_t allocations = 0;
+}
+
+void* operator new(size_t size)
+{
+    ++allocations;
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) throw()
+{
+    std::free(p);
+}
+
+namespace qpid {
+namespace tests {
+
+using qpid::types::Variant;
+
+Variant::Map createMap(size_t entries)
+{
+    Variant::Map map;
+    for (size_t i = 0; i < entries; ++i) {
+        std::stringstream key;
+        key << "key-" << i;
+        switch (i % 4) {
+          case 0: map[key.str()] = (uint32_t) i; break;
+          case 1: map[key.str()] = (int64_t) -i; break;
+          case 2:
+            map[key.str()] = "a string value";
+            map[key.str()].setEncoding(qpid::types::encodings::UTF8);
+            break;
+          case 3: map[key.str()] = (double) i / 2; break;
+        }
+    }
+    Variant::Map nested;
+    nested["name"] = "nested";
+    nested["name"].setEncoding(qpid::types::encodings::UTF8);
+    nested["count"] = (uint16_t) 7;
+    map["nested"] = nested;
+    return map;
+}
+
+class Measurement
+{
+  public:
+    Measurement(const std::string& n, size_t c) : name(n), count(c), start(qpid::sys::AbsTime::now()), startAllocations(allocations) {}
+    ~Measurement()
+    {
+        qpid::sys::Duration elapsed(start, qpid::sys::AbsTime::now());
+        size_t n = allocations - startAllocations;
+        std::cout << name << ": " << double(elapsed)/count << " ns, "
+                  << double(n)/count << " allocations per map" << std::endl;
+    }
+  private:
+    const std::string name;
+    const size_t count;
+    const qpid::sys::AbsTime start;
+    const size_t startAllocations;
+};
+
+int run(int argc, char** argv)
+{
+    size_t count = argc > 1 ? std::atoi(argv[1]) : 10000;
+    size_t entries = argc > 2 ? std::atoi(argv[2]) : 20;
+    Variant::Map map = createMap(entries);
+
+    std::string encoded;
+    {
+        Measurement m("0-10 encode", count);
+        for (size_t i = 0; i < count; ++i) {
+            qpid::amqp_0_10::MapCodec::encode(map, encoded);
+        }
+    }
+    {
+        Measurement m("0-10 decode", count);
+        for (size_t i = 0; i < count; ++i) {
+            Variant::Map decoded;
+            qpid::amqp_0_10::MapCodec::decode(encoded, decoded);
+        }
+    }
+
+    std::vector<char> buffer(encoded.size() * 2 + 1024);
+    size_t size = 0;
+    {
+        Measurement m("1.0 encode", count);
+        for (size_t i = 0; i < count; ++i) {
+            qpid::amqp::Encoder encoder(&buffer[0], buffer.size());
+            encoder.writeMap(map);
+            size = encoder.getPosition();
+        }
+    }
+    {
+        Measurement m("1.0 decode", count);
+        for (size_t i = 0; i < count; ++i) {
+            Variant::Map decoded;
+            qpid::amqp::Decoder decoder(&buffer[0], size);
+            decoder.readMap(decoded);
+        }
+    }
+    return 0;
+}
+
+}} // namespace qpid::tests
+
+int main(int argc, char** argv)
+{
+    try {
+        return qpid::tests::run(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Failed: " << e.what() << std::endl;
+        return 1;
+    }
+}